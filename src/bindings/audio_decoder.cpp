@@ -1,4 +1,5 @@
 #include "audio_decoder.h"
+#include <nanobind/stl/shared_ptr.h>
 #include <nanobind/ndarray.h>
 #include <cstring>
 #include <stdexcept>
@@ -21,11 +22,16 @@ bool is_aac_codec(const std::string& codec) {
 }
 }  // namespace
 
-AudioDecoder::AudioDecoder(nb::object output, nb::object error)
+AudioDecoder::AudioDecoder(nb::object output,
+                           nb::object error,
+                           std::shared_ptr<WorkerPool> worker_pool,
+                           bool output_queue)
     : output_callback_(output),
       error_callback_(error),
       state_(CodecState::UNCONFIGURED),
-      frame_count_(0) {
+      frame_count_(0),
+      worker_pool_(worker_pool ? std::move(worker_pool)
+                               : WorkerPool::default_pool()) {
   opus_decoder_ = nullptr;
   flac_decoder_ = nullptr;
   flac_input_position_ = 0;
@@ -36,6 +42,9 @@ AudioDecoder::AudioDecoder(nb::object output, nb::object error)
   // コールバックフラグを設定
   has_output_callback_ = !output_callback_.is_none();
   has_error_callback_ = !error_callback_.is_none();
+  if (output_queue) {
+    output_queue_ = std::make_unique<OutputQueue<std::unique_ptr<AudioData>>>();
+  }
   // コンストラクタではコーデックの初期化は行わない
   // configure() で初期化する
 }
@@ -92,7 +101,7 @@ void AudioDecoder::configure(nb::dict config_dict) {
   }
 
   // ワーカースレッドの開始
-  if (!worker_thread_.joinable()) {
+  if (!is_worker_running()) {
     start_worker();
   }
 
@@ -106,7 +115,7 @@ void AudioDecoder::decode(const EncodedAudioChunk& chunk) {
 
   // タスクを作成してキューに追加
   DecodeTask task;
-  task.chunk = chunk;
+  task.chunk = chunk;  // ペイロードは共有されるためバイト列はコピーされない
   task.sequence_number = next_sequence_number_++;
 
   {
@@ -117,6 +126,7 @@ void AudioDecoder::decode(const EncodedAudioChunk& chunk) {
 
   // ワーカースレッドに通知
   queue_cv_.notify_one();
+  post_worker_tasks(1);
 
   // デキューコールバックを呼び出す
   nb::object dequeue_cb;
@@ -151,9 +161,125 @@ void AudioDecoder::handle_decoded_frame(std::unique_ptr<AudioData> data) {
 }
 
 void AudioDecoder::flush() {
+  // 全てのペンディングタスクと flush タスクが完了するまで待機
   std::unique_lock<std::mutex> lock(queue_mutex_);
-  queue_cv_.wait(
-      lock, [this]() { return decode_queue_.empty() && pending_tasks_ == 0; });
+  queue_cv_.wait(lock, [this]() { return is_queue_idle(); });
+}
+
+uint64_t AudioDecoder::request_flush() {
+  if (!output_queue_) {
+    throw std::runtime_error("output_queue is not enabled");
+  }
+  uint64_t id;
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    // 構成済みでない場合は何もせずに完了とする
+    if (state_ != CodecState::CONFIGURED) {
+      return completed_flushes_;
+    }
+    // decode() で追加したチャンクを全て処理した後にワーカーで完了を通知する
+    DecodeTask task{};
+    task.flush = true;
+    decode_queue_.push(task);
+    id = ++requested_flushes_;
+  }
+  queue_cv_.notify_one();
+  post_worker_tasks(1);
+  return id;
+}
+
+void AudioDecoder::run_flush_task() {
+  // デコーダー内部に溜まるデータはないため、それまでのタスクを処理し終えたことだけを通知する
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    // reset() で完了扱いにした flush タスクは数えない
+    if (completed_flushes_ < requested_flushes_) {
+      completed_flushes_++;
+    }
+  }
+  queue_cv_.notify_all();
+  output_queue_->wake();
+}
+
+bool AudioDecoder::is_queue_idle() const {
+  return decode_queue_.empty() && pending_tasks_ == 0 &&
+         completed_flushes_ == requested_flushes_;
+}
+
+std::vector<std::unique_ptr<AudioData>> AudioDecoder::decode_sync(
+    const EncodedAudioChunk& chunk) {
+  if (state_ != CodecState::CONFIGURED) {
+    throw std::runtime_error("AudioDecoder is not configured");
+  }
+
+  DecodeTask task;
+  task.chunk = chunk;  // ペイロードは共有されるためバイト列はコピーされない
+
+  std::lock_guard<std::mutex> sync_lock(sync_mutex_);
+  return run_sync([this, &task]() {
+    {
+      // decode() でキューに追加したチャンクと順序が入れ替わらないよう、処理し終えるまで待機する
+      std::unique_lock<std::mutex> lock(queue_mutex_);
+      queue_cv_.wait(lock, [this]() { return is_queue_idle(); });
+      task.sequence_number = next_sequence_number_++;
+    }
+    process_decode_task(task);
+  });
+}
+
+std::vector<std::unique_ptr<AudioData>> AudioDecoder::flush_sync() {
+  std::lock_guard<std::mutex> sync_lock(sync_mutex_);
+  return run_sync([this]() { flush(); });
+}
+
+std::vector<std::unique_ptr<AudioData>> AudioDecoder::run_sync(
+    const std::function<void()>& fn) {
+  std::vector<std::unique_ptr<AudioData>> outputs;
+  sync_outputs_ = &outputs;
+  sync_thread_ = std::this_thread::get_id();
+  try {
+    fn();
+  } catch (...) {
+    sync_thread_ = std::thread::id();
+    sync_outputs_ = nullptr;
+    throw;
+  }
+  sync_thread_ = std::thread::id();
+  sync_outputs_ = nullptr;
+  return outputs;
+}
+
+std::unique_ptr<AudioData> AudioDecoder::read_output(
+    std::optional<double> timeout,
+    bool until_idle) {
+  if (!output_queue_) {
+    throw std::runtime_error("output_queue is not enabled");
+  }
+  auto output = output_queue_->pop(timeout, [this, until_idle]() {
+    return state_ == CodecState::CLOSED ||
+           (until_idle && pending_tasks_ == 0);
+  });
+  return output ? std::move(*output) : nullptr;
+}
+
+std::vector<std::unique_ptr<AudioData>> AudioDecoder::read_all_outputs() {
+  if (!output_queue_) {
+    throw std::runtime_error("output_queue is not enabled");
+  }
+  return output_queue_->pop_all();
+}
+
+int AudioDecoder::output_queue_fd() {
+  if (!output_queue_) {
+    throw std::runtime_error("output_queue is not enabled");
+  }
+  return output_queue_->wakeup_fd();
+}
+
+void AudioDecoder::clear_output_queue_fd() {
+  if (output_queue_) {
+    output_queue_->clear_wakeup_fd();
+  }
 }
 
 void AudioDecoder::reset() {
@@ -167,6 +293,8 @@ void AudioDecoder::reset() {
       decode_queue_.pop();
     }
     pending_tasks_ = 0;
+    // 破棄した flush タスクは完了として扱い、flush_async() の待機を終わらせる
+    completed_flushes_ = requested_flushes_.load();
   }
 
   // 出力バッファをクリア
@@ -214,6 +342,10 @@ void AudioDecoder::close() {
 #endif
 
   state_ = CodecState::CLOSED;
+  // 出力キューで待機している read() を起こす (出力済みのデータはキューに残す)
+  if (output_queue_) {
+    output_queue_->wake();
+  }
 }
 
 AudioDecoderSupport AudioDecoder::is_config_supported(
@@ -257,6 +389,31 @@ AudioDecoderSupport AudioDecoder::is_config_supported(
 // ワーカースレッドの開始
 void AudioDecoder::start_worker() {
   should_stop_ = false;
+  if (worker_pool_) {
+    // プールを使う場合はスレッドを立てず、キューに残っているタスクを投入する
+    // 関数から例外が伝播した場合はエラーコールバックで報告する
+    worker_strand_ =
+        worker_pool_->create_strand([this](const std::string& message) {
+          nb::object error_cb;
+          bool has_error;
+          {
+            nb::ft_lock_guard guard(callback_mutex_);
+            error_cb = error_callback_;
+            has_error = has_error_callback_;
+          }
+          if (has_error && !error_cb.is_none()) {
+            nb::gil_scoped_acquire gil;
+            error_cb(message);
+          }
+        });
+    size_t queued;
+    {
+      std::lock_guard<std::mutex> lock(queue_mutex_);
+      queued = decode_queue_.size();
+    }
+    post_worker_tasks(queued);
+    return;
+  }
   worker_thread_ = std::thread([this]() { worker_loop(); });
 }
 
@@ -268,17 +425,33 @@ void AudioDecoder::stop_worker() {
   }
   queue_cv_.notify_all();
 
+  if (worker_strand_) {
+    // 投入済みのタスクを処理し終えるまで待つ
+    worker_strand_->drain();
+    worker_strand_.reset();
+  }
   if (worker_thread_.joinable()) {
     worker_thread_.join();
   }
 }
 
+bool AudioDecoder::is_worker_running() const {
+  return worker_thread_.joinable() || worker_strand_ != nullptr;
+}
+
+void AudioDecoder::post_worker_tasks(size_t count) {
+  std::shared_ptr<WorkerStrand> strand = worker_strand_;
+  if (!strand) {
+    return;
+  }
+  for (size_t i = 0; i < count; i++) {
+    strand->post([this]() { run_next_task(); });
+  }
+}
+
 // ワーカースレッドのメインループ
 void AudioDecoder::worker_loop() {
   while (true) {
-    DecodeTask task;
-
-    // タスクを取得
     {
       std::unique_lock<std::mutex> lock(queue_mutex_);
       queue_cv_.wait(
@@ -287,26 +460,45 @@ void AudioDecoder::worker_loop() {
       if (should_stop_ && decode_queue_.empty()) {
         break;
       }
-
-      if (!decode_queue_.empty()) {
-        task = decode_queue_.front();
-        decode_queue_.pop();
-      } else {
-        continue;
-      }
     }
+    run_next_task();
+  }
+}
 
-    // タスクを処理
-    if (task.chunk.has_value()) {
-      process_decode_task(task);
-    }
+// キューの先頭のタスクを処理する
+// 専用スレッドの worker_loop() とプールのストランドの両方から呼ばれる
+void AudioDecoder::run_next_task() {
+  DecodeTask task;
 
-    // 処理待ちタスク数を減らす
-    {
-      std::lock_guard<std::mutex> lock(queue_mutex_);
-      pending_tasks_--;
+  // タスクを取得
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    if (decode_queue_.empty()) {
+      return;
     }
-    queue_cv_.notify_all();
+    task = decode_queue_.front();
+    decode_queue_.pop();
+  }
+
+  // flush タスクは処理待ちのタスク数に含めない
+  if (task.flush) {
+    run_flush_task();
+    return;
+  }
+
+  // タスクを処理
+  if (task.chunk.has_value()) {
+    process_decode_task(task);
+  }
+
+  // 処理待ちタスク数を減らす
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    pending_tasks_--;
+  }
+  queue_cv_.notify_all();
+  if (output_queue_) {
+    output_queue_->wake();
   }
 }
 
@@ -346,6 +538,20 @@ void AudioDecoder::handle_output(uint64_t sequence,
     }
   }
 
+  // 同期モードで実行中の場合はコールバックを呼ばずに戻り値として返す
+  if (sync_thread_.load() == std::this_thread::get_id()) {
+    for (auto& audio_data : data_to_output) {
+      sync_outputs_->push_back(std::move(audio_data));
+    }
+    return;
+  }
+
+  // 出力キューモードでは GIL を取得せずにキューに追加する
+  if (output_queue_) {
+    output_queue_->push(data_to_output);
+    return;
+  }
+
   // コールバックを呼び出す（GIL を取得）
   nb::object output_cb;
   bool has_output;
@@ -365,12 +571,26 @@ void AudioDecoder::handle_output(uint64_t sequence,
   }
 }
 
+// 同期モードで返すデータを Python のリストに変換する (GIL を保持して呼び出す)
+static nb::list audio_data_to_list(
+    std::vector<std::unique_ptr<AudioData>>& outputs) {
+  nb::list list;
+  for (auto& audio_data : outputs) {
+    list.append(nb::cast(audio_data.release(), nb::rv_policy::take_ownership));
+  }
+  return list;
+}
+
 void init_audio_decoder(nb::module_& m) {
   nb::class_<AudioDecoder>(m, "AudioDecoder")
-      .def(nb::init<nb::object, nb::object>(), "output"_a, "error"_a,
-           nb::sig(
-               "def __init__(self, output: typing.Callable[[AudioData], None], "
-               "error: typing.Callable[[str], None], /) -> None"))
+      .def(nb::init<nb::object, nb::object, std::shared_ptr<WorkerPool>,
+                    bool>(),
+           "output"_a, "error"_a, nb::kw_only(),
+           "worker_pool"_a.none() = nb::none(), "output_queue"_a = false,
+           nb::sig("def __init__(self, output: typing.Callable[[AudioData], "
+                   "None] | None, error: typing.Callable[[str], None], /, *, "
+                   "worker_pool: WorkerPool | None = None, "
+                   "output_queue: bool = False) -> None"))
       .def("configure", &AudioDecoder::configure, "config"_a,
            nb::sig("def configure(self, config: webcodecs.AudioDecoderConfig, "
                    "/) -> None"))
@@ -380,6 +600,95 @@ void init_audio_decoder(nb::module_& m) {
       .def("flush", &AudioDecoder::flush,
            nb::call_guard<nb::gil_scoped_release>(),
            nb::sig("def flush(self, /) -> None"))
+      .def(
+          "decode_sync",
+          [](AudioDecoder& self, const EncodedAudioChunk& chunk) {
+            std::vector<std::unique_ptr<AudioData>> outputs;
+            {
+              nb::gil_scoped_release gil;
+              outputs = self.decode_sync(chunk);
+            }
+            return audio_data_to_list(outputs);
+          },
+          "chunk"_a,
+          nb::sig("def decode_sync(self, chunk: EncodedAudioChunk, /) -> "
+                  "list[AudioData]"))
+      .def(
+          "flush_sync",
+          [](AudioDecoder& self) {
+            std::vector<std::unique_ptr<AudioData>> outputs;
+            {
+              nb::gil_scoped_release gil;
+              outputs = self.flush_sync();
+            }
+            return audio_data_to_list(outputs);
+          },
+          nb::sig("def flush_sync(self, /) -> list[AudioData]"))
+      .def(
+          "read",
+          [](AudioDecoder& self, std::optional<double> timeout) -> nb::object {
+            std::unique_ptr<AudioData> data;
+            {
+              nb::gil_scoped_release gil;
+              data = self.read_output(timeout, false);
+            }
+            if (!data) {
+              return nb::none();
+            }
+            return nb::cast(data.release(), nb::rv_policy::take_ownership);
+          },
+          "timeout"_a = nb::none(),
+          nb::sig("def read(self, timeout: float | None = None) -> "
+                  "AudioData | None"))
+      .def(
+          "read_all",
+          [](AudioDecoder& self) {
+            std::vector<std::unique_ptr<AudioData>> outputs =
+                self.read_all_outputs();
+            return audio_data_to_list(outputs);
+          },
+          nb::sig("def read_all(self, /) -> list[AudioData]"))
+      .def("__iter__", [](nb::object self) { return self; },
+           nb::sig("def __iter__(self, /) -> typing.Iterator[AudioData]"))
+      .def(
+          "__next__",
+          [](AudioDecoder& self) {
+            std::unique_ptr<AudioData> data;
+            {
+              nb::gil_scoped_release gil;
+              data = self.read_output(std::nullopt, true);
+            }
+            if (!data) {
+              throw nb::stop_iteration();
+            }
+            return nb::cast(data.release(), nb::rv_policy::take_ownership);
+          },
+          nb::sig("def __next__(self, /) -> AudioData"))
+      .def_prop_ro("output_queue_size", &AudioDecoder::output_queue_size,
+                   nb::sig("def output_queue_size(self, /) -> int"))
+      .def_prop_ro("output_queue_fd", &AudioDecoder::output_queue_fd,
+                   nb::sig("def output_queue_fd(self, /) -> int"))
+      .def("clear_output_queue_fd", &AudioDecoder::clear_output_queue_fd,
+           nb::sig("def clear_output_queue_fd(self, /) -> None"))
+      .def("request_flush", &AudioDecoder::request_flush,
+           nb::sig("def request_flush(self, /) -> int"))
+      .def_prop_ro("completed_flushes", &AudioDecoder::completed_flushes,
+                   nb::sig("def completed_flushes(self, /) -> int"))
+      .def(
+          "flush_async",
+          [](nb::object self) {
+            return nb::module_::import_("webcodecs._asyncio")
+                .attr("flush_async")(self);
+          },
+          nb::sig("def flush_async(self, /) -> "
+                  "typing.Coroutine[typing.Any, typing.Any, None]"))
+      .def(
+          "frames",
+          [](nb::object self) {
+            return nb::module_::import_("webcodecs._asyncio")
+                .attr("outputs")(self);
+          },
+          nb::sig("def frames(self, /) -> typing.AsyncIterator[AudioData]"))
       .def("reset", &AudioDecoder::reset, nb::sig("def reset(self, /) -> None"))
       .def("close", &AudioDecoder::close, nb::sig("def close(self, /) -> None"))
       .def_prop_ro("state", &AudioDecoder::state,
@@ -39,13 +39,12 @@ void AudioDecoder::decode_frame_opus(const EncodedAudioChunk& chunk) {
     throw std::runtime_error("Opus decoder not initialized");
   }
 
-  auto encoded_data = chunk.data_vector();
-
   std::vector<float> output(OPUS_MAX_FRAME_SIZE * config_.number_of_channels);
 
-  int decoded_samples =
-      opus_decode_float(opus_decoder_, encoded_data.data(), encoded_data.size(),
-                        output.data(), OPUS_MAX_FRAME_SIZE, 0);
+  // opus_decode_float() は呼び出し中のみデータを参照するため、コピーせずに渡す
+  int decoded_samples = opus_decode_float(
+      opus_decoder_, chunk.data(), static_cast<opus_int32>(chunk.byte_length()),
+      output.data(), OPUS_MAX_FRAME_SIZE, 0);
 
   if (decoded_samples < 0) {
     throw std::runtime_error("Opus decoding failed: " +
@@ -1,4 +1,5 @@
 #include "audio_encoder.h"
+#include <nanobind/stl/shared_ptr.h>
 #include <cstring>
 #include <stdexcept>
 #include <vector>
@@ -20,11 +21,16 @@ bool is_aac_codec(const std::string& codec) {
 }
 }  // namespace
 
-AudioEncoder::AudioEncoder(nb::object output, nb::object error)
+AudioEncoder::AudioEncoder(nb::object output,
+                           nb::object error,
+                           std::shared_ptr<WorkerPool> worker_pool,
+                           bool output_queue)
     : output_callback_(output),
       error_callback_(error),
       state_(CodecState::UNCONFIGURED),
-      frame_count_(0) {
+      frame_count_(0),
+      worker_pool_(worker_pool ? std::move(worker_pool)
+                               : WorkerPool::default_pool()) {
   opus_encoder_ = nullptr;
   flac_encoder_ = nullptr;
   flac_current_timestamp_ = 0;
@@ -36,6 +42,10 @@ AudioEncoder::AudioEncoder(nb::object output, nb::object error)
   // コールバックフラグを設定
   has_output_callback_ = !output_callback_.is_none();
   has_error_callback_ = !error_callback_.is_none();
+  if (output_queue) {
+    output_queue_ =
+        std::make_unique<OutputQueue<std::unique_ptr<EncodedAudioChunk>>>();
+  }
   // コンストラクタではコーデックの初期化は行わない
   // configure() で初期化する
 }
@@ -130,7 +140,7 @@ void AudioEncoder::configure(nb::dict config_dict) {
   }
 
   // ワーカースレッドの開始
-  if (!worker_thread_.joinable()) {
+  if (!is_worker_running()) {
     start_worker();
   }
 
@@ -155,6 +165,7 @@ void AudioEncoder::encode(const AudioData& data) {
 
   // ワーカースレッドに通知
   queue_cv_.notify_one();
+  post_worker_tasks(1);
 
   // デキューコールバックを呼び出す
   nb::object dequeue_cb;
@@ -178,7 +189,9 @@ void AudioEncoder::handle_encoded_frame(const uint8_t* data,
     nb::ft_lock_guard guard(callback_mutex_);
     has_output = has_output_callback_;
   }
-  if (has_output) {
+  // 同期モードと出力キューモードではコールバックがなくてもチャンクを作成する
+  if (has_output || output_queue_ ||
+      sync_thread_.load() == std::this_thread::get_id()) {
     auto chunk = std::make_unique<EncodedAudioChunk>(
         std::vector<uint8_t>(data, data + size), EncodedAudioChunkType::KEY,
         timestamp, 0);
@@ -202,14 +215,60 @@ void AudioEncoder::handle_encoded_frame(const uint8_t* data,
 }
 
 void AudioEncoder::flush() {
-  // 全てのペンディングタスクが完了するまで待機
+  // 全てのペンディングタスクと flush タスクが完了するまで待機
   {
     std::unique_lock<std::mutex> lock(queue_mutex_);
-    queue_cv_.wait(lock, [this]() {
-      return encode_queue_.empty() && pending_tasks_ == 0;
-    });
+    queue_cv_.wait(lock, [this]() { return is_queue_idle(); });
+  }
+
+  flush_encoder();
+}
+
+uint64_t AudioEncoder::request_flush() {
+  if (!output_queue_) {
+    throw std::runtime_error("output_queue is not enabled");
+  }
+  uint64_t id;
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    // 構成済みでない場合は何もせずに完了とする
+    if (state_ != CodecState::CONFIGURED) {
+      return completed_flushes_;
+    }
+    // encode() で追加したデータを全て処理した後にワーカーで flush する
+    EncodeTask task{};
+    task.flush = true;
+    encode_queue_.push(task);
+    id = ++requested_flushes_;
+  }
+  queue_cv_.notify_one();
+  post_worker_tasks(1);
+  return id;
+}
+
+void AudioEncoder::run_flush_task() {
+  try {
+    flush_encoder();
+  } catch (const std::exception& e) {
+    report_error(e.what());
   }
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    // reset() で完了扱いにした flush タスクは数えない
+    if (completed_flushes_ < requested_flushes_) {
+      completed_flushes_++;
+    }
+  }
+  queue_cv_.notify_all();
+  output_queue_->wake();
+}
+
+bool AudioEncoder::is_queue_idle() const {
+  return encode_queue_.empty() && pending_tasks_ == 0 &&
+         completed_flushes_ == requested_flushes_;
+}
 
+void AudioEncoder::flush_encoder() {
   // FLAC エンコーダーは finish() で残りのデータをフラッシュする必要がある
   if (config_.codec == "flac" && flac_encoder_) {
     finalize_flac_encoder();
@@ -227,8 +286,85 @@ void AudioEncoder::flush() {
     init_aac_encoder();
   }
 #endif
-  // Opus エンコーダーは明示的なフラッシュが不要
-  // フレームを即座に処理する
+  // Opus エンコーダーは frame_duration に満たない残りのサンプルをパディングして出力する
+  if (config_.codec == "opus" && opus_encoder_) {
+    finalize_opus_encoder();
+  }
+}
+
+std::vector<std::unique_ptr<EncodedAudioChunk>> AudioEncoder::encode_sync(
+    const AudioData& data) {
+  if (state_ != CodecState::CONFIGURED) {
+    throw std::runtime_error("AudioEncoder is not configured");
+  }
+
+  std::lock_guard<std::mutex> sync_lock(sync_mutex_);
+  return run_sync([this, &data]() {
+    {
+      // encode() でキューに追加したデータと順序が入れ替わらないよう、処理し終えるまで待機する
+      std::unique_lock<std::mutex> lock(queue_mutex_);
+      queue_cv_.wait(lock, [this]() { return is_queue_idle(); });
+      current_sequence_ = next_sequence_number_++;
+    }
+    // 呼び出し中にエンコーダーへ渡し終えるため、データはコピーしない
+    encode_internal(data);
+  });
+}
+
+std::vector<std::unique_ptr<EncodedAudioChunk>> AudioEncoder::flush_sync() {
+  std::lock_guard<std::mutex> sync_lock(sync_mutex_);
+  return run_sync([this]() { flush(); });
+}
+
+std::vector<std::unique_ptr<EncodedAudioChunk>> AudioEncoder::run_sync(
+    const std::function<void()>& fn) {
+  std::vector<std::unique_ptr<EncodedAudioChunk>> outputs;
+  sync_outputs_ = &outputs;
+  sync_thread_ = std::this_thread::get_id();
+  try {
+    fn();
+  } catch (...) {
+    sync_thread_ = std::thread::id();
+    sync_outputs_ = nullptr;
+    throw;
+  }
+  sync_thread_ = std::thread::id();
+  sync_outputs_ = nullptr;
+  return outputs;
+}
+
+std::unique_ptr<EncodedAudioChunk> AudioEncoder::read_output(
+    std::optional<double> timeout,
+    bool until_idle) {
+  if (!output_queue_) {
+    throw std::runtime_error("output_queue is not enabled");
+  }
+  auto output = output_queue_->pop(timeout, [this, until_idle]() {
+    return state_ == CodecState::CLOSED ||
+           (until_idle && pending_tasks_ == 0);
+  });
+  return output ? std::move(*output) : nullptr;
+}
+
+std::vector<std::unique_ptr<EncodedAudioChunk>>
+AudioEncoder::read_all_outputs() {
+  if (!output_queue_) {
+    throw std::runtime_error("output_queue is not enabled");
+  }
+  return output_queue_->pop_all();
+}
+
+int AudioEncoder::output_queue_fd() {
+  if (!output_queue_) {
+    throw std::runtime_error("output_queue is not enabled");
+  }
+  return output_queue_->wakeup_fd();
+}
+
+void AudioEncoder::clear_output_queue_fd() {
+  if (output_queue_) {
+    output_queue_->clear_wakeup_fd();
+  }
 }
 
 void AudioEncoder::reset() {
@@ -242,6 +378,8 @@ void AudioEncoder::reset() {
       encode_queue_.pop();
     }
     pending_tasks_ = 0;
+    // 破棄した flush タスクは完了として扱い、flush_async() の待機を終わらせる
+    completed_flushes_ = requested_flushes_.load();
   }
 
   // 出力バッファをクリア
@@ -269,7 +407,7 @@ void AudioEncoder::close() {
 
   // ワーカースレッドを停止してからリソースを解放
   // stop_worker() は再入可能なので、デストラクタから呼ばれても安全
-  if (worker_thread_.joinable()) {
+  if (is_worker_running()) {
     stop_worker();
   }
 
@@ -277,6 +415,7 @@ void AudioEncoder::close() {
     opus_encoder_destroy(opus_encoder_);
     opus_encoder_ = nullptr;
   }
+  opus_input_buffer_.clear();
 
   if (flac_encoder_) {
     finalize_flac_encoder();
@@ -292,6 +431,10 @@ void AudioEncoder::close() {
 #endif
 
   state_ = CodecState::CLOSED;
+  // 出力キューで待機している read() を起こす (出力済みのチャンクはキューに残す)
+  if (output_queue_) {
+    output_queue_->wake();
+  }
 }
 
 AudioEncoderSupport AudioEncoder::is_config_supported(
@@ -304,7 +447,11 @@ AudioEncoderSupport AudioEncoder::is_config_supported(
         config.sample_rate == 16000 || config.sample_rate == 24000 ||
         config.sample_rate == 48000) {
       // チャンネル数の確認 (Opus は 1-2 チャンネルをサポート)
-      if (config.number_of_channels >= 1 && config.number_of_channels <= 2) {
+      // フレーム期間の確認 (2.5, 5, 10, 20, 40, 60, 80, 100, 120 ms)
+      uint64_t frame_duration =
+          config.opus.has_value() ? config.opus->frame_duration : 20000;
+      if (config.number_of_channels >= 1 && config.number_of_channels <= 2 &&
+          opus_frame_size(config.sample_rate, frame_duration) != 0) {
         supported = true;
       }
     }
@@ -335,6 +482,19 @@ AudioEncoderSupport AudioEncoder::is_config_supported(
 // ワーカースレッドの開始
 void AudioEncoder::start_worker() {
   should_stop_ = false;
+  if (worker_pool_) {
+    // プールを使う場合はスレッドを立てず、キューに残っているタスクを投入する
+    // 関数から例外が伝播した場合はエラーコールバックで報告する
+    worker_strand_ = worker_pool_->create_strand(
+        [this](const std::string& message) { report_error(message); });
+    size_t queued;
+    {
+      std::lock_guard<std::mutex> lock(queue_mutex_);
+      queued = encode_queue_.size();
+    }
+    post_worker_tasks(queued);
+    return;
+  }
   worker_thread_ = std::thread([this]() { worker_loop(); });
 }
 
@@ -346,17 +506,33 @@ void AudioEncoder::stop_worker() {
   }
   queue_cv_.notify_all();
 
+  if (worker_strand_) {
+    // 投入済みのタスクを処理し終えるまで待つ
+    worker_strand_->drain();
+    worker_strand_.reset();
+  }
   if (worker_thread_.joinable()) {
     worker_thread_.join();
   }
 }
 
+bool AudioEncoder::is_worker_running() const {
+  return worker_thread_.joinable() || worker_strand_ != nullptr;
+}
+
+void AudioEncoder::post_worker_tasks(size_t count) {
+  std::shared_ptr<WorkerStrand> strand = worker_strand_;
+  if (!strand) {
+    return;
+  }
+  for (size_t i = 0; i < count; i++) {
+    strand->post([this]() { run_next_task(); });
+  }
+}
+
 // ワーカースレッドのメインループ
 void AudioEncoder::worker_loop() {
   while (true) {
-    EncodeTask task;
-
-    // タスクを取得
     {
       std::unique_lock<std::mutex> lock(queue_mutex_);
       queue_cv_.wait(
@@ -365,26 +541,63 @@ void AudioEncoder::worker_loop() {
       if (should_stop_ && encode_queue_.empty()) {
         break;
       }
-
-      if (!encode_queue_.empty()) {
-        task = encode_queue_.front();
-        encode_queue_.pop();
-      } else {
-        continue;
-      }
     }
+    run_next_task();
+  }
+}
+
+// キューの先頭のタスクを処理する
+// 専用スレッドの worker_loop() とプールのストランドの両方から呼ばれる
+void AudioEncoder::run_next_task() {
+  EncodeTask task;
 
-    // タスクを処理
-    if (task.data) {
-      process_encode_task(task);
+  // タスクを取得
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    if (encode_queue_.empty()) {
+      return;
     }
+    task = encode_queue_.front();
+    encode_queue_.pop();
+  }
 
-    // 処理待ちタスク数を減らす
-    {
-      std::lock_guard<std::mutex> lock(queue_mutex_);
-      pending_tasks_--;
+  // flush タスクは処理待ちのタスク数に含めない
+  if (task.flush) {
+    run_flush_task();
+    return;
+  }
+
+  // タスクを処理
+  if (task.data) {
+    process_encode_task(task);
+  }
+
+  // 処理待ちタスク数を減らす
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    pending_tasks_--;
+  }
+  queue_cv_.notify_all();
+  if (output_queue_) {
+    output_queue_->wake();
+  }
+}
+
+void AudioEncoder::report_error(const std::string& message) {
+  nb::object error_cb;
+  bool has_error;
+  {
+    nb::ft_lock_guard guard(callback_mutex_);
+    error_cb = error_callback_;
+    has_error = has_error_callback_;
+  }
+  if (has_error && !error_cb.is_none()) {
+    nb::gil_scoped_acquire gil;
+    try {
+      error_cb(message);
+    } catch (...) {
+      // エラーコールバック自体のエラーは無視
     }
-    queue_cv_.notify_all();
   }
 }
 
@@ -393,13 +606,17 @@ void AudioEncoder::process_encode_task(const EncodeTask& task) {
   // 現在のシーケンス番号を保存
   current_sequence_ = task.sequence_number;
 
+  encode_internal(*task.data);
+}
+
+void AudioEncoder::encode_internal(const AudioData& data) {
   if (config_.codec == "opus") {
-    encode_frame_opus(*task.data);
+    encode_frame_opus(data);
   } else if (config_.codec == "flac") {
-    encode_frame_flac(*task.data);
+    encode_frame_flac(data);
 #if defined(__APPLE__)
   } else if (is_aac_codec(config_.codec)) {
-    encode_frame_aac(*task.data);
+    encode_frame_aac(data);
 #endif
   }
 }
@@ -424,6 +641,20 @@ void AudioEncoder::handle_output(uint64_t sequence,
     }
   }
 
+  // 同期モードで実行中の場合はコールバックを呼ばずに戻り値として返す
+  if (sync_thread_.load() == std::this_thread::get_id()) {
+    for (auto& chunk : chunks_to_output) {
+      sync_outputs_->push_back(std::move(chunk));
+    }
+    return;
+  }
+
+  // 出力キューモードでは GIL を取得せずにキューに追加する
+  if (output_queue_) {
+    output_queue_->push(chunks_to_output);
+    return;
+  }
+
   // コールバックを呼び出す（GIL を取得）
   nb::object output_cb;
   bool has_output;
@@ -442,12 +673,27 @@ void AudioEncoder::handle_output(uint64_t sequence,
   }
 }
 
+// 同期モードで返すチャンクを Python のリストに変換する (GIL を保持して呼び出す)
+static nb::list chunks_to_list(
+    std::vector<std::unique_ptr<EncodedAudioChunk>>& chunks) {
+  nb::list list;
+  for (auto& chunk : chunks) {
+    list.append(nb::cast(chunk.release(), nb::rv_policy::take_ownership));
+  }
+  return list;
+}
+
 void init_audio_encoder(nb::module_& m) {
   nb::class_<AudioEncoder>(m, "AudioEncoder")
-      .def(nb::init<nb::object, nb::object>(), "output"_a, "error"_a,
+      .def(nb::init<nb::object, nb::object, std::shared_ptr<WorkerPool>,
+                    bool>(),
+           "output"_a, "error"_a, nb::kw_only(),
+           "worker_pool"_a.none() = nb::none(), "output_queue"_a = false,
            nb::sig("def __init__(self, output: "
-                   "typing.Callable[[EncodedAudioChunk], None], "
-                   "error: typing.Callable[[str], None], /) -> None"))
+                   "typing.Callable[[EncodedAudioChunk], None] | None, "
+                   "error: typing.Callable[[str], None], /, *, "
+                   "worker_pool: WorkerPool | None = None, "
+                   "output_queue: bool = False) -> None"))
       .def("configure", &AudioEncoder::configure, "config"_a,
            nb::sig("def configure(self, config: webcodecs.AudioEncoderConfig, "
                    "/) -> None"))
@@ -457,6 +703,96 @@ void init_audio_encoder(nb::module_& m) {
       .def("flush", &AudioEncoder::flush,
            nb::call_guard<nb::gil_scoped_release>(),
            nb::sig("def flush(self, /) -> None"))
+      .def(
+          "encode_sync",
+          [](AudioEncoder& self, const AudioData& data) {
+            std::vector<std::unique_ptr<EncodedAudioChunk>> chunks;
+            {
+              nb::gil_scoped_release gil;
+              chunks = self.encode_sync(data);
+            }
+            return chunks_to_list(chunks);
+          },
+          "data"_a,
+          nb::sig("def encode_sync(self, data: AudioData, /) -> "
+                  "list[EncodedAudioChunk]"))
+      .def(
+          "flush_sync",
+          [](AudioEncoder& self) {
+            std::vector<std::unique_ptr<EncodedAudioChunk>> chunks;
+            {
+              nb::gil_scoped_release gil;
+              chunks = self.flush_sync();
+            }
+            return chunks_to_list(chunks);
+          },
+          nb::sig("def flush_sync(self, /) -> list[EncodedAudioChunk]"))
+      .def(
+          "read",
+          [](AudioEncoder& self, std::optional<double> timeout) -> nb::object {
+            std::unique_ptr<EncodedAudioChunk> chunk;
+            {
+              nb::gil_scoped_release gil;
+              chunk = self.read_output(timeout, false);
+            }
+            if (!chunk) {
+              return nb::none();
+            }
+            return nb::cast(chunk.release(), nb::rv_policy::take_ownership);
+          },
+          "timeout"_a = nb::none(),
+          nb::sig("def read(self, timeout: float | None = None) -> "
+                  "EncodedAudioChunk | None"))
+      .def(
+          "read_all",
+          [](AudioEncoder& self) {
+            std::vector<std::unique_ptr<EncodedAudioChunk>> chunks =
+                self.read_all_outputs();
+            return chunks_to_list(chunks);
+          },
+          nb::sig("def read_all(self, /) -> list[EncodedAudioChunk]"))
+      .def("__iter__", [](nb::object self) { return self; },
+           nb::sig("def __iter__(self, /) -> "
+                   "typing.Iterator[EncodedAudioChunk]"))
+      .def(
+          "__next__",
+          [](AudioEncoder& self) {
+            std::unique_ptr<EncodedAudioChunk> chunk;
+            {
+              nb::gil_scoped_release gil;
+              chunk = self.read_output(std::nullopt, true);
+            }
+            if (!chunk) {
+              throw nb::stop_iteration();
+            }
+            return nb::cast(chunk.release(), nb::rv_policy::take_ownership);
+          },
+          nb::sig("def __next__(self, /) -> EncodedAudioChunk"))
+      .def_prop_ro("output_queue_size", &AudioEncoder::output_queue_size,
+                   nb::sig("def output_queue_size(self, /) -> int"))
+      .def_prop_ro("output_queue_fd", &AudioEncoder::output_queue_fd,
+                   nb::sig("def output_queue_fd(self, /) -> int"))
+      .def("clear_output_queue_fd", &AudioEncoder::clear_output_queue_fd,
+           nb::sig("def clear_output_queue_fd(self, /) -> None"))
+      .def("request_flush", &AudioEncoder::request_flush,
+           nb::sig("def request_flush(self, /) -> int"))
+      .def_prop_ro("completed_flushes", &AudioEncoder::completed_flushes,
+                   nb::sig("def completed_flushes(self, /) -> int"))
+      .def(
+          "flush_async",
+          [](nb::object self) {
+            return nb::module_::import_("webcodecs._asyncio")
+                .attr("flush_async")(self);
+          },
+          nb::sig("def flush_async(self, /) -> "
+                  "typing.Coroutine[typing.Any, typing.Any, None]"))
+      .def(
+          "chunks",
+          [](nb::object self) {
+            return nb::module_::import_("webcodecs._asyncio")
+                .attr("outputs")(self);
+          },
+          nb::sig("def chunks(self, /) -> typing.AsyncIterator[EncodedAudioChunk]"))
       .def("reset", &AudioEncoder::reset, nb::sig("def reset(self, /) -> None"))
       .def("close", &AudioEncoder::close, nb::sig("def close(self, /) -> None"))
       .def_prop_ro("state", &AudioEncoder::state,
@@ -487,6 +823,14 @@ void init_audio_encoder(nb::module_& m) {
             if (config_dict.contains("bitrate_mode"))
               config.bitrate_mode =
                   nb::cast<BitrateMode>(config_dict["bitrate_mode"]);
+            if (config_dict.contains("opus")) {
+              nb::dict opus_dict = nb::cast<nb::dict>(config_dict["opus"]);
+              OpusEncoderConfig opus_config;
+              if (opus_dict.contains("frame_duration"))
+                opus_config.frame_duration =
+                    nb::cast<uint64_t>(opus_dict["frame_duration"]);
+              config.opus = opus_config;
+            }
 
             return AudioEncoder::is_config_supported(config);
           },
@@ -15,7 +15,9 @@
 
 #include <FLAC/stream_encoder.h>
 #include <opus.h>
+#include "output_queue.h"
 #include "webcodecs_types.h"
+#include "worker_pool.h"
 
 #if defined(__APPLE__)
 #include <AudioToolbox/AudioToolbox.h>
@@ -32,10 +34,17 @@ class AudioEncoder {
   struct EncodeTask {
     std::shared_ptr<AudioData> data;  // AudioDataの共有所有権
     uint64_t sequence_number;         // タスクの順序を保持
+    // request_flush() で追加した flush タスク (データは持たない)
+    bool flush = false;
   };
 
   // コールバックを直接受け取るコンストラクタ
-  AudioEncoder(nb::object output, nb::object error);
+  // worker_pool を指定した場合は専用スレッドの代わりにプールのスレッドで処理する
+  // output_queue が true の場合は出力コールバックの代わりに出力キューに溜める
+  AudioEncoder(nb::object output,
+               nb::object error,
+               std::shared_ptr<WorkerPool> worker_pool = nullptr,
+               bool output_queue = false);
   ~AudioEncoder();
 
   // dict を受け取る configure
@@ -45,6 +54,38 @@ class AudioEncoder {
   void reset();
   void close();
 
+  // 同期モード（独自拡張）
+  // ワーカースレッドを経由せず、呼び出し元のスレッドでエンコードする
+  // 出力コールバックは呼び出さず、順序が確定したチャンクを戻り値で返す
+  std::vector<std::unique_ptr<EncodedAudioChunk>> encode_sync(
+      const AudioData& data);
+  // flush() と同じ処理を行い、残りのチャンクを戻り値で返す
+  std::vector<std::unique_ptr<EncodedAudioChunk>> flush_sync();
+
+  // 出力キューモード（独自拡張）
+  // 出力キューからチャンクを 1 つ取り出す。取り出せなかった場合は nullptr を返す
+  // timeout (秒) が nullopt の場合は close() されるまで待機する
+  // until_idle が true の場合は処理待ちのタスクがなくなった時点でも待機をやめる
+  std::unique_ptr<EncodedAudioChunk> read_output(
+      std::optional<double> timeout,
+      bool until_idle);
+  // 出力キューのチャンクを待機せずに全て取り出す
+  std::vector<std::unique_ptr<EncodedAudioChunk>> read_all_outputs();
+  // 出力キューに溜まっているチャンクの数
+  uint32_t output_queue_size() const {
+    return output_queue_ ? static_cast<uint32_t>(output_queue_->size()) : 0;
+  }
+  // 出力の追加やタスクの完了、close() の度に読み込み可能になるファイルディスクリプタ
+  // asyncio のイベントループで監視する
+  int output_queue_fd();
+  // output_queue_fd() の通知を読み捨てる
+  void clear_output_queue_fd();
+  // 処理待ちのタスクの後ろに flush タスクを追加し、その番号を返す (flush_async() から使用)
+  // ワーカーがエンコーダー内部に残っているサンプルを出力し終えると completed_flushes が
+  // その番号に達し、output_queue_fd() に通知する
+  uint64_t request_flush();
+  uint64_t completed_flushes() const { return completed_flushes_.load(); }
+
   CodecState state() const { return state_; }
   uint32_t encode_queue_size() const { return pending_tasks_.load(); }
 
@@ -102,9 +143,15 @@ class AudioEncoder {
   std::queue<EncodeTask> encode_queue_;     // エンコード待ちタスクのキュー
   std::atomic<uint32_t> pending_tasks_{0};  // 処理待ちタスク数
   std::atomic<uint64_t> next_sequence_number_{0};  // タスクのシーケンス番号
+  // request_flush() で追加した flush タスクの数と処理し終えた数 (queue_mutex_ を保持して更新する)
+  // reset() で破棄した flush タスクは処理し終えたものとして扱う
+  std::atomic<uint64_t> requested_flushes_{0};
+  std::atomic<uint64_t> completed_flushes_{0};
   std::mutex queue_mutex_;                         // キューアクセスの同期
   std::condition_variable queue_cv_;               // キューの待機/通知
   std::thread worker_thread_;                      // ワーカースレッド
+  std::shared_ptr<WorkerPool> worker_pool_;        // 共有するワーカープール
+  std::shared_ptr<WorkerStrand> worker_strand_;    // プールで処理する場合のストランド
   std::atomic<bool> should_stop_{false};           // スレッド終了フラグ
   uint64_t current_sequence_{0};                   // 現在処理中のシーケンス番号
 
@@ -116,8 +163,27 @@ class AudioEncoder {
   uint64_t next_output_sequence_{0};  // 次に出力すべきシーケンス番号
   std::mutex output_mutex_;           // 出力バッファの同期
 
+  // 同期モードのためのメンバー
+  // sync_thread_ で実行中に出力されたチャンクはコールバックを呼ばずに sync_outputs_ に追加する
+  std::mutex sync_mutex_;  // 同期モードの呼び出しを直列化する
+  std::atomic<std::thread::id> sync_thread_{};
+  std::vector<std::unique_ptr<EncodedAudioChunk>>* sync_outputs_{nullptr};
+
+  // 出力キューモードで順序が確定したチャンクを溜めるキュー (無効の場合は nullptr)
+  std::unique_ptr<OutputQueue<std::unique_ptr<EncodedAudioChunk>>>
+      output_queue_;
+
   void init_opus_encoder();
   void encode_frame_opus(const AudioData& data);
+  void encode_opus_packet(const float* pcm);
+  void finalize_opus_encoder();
+
+  // Opus エンコード用バッファ
+  // encode() をまたいで frame_duration に満たないサンプルを保持する
+  std::vector<float> opus_input_buffer_;
+  uint32_t opus_frame_size_ = 0;  // 1 パケットあたりのサンプル数
+  int64_t opus_buffer_timestamp_ = 0;
+  uint64_t opus_samples_encoded_ = 0;
 
   void init_flac_encoder();
   void encode_frame_flac(const AudioData& data);
@@ -149,11 +215,32 @@ class AudioEncoder {
 
   // 並列処理のためのメソッド
   void worker_loop();  // ワーカースレッドのメインループ
+  void run_next_task();  // キューの先頭のタスクを 1 つ処理する
   void process_encode_task(const EncodeTask& task);  // タスクの処理
+  void encode_internal(const AudioData& data);  // コーデックごとのエンコード
   void handle_output(uint64_t sequence,
                      std::unique_ptr<EncodedAudioChunk> chunk);  // 出力処理
   void start_worker();  // ワーカースレッドの開始
   void stop_worker();   // ワーカースレッドの停止
+  bool is_worker_running() const;  // ワーカースレッドまたはストランドが動作中か
+  // プールを使う場合は count 個のタスクの処理をストランドに投入する
+  void post_worker_tasks(size_t count);
+  // 処理待ちのタスクも処理中の flush タスクもないか (queue_mutex_ を保持して呼び出す)
+  bool is_queue_idle() const;
+  // エンコーダー内部に残っているサンプルを全て出力する
+  // flush() と、ワーカーで処理する flush タスクから呼び出す
+  void flush_encoder();
+  // ワーカーで flush タスクを処理し、完了を output_queue_fd() に通知する
+  void run_flush_task();
+  // エラーコールバックを呼び出す (GIL を取得する)
+  void report_error(const std::string& message);
+  // 呼び出し元のスレッドで fn を実行し、その間に出力されたチャンクを返す
+  std::vector<std::unique_ptr<EncodedAudioChunk>> run_sync(
+      const std::function<void()>& fn);
 };
 
+// frame_duration (マイクロ秒) に対応する Opus の 1 パケットあたりのサンプル数
+// 対応していない frame_duration の場合は 0 を返す
+uint32_t opus_frame_size(uint32_t sample_rate, uint64_t frame_duration);
+
 void init_audio_encoder(nb::module_& m);
@@ -1,5 +1,3 @@
-#include <algorithm>
-#include <cstring>
 #include <stdexcept>
 #include <vector>
 
@@ -9,15 +7,28 @@
 namespace {
 // Opus エンコーダーの定数
 constexpr int OPUS_MAX_PACKET_SIZE = 4000;
-
-// 各サンプルレートでの 20ms フレームサイズ
-constexpr int FRAME_SIZE_48KHZ = 960;  // 48000 * 0.02 = 960
-constexpr int FRAME_SIZE_24KHZ = 480;  // 24000 * 0.02 = 480
-constexpr int FRAME_SIZE_16KHZ = 320;  // 16000 * 0.02 = 320
-constexpr int FRAME_SIZE_12KHZ = 240;  // 12000 * 0.02 = 240
-constexpr int FRAME_SIZE_8KHZ = 160;   // 8000 * 0.02 = 160
 }  // namespace
 
+// frame_duration (マイクロ秒) から 1 パケットあたりのサンプル数を求める
+// Opus が対応する 2.5, 5, 10, 20, 40, 60, 80, 100, 120 ms 以外の場合は 0 を返す
+uint32_t opus_frame_size(uint32_t sample_rate, uint64_t frame_duration) {
+  switch (frame_duration) {
+    case 2500:
+    case 5000:
+    case 10000:
+    case 20000:
+    case 40000:
+    case 60000:
+    case 80000:
+    case 100000:
+    case 120000:
+      // 8 kHz の 2.5 ms でも 20 サンプルになるため割り切れる
+      return static_cast<uint32_t>(sample_rate * frame_duration / 1000000);
+    default:
+      return 0;
+  }
+}
+
 void AudioEncoder::init_opus_encoder() {
   // Opus エンコーダーを作成
   int error;
@@ -44,6 +55,22 @@ void AudioEncoder::init_opus_encoder() {
     // "audio" はデフォルト
   }
 
+  // フレーム期間からパケットあたりのサンプル数を決定 (デフォルト 20ms)
+  uint64_t frame_duration =
+      config_.opus.has_value() ? config_.opus->frame_duration : 20000;
+  uint32_t frame_size = opus_frame_size(sample_rate, frame_duration);
+  if (frame_size == 0) {
+    throw std::runtime_error(
+        "NotSupportedError: Opus encoder only supports frame durations of "
+        "2500, 5000, 10000, 20000, 40000, 60000, 80000, 100000, or 120000 "
+        "microseconds. Got " +
+        std::to_string(frame_duration));
+  }
+  opus_frame_size_ = frame_size;
+  opus_input_buffer_.clear();
+  opus_buffer_timestamp_ = 0;
+  opus_samples_encoded_ = 0;
+
   opus_encoder_ = opus_encoder_create(sample_rate, config_.number_of_channels,
                                       application, &error);
   if (error != OPUS_OK) {
@@ -104,62 +131,61 @@ void AudioEncoder::encode_frame_opus(const AudioData& data) {
   // 必要に応じて最初に float 形式に変換
   auto float_data = data.convert_format(AudioSampleFormat::F32);
   uint32_t frame_count = float_data->number_of_frames();
-  std::vector<float> pcm_copy(frame_count * config_.number_of_channels);
-  std::memcpy(pcm_copy.data(), float_data->data_ptr(),
-              pcm_copy.size() * sizeof(float));
-
-  // 各サンプルレートに対応する 20ms フレームサイズを取得
-  // 全てのサンプルレートで 20ms (0.02 秒) のフレーム期間を使用
-  uint32_t frame_size = FRAME_SIZE_48KHZ;
-  if (config_.sample_rate == 24000) {
-    frame_size = FRAME_SIZE_24KHZ;
-  } else if (config_.sample_rate == 16000) {
-    frame_size = FRAME_SIZE_16KHZ;
-  } else if (config_.sample_rate == 12000) {
-    frame_size = FRAME_SIZE_12KHZ;
-  } else if (config_.sample_rate == 8000) {
-    frame_size = FRAME_SIZE_8KHZ;
-  }
-
-  // 出力バッファを準備
-  std::vector<uint8_t> output(OPUS_MAX_PACKET_SIZE);
 
-  // オーディオをチャンクごとに処理
-  uint32_t samples_processed = 0;
-  uint32_t total_samples = frame_count;
-
-  while (samples_processed < total_samples) {
-    uint32_t samples_to_process =
-        std::min(frame_size, total_samples - samples_processed);
-
-    // フルフレームに満たない場合は、ゼロでパディング
-    std::vector<float> padded_frame;
-    const float* frame_ptr =
-        pcm_copy.data() + (samples_processed * config_.number_of_channels);
-
-    if (samples_to_process < frame_size) {
-      padded_frame.resize(frame_size * config_.number_of_channels, 0.0f);
-      std::memcpy(
-          padded_frame.data(), frame_ptr,
-          samples_to_process * config_.number_of_channels * sizeof(float));
-      frame_ptr = padded_frame.data();
-    }
+  // バッファが空の場合は、この AudioData の先頭をタイムスタンプの基準にする
+  if (opus_input_buffer_.empty()) {
+    opus_buffer_timestamp_ = data.timestamp();
+    opus_samples_encoded_ = 0;
+  }
 
-    // フレームをエンコード
-    int encoded_bytes = opus_encode_float(opus_encoder_, frame_ptr, frame_size,
-                                          output.data(), output.size());
+  // 前回の encode() で残ったサンプルに続けて蓄積する
+  // パディングは flush() でのみ行うため、短い AudioData を渡してもパケットは無音にならない
+  const float* input_ptr =
+      reinterpret_cast<const float*>(float_data->data_ptr());
+  opus_input_buffer_.insert(
+      opus_input_buffer_.end(), input_ptr,
+      input_ptr + static_cast<size_t>(frame_count) * config_.number_of_channels);
+
+  size_t packet_samples =
+      static_cast<size_t>(opus_frame_size_) * config_.number_of_channels;
+  size_t offset = 0;
+  while (opus_input_buffer_.size() - offset >= packet_samples) {
+    encode_opus_packet(opus_input_buffer_.data() + offset);
+    offset += packet_samples;
+  }
+  // エンコード済みのサンプルはまとめて取り除く
+  opus_input_buffer_.erase(
+      opus_input_buffer_.begin(),
+      opus_input_buffer_.begin() + static_cast<ptrdiff_t>(offset));
+}
 
-    if (encoded_bytes < 0) {
-      throw std::runtime_error("Opus encoding failed: " +
-                               std::string(opus_strerror(encoded_bytes)));
-    }
+void AudioEncoder::encode_opus_packet(const float* pcm) {
+  std::vector<uint8_t> output(OPUS_MAX_PACKET_SIZE);
+  int encoded_bytes =
+      opus_encode_float(opus_encoder_, pcm, static_cast<int>(opus_frame_size_),
+                        output.data(), static_cast<opus_int32>(output.size()));
+  if (encoded_bytes < 0) {
+    throw std::runtime_error("Opus encoding failed: " +
+                             std::string(opus_strerror(encoded_bytes)));
+  }
 
-    // エンコードされたフレームを処理
-    int64_t timestamp =
-        data.timestamp() + (samples_processed * 1000000 /
-                            config_.sample_rate);  // マイクロ秒に変換
-    handle_encoded_frame(output.data(), encoded_bytes, timestamp);
+  // 誤差が蓄積しないように、基準タイムスタンプからのサンプル数で計算する
+  int64_t timestamp =
+      opus_buffer_timestamp_ +
+      static_cast<int64_t>(opus_samples_encoded_ * 1000000 /
+                           config_.sample_rate);  // マイクロ秒に変換
+  handle_encoded_frame(output.data(), encoded_bytes, timestamp);
+  opus_samples_encoded_ += opus_frame_size_;
+}
 
-    samples_processed += samples_to_process;
+void AudioEncoder::finalize_opus_encoder() {
+  if (!opus_encoder_ || opus_input_buffer_.empty()) {
+    return;
   }
+
+  // 残りのサンプルを無音でパディングして 1 パケットにする
+  opus_input_buffer_.resize(
+      static_cast<size_t>(opus_frame_size_) * config_.number_of_channels, 0.0f);
+  encode_opus_packet(opus_input_buffer_.data());
+  opus_input_buffer_.clear();
 }
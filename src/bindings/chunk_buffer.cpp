@@ -0,0 +1,87 @@
+#include "chunk_buffer.h"
+
+#include <Python.h>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+
+namespace {
+
+// GIL を保持していないスレッド (デコーダーのワーカースレッドなど) で
+// 最後の参照が外れた Py_buffer は、GIL を保持しているときにまとめて解放する
+// ワーカースレッドの join 中は呼び出し元が GIL を保持しているため、
+// ここで GIL を取得するとデッドロックする
+std::mutex g_deferred_mutex;
+std::vector<Py_buffer*> g_deferred_buffers;
+
+void release_deferred_buffers() {
+  std::vector<Py_buffer*> buffers;
+  {
+    std::lock_guard<std::mutex> lock(g_deferred_mutex);
+    buffers.swap(g_deferred_buffers);
+  }
+  for (Py_buffer* view : buffers) {
+    PyBuffer_Release(view);
+    delete view;
+  }
+}
+
+int release_deferred_buffers_callback(void*) {
+  release_deferred_buffers();
+  return 0;
+}
+
+void release_py_buffer(Py_buffer* view) {
+  if (Py_IsInitialized() == 0) {
+    // インタープリター終了後は解放できないため、そのまま手放す
+    return;
+  }
+  if (PyGILState_Check()) {
+    PyBuffer_Release(view);
+    delete view;
+    return;
+  }
+  bool schedule = false;
+  {
+    std::lock_guard<std::mutex> lock(g_deferred_mutex);
+    schedule = g_deferred_buffers.empty();
+    g_deferred_buffers.push_back(view);
+  }
+  if (schedule) {
+    // 失敗した場合は次の from_python() で解放する
+    Py_AddPendingCall(release_deferred_buffers_callback, nullptr);
+  }
+}
+
+}  // namespace
+
+ChunkBuffer::ChunkBuffer(std::vector<uint8_t> data) {
+  auto holder = std::make_shared<std::vector<uint8_t>>(std::move(data));
+  size_ = holder->size();
+  // aliasing コンストラクタで vector の所有権を共有する
+  data_ = std::shared_ptr<const uint8_t>(holder, holder->data());
+}
+
+ChunkBuffer ChunkBuffer::from_python(nb::handle obj, bool borrow) {
+  release_deferred_buffers();
+
+  auto view = std::make_unique<Py_buffer>();
+  if (PyObject_GetBuffer(obj.ptr(), view.get(), PyBUF_C_CONTIGUOUS) != 0) {
+    PyErr_Clear();
+    throw nb::type_error(
+        "data must be a C-contiguous object supporting the buffer protocol");
+  }
+
+  const auto* ptr = static_cast<const uint8_t*>(view->buf);
+  size_t size = static_cast<size_t>(view->len);
+
+  if (!borrow) {
+    std::vector<uint8_t> data(ptr, ptr + size);
+    PyBuffer_Release(view.get());
+    return ChunkBuffer(std::move(data));
+  }
+
+  // Py_buffer が元のオブジェクトへの参照を保持する
+  std::shared_ptr<Py_buffer> holder(view.release(), release_py_buffer);
+  return ChunkBuffer(std::shared_ptr<const uint8_t>(holder, ptr), size);
+}
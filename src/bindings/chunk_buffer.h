@@ -0,0 +1,40 @@
+#pragma once
+
+#include <nanobind/nanobind.h>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace nb = nanobind;
+
+// EncodedVideoChunk / EncodedAudioChunk のペイロード
+// 不変なバイト列を参照カウントで共有し、デコーダーのキューやコーデックライブラリが
+// コピーせずに同じバイト列を借用できるようにする
+class ChunkBuffer {
+ public:
+  ChunkBuffer() = default;
+
+  // vector の所有権を受け取る（コピーしない）
+  explicit ChunkBuffer(std::vector<uint8_t> data);
+
+  // data/size を指す holder を共有する（コピーしない）
+  ChunkBuffer(std::shared_ptr<const uint8_t> data, size_t size)
+      : data_(std::move(data)), size_(size) {}
+
+  // Python のバッファプロトコル対応オブジェクト (bytes / bytearray /
+  // memoryview / numpy.ndarray) から作成する
+  // borrow が true の場合はバッファをコピーせずに参照する
+  // 参照中は呼び出し側がバッファを書き換えないことを前提とする
+  static ChunkBuffer from_python(nb::handle obj, bool borrow);
+
+  const uint8_t* data() const { return data_.get(); }
+  size_t size() const { return size_; }
+
+  // コーデックライブラリに渡す間、バイト列を生存させるための参照
+  const std::shared_ptr<const uint8_t>& shared() const { return data_; }
+
+ private:
+  std::shared_ptr<const uint8_t> data_;
+  size_t size_ = 0;
+};
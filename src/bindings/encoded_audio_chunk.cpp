@@ -3,22 +3,23 @@
 
 using namespace nb::literals;
 
-EncodedAudioChunk::EncodedAudioChunk(const std::vector<uint8_t>& data,
+EncodedAudioChunk::EncodedAudioChunk(std::vector<uint8_t> data,
                                      EncodedAudioChunkType type,
                                      int64_t timestamp,
                                      uint64_t duration)
-    : data_(data), type_(type), timestamp_(timestamp), duration_(duration) {}
+    : data_(std::move(data)),
+      type_(type),
+      timestamp_(timestamp),
+      duration_(duration) {}
 
-EncodedAudioChunk::EncodedAudioChunk(nb::bytes data,
+EncodedAudioChunk::EncodedAudioChunk(ChunkBuffer data,
                                      EncodedAudioChunkType type,
                                      int64_t timestamp,
                                      uint64_t duration)
-    : type_(type), timestamp_(timestamp), duration_(duration) {
-  const char* ptr = data.c_str();
-  size_t size = data.size();
-  data_.resize(size);
-  std::memcpy(data_.data(), ptr, size);
-}
+    : data_(std::move(data)),
+      type_(type),
+      timestamp_(timestamp),
+      duration_(duration) {}
 
 // copy_to(): WebCodecs API 準拠の実装
 // destination に書き込む
@@ -57,9 +58,22 @@ void init_encoded_audio_chunk(nb::module_& m) {
             if (init.contains("duration")) {
               duration = nb::cast<uint64_t>(init["duration"]);
             }
-            nb::bytes data = nb::cast<nb::bytes>(init["data"]);
+            // bytes は不変なのでコピーせずに参照する
+            // それ以外のバッファは transfer に含まれている場合のみ参照し、
+            // 含まれていない場合はコピーする
+            nb::object data = init["data"];
+            bool borrow = nb::isinstance<nb::bytes>(data);
+            if (!borrow && init.contains("transfer")) {
+              for (nb::handle item : nb::iter(init["transfer"])) {
+                if (item.is(data)) {
+                  borrow = true;
+                  break;
+                }
+              }
+            }
 
-            new (self) EncodedAudioChunk(data, type, timestamp, duration);
+            new (self) EncodedAudioChunk(ChunkBuffer::from_python(data, borrow),
+                                         type, timestamp, duration);
           },
           "init"_a,
           nb::sig("def __init__(self, init: webcodecs.EncodedAudioChunkInit) "
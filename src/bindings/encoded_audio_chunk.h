@@ -7,6 +7,7 @@
 #include <cstdint>
 #include <string>
 #include <vector>
+#include "chunk_buffer.h"
 
 namespace nb = nanobind;
 
@@ -17,12 +18,13 @@ enum class EncodedAudioChunkType {
 
 class EncodedAudioChunk {
  public:
-  EncodedAudioChunk(const std::vector<uint8_t>& data,
+  // data の所有権を受け取る（コピーしない）
+  EncodedAudioChunk(std::vector<uint8_t> data,
                     EncodedAudioChunkType type,
                     int64_t timestamp,
                     uint64_t duration = 0);
 
-  EncodedAudioChunk(nb::bytes data,
+  EncodedAudioChunk(ChunkBuffer data,
                     EncodedAudioChunkType type,
                     int64_t timestamp,
                     uint64_t duration = 0);
@@ -37,11 +39,17 @@ class EncodedAudioChunk {
 
   // Data access
   void copy_to(nb::ndarray<nb::numpy> destination) const;
-  // 内部使用: std::vector<uint8_t> を返す
-  std::vector<uint8_t> data_vector() const { return data_; }
+  // 内部使用: ペイロードのコピーを std::vector<uint8_t> で返す
+  std::vector<uint8_t> data_vector() const {
+    return std::vector<uint8_t>(data_.data(), data_.data() + data_.size());
+  }
+  // 内部使用: ペイロードをコピーせずに参照する
+  // チャンクのコピーはペイロードを共有するため、コピーのコストは小さい
+  const uint8_t* data() const { return data_.data(); }
+  const ChunkBuffer& buffer() const { return data_; }
 
  private:
-  std::vector<uint8_t> data_;
+  ChunkBuffer data_;
   EncodedAudioChunkType type_;
   int64_t timestamp_;
   uint64_t duration_;
@@ -0,0 +1,139 @@
+#include "frame_pool.h"
+
+#include <cstdlib>
+#include <cstring>
+
+namespace nb = nanobind;
+
+FramePool::FramePool(size_t max_free_bytes) : max_free_bytes_(max_free_bytes) {}
+
+FramePool::~FramePool() {
+  trim();
+}
+
+size_t FramePool::size_class(size_t size) {
+  // ページ単位に切り上げる（同じ解像度のフレームは同じサイズクラスになる）
+  return (size + kPageSize - 1) / kPageSize * kPageSize;
+}
+
+void* FramePool::allocate_aligned(size_t size) {
+  // aligned_alloc はサイズがアライメントの倍数である必要がある
+  size_t aligned_size = (size + kAlignment - 1) / kAlignment * kAlignment;
+#if defined(_WIN32)
+  void* ptr = _aligned_malloc(aligned_size, kAlignment);
+#else
+  void* ptr = std::aligned_alloc(kAlignment, aligned_size);
+#endif
+  if (!ptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+void FramePool::free_aligned(void* ptr) noexcept {
+#if defined(_WIN32)
+  _aligned_free(ptr);
+#else
+  std::free(ptr);
+#endif
+}
+
+void* FramePool::acquire(size_t size) {
+  size_t bytes = size_class(size);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = free_lists_.find(bytes);
+    if (it != free_lists_.end() && !it->second.empty()) {
+      void* ptr = it->second.back();
+      it->second.pop_back();
+      stats_.hits++;
+      stats_.bytes_free -= bytes;
+      stats_.buffers_free--;
+      return ptr;
+    }
+    stats_.misses++;
+    stats_.bytes_resident += bytes;
+  }
+
+  void* ptr = nullptr;
+  try {
+    ptr = allocate_aligned(bytes);
+  } catch (...) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.bytes_resident -= bytes;
+    throw;
+  }
+  // 最初の書き込みでページフォルトが起きないように、ここでページを割り当てておく
+  std::memset(ptr, 0, bytes);
+  return ptr;
+}
+
+void FramePool::release(void* ptr, size_t size) noexcept {
+  if (!ptr) {
+    return;
+  }
+  size_t bytes = size_class(size);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stats_.bytes_free + bytes <= max_free_bytes_) {
+      try {
+        free_lists_[bytes].push_back(ptr);
+        stats_.bytes_free += bytes;
+        stats_.buffers_free++;
+        return;
+      } catch (...) {
+        // 空きリストに追加できない場合は解放する
+      }
+    }
+    stats_.bytes_resident -= bytes;
+  }
+  free_aligned(ptr);
+}
+
+void FramePool::trim() {
+  std::unordered_map<size_t, std::vector<void*>> free_lists;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    free_lists.swap(free_lists_);
+    stats_.bytes_resident -= stats_.bytes_free;
+    stats_.bytes_free = 0;
+    stats_.buffers_free = 0;
+  }
+  for (auto& [bytes, buffers] : free_lists) {
+    for (void* ptr : buffers) {
+      free_aligned(ptr);
+    }
+  }
+}
+
+FramePool::Stats FramePool::stats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+const std::shared_ptr<FramePool>& FramePool::global() {
+  // 終了時に VideoFrame より先に破棄されないよう意図的に解放しない
+  static const std::shared_ptr<FramePool>* pool =
+      new std::shared_ptr<FramePool>(std::make_shared<FramePool>());
+  return *pool;
+}
+
+nb::dict frame_pool_stats_to_dict(const FramePool::Stats& stats) {
+  nb::dict d;
+  d["hits"] = stats.hits;
+  d["misses"] = stats.misses;
+  d["bytes_resident"] = stats.bytes_resident;
+  d["bytes_free"] = stats.bytes_free;
+  d["buffers_free"] = stats.buffers_free;
+  return d;
+}
+
+void init_frame_pool(nb::module_& m) {
+  m.def(
+      "get_frame_pool_stats",
+      []() { return frame_pool_stats_to_dict(FramePool::global()->stats()); },
+      nb::sig("def get_frame_pool_stats() -> webcodecs.FramePoolStats"));
+  m.def(
+      "clear_frame_pool", []() { FramePool::global()->trim(); },
+      nb::sig("def clear_frame_pool() -> None"));
+}
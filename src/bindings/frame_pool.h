@@ -0,0 +1,123 @@
+#pragma once
+
+#include <nanobind/nanobind.h>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// VideoFrame のプレーンバッファを再利用するためのプール
+// バッファは 64 バイト境界に揃え、ページ単位に切り上げたサイズクラスごとに
+// 空きリストを持つ。VideoFrame が close() または破棄されるとプールに戻る
+class FramePool {
+ public:
+  // プールの統計情報
+  struct Stats {
+    uint64_t hits = 0;          // 空きリストから再利用できた回数
+    uint64_t misses = 0;        // 新しく確保した回数
+    size_t bytes_resident = 0;  // プールが確保しているバイト数 (使用中 + 空き)
+    size_t bytes_free = 0;      // 空きリストにあるバイト数
+    size_t buffers_free = 0;    // 空きリストにあるバッファ数
+  };
+
+  static constexpr size_t kAlignment = 64;
+  static constexpr size_t kPageSize = 4096;
+  // 空きリストに保持する上限 (超えた分は解放する)
+  static constexpr size_t kDefaultMaxFreeBytes = 256 * 1024 * 1024;
+
+  explicit FramePool(size_t max_free_bytes = kDefaultMaxFreeBytes);
+  ~FramePool();
+
+  FramePool(const FramePool&) = delete;
+  FramePool& operator=(const FramePool&) = delete;
+
+  // size バイト以上のバッファを返す
+  // 空きリストにあればそれを返し (内容は未初期化)、なければ新しく確保して
+  // ページをあらかじめ割り当てておく
+  void* acquire(size_t size);
+  // acquire() で受け取ったバッファを返す
+  void release(void* ptr, size_t size) noexcept;
+  // 空きリストのバッファをすべて解放する
+  void trim();
+  Stats stats() const;
+
+  // プールを使わない場合の 64 バイト境界のメモリ確保
+  static void* allocate_aligned(size_t size);
+  static void free_aligned(void* ptr) noexcept;
+
+  // プロセス全体で共有するプール
+  // デコーダー/エンコーダーに属さない VideoFrame の clone() や変換で使用する
+  static const std::shared_ptr<FramePool>& global();
+
+ private:
+  static size_t size_class(size_t size);
+
+  const size_t max_free_bytes_;
+  mutable std::mutex mutex_;
+  std::unordered_map<size_t, std::vector<void*>> free_lists_;
+  Stats stats_;
+};
+
+// FramePool からメモリを確保する std::vector 用のアロケーター
+// pool が nullptr の場合は 64 バイト境界に揃えて直接確保する
+template <typename T>
+class FramePoolAllocator {
+ public:
+  using value_type = T;
+  using propagate_on_container_copy_assignment = std::true_type;
+  using propagate_on_container_move_assignment = std::true_type;
+  using propagate_on_container_swap = std::true_type;
+
+  FramePoolAllocator() noexcept = default;
+  explicit FramePoolAllocator(std::shared_ptr<FramePool> pool) noexcept
+      : pool_(std::move(pool)) {}
+  template <typename U>
+  FramePoolAllocator(const FramePoolAllocator<U>& other) noexcept
+      : pool_(other.pool()) {}
+
+  T* allocate(size_t n) {
+    size_t size = n * sizeof(T);
+    void* ptr = pool_ ? pool_->acquire(size) : FramePool::allocate_aligned(size);
+    return static_cast<T*>(ptr);
+  }
+
+  void deallocate(T* ptr, size_t n) noexcept {
+    if (pool_) {
+      pool_->release(ptr, n * sizeof(T));
+    } else {
+      FramePool::free_aligned(ptr);
+    }
+  }
+
+  // resize() でゼロ初期化しないようにデフォルト初期化で構築する
+  template <typename U>
+  void construct(U* ptr) noexcept(std::is_nothrow_default_constructible_v<U>) {
+    ::new (static_cast<void*>(ptr)) U;
+  }
+  template <typename U, typename... Args>
+  void construct(U* ptr, Args&&... args) {
+    ::new (static_cast<void*>(ptr)) U(std::forward<Args>(args)...);
+  }
+
+  const std::shared_ptr<FramePool>& pool() const noexcept { return pool_; }
+
+ private:
+  std::shared_ptr<FramePool> pool_;
+};
+
+template <typename T, typename U>
+bool operator==(const FramePoolAllocator<T>& a,
+                const FramePoolAllocator<U>& b) noexcept {
+  return a.pool() == b.pool();
+}
+
+// VideoFrame のデータストレージ
+using FrameBuffer = std::vector<uint8_t, FramePoolAllocator<uint8_t>>;
+
+// 統計情報を Python の dict (FramePoolStats) に変換する
+nanobind::dict frame_pool_stats_to_dict(const FramePool::Stats& stats);
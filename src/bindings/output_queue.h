@@ -0,0 +1,116 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "wakeup_fd.h"
+
+// 出力キューモード (独自拡張) で使う、順序が確定した出力を溜めるキュー
+// ワーカースレッドは GIL を取得せずに push() し、Python 側は read() で取り出す
+// ロックは出力の追加と取り出しの間だけ保持し、コーデックのスレッドが
+// インタプリタの処理を待つことはない
+template <typename T>
+class OutputQueue {
+ public:
+  // 出力を追加し、待機中の pop() を起こす
+  void push(std::vector<T>& items) {
+    if (items.empty()) {
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      for (auto& item : items) {
+        items_.push_back(std::move(item));
+      }
+      if (wakeup_fd_) {
+        wakeup_fd_->signal();
+      }
+    }
+    cv_.notify_all();
+  }
+
+  // 待機中の pop() を起こし、終了条件を確認させる
+  void wake() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (wakeup_fd_) {
+        wakeup_fd_->signal();
+      }
+    }
+    cv_.notify_all();
+  }
+
+  // push() と wake() の度に読み込み可能になるファイルディスクリプタを返す
+  // 初回の呼び出しで作成し、キューと同じ期間だけ有効
+  int wakeup_fd() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!wakeup_fd_) {
+      wakeup_fd_ = std::make_unique<WakeupFd>();
+      // 作成前に追加された出力も取りこぼさないようにする
+      if (!items_.empty()) {
+        wakeup_fd_->signal();
+      }
+    }
+    return wakeup_fd_->fd();
+  }
+
+  // wakeup_fd() の通知を読み捨てる
+  void clear_wakeup_fd() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (wakeup_fd_) {
+      wakeup_fd_->clear();
+    }
+  }
+
+  // 出力を 1 つ取り出す
+  // timeout (秒) が nullopt の場合は出力が追加されるか done() が true になるまで待機する
+  // 取り出せなかった場合は nullopt を返す
+  template <typename Done>
+  std::optional<T> pop(std::optional<double> timeout, Done done) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto ready = [&]() { return !items_.empty() || done(); };
+    if (timeout.has_value()) {
+      auto duration = std::chrono::duration<double>(std::max(0.0, *timeout));
+      cv_.wait_for(lock, duration, ready);
+    } else {
+      cv_.wait(lock, ready);
+    }
+    if (items_.empty()) {
+      return std::nullopt;
+    }
+    std::optional<T> item(std::move(items_.front()));
+    items_.pop_front();
+    return item;
+  }
+
+  // 待機せずに全ての出力を取り出す
+  std::vector<T> pop_all() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<T> items;
+    items.reserve(items_.size());
+    for (auto& item : items_) {
+      items.push_back(std::move(item));
+    }
+    items_.clear();
+    return items;
+  }
+
+  size_t size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return items_.size();
+  }
+
+ private:
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<T> items_;
+  std::unique_ptr<WakeupFd> wakeup_fd_;
+};
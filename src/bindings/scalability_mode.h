@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+
+// WebCodecs の scalabilityMode (L{空間レイヤー数}T{時間レイヤー数})
+// libaom / libvpx で対応している L1T1 - L2T3 のみ扱う
+struct ScalabilityMode {
+  int spatial_layers = 1;
+  int temporal_layers = 1;
+
+  bool is_layered() const { return spatial_layers > 1 || temporal_layers > 1; }
+};
+
+// 対応していない scalabilityMode の場合は std::nullopt を返す
+inline std::optional<ScalabilityMode> parse_scalability_mode(
+    const std::string& mode) {
+  if (mode.size() != 4 || mode[0] != 'L' || mode[2] != 'T') {
+    return std::nullopt;
+  }
+  ScalabilityMode result;
+  result.spatial_layers = mode[1] - '0';
+  result.temporal_layers = mode[3] - '0';
+  if (result.spatial_layers < 1 || result.spatial_layers > 2 ||
+      result.temporal_layers < 1 || result.temporal_layers > 3) {
+    return std::nullopt;
+  }
+  return result;
+}
+
+// 時間レイヤーのパターンの周期 (T1: 1, T2: 2, T3: 4)
+inline int scalability_temporal_periodicity(int temporal_layers) {
+  return temporal_layers == 3 ? 4 : temporal_layers;
+}
+
+// キーフレームからのフレーム数に対する temporal_layer_id
+// T2: 0, 1, 0, 1, ... / T3: 0, 2, 1, 2, ...
+inline int scalability_temporal_layer_id(int temporal_layers,
+                                         uint64_t index) {
+  static constexpr int kT3Pattern[] = {0, 2, 1, 2};
+  switch (temporal_layers) {
+    case 2:
+      return static_cast<int>(index % 2);
+    case 3:
+      return kT3Pattern[index % 4];
+    default:
+      return 0;
+  }
+}
+
+// 時間レイヤーに割り当てるビットレートの割合 (下位レイヤーを含めた累積)
+// WebRTC の kLayerRateAllocation に準拠
+inline double scalability_temporal_rate(int temporal_layers,
+                                        int temporal_layer_id) {
+  static constexpr double kT2[] = {0.6, 1.0};
+  static constexpr double kT3[] = {0.4, 0.6, 1.0};
+  switch (temporal_layers) {
+    case 2:
+      return kT2[temporal_layer_id];
+    case 3:
+      return kT3[temporal_layer_id];
+    default:
+      return 1.0;
+  }
+}
+
+// 空間レイヤーに割り当てるビットレートの割合
+// 下位レイヤーは縦横 1/2 の解像度でエンコードする
+inline double scalability_spatial_rate(int spatial_layers,
+                                       int spatial_layer_id) {
+  if (spatial_layers == 2) {
+    return spatial_layer_id == 0 ? 0.3 : 0.7;
+  }
+  return 1.0;
+}
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+// reorder_capacity の既定値と上限
+constexpr size_t kDefaultReorderCapacity = 64;
+constexpr size_t kMaxReorderCapacity = 4096;
+
+// シーケンス番号順に結果を並べ替えるための固定長リングバッファ
+// sequence % capacity のスロットに格納し、next() から連続して揃った結果を取り出す
+// 同期は呼び出し側で行う (デコーダー/エンコーダーの output_mutex_ で保護する)
+template <typename T>
+class SequenceRing {
+ public:
+  explicit SequenceRing(size_t capacity = kDefaultReorderCapacity)
+      : slots_(capacity) {}
+
+  size_t capacity() const { return slots_.size(); }
+  // 次に出力すべきシーケンス番号
+  uint64_t next() const { return next_; }
+  // 出力せずに飛ばしたシーケンス番号の累計
+  uint64_t skipped() const { return skipped_; }
+
+  // 空にしてシーケンス番号を 0 に戻す
+  void clear() {
+    for (auto& slot : slots_) {
+      slot = Slot();
+    }
+    next_ = 0;
+    skipped_ = 0;
+  }
+
+  // 格納されている結果を保ったまま容量を変更する
+  // 新しい容量に収まらない古い結果はシーケンス番号順に out に追加する
+  void resize(size_t capacity, std::vector<T>& out) {
+    if (capacity == slots_.size()) {
+      return;
+    }
+    size_t count = occupied_span();
+    while (count > capacity) {
+      advance(out);
+      count--;
+    }
+    std::vector<Slot> slots(capacity);
+    for (size_t i = 0; i < count; i++) {
+      uint64_t sequence = next_ + i;
+      slots[sequence % capacity] = std::move(slots_[sequence % slots_.size()]);
+    }
+    slots_.swap(slots);
+  }
+
+  // sequence の結果を格納し、順序通りに出力できる結果を out に追加する
+  // next() + capacity() 以降のシーケンス番号が来た場合は、結果が届いていない
+  // 古いシーケンス番号を飛ばしてスロットを空ける (メモリを capacity() 以内に保つ)
+  // 既に飛ばしたシーケンス番号の結果は順序を待たずにそのまま out に追加する
+  void put(uint64_t sequence, T value, std::vector<T>& out) {
+    if (sequence < next_) {
+      out.push_back(std::move(value));
+      return;
+    }
+    Slot& slot = reserve(sequence, out);
+    slot.value = std::move(value);
+    slot.done = true;
+    advance_ready(out);
+  }
+
+  // sequence は結果を出さないことを記録し、順序通りに出力できる結果を out に追加する
+  // キューから破棄したタスクのシーケンス番号で後続の出力が止まらないようにする
+  void discard(uint64_t sequence, std::vector<T>& out) {
+    if (sequence < next_) {
+      return;
+    }
+    reserve(sequence, out).done = true;
+    advance_ready(out);
+  }
+
+  // 格納されている結果を全てシーケンス番号順に out に追加して空にする
+  // 結果が届いていないシーケンス番号は飛ばす
+  void drain(std::vector<T>& out) {
+    size_t count = occupied_span();
+    for (size_t i = 0; i < count; i++) {
+      advance(out);
+    }
+  }
+
+  // sequence より前の結果を待たないようにする
+  // drain() の後に呼び出し、結果を出さなかったシーケンス番号を飛ばす
+  void skip_to(uint64_t sequence) {
+    if (sequence > next_) {
+      skipped_ += sequence - next_;
+      next_ = sequence;
+    }
+  }
+
+ private:
+  struct Slot {
+    std::optional<T> value;
+    bool done = false;  // 結果が届いた (または破棄された)
+  };
+
+  // sequence のスロットを返す (容量を超える場合は古いシーケンス番号を飛ばす)
+  Slot& reserve(uint64_t sequence, std::vector<T>& out) {
+    while (sequence - next_ >= slots_.size()) {
+      advance(out);
+    }
+    return slots_[sequence % slots_.size()];
+  }
+
+  // next_ から連続して揃っている結果を出力する
+  void advance_ready(std::vector<T>& out) {
+    while (slots_[next_ % slots_.size()].done) {
+      advance(out);
+    }
+  }
+
+  // next_ から最後に結果が届いているスロットまでの長さ
+  size_t occupied_span() const {
+    size_t count = 0;
+    for (size_t i = 0; i < slots_.size(); i++) {
+      if (slots_[(next_ + i) % slots_.size()].done) {
+        count = i + 1;
+      }
+    }
+    return count;
+  }
+
+  // next_ のスロットを出力 (空なら飛ばす) して次に進める
+  void advance(std::vector<T>& out) {
+    Slot& slot = slots_[next_ % slots_.size()];
+    if (slot.value.has_value()) {
+      out.push_back(std::move(*slot.value));
+    } else if (!slot.done) {
+      skipped_++;
+    }
+    slot = Slot();
+    next_++;
+  }
+
+  std::vector<Slot> slots_;
+  uint64_t next_ = 0;
+  uint64_t skipped_ = 0;
+};
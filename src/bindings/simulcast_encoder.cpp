@@ -0,0 +1,425 @@
+#include "simulcast_encoder.h"
+
+#include <nanobind/stl/optional.h>
+#include <nanobind/stl/shared_ptr.h>
+#include <nanobind/stl/string.h>
+#include <nanobind/stl/vector.h>
+#include <libyuv.h>
+#include <algorithm>
+#include <set>
+#include <stdexcept>
+
+#include "video_encoder.h"
+#include "video_frame.h"
+
+using namespace nb::literals;
+
+// VideoEncoder.configure() には渡さない SimulcastEncoder 固有のキー
+static bool is_simulcast_config_key(const std::string& key) {
+  return key == "renditions" || key == "scale_filter" ||
+         key == "align_key_frames";
+}
+
+static libyuv::FilterMode to_libyuv_filter(VideoScaleFilter filter) {
+  switch (filter) {
+    case VideoScaleFilter::NONE:
+      return libyuv::kFilterNone;
+    case VideoScaleFilter::LINEAR:
+      return libyuv::kFilterLinear;
+    case VideoScaleFilter::BILINEAR:
+      return libyuv::kFilterBilinear;
+    case VideoScaleFilter::BOX:
+      return libyuv::kFilterBox;
+  }
+  return libyuv::kFilterBox;
+}
+
+SimulcastEncoder::SimulcastEncoder(nb::object output,
+                                   nb::object error,
+                                   std::shared_ptr<WorkerPool> worker_pool)
+    : output_callback_(output),
+      error_callback_(error),
+      worker_pool_(std::move(worker_pool)) {}
+
+SimulcastEncoder::~SimulcastEncoder() {
+  close();
+}
+
+std::unique_ptr<VideoEncoder> SimulcastEncoder::create_encoder(
+    const std::string& id) {
+  // 出力とエラーにレンディションの ID を付けて呼び出すコールバック
+  nb::object output = output_callback_;
+  nb::object error = error_callback_;
+  nb::object on_output = nb::cpp_function(
+      [output, id](nb::handle chunk, nb::handle metadata) {
+        output(id, chunk, metadata);
+      },
+      "chunk"_a, "metadata"_a = nb::none());
+  nb::object on_error = nb::cpp_function(
+      [error, id](const std::string& message) {
+        error(id + ": " + message);
+      },
+      "message"_a);
+  return std::make_unique<VideoEncoder>(on_output, on_error, worker_pool_);
+}
+
+void SimulcastEncoder::destroy_encoders() {
+  for (auto& encoder : encoders_) {
+    encoder->close();
+  }
+  encoders_.clear();
+}
+
+void SimulcastEncoder::configure(nb::dict config) {
+  if (state_ == CodecState::CLOSED) {
+    throw std::runtime_error("SimulcastEncoder is closed");
+  }
+  if (!config.contains("codec"))
+    throw nb::value_error("codec is required");
+  if (!config.contains("renditions"))
+    throw nb::value_error("renditions is required");
+
+  // レンディションの設定を検証する
+  std::vector<Rendition> renditions;
+  std::set<std::string> ids;
+  for (nb::handle item : nb::cast<nb::sequence>(config["renditions"])) {
+    nb::dict rendition_dict = nb::cast<nb::dict>(item);
+    if (!rendition_dict.contains("id"))
+      throw nb::value_error("rendition id is required");
+    if (!rendition_dict.contains("width"))
+      throw nb::value_error("rendition width is required");
+    if (!rendition_dict.contains("height"))
+      throw nb::value_error("rendition height is required");
+    Rendition rendition;
+    rendition.id = nb::cast<std::string>(rendition_dict["id"]);
+    rendition.width = nb::cast<uint32_t>(rendition_dict["width"]);
+    rendition.height = nb::cast<uint32_t>(rendition_dict["height"]);
+    if (rendition.width == 0 || rendition.height == 0) {
+      throw nb::value_error("rendition width and height must be 1 or greater");
+    }
+    if (rendition_dict.contains("bitrate") &&
+        !rendition_dict["bitrate"].is_none()) {
+      rendition.bitrate = nb::cast<uint64_t>(rendition_dict["bitrate"]);
+    }
+    if (rendition_dict.contains("scalability_mode") &&
+        !rendition_dict["scalability_mode"].is_none()) {
+      rendition.scalability_mode =
+          nb::cast<std::string>(rendition_dict["scalability_mode"]);
+    }
+    if (!ids.insert(rendition.id).second) {
+      throw nb::value_error(
+          ("rendition id must be unique: " + rendition.id).c_str());
+    }
+    renditions.push_back(std::move(rendition));
+  }
+  if (renditions.empty()) {
+    throw nb::value_error("renditions must not be empty");
+  }
+
+  VideoScaleFilter scale_filter = VideoScaleFilter::BOX;
+  if (config.contains("scale_filter") && !config["scale_filter"].is_none()) {
+    scale_filter = nb::cast<VideoScaleFilter>(config["scale_filter"]);
+  }
+  bool align_key_frames = false;
+  if (config.contains("align_key_frames") &&
+      !config["align_key_frames"].is_none()) {
+    align_key_frames = nb::cast<bool>(config["align_key_frames"]);
+  }
+
+  // レンディションごとの VideoEncoder に渡す設定を作成する
+  std::vector<nb::dict> encoder_configs;
+  for (const auto& rendition : renditions) {
+    nb::dict encoder_config;
+    for (auto [key, value] : config) {
+      if (!is_simulcast_config_key(nb::cast<std::string>(key))) {
+        encoder_config[key] = value;
+      }
+    }
+    encoder_config["width"] = rendition.width;
+    encoder_config["height"] = rendition.height;
+    if (rendition.bitrate.has_value()) {
+      encoder_config["bitrate"] = *rendition.bitrate;
+    }
+    if (rendition.scalability_mode.has_value()) {
+      encoder_config["scalability_mode"] = *rendition.scalability_mode;
+    }
+    encoder_configs.push_back(std::move(encoder_config));
+  }
+
+  // レンディションの ID と解像度が変わらない場合は各エンコーダーを再設定する
+  // (ビットレートだけの変更であればエンコーダーを作り直さずに反映される)
+  bool same_layout = state_ == CodecState::CONFIGURED &&
+                     renditions.size() == renditions_.size();
+  for (size_t i = 0; same_layout && i < renditions.size(); ++i) {
+    same_layout = renditions[i].id == renditions_[i].id &&
+                  renditions[i].width == renditions_[i].width &&
+                  renditions[i].height == renditions_[i].height;
+  }
+  if (same_layout) {
+    for (size_t i = 0; i < encoders_.size(); ++i) {
+      encoders_[i]->configure(encoder_configs[i]);
+    }
+  } else {
+    std::vector<std::unique_ptr<VideoEncoder>> encoders;
+    for (size_t i = 0; i < renditions.size(); ++i) {
+      encoders.push_back(create_encoder(renditions[i].id));
+      encoders.back()->configure(encoder_configs[i]);
+    }
+    {
+      // 以前のレンディションのキューに積まれたフレームを出力してから破棄する
+      // ワーカースレッドがコールバックを呼び出せるように GIL を解放する
+      nb::gil_scoped_release gil;
+      for (auto& encoder : encoders_) {
+        encoder->flush();
+      }
+    }
+    destroy_encoders();
+    encoders_ = std::move(encoders);
+  }
+
+  renditions_ = std::move(renditions);
+  scale_filter_ = scale_filter;
+  align_key_frames_ = align_key_frames;
+
+  // 解像度の大きい順に縮小し、小さいレンディションは縮小済みのフレームから作る
+  scale_order_.resize(renditions_.size());
+  for (size_t i = 0; i < scale_order_.size(); ++i) {
+    scale_order_[i] = i;
+  }
+  std::stable_sort(scale_order_.begin(), scale_order_.end(),
+                   [this](size_t a, size_t b) {
+                     return static_cast<uint64_t>(renditions_[a].width) *
+                                renditions_[a].height >
+                            static_cast<uint64_t>(renditions_[b].width) *
+                                renditions_[b].height;
+                   });
+
+  state_ = CodecState::CONFIGURED;
+}
+
+void SimulcastEncoder::encode(VideoFrame& frame, const EncodeOptions& options) {
+  if (state_ != CodecState::CONFIGURED) {
+    throw std::runtime_error("SimulcastEncoder is not configured");
+  }
+  if (frame.is_closed()) {
+    throw std::runtime_error("VideoFrame is closed");
+  }
+
+  // レンディションごとにキーフレームにするかを決める
+  std::vector<bool> keyframes(renditions_.size(), options.keyframe);
+  for (const auto& id : options.keyframe_renditions) {
+    auto it = std::find_if(renditions_.begin(), renditions_.end(),
+                           [&id](const Rendition& r) { return r.id == id; });
+    if (it == renditions_.end()) {
+      throw nb::value_error(("Unknown rendition: " + id).c_str());
+    }
+    keyframes[it - renditions_.begin()] = true;
+  }
+  // レンディションを切り替えられるように、全てのレンディションで同じフレームをキーフレームにする
+  if (align_key_frames_ &&
+      std::find(keyframes.begin(), keyframes.end(), true) != keyframes.end()) {
+    std::fill(keyframes.begin(), keyframes.end(), true);
+  }
+
+  const uint32_t width = frame.width();
+  const uint32_t height = frame.height();
+  auto is_input_size = [width, height](const Rendition& r) {
+    return r.width == width && r.height == height;
+  };
+  const bool needs_scaling =
+      !std::all_of(renditions_.begin(), renditions_.end(), is_input_size);
+
+  // 縮小元の I420 画像
+  // I420 以外の入力は 1 回だけ I420 に変換し、全てのレンディションで共有する
+  std::unique_ptr<VideoFrame> i420_input;
+  const VideoFrame* source = &frame;
+  if (needs_scaling && frame.format() != VideoPixelFormat::I420) {
+    i420_input = std::make_unique<VideoFrame>(
+        width, height, VideoPixelFormat::I420, frame.timestamp(), frame_pool_);
+    i420_input->set_duration(frame.duration());
+    frame.write_i420(i420_input->mutable_plane_ptr(0),
+                     static_cast<int>(i420_input->plane_stride(0)),
+                     i420_input->mutable_plane_ptr(1),
+                     static_cast<int>(i420_input->plane_stride(1)),
+                     i420_input->mutable_plane_ptr(2),
+                     static_cast<int>(i420_input->plane_stride(2)));
+    source = i420_input.get();
+  }
+
+  // 解像度の大きい順に縮小する
+  // 縮小元には、縮小済みのフレームのうち縮小先以上の解像度で最も小さいものを使う
+  std::vector<std::unique_ptr<VideoFrame>> scaled(renditions_.size());
+  std::vector<const VideoFrame*> levels;
+  const libyuv::FilterMode filter = to_libyuv_filter(scale_filter_);
+  for (size_t index : scale_order_) {
+    const Rendition& rendition = renditions_[index];
+    if (is_input_size(rendition)) {
+      continue;
+    }
+    const VideoFrame* from = source;
+    for (auto it = levels.rbegin(); it != levels.rend(); ++it) {
+      if ((*it)->width() >= rendition.width &&
+          (*it)->height() >= rendition.height) {
+        from = *it;
+        break;
+      }
+    }
+    auto dst = std::make_unique<VideoFrame>(rendition.width, rendition.height,
+                                            VideoPixelFormat::I420,
+                                            frame.timestamp(), frame_pool_);
+    dst->set_duration(frame.duration());
+    int result = libyuv::I420Scale(
+        from->plane_ptr(0), static_cast<int>(from->plane_stride(0)),
+        from->plane_ptr(1), static_cast<int>(from->plane_stride(1)),
+        from->plane_ptr(2), static_cast<int>(from->plane_stride(2)),
+        static_cast<int>(from->width()), static_cast<int>(from->height()),
+        dst->mutable_plane_ptr(0), static_cast<int>(dst->plane_stride(0)),
+        dst->mutable_plane_ptr(1), static_cast<int>(dst->plane_stride(1)),
+        dst->mutable_plane_ptr(2), static_cast<int>(dst->plane_stride(2)),
+        static_cast<int>(rendition.width), static_cast<int>(rendition.height),
+        filter);
+    if (result != 0) {
+      throw std::runtime_error("Failed to scale VideoFrame for rendition: " +
+                               rendition.id);
+    }
+    levels.push_back(dst.get());
+    scaled[index] = std::move(dst);
+  }
+
+  // 縮小したフレームはコピーせずにエンコーダーへ渡す
+  std::vector<size_t> input_size_indices;
+  for (size_t i = 0; i < renditions_.size(); ++i) {
+    if (!scaled[i]) {
+      input_size_indices.push_back(i);
+      continue;
+    }
+    VideoEncoder::EncodeOptions encode_options;
+    encode_options.keyframe = keyframes[i];
+    encode_options.transfer = true;
+    encoders_[i]->encode(*scaled[i], encode_options);
+  }
+
+  // 入力と同じ解像度のレンディションには入力フレームを渡す
+  // I420 に変換済みの場合はそれを、transfer の場合は入力フレームを最後のエンコーダーに移す
+  for (size_t n = 0; n < input_size_indices.size(); ++n) {
+    const size_t i = input_size_indices[n];
+    const bool last = n + 1 == input_size_indices.size();
+    VideoEncoder::EncodeOptions encode_options;
+    encode_options.keyframe = keyframes[i];
+    if (i420_input) {
+      encode_options.transfer = last;
+      encoders_[i]->encode(*i420_input, encode_options);
+    } else {
+      encode_options.transfer = last && options.transfer;
+      encoders_[i]->encode(frame, encode_options);
+    }
+  }
+  if (options.transfer && !frame.is_closed()) {
+    frame.close();
+  }
+}
+
+void SimulcastEncoder::flush() {
+  if (state_ != CodecState::CONFIGURED) {
+    return;
+  }
+  for (auto& encoder : encoders_) {
+    encoder->flush();
+  }
+}
+
+void SimulcastEncoder::reset() {
+  if (state_ == CodecState::CLOSED) {
+    throw std::runtime_error("SimulcastEncoder is closed");
+  }
+  destroy_encoders();
+  renditions_.clear();
+  scale_order_.clear();
+  state_ = CodecState::UNCONFIGURED;
+}
+
+void SimulcastEncoder::close() {
+  if (state_ == CodecState::CLOSED) {
+    return;
+  }
+  destroy_encoders();
+  frame_pool_->trim();
+  state_ = CodecState::CLOSED;
+}
+
+std::vector<std::string> SimulcastEncoder::renditions() const {
+  std::vector<std::string> ids;
+  for (const auto& rendition : renditions_) {
+    ids.push_back(rendition.id);
+  }
+  return ids;
+}
+
+uint32_t SimulcastEncoder::encode_queue_size() const {
+  uint32_t size = 0;
+  for (const auto& encoder : encoders_) {
+    size += encoder->encode_queue_size();
+  }
+  return size;
+}
+
+void init_simulcast_encoder(nb::module_& m) {
+  nb::class_<SimulcastEncoder>(m, "SimulcastEncoder")
+      .def(nb::init<nb::object, nb::object, std::shared_ptr<WorkerPool>>(),
+           "output"_a, "error"_a, nb::kw_only(),
+           "worker_pool"_a.none() = nb::none(),
+           nb::sig("def __init__(self, output: typing.Callable[[str, "
+                   "EncodedVideoChunk, webcodecs.EncodedVideoChunkMetadata], "
+                   "None], error: typing.Callable[[str], None], /, *, "
+                   "worker_pool: WorkerPool | None = None) -> None"))
+      .def("configure", &SimulcastEncoder::configure, "config"_a,
+           nb::sig("def configure(self, config: "
+                   "webcodecs.SimulcastEncoderConfig, /) -> None"))
+      .def(
+          "encode",
+          [](SimulcastEncoder& self, VideoFrame& frame, nb::object options) {
+            // dict アクセスには GIL が必要なので、変換してから GIL を解放する
+            SimulcastEncoder::EncodeOptions encode_options;
+            if (!options.is_none()) {
+              nb::dict options_dict = nb::cast<nb::dict>(options);
+              if (options_dict.contains("key_frame") &&
+                  !options_dict["key_frame"].is_none()) {
+                encode_options.keyframe =
+                    nb::cast<bool>(options_dict["key_frame"]);
+              }
+              if (options_dict.contains("key_frame_renditions") &&
+                  !options_dict["key_frame_renditions"].is_none()) {
+                encode_options.keyframe_renditions =
+                    nb::cast<std::vector<std::string>>(
+                        options_dict["key_frame_renditions"]);
+              }
+              if (options_dict.contains("transfer") &&
+                  !options_dict["transfer"].is_none()) {
+                encode_options.transfer =
+                    nb::cast<bool>(options_dict["transfer"]);
+              }
+            }
+            nb::gil_scoped_release gil;
+            self.encode(frame, encode_options);
+          },
+          "frame"_a, "options"_a = nb::none(),
+          nb::sig("def encode(self, frame: VideoFrame, options: "
+                  "webcodecs.SimulcastEncoderEncodeOptions | None = None, /) "
+                  "-> None"))
+      .def("flush", &SimulcastEncoder::flush,
+           nb::call_guard<nb::gil_scoped_release>(),
+           nb::sig("def flush(self, /) -> None"))
+      .def("reset", &SimulcastEncoder::reset,
+           nb::sig("def reset(self, /) -> None"))
+      .def("close", &SimulcastEncoder::close,
+           nb::sig("def close(self, /) -> None"))
+      .def_prop_ro("state", &SimulcastEncoder::state,
+                   nb::sig("def state(self, /) -> CodecState"))
+      .def_prop_ro("renditions", &SimulcastEncoder::renditions,
+                   nb::sig("def renditions(self, /) -> list[str]"))
+      .def_prop_ro("encode_queue_size", &SimulcastEncoder::encode_queue_size,
+                   nb::sig("def encode_queue_size(self, /) -> int"))
+      .def("frame_pool_stats", &SimulcastEncoder::frame_pool_stats,
+           nb::sig("def frame_pool_stats(self, /) -> "
+                   "webcodecs.FramePoolStats"));
+}
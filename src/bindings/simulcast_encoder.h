@@ -0,0 +1,94 @@
+#pragma once
+
+#include <nanobind/nanobind.h>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "frame_pool.h"
+#include "webcodecs_types.h"
+#include "worker_pool.h"
+
+namespace nb = nanobind;
+
+class VideoEncoder;
+class VideoFrame;
+
+// 1 つの入力から解像度の異なる複数のストリームを作るエンコーダー (独自拡張)
+// 入力フレームから縮小したフレームを大きい解像度から順に 1 回だけ作り、
+// 解像度 (レンディション) ごとの VideoEncoder に渡して並列にエンコードする
+// 縮小したフレームは frame_pool_ から確保し、コピーせずにエンコーダーへ渡す
+class SimulcastEncoder {
+ public:
+  // レンディションの設定
+  struct Rendition {
+    std::string id;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    std::optional<uint64_t> bitrate;
+    std::optional<std::string> scalability_mode;
+  };
+
+  // エンコードオプション
+  struct EncodeOptions {
+    // 全てのレンディションでキーフレームにする
+    bool keyframe = false;
+    // 指定したレンディションだけキーフレームにする
+    // align_key_frames が true の場合は全てのレンディションでキーフレームにする
+    std::vector<std::string> keyframe_renditions;
+    // true の場合は入力フレームのバッファをコピーせずに受け取り、フレームを close する
+    bool transfer = false;
+  };
+
+  // output は (rendition_id, chunk, metadata) で呼び出す
+  // worker_pool を指定した場合は全てのレンディションのエンコーダーでプールを共有する
+  SimulcastEncoder(nb::object output,
+                   nb::object error,
+                   std::shared_ptr<WorkerPool> worker_pool = nullptr);
+  ~SimulcastEncoder();
+
+  SimulcastEncoder(const SimulcastEncoder&) = delete;
+  SimulcastEncoder& operator=(const SimulcastEncoder&) = delete;
+
+  // renditions 以外のキーは全てのレンディションの VideoEncoder.configure() に渡す
+  // 構成済みでレンディションの ID と解像度が変わらない場合は、
+  // 各エンコーダーの configure() で再設定する
+  void configure(nb::dict config);
+  void encode(VideoFrame& frame, const EncodeOptions& options);
+  void flush();
+  void reset();
+  void close();
+
+  CodecState state() const { return state_; }
+  // レンディションの ID (configure() で指定した順)
+  std::vector<std::string> renditions() const;
+  // 全てのレンディションのエンコーダーの encode_queue_size の合計
+  uint32_t encode_queue_size() const;
+
+  // 縮小したフレームが使うバッファプールの統計情報
+  nb::dict frame_pool_stats() const {
+    return frame_pool_stats_to_dict(frame_pool_->stats());
+  }
+
+ private:
+  // レンディションの VideoEncoder を作成する
+  std::unique_ptr<VideoEncoder> create_encoder(const std::string& id);
+  // 全てのレンディションのエンコーダーを close して破棄する
+  void destroy_encoders();
+
+  nb::object output_callback_;
+  nb::object error_callback_;
+  std::shared_ptr<WorkerPool> worker_pool_;
+  CodecState state_ = CodecState::UNCONFIGURED;
+
+  std::vector<Rendition> renditions_;
+  std::vector<std::unique_ptr<VideoEncoder>> encoders_;  // renditions_ と同じ順
+  // 縮小する順序 (解像度の大きい順の renditions_ のインデックス)
+  std::vector<size_t> scale_order_;
+  VideoScaleFilter scale_filter_ = VideoScaleFilter::BOX;
+  bool align_key_frames_ = false;
+
+  std::shared_ptr<FramePool> frame_pool_ = std::make_shared<FramePool>();
+};
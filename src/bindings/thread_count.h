@@ -0,0 +1,21 @@
+#pragma once
+
+// WebRTC の NumberOfThreads ロジックに準拠してスレッド数を決定
+// エンコーダー・デコーダーで共通に使う
+// AV1 のタイル数（1, 2, 4, 8）に合わせてスレッド数を選ぶ
+inline int calculate_number_of_threads(int width,
+                                       int height,
+                                       int number_of_cores) {
+  // Keep the number of encoder threads equal to the possible number of
+  // column/row tiles, which is (1, 2, 4, 8).
+  if (width * height > 1280 * 720 && number_of_cores > 8) {
+    return 8;
+  } else if (width * height >= 640 * 360 && number_of_cores > 4) {
+    return 4;
+  } else if (width * height >= 320 * 180 && number_of_cores > 2) {
+    return 2;
+  } else {
+    // 1 thread less than VGA.
+    return 1;
+  }
+}
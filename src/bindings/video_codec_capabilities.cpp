@@ -9,6 +9,7 @@
 #endif
 
 #if defined(__linux__)
+#include "../dyn/openh264.h"
 #include "../dyn/vpl.h"
 #endif
 
@@ -23,6 +24,12 @@ get_video_codec_capabilities_impl() {
   none_support.available = true;
   none_support.platform = "all";
   none_support.codecs["av01"] = {true, true};  // AV1
+#if defined(__linux__)
+  // H.264 は OpenH264 が dlopen できる場合のみエンコード・デコード可能
+  if (dyn::DynModule::IsLoadable(dyn::openh264_so())) {
+    none_support.codecs["avc1"] = {true, true};
+  }
+#endif
   capabilities[HardwareAccelerationEngine::NONE] = none_support;
 
 #if defined(__APPLE__)
@@ -1,9 +1,49 @@
 #include "video_decoder.h"
+#include <nanobind/stl/shared_ptr.h>
+#include <libyuv.h>
+#include <nanobind/stl/vector.h>
+#include <algorithm>
 #include <cstring>
 #include <stdexcept>
 
+#if defined(__linux__)
+#include "../dyn/openh264.h"
+#endif
+
 using namespace nb::literals;
 
+namespace {
+// VideoDecoderConfig の output_format に指定できるフォーマットか
+bool is_decoder_output_format(VideoPixelFormat format) {
+  switch (format) {
+    case VideoPixelFormat::I420:
+    case VideoPixelFormat::NV12:
+    case VideoPixelFormat::RGBA:
+    case VideoPixelFormat::BGRA:
+    case VideoPixelFormat::RGB:
+    case VideoPixelFormat::BGR:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// decode_frame_type に対応しているか
+// KEY はチャンクの type で判定するため全てのデコーダーで使える
+// REFERENCE / INTRA は dav1d でソフトウェアデコードする AV1 のみ
+bool supports_decode_frame_type(const VideoDecoderConfig& config) {
+  if (config.decode_frame_type == DecodeFrameType::ALL ||
+      config.decode_frame_type == DecodeFrameType::KEY) {
+    return true;
+  }
+  bool av1 = config.codec.size() >= 5 && config.codec.compare(0, 5, "av01.") == 0;
+  bool software = !config.hardware_acceleration_engine.has_value() ||
+                  config.hardware_acceleration_engine.value() ==
+                      HardwareAccelerationEngine::NONE;
+  return av1 && software;
+}
+}  // namespace
+
 VideoCodec VideoDecoder::string_to_codec(const std::string& codec) {
   // 完全なコーデック文字列フォーマットを持つ AV1 (av01.x.xxM.xx)
   if (codec.length() >= 5 && codec.substr(0, 5) == "av01.")
@@ -25,15 +65,24 @@ VideoCodec VideoDecoder::string_to_codec(const std::string& codec) {
   throw std::runtime_error("Unknown codec: " + codec);
 }
 
-VideoDecoder::VideoDecoder(nb::object output, nb::object error)
+VideoDecoder::VideoDecoder(nb::object output,
+                           nb::object error,
+                           std::shared_ptr<WorkerPool> worker_pool,
+                           bool output_queue)
     : output_callback_(output),
       error_callback_(error),
       state_(CodecState::UNCONFIGURED),
-      decoder_context_(nullptr),
-      config_() {
+      config_(),
+      worker_pool_(worker_pool ? std::move(worker_pool)
+                               : WorkerPool::default_pool()),
+      decoder_context_(nullptr) {
   // コールバックフラグを設定
   has_output_callback_ = !output_callback_.is_none();
   has_error_callback_ = !error_callback_.is_none();
+  if (output_queue) {
+    output_queue_ =
+        std::make_unique<OutputQueue<std::unique_ptr<VideoFrame>>>();
+  }
   // コンストラクタではコーデックの初期化は行わない
   // configure() で初期化する
 }
@@ -74,6 +123,103 @@ void VideoDecoder::configure(nb::dict config_dict) {
     config.hardware_acceleration_engine = nb::cast<HardwareAccelerationEngine>(
         config_dict["hardware_acceleration_engine"]);
   }
+  if (config_dict.contains("optimize_for_latency") &&
+      !config_dict["optimize_for_latency"].is_none()) {
+    config.optimize_for_latency =
+        nb::cast<bool>(config_dict["optimize_for_latency"]);
+  }
+  if (config_dict.contains("decode_threads") &&
+      !config_dict["decode_threads"].is_none()) {
+    config.decode_threads = nb::cast<uint32_t>(config_dict["decode_threads"]);
+    // dav1d の上限に合わせる
+    if (*config.decode_threads > 256) {
+      throw nb::value_error("decode_threads must be between 0 and 256");
+    }
+  }
+  if (config_dict.contains("max_frame_delay") &&
+      !config_dict["max_frame_delay"].is_none()) {
+    config.max_frame_delay =
+        nb::cast<uint32_t>(config_dict["max_frame_delay"]);
+    // 0 は dav1d の自動設定になり遅延量が予測できないため受け付けない
+    if (*config.max_frame_delay < 1 || *config.max_frame_delay > 256) {
+      throw nb::value_error("max_frame_delay must be between 1 and 256");
+    }
+  }
+  if (config_dict.contains("reorder_capacity") &&
+      !config_dict["reorder_capacity"].is_none()) {
+    config.reorder_capacity =
+        nb::cast<uint32_t>(config_dict["reorder_capacity"]);
+    if (*config.reorder_capacity < 1 ||
+        *config.reorder_capacity > kMaxReorderCapacity) {
+      throw nb::value_error("reorder_capacity must be between 1 and 4096");
+    }
+  }
+  if (config_dict.contains("max_queue_size") &&
+      !config_dict["max_queue_size"].is_none()) {
+    config.max_queue_size = nb::cast<uint32_t>(config_dict["max_queue_size"]);
+    if (*config.max_queue_size < 1) {
+      throw nb::value_error("max_queue_size must be 1 or greater");
+    }
+  }
+  if (config_dict.contains("max_queue_bytes") &&
+      !config_dict["max_queue_bytes"].is_none()) {
+    config.max_queue_bytes =
+        nb::cast<uint64_t>(config_dict["max_queue_bytes"]);
+    if (*config.max_queue_bytes < 1) {
+      throw nb::value_error("max_queue_bytes must be 1 or greater");
+    }
+  }
+  if (config_dict.contains("queue_full_policy") &&
+      !config_dict["queue_full_policy"].is_none()) {
+    config.queue_full_policy =
+        nb::cast<QueueFullPolicy>(config_dict["queue_full_policy"]);
+  }
+  if (config_dict.contains("output_width") &&
+      !config_dict["output_width"].is_none()) {
+    config.output_width = nb::cast<uint32_t>(config_dict["output_width"]);
+  }
+  if (config_dict.contains("output_height") &&
+      !config_dict["output_height"].is_none()) {
+    config.output_height = nb::cast<uint32_t>(config_dict["output_height"]);
+  }
+  if (config.output_width.has_value() != config.output_height.has_value()) {
+    throw nb::value_error(
+        "output_width and output_height must be specified together");
+  }
+  if (config.output_width.has_value()) {
+    // I420 の VideoFrame は偶数のサイズのみ扱える
+    if (*config.output_width < 2 || *config.output_width > 8192 ||
+        *config.output_width % 2 != 0 || *config.output_height < 2 ||
+        *config.output_height > 8192 || *config.output_height % 2 != 0) {
+      throw nb::value_error(
+          "output_width and output_height must be even numbers between 2 "
+          "and 8192");
+    }
+  }
+  if (config_dict.contains("output_scale_filter") &&
+      !config_dict["output_scale_filter"].is_none()) {
+    config.output_scale_filter =
+        nb::cast<VideoScaleFilter>(config_dict["output_scale_filter"]);
+  }
+  if (config_dict.contains("output_format") &&
+      !config_dict["output_format"].is_none()) {
+    config.output_format =
+        nb::cast<VideoPixelFormat>(config_dict["output_format"]);
+    if (!is_decoder_output_format(*config.output_format)) {
+      throw nb::value_error(
+          "output_format must be I420, NV12, RGBA, BGRA, RGB, or BGR");
+    }
+  }
+  if (config_dict.contains("decode_frame_type") &&
+      !config_dict["decode_frame_type"].is_none()) {
+    config.decode_frame_type =
+        nb::cast<DecodeFrameType>(config_dict["decode_frame_type"]);
+  }
+  if (config_dict.contains("decode_quality") &&
+      !config_dict["decode_quality"].is_none()) {
+    config.decode_quality =
+        nb::cast<DecodeQuality>(config_dict["decode_quality"]);
+  }
 
   // 既存のデコーダーをクリーンアップ
   if (decoder_context_) {
@@ -91,18 +237,48 @@ void VideoDecoder::configure(nb::dict config_dict) {
                                 e.what());
   }
 
+  // 出力サイズとフォーマットの変換はソフトウェアデコーダーのピクチャをコピーする際に行う
+  if (converts_output() && !uses_software_decoder()) {
+    throw std::runtime_error(
+        "NotSupportedError: output_width / output_height / output_format is "
+        "only supported by software decoders (dav1d / libvpx / OpenH264)");
+  }
+
+  // REFERENCE / INTRA はフレームヘッダーを解析する dav1d のみ対応
+  if (!supports_decode_frame_type(config_)) {
+    throw std::runtime_error(
+        "NotSupportedError: decode_frame_type REFERENCE / INTRA is only "
+        "supported by the AV1 software decoder (dav1d)");
+  }
+
   init_decoder();
 
+  // 出力の並べ替えに使うリングの容量を設定
+  // 未指定の場合は dav1d のフレーム遅延分より十分大きくする
+  size_t reorder_capacity = kDefaultReorderCapacity;
+  if (config_.reorder_capacity.has_value()) {
+    reorder_capacity = *config_.reorder_capacity;
+  } else if (config_.max_frame_delay.has_value()) {
+    reorder_capacity = std::max<size_t>(reorder_capacity,
+                                        *config_.max_frame_delay * 2);
+  }
+  std::vector<std::unique_ptr<VideoFrame>> evicted_frames;
+  {
+    std::lock_guard<std::mutex> lock(output_mutex_);
+    output_ring_.resize(reorder_capacity, evicted_frames);
+  }
+  emit_frames(std::move(evicted_frames));
+
   // ワーカースレッドの開始
   // VideoToolbox は独自の非同期モデルを持つため、ワーカースレッドを開始しない
 #if defined(__APPLE__)
   if (!uses_apple_video_toolbox()) {
-    if (!worker_thread_.joinable()) {
+    if (!is_worker_running()) {
       start_worker();  // ワーカースレッドを開始
     }
   }
 #else
-  if (!worker_thread_.joinable()) {
+  if (!is_worker_running()) {
     start_worker();  // ワーカースレッドを開始
   }
 #endif
@@ -111,27 +287,54 @@ void VideoDecoder::configure(nb::dict config_dict) {
 }
 
 void VideoDecoder::decode(const EncodedVideoChunk& chunk) {
+  // チャンクのコピーはペイロードを共有するため、バイト列はコピーされない
+  decode_many(std::vector<EncodedVideoChunk>{chunk});
+}
+
+void VideoDecoder::decode_many(const std::vector<EncodedVideoChunk>& chunks) {
   if (state_ != CodecState::CONFIGURED) {
     throw std::runtime_error("Decoder is not configured");
   }
+  if (chunks.empty()) {
+    return;
+  }
+
+  // decode_frame_type が KEY の場合、差分フレームはキューに積む前に破棄する
+  // シーケンス番号も割り当てないため、出力の並べ替えを待たせることもない
+  if (config_.decode_frame_type == DecodeFrameType::KEY &&
+      std::any_of(chunks.begin(), chunks.end(), [](const auto& chunk) {
+        return chunk.type() != EncodedVideoChunkType::KEY;
+      })) {
+    std::vector<EncodedVideoChunk> key_chunks;
+    for (const auto& chunk : chunks) {
+      if (chunk.type() == EncodedVideoChunkType::KEY) {
+        key_chunks.push_back(chunk);
+      }
+    }
+    decode_queue_skipped_ += chunks.size() - key_chunks.size();
+    decode_many(key_chunks);
+    return;
+  }
 
   // VideoToolbox は独自の非同期モデルを持つため、ワーカースレッドをバイパス
 #if defined(__APPLE__)
   if (uses_apple_video_toolbox()) {
-    // シーケンス番号を設定して直接デコード
-    current_sequence_ = next_sequence_number_++;
-    bool success = decode_internal(chunk);
-    if (!success) {
-      nb::object error_cb;
-      bool has_error;
-      {
-        nb::ft_lock_guard guard(callback_mutex_);
-        error_cb = error_callback_;
-        has_error = has_error_callback_;
-      }
-      if (has_error && !error_cb.is_none()) {
-        nb::gil_scoped_acquire gil;
-        error_cb("Decode failed");
+    for (const auto& chunk : chunks) {
+      // シーケンス番号を設定して直接デコード
+      current_sequence_ = next_sequence_number_++;
+      bool success = decode_internal(chunk);
+      if (!success) {
+        nb::object error_cb;
+        bool has_error;
+        {
+          nb::ft_lock_guard guard(callback_mutex_);
+          error_cb = error_callback_;
+          has_error = has_error_callback_;
+        }
+        if (has_error && !error_cb.is_none()) {
+          nb::gil_scoped_acquire gil;
+          error_cb("Decode failed");
+        }
       }
     }
 
@@ -152,19 +355,55 @@ void VideoDecoder::decode(const EncodedVideoChunk& chunk) {
 #endif
 
   // その他のコーデックはワーカースレッドを使用
-  DecodeTask task;
-  task.chunk = chunk;  // optional への代入
-  task.sequence_number = next_sequence_number_++;
+  // タスクをまとめてキューに追加
+  // 破棄によって順序通りに出力できるようになったフレーム
+  std::vector<std::unique_ptr<VideoFrame>> outputs;
+  try {
+    std::unique_lock<std::mutex> lock(queue_mutex_);
+    for (const auto& chunk : chunks) {
+      bool is_key = chunk.type() == EncodedVideoChunkType::KEY;
+      // 差分フレームを破棄した後は、参照先がないため次のキーフレームまで破棄する
+      if (!is_key && awaiting_keyframe_) {
+        discard_sequence(next_sequence_number_++, outputs);
+        continue;
+      }
 
-  // タスクをキューに追加
-  {
-    std::lock_guard<std::mutex> lock(queue_mutex_);
-    decode_queue_.push(task);
-    pending_tasks_++;
+      // キューの上限に達している場合は queue_full_policy に従う
+      make_queue_space(lock, chunk.byte_length(), outputs);
+      if (!is_key && awaiting_keyframe_) {
+        discard_sequence(next_sequence_number_++, outputs);
+        continue;
+      }
+      if (is_key) {
+        awaiting_keyframe_ = false;
+      }
+
+      // 順序待ちのシーケンス番号が上限に達している間は待機する (バックプレッシャー)
+      // Python 側の出力処理がデコードより遅くてもメモリ使用量が増え続けないようにする
+      queue_cv_.wait(lock, [this]() { return has_output_capacity(); });
+
+      DecodeTask task;
+      task.chunk = chunk;  // ペイロードは共有されるためバイト列はコピーされない
+      task.sequence_number = next_sequence_number_++;
+      task.bytes = chunk.byte_length();
+      pending_bytes_ += task.bytes;
+      decode_queue_.push_back(std::move(task));
+      uint32_t pending = ++pending_tasks_;
+      if (pending > queue_high_water_mark_) {
+        queue_high_water_mark_ = pending;
+      }
+      queue_cv_.notify_all();
+      // 上限で待機している間も処理が進むよう、1 つずつストランドに投入する
+      post_worker_tasks(1);
+    }
+  } catch (...) {
+    // QuotaExceededError の場合も、それまでに追加したチャンクはキューに残る
+    emit_frames(std::move(outputs));
+    throw;
   }
-  queue_cv_.notify_one();
+  emit_frames(std::move(outputs));
 
-  // デキューコールバックを呼び出す
+  // デキューコールバックを呼び出す（バッチごとに 1 回）
   nb::object dequeue_cb;
   bool has_dequeue;
   {
@@ -183,16 +422,85 @@ void VideoDecoder::flush() {
     return;
   }
 
+  // VideoToolbox は直接処理されるため、ワーカーキューの待機をスキップ
+#if defined(__APPLE__)
+  if (!uses_apple_video_toolbox()) {
+#endif
+    // 全てのペンディングタスクと flush タスクが完了するまで待機
+    std::unique_lock<std::mutex> lock(queue_mutex_);
+    queue_cv_.wait(lock, [this]() { return is_queue_idle(); });
+#if defined(__APPLE__)
+  }
+#endif
+
+  flush_decoder();
+}
+
+uint64_t VideoDecoder::request_flush() {
+  if (!output_queue_) {
+    throw std::runtime_error("output_queue is not enabled");
+  }
+  std::lock_guard<std::mutex> lock(queue_mutex_);
+  // flush() と同じく、構成済みでない場合は何もせずに完了とする
+  if (state_ != CodecState::CONFIGURED) {
+    return completed_flushes_;
+  }
+  // decode() で追加したチャンクを全て処理した後にワーカーで flush する
+  DecodeTask task{};
+  task.flush = true;
+  decode_queue_.push_back(std::move(task));
+  uint64_t id = ++requested_flushes_;
+  queue_cv_.notify_all();
+  post_worker_tasks(1);
+  return id;
+}
+
+void VideoDecoder::report_error(const std::string& message) {
+  nb::object error_cb;
+  bool has_error;
+  {
+    nb::ft_lock_guard guard(callback_mutex_);
+    error_cb = error_callback_;
+    has_error = has_error_callback_;
+  }
+  if (has_error && !error_cb.is_none()) {
+    nb::gil_scoped_acquire gil;
+    try {
+      error_cb(message);
+    } catch (...) {
+      // エラーコールバック自体のエラーは無視
+    }
+  }
+}
+
+void VideoDecoder::run_flush_task() {
+  try {
+    flush_decoder();
+  } catch (const std::exception& e) {
+    report_error(e.what());
+  }
+  // 出力をキューに追加し終えてから完了を通知する
+  deliver_output_batch(true);
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    // reset() で完了扱いにした flush タスクは数えない
+    if (completed_flushes_ < requested_flushes_) {
+      completed_flushes_++;
+    }
+  }
+  queue_cv_.notify_all();
+  output_queue_->wake();
+}
+
+bool VideoDecoder::is_queue_idle() const {
+  return decode_queue_.empty() && pending_tasks_ == 0 &&
+         completed_flushes_ == requested_flushes_;
+}
+
+void VideoDecoder::flush_decoder() {
   // NVIDIA Video Codec SDK の場合
 #if defined(USE_NVIDIA_CUDA_TOOLKIT)
   if (uses_nvidia_video_codec()) {
-    // 全てのペンディングタスクが完了するまで待機
-    {
-      std::unique_lock<std::mutex> lock(queue_mutex_);
-      queue_cv_.wait(lock, [this]() {
-        return decode_queue_.empty() && pending_tasks_ == 0;
-      });
-    }
     flush_nvdec();
     return;
   }
@@ -201,58 +509,29 @@ void VideoDecoder::flush() {
   // Intel VPL の場合
 #if defined(__linux__)
   if (uses_intel_vpl()) {
-    // 全てのペンディングタスクが完了するまで待機
-    {
-      std::unique_lock<std::mutex> lock(queue_mutex_);
-      queue_cv_.wait(lock, [this]() {
-        return decode_queue_.empty() && pending_tasks_ == 0;
-      });
-    }
     flush_intel_vpl();
 
     // 出力バッファに残っているフレームを全て出力
-    std::vector<std::unique_ptr<VideoFrame>> frames_to_output;
-    {
-      std::lock_guard<std::mutex> lock(output_mutex_);
-      for (auto& pair : output_buffer_) {
-        frames_to_output.push_back(std::move(pair.second));
-      }
-      output_buffer_.clear();
-    }
-
-    // コールバックを呼び出す（GIL を取得）
-    nb::object output_cb;
-    bool has_output;
-    {
-      nb::ft_lock_guard guard(callback_mutex_);
-      output_cb = output_callback_;
-      has_output = has_output_callback_;
-    }
-    if (has_output && !frames_to_output.empty()) {
-      nb::gil_scoped_acquire gil;
-      for (auto& frame : frames_to_output) {
-        if (!output_cb.is_none()) {
-          output_cb(nb::cast(frame.release(), nb::rv_policy::take_ownership));
-        }
-      }
-    }
+    drain_output_ring();
 
     return;
   }
 #endif
 
-  // VideoToolbox は直接処理されるため、ワーカーキューの待機をスキップ
-#if defined(__APPLE__)
-  if (!uses_apple_video_toolbox()) {
+  // フレーム遅延により dav1d 内部に残っているピクチャを取り出す
+  if (decoder_context_ && string_to_codec(config_.codec) == VideoCodec::AV1) {
+    flush_dav1d();
+  }
+#if defined(__APPLE__) || defined(__linux__)
+  // libvpx 内部に残っているフレームを取り出す
+  if (vpx_decoder_) {
+    flush_vpx();
+  }
 #endif
-    // 全てのペンディングタスクが完了するまで待機
-    {
-      std::unique_lock<std::mutex> lock(queue_mutex_);
-      queue_cv_.wait(lock, [this]() {
-        return decode_queue_.empty() && pending_tasks_ == 0;
-      });
-    }
-#if defined(__APPLE__)
+#if defined(__linux__)
+  // スレッドや並べ替えにより OpenH264 内部に残っているピクチャを取り出す
+  if (decoder_context_ && string_to_codec(config_.codec) == VideoCodec::H264) {
+    flush_openh264();
   }
 #endif
 
@@ -265,6 +544,213 @@ void VideoDecoder::flush() {
     }
   }
 #endif
+
+  // 結果を出さなかったシーケンス番号で止まっているフレームを全て出力
+  drain_output_ring();
+}
+
+std::vector<std::unique_ptr<VideoFrame>> VideoDecoder::decode_sync(
+    const EncodedVideoChunk& chunk) {
+  if (state_ != CodecState::CONFIGURED) {
+    throw std::runtime_error("Decoder is not configured");
+  }
+  // VideoToolbox はデコード結果を別スレッドのコールバックで返すため対応しない
+#if defined(__APPLE__)
+  if (uses_apple_video_toolbox()) {
+    throw std::runtime_error(
+        "NotSupportedError: decode_sync is not supported by the VideoToolbox "
+        "decoder");
+  }
+#endif
+
+  bool is_key = chunk.type() == EncodedVideoChunkType::KEY;
+  if (config_.decode_frame_type == DecodeFrameType::KEY && !is_key) {
+    decode_queue_skipped_++;
+    return {};
+  }
+
+  std::lock_guard<std::mutex> sync_lock(sync_mutex_);
+  return run_sync([this, &chunk, is_key]() {
+    bool discard = false;
+    uint64_t sequence;
+    {
+      // decode() でキューに追加したチャンクと順序が入れ替わらないよう、処理し終えるまで待機する
+      std::unique_lock<std::mutex> lock(queue_mutex_);
+      queue_cv_.wait(lock, [this]() { return is_queue_idle(); });
+      // 差分フレームを破棄した後は、参照先がないため次のキーフレームまで破棄する
+      if (!is_key && awaiting_keyframe_) {
+        discard = true;
+      } else if (is_key) {
+        awaiting_keyframe_ = false;
+      }
+      sequence = next_sequence_number_++;
+    }
+
+    if (discard) {
+      std::vector<std::unique_ptr<VideoFrame>> outputs;
+      discard_sequence(sequence, outputs);
+      emit_frames(std::move(outputs));
+      return;
+    }
+
+    current_sequence_ = sequence;
+    if (!decode_internal(chunk)) {
+      throw std::runtime_error("Failed to decode chunk");
+    }
+  });
+}
+
+std::vector<std::unique_ptr<VideoFrame>> VideoDecoder::flush_sync() {
+  std::lock_guard<std::mutex> sync_lock(sync_mutex_);
+  return run_sync([this]() { flush(); });
+}
+
+std::vector<std::unique_ptr<VideoFrame>> VideoDecoder::run_sync(
+    const std::function<void()>& fn) {
+  std::vector<std::unique_ptr<VideoFrame>> outputs;
+  sync_outputs_ = &outputs;
+  sync_thread_ = std::this_thread::get_id();
+  try {
+    fn();
+  } catch (...) {
+    sync_thread_ = std::thread::id();
+    sync_outputs_ = nullptr;
+    throw;
+  }
+  sync_thread_ = std::thread::id();
+  sync_outputs_ = nullptr;
+  return outputs;
+}
+
+std::unique_ptr<VideoFrame> VideoDecoder::read_output(
+    std::optional<double> timeout,
+    bool until_idle) {
+  if (!output_queue_) {
+    throw std::runtime_error("output_queue is not enabled");
+  }
+  auto frame = output_queue_->pop(timeout, [this, until_idle]() {
+    return state_ == CodecState::CLOSED ||
+           (until_idle && pending_tasks_ == 0);
+  });
+  return frame ? std::move(*frame) : nullptr;
+}
+
+std::vector<std::unique_ptr<VideoFrame>> VideoDecoder::read_all_outputs() {
+  if (!output_queue_) {
+    throw std::runtime_error("output_queue is not enabled");
+  }
+  return output_queue_->pop_all();
+}
+
+int VideoDecoder::output_queue_fd() {
+  if (!output_queue_) {
+    throw std::runtime_error("output_queue is not enabled");
+  }
+  return output_queue_->wakeup_fd();
+}
+
+void VideoDecoder::clear_output_queue_fd() {
+  if (output_queue_) {
+    output_queue_->clear_wakeup_fd();
+  }
+}
+
+bool VideoDecoder::is_queue_full(size_t bytes) {
+  // ワーカースレッド (出力コールバック内) から呼ばれた場合は待機すると進まなくなる
+  if (should_stop_ || is_worker_thread()) {
+    return false;
+  }
+  // 上限より大きなチャンクでも進むよう、処理待ちがなければ常に受け付ける
+  if (pending_tasks_ == 0) {
+    return false;
+  }
+  if (config_.max_queue_size.has_value() &&
+      pending_tasks_ >= *config_.max_queue_size) {
+    return true;
+  }
+  if (config_.max_queue_bytes.has_value() &&
+      pending_bytes_ + bytes > *config_.max_queue_bytes) {
+    return true;
+  }
+  return false;
+}
+
+void VideoDecoder::make_queue_space(
+    std::unique_lock<std::mutex>& lock,
+    size_t bytes,
+    std::vector<std::unique_ptr<VideoFrame>>& outputs) {
+  while (is_queue_full(bytes)) {
+    switch (config_.queue_full_policy) {
+      case QueueFullPolicy::RAISE:
+        throw QuotaExceededError("Decode queue is full");
+      case QueueFullPolicy::DROP_OLDEST:
+        if (drop_oldest_task(outputs)) {
+          break;
+        }
+        // 破棄できるチャンクがない場合は空きができるまで待機する
+        [[fallthrough]];
+      case QueueFullPolicy::BLOCK:
+        queue_cv_.wait(lock, [this, bytes]() { return !is_queue_full(bytes); });
+        break;
+    }
+  }
+}
+
+bool VideoDecoder::drop_oldest_task(
+    std::vector<std::unique_ptr<VideoFrame>>& outputs) {
+  auto it = std::find_if(
+      decode_queue_.begin(), decode_queue_.end(), [](const DecodeTask& task) {
+        return !task.flush && task.chunk->type() == EncodedVideoChunkType::DELTA;
+      });
+  if (it == decode_queue_.end()) {
+    return false;
+  }
+
+  // 後続の差分フレームは破棄したフレームを参照するため、次のキーフレームまで破棄する
+  while (it != decode_queue_.end() && !it->flush &&
+         it->chunk->type() == EncodedVideoChunkType::DELTA) {
+    discard_sequence(it->sequence_number, outputs);
+    pending_bytes_ -= it->bytes;
+    pending_tasks_--;
+    it = decode_queue_.erase(it);
+  }
+  // キューに次のキーフレームがない場合は、これから追加される差分フレームも破棄する
+  if (it == decode_queue_.end()) {
+    awaiting_keyframe_ = true;
+  }
+  // flush() の待機側に通知
+  queue_cv_.notify_all();
+  return true;
+}
+
+void VideoDecoder::discard_sequence(
+    uint64_t sequence,
+    std::vector<std::unique_ptr<VideoFrame>>& outputs) {
+  queue_dropped_++;
+  std::lock_guard<std::mutex> lock(output_mutex_);
+  output_ring_.discard(sequence, outputs);
+}
+
+bool VideoDecoder::has_output_capacity() {
+  // ワーカースレッド (出力コールバック内) から呼ばれた場合は待機すると進まなくなる
+  if (should_stop_ || is_worker_thread()) {
+    return true;
+  }
+  if (decode_queue_.empty() && pending_tasks_ == 0) {
+    return true;
+  }
+  std::lock_guard<std::mutex> lock(output_mutex_);
+  return next_sequence_number_ - output_ring_.next() < output_ring_.capacity();
+}
+
+void VideoDecoder::drain_output_ring() {
+  std::vector<std::unique_ptr<VideoFrame>> frames_to_output;
+  {
+    std::lock_guard<std::mutex> lock(output_mutex_);
+    output_ring_.drain(frames_to_output);
+    output_ring_.skip_to(next_sequence_number_);
+  }
+  emit_frames(std::move(frames_to_output));
 }
 
 void VideoDecoder::reset() {
@@ -278,17 +764,27 @@ void VideoDecoder::reset() {
   // キューをクリア
   {
     std::lock_guard<std::mutex> lock(queue_mutex_);
-    while (!decode_queue_.empty()) {
-      decode_queue_.pop();
-    }
+    decode_queue_.clear();
     pending_tasks_ = 0;
+    pending_bytes_ = 0;
+    awaiting_keyframe_ = false;
+    queue_high_water_mark_ = 0;
+    queue_dropped_ = 0;
+    decode_queue_skipped_ = 0;
+    // 破棄した flush タスクは完了として扱い、flush_async() の待機を終わらせる
+    completed_flushes_ = requested_flushes_.load();
+  }
+  // 出力キューで待機している read() に処理待ちのタスクがなくなったことを通知する
+  // 出力済みのフレームはキューに残す
+  if (output_queue_) {
+    output_queue_->wake();
   }
 
   // 出力バッファをクリア
   {
     std::lock_guard<std::mutex> lock(output_mutex_);
-    output_buffer_.clear();
-    next_output_sequence_ = 0;
+    output_ring_.clear();
+    output_batch_.clear();
   }
 
   // シーケンス番号をリセット
@@ -311,11 +807,17 @@ void VideoDecoder::close() {
 
   // ワーカースレッドを停止してからリソースを解放
   // stop_worker() は再入可能なので、デストラクタから呼ばれても安全
-  if (worker_thread_.joinable()) {
+  if (is_worker_running()) {
     stop_worker();
   }
   cleanup_decoder();
+  // 出力済みの VideoFrame が使用中のバッファはそれぞれの close() で解放される
+  frame_pool_->trim();
   state_ = CodecState::CLOSED;
+  // 出力キューで待機している read() を起こす
+  if (output_queue_) {
+    output_queue_->wake();
+  }
 }
 
 VideoDecoderSupport VideoDecoder::is_config_supported(
@@ -324,6 +826,34 @@ VideoDecoderSupport VideoDecoder::is_config_supported(
   try {
     VideoCodec codec = string_to_codec(config.codec);
 
+    if (!supports_decode_frame_type(config)) {
+      return VideoDecoderSupport(false, config);
+    }
+
+    // 出力サイズとフォーマットの変換はソフトウェアデコーダーのみ対応
+    if (config.output_format.has_value() &&
+        !is_decoder_output_format(*config.output_format)) {
+      return VideoDecoderSupport(false, config);
+    }
+    if (config.output_width.has_value() || config.output_height.has_value() ||
+        config.output_format.value_or(VideoPixelFormat::I420) !=
+            VideoPixelFormat::I420) {
+      bool hardware = config.hardware_acceleration_engine.has_value() &&
+                      config.hardware_acceleration_engine.value() !=
+                          HardwareAccelerationEngine::NONE;
+#if defined(__APPLE__)
+      // H.264 / H.265 はエンジン未指定でも VideoToolbox を使用する
+      if (!config.hardware_acceleration_engine.has_value() &&
+          (codec == VideoCodec::H264 || codec == VideoCodec::H265)) {
+        hardware = true;
+      }
+#endif
+      if (hardware || config.output_width.has_value() !=
+                          config.output_height.has_value()) {
+        return VideoDecoderSupport(false, config);
+      }
+    }
+
     // NVIDIA Video Codec SDK でサポートされているかチェック
 #if defined(USE_NVIDIA_CUDA_TOOLKIT)
     if (config.hardware_acceleration_engine.has_value() &&
@@ -384,6 +914,15 @@ VideoDecoderSupport VideoDecoder::is_config_supported(
                          HardwareAccelerationEngine::INTEL_VPL);
 #else
         supported = false;  // 他のプラットフォームではまだサポートされていない
+#endif
+#if defined(__linux__)
+        // H.264 はエンジン未指定 (または NONE) の場合に OpenH264 でソフトウェアデコード
+        if (codec == VideoCodec::H264 &&
+            (!config.hardware_acceleration_engine.has_value() ||
+             config.hardware_acceleration_engine.value() ==
+                 HardwareAccelerationEngine::NONE)) {
+          supported = dyn::DynModule::IsLoadable(dyn::openh264_so());
+        }
 #endif
         break;
       case VideoCodec::VP8:
@@ -449,8 +988,16 @@ void VideoDecoder::init_decoder() {
       init_dav1d_decoder();
       break;
     case VideoCodec::H264:
+#if defined(__linux__)
+      // ハードウェアアクセラレーションを使用しない場合は OpenH264 でソフトウェアデコード
+      init_openh264_decoder();
+#else
+      // H.264 は uses_apple_video_toolbox() で処理されるため、ここには到達しない
+      throw std::runtime_error("H.264/H.265 not supported on this platform");
+#endif
+      break;
     case VideoCodec::H265:
-      // H.264/H.265 は uses_apple_video_toolbox()/uses_intel_vpl() で処理されるため、ここには到達しない
+      // H.265 は uses_apple_video_toolbox()/uses_intel_vpl() で処理されるため、ここには到達しない
       throw std::runtime_error("H.264/H.265 not supported on this platform");
       break;
     case VideoCodec::VP8:
@@ -468,7 +1015,7 @@ void VideoDecoder::init_decoder() {
 
 void VideoDecoder::cleanup_decoder() {
   // ワーカースレッドが完全に停止していることを確認
-  if (worker_thread_.joinable()) {
+  if (is_worker_running()) {
     // まだワーカースレッドが動いている場合は先に停止
     stop_worker();
   }
@@ -512,6 +1059,10 @@ void VideoDecoder::cleanup_decoder() {
       cleanup_dav1d_decoder();
       break;
     case VideoCodec::H264:
+#if defined(__linux__)
+      cleanup_openh264_decoder();
+#endif
+      break;
     case VideoCodec::H265:
       // VideoToolbox/Intel VPL は上で処理されるため、ここには到達しない
       break;
@@ -555,6 +1106,9 @@ bool VideoDecoder::decode_internal(const EncodedVideoChunk& chunk) {
     case VideoCodec::AV1:
       return decode_dav1d(chunk);
     case VideoCodec::H264:
+#if defined(__linux__)
+      return decode_openh264(chunk);
+#endif
     case VideoCodec::H265: {
       // H.264/H.265 は uses_apple_video_toolbox()/uses_intel_vpl() で処理されるため、ここには到達しない
       nb::object error_cb;
@@ -595,11 +1149,6 @@ bool VideoDecoder::decode_internal(const EncodedVideoChunk& chunk) {
   }
 }
 
-void VideoDecoder::flush_dav1d() {
-  // AV1 デコーダーのフラッシュ処理は decode_dav1d() 側で実行される
-  // ここでは特に何もしない
-}
-
 // 分割されたファイルをインクルード
 #include "video_decoder_apple_video_toolbox.cpp"
 #include "video_decoder_dav1d.cpp"
@@ -609,6 +1158,7 @@ void VideoDecoder::flush_dav1d() {
 #endif
 #if defined(__linux__)
 #include "video_decoder_intel_vpl.cpp"
+#include "video_decoder_openh264.cpp"
 #endif
 
 bool VideoDecoder::uses_nvidia_video_codec() const {
@@ -653,6 +1203,160 @@ bool VideoDecoder::uses_apple_video_toolbox() const {
 #endif
 }
 
+bool VideoDecoder::uses_software_decoder() const {
+  return !uses_nvidia_video_codec() && !uses_apple_video_toolbox() &&
+         !uses_intel_vpl();
+}
+
+bool VideoDecoder::converts_output() const {
+  return config_.output_width.has_value() ||
+         config_.output_format.value_or(VideoPixelFormat::I420) !=
+             VideoPixelFormat::I420;
+}
+
+std::unique_ptr<VideoFrame> VideoDecoder::make_output_frame(
+    const uint8_t* y,
+    int y_stride,
+    const uint8_t* u,
+    int u_stride,
+    const uint8_t* v,
+    int v_stride,
+    int width,
+    int height,
+    int64_t timestamp,
+    VideoMatrixCoefficients matrix,
+    bool full_range) {
+  VideoPixelFormat format =
+      config_.output_format.value_or(VideoPixelFormat::I420);
+  int output_width = config_.output_width.has_value()
+                         ? static_cast<int>(*config_.output_width)
+                         : width;
+  int output_height = config_.output_height.has_value()
+                          ? static_cast<int>(*config_.output_height)
+                          : height;
+  auto frame = std::make_unique<VideoFrame>(
+      static_cast<uint32_t>(output_width), static_cast<uint32_t>(output_height),
+      format, timestamp, frame_pool_);
+
+  // 出力サイズに変換する
+  // I420 の場合は出力先へ直接、それ以外は作業用バッファへ変換してから色変換する
+  if (output_width != width || output_height != height) {
+    libyuv::FilterMode filter = libyuv::kFilterBox;
+    switch (config_.output_scale_filter) {
+      case VideoScaleFilter::NONE:
+        filter = libyuv::kFilterNone;
+        break;
+      case VideoScaleFilter::LINEAR:
+        filter = libyuv::kFilterLinear;
+        break;
+      case VideoScaleFilter::BILINEAR:
+        filter = libyuv::kFilterBilinear;
+        break;
+      case VideoScaleFilter::BOX:
+        filter = libyuv::kFilterBox;
+        break;
+    }
+
+    uint8_t* dst_y;
+    uint8_t* dst_u;
+    uint8_t* dst_v;
+    int dst_stride_y = output_width;
+    int dst_stride_uv = output_width / 2;
+    if (format == VideoPixelFormat::I420) {
+      dst_y = frame->mutable_plane_ptr(0);
+      dst_u = frame->mutable_plane_ptr(1);
+      dst_v = frame->mutable_plane_ptr(2);
+      dst_stride_y = static_cast<int>(frame->plane_stride(0));
+      dst_stride_uv = static_cast<int>(frame->plane_stride(1));
+    } else {
+      size_t y_size = static_cast<size_t>(output_width) * output_height;
+      size_t uv_size = y_size / 4;
+      output_scale_buffer_.resize(y_size + uv_size * 2);
+      dst_y = output_scale_buffer_.data();
+      dst_u = dst_y + y_size;
+      dst_v = dst_u + uv_size;
+    }
+    libyuv::I420Scale(y, y_stride, u, u_stride, v, v_stride, width, height,
+                      dst_y, dst_stride_y, dst_u, dst_stride_uv, dst_v,
+                      dst_stride_uv, output_width, output_height, filter);
+    if (format == VideoPixelFormat::I420) {
+      return frame;
+    }
+    y = dst_y;
+    u = dst_u;
+    v = dst_v;
+    y_stride = dst_stride_y;
+    u_stride = dst_stride_uv;
+    v_stride = dst_stride_uv;
+    width = output_width;
+    height = output_height;
+  }
+
+  // ストリームの行列係数とレンジに合わせた変換係数を選ぶ
+  // libyuv の ARGB / RGB24 はメモリ上で B, G, R の順になるため、
+  // R, G, B の順で出力する場合は U と V を入れ替えて YVU の係数を使う
+  const libyuv::YuvConstants* yuv_constants;
+  const libyuv::YuvConstants* yvu_constants;
+  switch (matrix) {
+    case VideoMatrixCoefficients::BT709:
+      yuv_constants =
+          full_range ? &libyuv::kYuvF709Constants : &libyuv::kYuvH709Constants;
+      yvu_constants =
+          full_range ? &libyuv::kYvuF709Constants : &libyuv::kYvuH709Constants;
+      break;
+    case VideoMatrixCoefficients::BT2020_NCL:
+      yuv_constants =
+          full_range ? &libyuv::kYuvV2020Constants : &libyuv::kYuv2020Constants;
+      yvu_constants =
+          full_range ? &libyuv::kYvuV2020Constants : &libyuv::kYvu2020Constants;
+      break;
+    default:
+      // BT.601 (BT470BG / SMPTE170M) と不明な場合
+      yuv_constants =
+          full_range ? &libyuv::kYuvJPEGConstants : &libyuv::kYuvI601Constants;
+      yvu_constants =
+          full_range ? &libyuv::kYvuJPEGConstants : &libyuv::kYvuI601Constants;
+      break;
+  }
+
+  uint8_t* dst = frame->mutable_plane_ptr(0);
+  int dst_stride = static_cast<int>(frame->plane_stride(0));
+  switch (format) {
+    case VideoPixelFormat::I420:
+      libyuv::I420Copy(y, y_stride, u, u_stride, v, v_stride, dst, dst_stride,
+                       frame->mutable_plane_ptr(1),
+                       static_cast<int>(frame->plane_stride(1)),
+                       frame->mutable_plane_ptr(2),
+                       static_cast<int>(frame->plane_stride(2)), width, height);
+      break;
+    case VideoPixelFormat::NV12:
+      libyuv::I420ToNV12(y, y_stride, u, u_stride, v, v_stride, dst,
+                         dst_stride, frame->mutable_plane_ptr(1),
+                         static_cast<int>(frame->plane_stride(1)), width,
+                         height);
+      break;
+    case VideoPixelFormat::RGBA:
+      libyuv::I420ToARGBMatrix(y, y_stride, v, v_stride, u, u_stride, dst,
+                               dst_stride, yvu_constants, width, height);
+      break;
+    case VideoPixelFormat::BGRA:
+      libyuv::I420ToARGBMatrix(y, y_stride, u, u_stride, v, v_stride, dst,
+                               dst_stride, yuv_constants, width, height);
+      break;
+    case VideoPixelFormat::RGB:
+      libyuv::I420ToRGB24Matrix(y, y_stride, v, v_stride, u, u_stride, dst,
+                                dst_stride, yvu_constants, width, height);
+      break;
+    case VideoPixelFormat::BGR:
+      libyuv::I420ToRGB24Matrix(y, y_stride, u, u_stride, v, v_stride, dst,
+                                dst_stride, yuv_constants, width, height);
+      break;
+    default:
+      throw std::runtime_error("Unsupported output_format");
+  }
+  return frame;
+}
+
 bool VideoDecoder::uses_intel_vpl() const {
 #if defined(__linux__)
   VideoCodec codec = string_to_codec(config_.codec);
@@ -668,6 +1372,19 @@ bool VideoDecoder::uses_intel_vpl() const {
 // ワーカースレッドの開始
 void VideoDecoder::start_worker() {
   should_stop_ = false;
+  if (worker_pool_) {
+    // プールを使う場合はスレッドを立てず、キューに残っているタスクを投入する
+    // 関数から例外が伝播した場合はエラーコールバックで報告する
+    worker_strand_ = worker_pool_->create_strand(
+        [this](const std::string& message) { report_error(message); });
+    size_t queued;
+    {
+      std::lock_guard<std::mutex> lock(queue_mutex_);
+      queued = decode_queue_.size();
+    }
+    post_worker_tasks(queued);
+    return;
+  }
   worker_thread_ = std::thread([this]() { worker_loop(); });
 }
 
@@ -679,17 +1396,40 @@ void VideoDecoder::stop_worker() {
   }
   queue_cv_.notify_all();
 
+  if (worker_strand_) {
+    // 投入済みのタスクを処理し終えるまで待つ
+    worker_strand_->drain();
+    worker_strand_.reset();
+  }
   if (worker_thread_.joinable()) {
     worker_thread_.join();
   }
 }
 
+bool VideoDecoder::is_worker_running() const {
+  return worker_thread_.joinable() || worker_strand_ != nullptr;
+}
+
+bool VideoDecoder::is_worker_thread() const {
+  if (worker_strand_) {
+    return worker_strand_->running_in_this_thread();
+  }
+  return std::this_thread::get_id() == worker_thread_.get_id();
+}
+
+void VideoDecoder::post_worker_tasks(size_t count) {
+  std::shared_ptr<WorkerStrand> strand = worker_strand_;
+  if (!strand) {
+    return;
+  }
+  for (size_t i = 0; i < count; i++) {
+    strand->post([this]() { run_next_task(); });
+  }
+}
+
 // ワーカースレッドのメインループ
 void VideoDecoder::worker_loop() {
   while (true) {
-    DecodeTask task;
-
-    // タスクを取得
     {
       std::unique_lock<std::mutex> lock(queue_mutex_);
       queue_cv_.wait(
@@ -698,27 +1438,56 @@ void VideoDecoder::worker_loop() {
       if (should_stop_ && decode_queue_.empty()) {
         break;
       }
-
-      if (!decode_queue_.empty()) {
-        task = decode_queue_.front();
-        decode_queue_.pop();
-      } else {
-        continue;  // タスクがない場合は次のループへ
-      }
     }
+    run_next_task();
+  }
+}
 
-    // タスクを処理
-    if (task.chunk.has_value()) {
-      process_decode_task(task);
-    }
+// キューの先頭のタスクを処理する
+// 専用スレッドの worker_loop() とプールのストランドの両方から呼ばれる
+void VideoDecoder::run_next_task() {
+  DecodeTask task;
 
-    // 処理待ちタスク数を減らす
-    {
-      std::lock_guard<std::mutex> lock(queue_mutex_);
-      pending_tasks_--;
+  // タスクを取得
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    if (decode_queue_.empty()) {
+      return;
     }
-    // flush() の待機側に通知
-    queue_cv_.notify_all();
+    task = std::move(decode_queue_.front());
+    decode_queue_.pop_front();
+  }
+
+  // flush タスクは処理待ちのタスク数に含めない
+  if (task.flush) {
+    run_flush_task();
+    return;
+  }
+
+  // タスクを処理
+  if (task.chunk.has_value()) {
+    process_decode_task(task);
+  }
+
+  // バッチ出力: キューが空になったか上限に達したら溜めたフレームを出力する
+  // pending_tasks_ を減らす前に出力し、flush() の完了時には出力済みにする
+  bool queue_empty;
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    queue_empty = decode_queue_.empty();
+  }
+  deliver_output_batch(queue_empty);
+
+  // 処理待ちタスク数を減らす
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    pending_tasks_--;
+    pending_bytes_ -= task.bytes;
+  }
+  // flush() と上限で待機している decode() に通知
+  queue_cv_.notify_all();
+  if (output_queue_) {
+    output_queue_->wake();
   }
 }
 
@@ -756,29 +1525,66 @@ void VideoDecoder::handle_output(uint64_t sequence,
   {
     std::lock_guard<std::mutex> lock(output_mutex_);
 
-    // フレームをバッファに追加
-    output_buffer_[sequence] = std::move(frame);
+    // フレームをリングに追加し、順序通りに出力できるフレームを収集
+    output_ring_.put(sequence, std::move(frame), frames_to_output);
+  }
+
+  emit_frames(std::move(frames_to_output));
+}
+
+void VideoDecoder::emit_frames(
+    std::vector<std::unique_ptr<VideoFrame>> frames) {
+  if (frames.empty()) {
+    return;
+  }
 
-    // 順序通りに出力できるフレームを収集
-    while (output_buffer_.find(next_output_sequence_) != output_buffer_.end()) {
-      frames_to_output.push_back(
-          std::move(output_buffer_[next_output_sequence_]));
-      output_buffer_.erase(next_output_sequence_);
-      next_output_sequence_++;
+  // 同期モードで実行中の場合はコールバックを呼ばずに戻り値として返す
+  if (sync_thread_.load() == std::this_thread::get_id()) {
+    for (auto& frame : frames) {
+      if (frame) {
+        sync_outputs_->push_back(std::move(frame));
+      }
     }
+    return;
+  }
+
+  // 出力キューモードでは GIL を取得せずにキューに追加する
+  if (output_queue_) {
+    frames.erase(std::remove(frames.begin(), frames.end(), nullptr),
+                 frames.end());
+    output_queue_->push(frames);
+    return;
   }
 
-  // コールバックを呼び出す（GIL を取得）
   nb::object output_cb;
   bool has_output;
+  bool has_output_batch;
   {
     nb::ft_lock_guard guard(callback_mutex_);
     output_cb = output_callback_;
     has_output = has_output_callback_;
+    has_output_batch = has_output_batch_callback_;
+  }
+
+  if (has_output_batch) {
+    {
+      std::lock_guard<std::mutex> lock(output_mutex_);
+      for (auto& frame : frames) {
+        if (frame) {
+          output_batch_.push_back(std::move(frame));
+        }
+      }
+    }
+    // ワーカースレッドではキューが空になるまで溜める
+    // それ以外 (flush() や VideoToolbox のコールバック) ではすぐに出力する
+    deliver_output_batch(!is_worker_thread());
+    return;
   }
-  if (has_output && !frames_to_output.empty()) {
+
+  // コールバックを呼び出す（GIL を取得）
+  if (has_output) {
     nb::gil_scoped_acquire gil;
-    for (auto& output_frame : frames_to_output) {
+    for (auto& output_frame : frames) {
       if (output_frame && !output_cb.is_none()) {
         output_cb(
             nb::cast(output_frame.release(), nb::rv_policy::take_ownership));
@@ -787,28 +1593,187 @@ void VideoDecoder::handle_output(uint64_t sequence,
   }
 }
 
+void VideoDecoder::deliver_output_batch(bool force) {
+  std::vector<std::unique_ptr<VideoFrame>> frames;
+  {
+    std::lock_guard<std::mutex> lock(output_mutex_);
+    if (output_batch_.empty() ||
+        (!force && output_batch_.size() < kMaxOutputBatchSize)) {
+      return;
+    }
+    frames.swap(output_batch_);
+  }
+
+  nb::object output_cb;
+  nb::object output_batch_cb;
+  bool has_output;
+  bool has_output_batch;
+  {
+    nb::ft_lock_guard guard(callback_mutex_);
+    output_cb = output_callback_;
+    output_batch_cb = output_batch_callback_;
+    has_output = has_output_callback_;
+    has_output_batch = has_output_batch_callback_;
+  }
+
+  nb::gil_scoped_acquire gil;
+  if (has_output_batch && !output_batch_cb.is_none()) {
+    // 1 回の GIL 取得と 1 回の呼び出しでまとめて渡す
+    nb::list batch;
+    for (auto& frame : frames) {
+      batch.append(nb::cast(frame.release(), nb::rv_policy::take_ownership));
+    }
+    output_batch_cb(batch);
+  } else if (has_output && !output_cb.is_none()) {
+    // 溜めている間に output_batch コールバックが外された場合は 1 フレームずつ出力する
+    for (auto& frame : frames) {
+      output_cb(nb::cast(frame.release(), nb::rv_policy::take_ownership));
+    }
+  }
+}
+
+namespace {
+
+// 同期モードで返すフレームを Python のリストに変換する (GIL を保持して呼び出す)
+nb::list frames_to_list(std::vector<std::unique_ptr<VideoFrame>>& frames) {
+  nb::list list;
+  for (auto& frame : frames) {
+    list.append(nb::cast(frame.release(), nb::rv_policy::take_ownership));
+  }
+  return list;
+}
+
+}  // namespace
+
 void init_video_decoder(nb::module_& m) {
   nb::class_<VideoDecoder>(m, "VideoDecoder")
       .def(
-          nb::init<nb::object, nb::object>(), "output"_a, "error"_a,
-          nb::sig(
-              "def __init__(self, output: typing.Callable[[VideoFrame], None], "
-              "error: typing.Callable[[str], None], /) -> None"))
+          nb::init<nb::object, nb::object, std::shared_ptr<WorkerPool>,
+                   bool>(),
+          "output"_a, "error"_a, nb::kw_only(),
+          "worker_pool"_a.none() = nb::none(), "output_queue"_a = false,
+          nb::sig("def __init__(self, output: typing.Callable[[VideoFrame], "
+                  "None] | None, error: typing.Callable[[str], None], /, *, "
+                  "worker_pool: WorkerPool | None = None, "
+                  "output_queue: bool = False) -> None"))
       .def("configure", &VideoDecoder::configure, "config"_a,
            nb::sig("def configure(self, config: webcodecs.VideoDecoderConfig, "
                    "/) -> None"))
       .def("decode", &VideoDecoder::decode, "chunk"_a,
            nb::call_guard<nb::gil_scoped_release>(),
            nb::sig("def decode(self, chunk: EncodedVideoChunk, /) -> None"))
+      .def("decode_many", &VideoDecoder::decode_many, "chunks"_a,
+           nb::call_guard<nb::gil_scoped_release>(),
+           nb::sig("def decode_many(self, chunks: "
+                   "typing.Sequence[EncodedVideoChunk], /) -> None"))
       .def("flush", &VideoDecoder::flush,
            nb::call_guard<nb::gil_scoped_release>(),
            nb::sig("def flush(self, /) -> None"))
+      .def(
+          "decode_sync",
+          [](VideoDecoder& self, const EncodedVideoChunk& chunk) {
+            std::vector<std::unique_ptr<VideoFrame>> frames;
+            {
+              nb::gil_scoped_release gil;
+              frames = self.decode_sync(chunk);
+            }
+            return frames_to_list(frames);
+          },
+          "chunk"_a,
+          nb::sig("def decode_sync(self, chunk: EncodedVideoChunk, /) -> "
+                  "list[VideoFrame]"))
+      .def(
+          "flush_sync",
+          [](VideoDecoder& self) {
+            std::vector<std::unique_ptr<VideoFrame>> frames;
+            {
+              nb::gil_scoped_release gil;
+              frames = self.flush_sync();
+            }
+            return frames_to_list(frames);
+          },
+          nb::sig("def flush_sync(self, /) -> list[VideoFrame]"))
+      .def(
+          "read",
+          [](VideoDecoder& self, std::optional<double> timeout) -> nb::object {
+            std::unique_ptr<VideoFrame> frame;
+            {
+              nb::gil_scoped_release gil;
+              frame = self.read_output(timeout, false);
+            }
+            if (!frame) {
+              return nb::none();
+            }
+            return nb::cast(frame.release(), nb::rv_policy::take_ownership);
+          },
+          "timeout"_a = nb::none(),
+          nb::sig("def read(self, timeout: float | None = None) -> "
+                  "VideoFrame | None"))
+      .def(
+          "read_all",
+          [](VideoDecoder& self) {
+            std::vector<std::unique_ptr<VideoFrame>> frames =
+                self.read_all_outputs();
+            return frames_to_list(frames);
+          },
+          nb::sig("def read_all(self, /) -> list[VideoFrame]"))
+      .def("__iter__", [](nb::object self) { return self; },
+           nb::sig("def __iter__(self, /) -> typing.Iterator[VideoFrame]"))
+      .def(
+          "__next__",
+          [](VideoDecoder& self) {
+            std::unique_ptr<VideoFrame> frame;
+            {
+              nb::gil_scoped_release gil;
+              frame = self.read_output(std::nullopt, true);
+            }
+            if (!frame) {
+              throw nb::stop_iteration();
+            }
+            return nb::cast(frame.release(), nb::rv_policy::take_ownership);
+          },
+          nb::sig("def __next__(self, /) -> VideoFrame"))
+      .def_prop_ro("output_queue_size", &VideoDecoder::output_queue_size,
+                   nb::sig("def output_queue_size(self, /) -> int"))
+      .def_prop_ro("output_queue_fd", &VideoDecoder::output_queue_fd,
+                   nb::sig("def output_queue_fd(self, /) -> int"))
+      .def("clear_output_queue_fd", &VideoDecoder::clear_output_queue_fd,
+           nb::sig("def clear_output_queue_fd(self, /) -> None"))
+      .def("request_flush", &VideoDecoder::request_flush,
+           nb::sig("def request_flush(self, /) -> int"))
+      .def_prop_ro("completed_flushes", &VideoDecoder::completed_flushes,
+                   nb::sig("def completed_flushes(self, /) -> int"))
+      .def(
+          "flush_async",
+          [](nb::object self) {
+            return nb::module_::import_("webcodecs._asyncio")
+                .attr("flush_async")(self);
+          },
+          nb::sig("def flush_async(self, /) -> "
+                  "typing.Coroutine[typing.Any, typing.Any, None]"))
+      .def(
+          "frames",
+          [](nb::object self) {
+            return nb::module_::import_("webcodecs._asyncio")
+                .attr("outputs")(self);
+          },
+          nb::sig("def frames(self, /) -> typing.AsyncIterator[VideoFrame]"))
       .def("reset", &VideoDecoder::reset, nb::sig("def reset(self, /) -> None"))
       .def("close", &VideoDecoder::close, nb::sig("def close(self, /) -> None"))
       .def_prop_ro("state", &VideoDecoder::state,
                    nb::sig("def state(self, /) -> CodecState"))
       .def_prop_ro("decode_queue_size", &VideoDecoder::decode_queue_size,
                    nb::sig("def decode_queue_size(self, /) -> int"))
+      .def_prop_ro(
+          "decode_queue_high_water_mark",
+          &VideoDecoder::decode_queue_high_water_mark,
+          nb::sig("def decode_queue_high_water_mark(self, /) -> int"))
+      .def_prop_ro("decode_queue_dropped", &VideoDecoder::decode_queue_dropped,
+                   nb::sig("def decode_queue_dropped(self, /) -> int"))
+      .def_prop_ro("decode_queue_skipped", &VideoDecoder::decode_queue_skipped,
+                   nb::sig("def decode_queue_skipped(self, /) -> int"))
+      .def("frame_pool_stats", &VideoDecoder::frame_pool_stats,
+           nb::sig("def frame_pool_stats(self, /) -> webcodecs.FramePoolStats"))
       .def_static(
           "is_config_supported",
           [](nb::dict config_dict) {
@@ -842,6 +1807,48 @@ void init_video_decoder(nb::module_& m) {
             if (config_dict.contains("optimize_for_latency"))
               config.optimize_for_latency =
                   nb::cast<bool>(config_dict["optimize_for_latency"]);
+            if (config_dict.contains("decode_threads"))
+              config.decode_threads =
+                  nb::cast<uint32_t>(config_dict["decode_threads"]);
+            if (config_dict.contains("max_frame_delay"))
+              config.max_frame_delay =
+                  nb::cast<uint32_t>(config_dict["max_frame_delay"]);
+            if (config_dict.contains("reorder_capacity"))
+              config.reorder_capacity =
+                  nb::cast<uint32_t>(config_dict["reorder_capacity"]);
+            if (config_dict.contains("max_queue_size"))
+              config.max_queue_size =
+                  nb::cast<uint32_t>(config_dict["max_queue_size"]);
+            if (config_dict.contains("max_queue_bytes"))
+              config.max_queue_bytes =
+                  nb::cast<uint64_t>(config_dict["max_queue_bytes"]);
+            if (config_dict.contains("queue_full_policy"))
+              config.queue_full_policy =
+                  nb::cast<QueueFullPolicy>(config_dict["queue_full_policy"]);
+            if (config_dict.contains("output_width") &&
+                !config_dict["output_width"].is_none())
+              config.output_width =
+                  nb::cast<uint32_t>(config_dict["output_width"]);
+            if (config_dict.contains("output_height") &&
+                !config_dict["output_height"].is_none())
+              config.output_height =
+                  nb::cast<uint32_t>(config_dict["output_height"]);
+            if (config_dict.contains("output_scale_filter") &&
+                !config_dict["output_scale_filter"].is_none())
+              config.output_scale_filter = nb::cast<VideoScaleFilter>(
+                  config_dict["output_scale_filter"]);
+            if (config_dict.contains("output_format") &&
+                !config_dict["output_format"].is_none())
+              config.output_format =
+                  nb::cast<VideoPixelFormat>(config_dict["output_format"]);
+            if (config_dict.contains("decode_frame_type") &&
+                !config_dict["decode_frame_type"].is_none())
+              config.decode_frame_type =
+                  nb::cast<DecodeFrameType>(config_dict["decode_frame_type"]);
+            if (config_dict.contains("decode_quality") &&
+                !config_dict["decode_quality"].is_none())
+              config.decode_quality =
+                  nb::cast<DecodeQuality>(config_dict["decode_quality"]);
 
             return VideoDecoder::is_config_supported(config);
           },
@@ -858,5 +1865,9 @@ void init_video_decoder(nb::module_& m) {
                    "/) -> None"))
       .def("on_dequeue", &VideoDecoder::on_dequeue,
            nb::sig("def on_dequeue(self, callback: typing.Callable[[], None], "
+                   "/) -> None"))
+      .def("on_output_batch", &VideoDecoder::on_output_batch,
+           nb::sig("def on_output_batch(self, callback: "
+                   "typing.Callable[[list[VideoFrame]], None] | None, "
                    "/) -> None"));
 }
@@ -3,6 +3,8 @@
 #include <nanobind/nanobind.h>
 #include <atomic>
 #include <condition_variable>
+#include <deque>
+#include <functional>
 #include <map>
 #include <memory>
 #include <mutex>
@@ -13,8 +15,11 @@
 #include <vector>
 #include "codec_parser.h"
 #include "encoded_video_chunk.h"
+#include "output_queue.h"
+#include "sequence_ring.h"
 #include "video_frame.h"
 #include "webcodecs_types.h"
+#include "worker_pool.h"
 
 #if defined(USE_NVIDIA_CUDA_TOOLKIT)
 #include <cuda.h>
@@ -44,22 +49,72 @@ class VideoDecoder {
   struct DecodeTask {
     std::optional<EncodedVideoChunk> chunk;
     uint64_t sequence_number;  // タスクの順序を保持
+    size_t bytes = 0;          // max_queue_bytes の計算に使うバイト数
+    // request_flush() で追加した flush タスク (チャンクは持たない)
+    bool flush = false;
   };
 
   // コールバックを直接受け取るコンストラクタ
-  VideoDecoder(nb::object output, nb::object error);
+  // worker_pool を指定した場合は専用スレッドの代わりにプールのスレッドで処理する
+  // output_queue が true の場合は出力コールバックの代わりに出力キューに溜める
+  VideoDecoder(nb::object output,
+               nb::object error,
+               std::shared_ptr<WorkerPool> worker_pool = nullptr,
+               bool output_queue = false);
   ~VideoDecoder();
 
   // WebCodecs-like API
   void configure(nb::dict config);
   void decode(const EncodedVideoChunk& chunk);
+  // 複数のチャンクをまとめてキューに追加する（独自拡張）
+  // キューのロックと on_dequeue の呼び出しはバッチごとに 1 回
+  void decode_many(const std::vector<EncodedVideoChunk>& chunks);
   void flush();
   void reset();
   void close();
 
+  // 同期モード（独自拡張）
+  // ワーカースレッドを経由せず、呼び出し元のスレッドでデコードする
+  // 出力コールバックは呼び出さず、順序が確定したフレームを戻り値で返す
+  std::vector<std::unique_ptr<VideoFrame>> decode_sync(
+      const EncodedVideoChunk& chunk);
+  // flush() と同じ処理を行い、残りのフレームを戻り値で返す
+  std::vector<std::unique_ptr<VideoFrame>> flush_sync();
+
+  // 出力キューモード（独自拡張）
+  // 出力キューからフレームを 1 つ取り出す。取り出せなかった場合は nullptr を返す
+  // timeout (秒) が nullopt の場合は close() されるまで待機する
+  // until_idle が true の場合は処理待ちのタスクがなくなった時点でも待機をやめる
+  std::unique_ptr<VideoFrame> read_output(std::optional<double> timeout,
+                                          bool until_idle);
+  // 出力キューのフレームを待機せずに全て取り出す
+  std::vector<std::unique_ptr<VideoFrame>> read_all_outputs();
+  // 出力キューに溜まっているフレーム数
+  uint32_t output_queue_size() const {
+    return output_queue_ ? static_cast<uint32_t>(output_queue_->size()) : 0;
+  }
+  // 出力の追加やタスクの完了、close() の度に読み込み可能になるファイルディスクリプタ
+  // asyncio のイベントループで監視する
+  int output_queue_fd();
+  // output_queue_fd() の通知を読み捨てる
+  void clear_output_queue_fd();
+  // 処理待ちのタスクの後ろに flush タスクを追加し、その番号を返す (flush_async() から使用)
+  // ワーカーがデコーダー内部に残っているフレームを出力し終えると completed_flushes が
+  // その番号に達し、output_queue_fd() に通知する
+  uint64_t request_flush();
+  uint64_t completed_flushes() const { return completed_flushes_.load(); }
+
   // Properties
   CodecState state() const { return state_; }
   uint32_t decode_queue_size() const { return pending_tasks_.load(); }
+  // decode_queue_size の最大値（独自拡張）
+  uint32_t decode_queue_high_water_mark() const {
+    return queue_high_water_mark_.load();
+  }
+  // queue_full_policy が DROP_OLDEST の場合に破棄したチャンク数（独自拡張）
+  uint64_t decode_queue_dropped() const { return queue_dropped_.load(); }
+  // decode_frame_type が KEY の場合にキューに積まずに破棄した差分フレーム数（独自拡張）
+  uint64_t decode_queue_skipped() const { return decode_queue_skipped_.load(); }
 
   // Static method to check if configuration is supported
   static VideoDecoderSupport is_config_supported(
@@ -81,38 +136,84 @@ class VideoDecoder {
     dequeue_callback_ = callback;
     has_dequeue_callback_ = !callback.is_none();
   }
+  // 出力フレームを list[VideoFrame] でまとめて受け取るコールバック（独自拡張）
+  // 設定されている場合は output コールバックの代わりに呼び出す
+  void on_output_batch(nb::object callback) {
+    nb::ft_lock_guard guard(callback_mutex_);
+    output_batch_callback_ = callback;
+    has_output_batch_callback_ = !callback.is_none();
+  }
+
+  // デコード結果の VideoFrame が使うバッファプールの統計情報
+  nb::dict frame_pool_stats() const {
+    return frame_pool_stats_to_dict(frame_pool_->stats());
+  }
 
   // VideoToolbox コールバック用に public にする
   void handle_output(uint64_t sequence,
                      std::unique_ptr<VideoFrame> frame);  // 出力処理
+  const std::shared_ptr<FramePool>& frame_pool() const { return frame_pool_; }
 
  private:
   nb::object output_callback_;
   nb::object error_callback_;
   nb::object dequeue_callback_;
+  nb::object output_batch_callback_;
   nb::ft_mutex callback_mutex_;  // Free-Threading 用コールバック保護
   bool has_output_callback_{false};
   bool has_error_callback_{false};
   bool has_dequeue_callback_{false};
+  bool has_output_batch_callback_{false};
   CodecState state_;
   VideoDecoderConfig config_;     // 内部で保持する設定
   CodecParameters codec_params_;  // パースしたコーデックパラメータ
 
   // 並列処理のためのメンバー
-  std::queue<DecodeTask> decode_queue_;            // デコード待ちタスクのキュー
+  std::deque<DecodeTask> decode_queue_;            // デコード待ちタスクのキュー
   std::atomic<uint32_t> pending_tasks_{0};         // 処理待ちタスク数
+  size_t pending_bytes_{0};  // 処理待ちタスクのバイト数 (queue_mutex_ で保護)
+  std::atomic<uint32_t> queue_high_water_mark_{0};  // pending_tasks_ の最大値
+  std::atomic<uint64_t> queue_dropped_{0};          // 破棄したチャンク数
+  std::atomic<uint64_t> decode_queue_skipped_{0};  // KEY 指定で破棄した差分フレーム数
+  // DROP_OLDEST で差分フレームを破棄したため、次のキーフレームまで差分フレームを
+  // 破棄する (queue_mutex_ で保護)
+  bool awaiting_keyframe_{false};
   std::atomic<uint64_t> next_sequence_number_{0};  // タスクのシーケンス番号
+  // request_flush() で追加した flush タスクの数と処理し終えた数 (queue_mutex_ を保持して更新する)
+  // reset() で破棄した flush タスクは処理し終えたものとして扱う
+  std::atomic<uint64_t> requested_flushes_{0};
+  std::atomic<uint64_t> completed_flushes_{0};
   std::mutex queue_mutex_;                         // キューアクセスの同期
   std::condition_variable queue_cv_;               // キューの待機/通知
   std::thread worker_thread_;                      // ワーカースレッド
+  std::shared_ptr<WorkerPool> worker_pool_;        // 共有するワーカープール
+  std::shared_ptr<WorkerStrand> worker_strand_;    // プールで処理する場合のストランド
   std::atomic<bool> should_stop_{false};           // スレッド終了フラグ
   uint64_t current_sequence_{0};                   // 現在処理中のシーケンス番号
 
   // 出力順序制御のためのメンバー
-  std::map<uint64_t, std::unique_ptr<VideoFrame>>
-      output_buffer_;                 // 順序待ちバッファ
-  uint64_t next_output_sequence_{0};  // 次に出力すべきシーケンス番号
-  std::mutex output_mutex_;           // 出力バッファの同期
+  // シーケンス番号順に並べ替えるリング (容量は reorder_capacity で指定)
+  SequenceRing<std::unique_ptr<VideoFrame>> output_ring_;
+  std::mutex output_mutex_;  // 出力バッファの同期
+
+  // バッチ出力のためのメンバー
+  // ワーカースレッドで出力されたフレームを溜め、キューが空になるか
+  // 上限に達した時点で output_batch コールバックをまとめて呼び出す
+  static constexpr size_t kMaxOutputBatchSize = 64;
+  std::vector<std::unique_ptr<VideoFrame>> output_batch_;  // output_mutex_ で保護
+
+  // 同期モードのためのメンバー
+  // sync_thread_ で実行中に出力されたフレームはコールバックを呼ばずに sync_outputs_ に追加する
+  std::mutex sync_mutex_;  // 同期モードの呼び出しを直列化する
+  std::atomic<std::thread::id> sync_thread_{};
+  std::vector<std::unique_ptr<VideoFrame>>* sync_outputs_{nullptr};
+
+  // 出力キューモードで順序が確定したフレームを溜めるキュー (無効の場合は nullptr)
+  std::unique_ptr<OutputQueue<std::unique_ptr<VideoFrame>>> output_queue_;
+
+  // デコード結果をコピーする VideoFrame のバッファプール
+  // VideoFrame がデコーダーより長く生存してもよいよう shared_ptr で共有する
+  std::shared_ptr<FramePool> frame_pool_ = std::make_shared<FramePool>();
 
   // コーデック固有のデコーダーコンテキスト
   void* decoder_context_;
@@ -129,7 +230,13 @@ class VideoDecoder {
   void init_dav1d_decoder();
   void cleanup_dav1d_decoder();
   bool decode_dav1d(const EncodedVideoChunk& chunk);
-  void flush_dav1d();  // AV1 フラッシュ処理
+  // drain が false の場合は取り出せるピクチャを 1 枚だけ出力し、
+  // true の場合は内部に残っているピクチャを全て出力する
+  bool output_dav1d_pictures(bool drain);
+  void flush_dav1d();            // AV1 フラッシュ処理
+  // decode_frame_type でピクチャを出力しなかったチャンクを飛ばすため、
+  // 次に出力されるはずのシーケンス番号を保持する
+  uint64_t dav1d_next_output_sequence_ = 0;
 
   // ハードウェアアクセラレーションバックエンド
   void init_videotoolbox_decoder();
@@ -142,17 +249,65 @@ class VideoDecoder {
   void init_vpx_decoder();
   void cleanup_vpx_decoder();
   bool decode_vpx(const EncodedVideoChunk& chunk);
+  // libvpx から取り出せるフレームを全て出力する (vpx_mutex_ を保持して呼び出す)
+  void output_vpx_frames();
   void flush_vpx();
 
   void* vpx_decoder_ = nullptr;
   std::mutex vpx_mutex_;
+  // 出力フレームと対応付けるシーケンス番号ごとの timestamp と duration
+  // vpx_codec_decode() の user_priv にシーケンス番号を渡し、出力画像の user_priv から引く
+  std::map<uint64_t, std::pair<int64_t, uint64_t>> vpx_inputs_;
 #endif
 
   // 並列処理のためのメソッド
   void worker_loop();  // ワーカースレッドのメインループ
+  void run_next_task();  // キューの先頭のタスクを 1 つ処理する
   void process_decode_task(const DecodeTask& task);  // タスクの処理
   void start_worker();                               // ワーカースレッドの開始
   void stop_worker();                                // ワーカースレッドの停止
+  bool is_worker_running() const;  // ワーカースレッドまたはストランドが動作中か
+  bool is_worker_thread() const;   // 現在のスレッドでタスクを処理中か
+  // プールを使う場合は count 個のタスクの処理をストランドに投入する
+  void post_worker_tasks(size_t count);
+  // 順序待ちのシーケンス番号が output_ring_ の容量未満か (queue_mutex_ を保持して呼び出す)
+  // ワーカースレッドが待機中の場合は、結果が届かないシーケンス番号で止まらないよう true を返す
+  bool has_output_capacity();
+  // bytes バイトのタスクを追加するとキューの上限を超えるか (queue_mutex_ を保持して呼び出す)
+  bool is_queue_full(size_t bytes);
+  // キューに bytes バイトのタスクを追加できるようにする (queue_mutex_ を保持して呼び出す)
+  // 上限に達している場合は queue_full_policy に従って待機、例外送出、破棄を行う
+  // 破棄によって順序通りに出力できるようになったフレームは outputs に追加する
+  void make_queue_space(std::unique_lock<std::mutex>& lock,
+                        size_t bytes,
+                        std::vector<std::unique_ptr<VideoFrame>>& outputs);
+  // キュー内の最も古い差分フレームと、それを参照する後続の差分フレームを破棄する
+  // 破棄できるチャンクがない場合は false を返す (queue_mutex_ を保持して呼び出す)
+  bool drop_oldest_task(std::vector<std::unique_ptr<VideoFrame>>& outputs);
+  // シーケンス番号 sequence のチャンクを破棄したことを記録する
+  void discard_sequence(uint64_t sequence,
+                        std::vector<std::unique_ptr<VideoFrame>>& outputs);
+  // output_ring_ に残っているフレームを全て出力する (flush() の最後に呼び出す)
+  void drain_output_ring();
+  // 処理待ちのタスクも処理中の flush タスクもないか (queue_mutex_ を保持して呼び出す)
+  bool is_queue_idle() const;
+  // デコーダー内部に残っているフレームと順序待ちのフレームを全て出力する
+  // flush() と、ワーカーで処理する flush タスクから呼び出す
+  void flush_decoder();
+  // ワーカーで flush タスクを処理し、完了を output_queue_fd() に通知する
+  void run_flush_task();
+  // エラーコールバックを呼び出す (GIL を取得する)
+  void report_error(const std::string& message);
+
+  // 順序が確定したフレームを出力する
+  // バッチ出力が有効でワーカースレッドから呼ばれた場合は output_batch_ に溜める
+  void emit_frames(std::vector<std::unique_ptr<VideoFrame>> frames);
+  // output_batch_ のフレームを出力する
+  // force が false の場合は上限に達しているときだけ出力する
+  void deliver_output_batch(bool force);
+  // 呼び出し元のスレッドで fn を実行し、その間に出力されたフレームを返す
+  std::vector<std::unique_ptr<VideoFrame>> run_sync(
+      const std::function<void()>& fn);
 
   // ユーティリティーメソッド
   static VideoCodec string_to_codec(const std::string& codec);
@@ -205,4 +360,46 @@ class VideoDecoder {
 
   // Intel VPL を使用するかどうかを判定
   bool uses_intel_vpl() const;
+
+  // dav1d / libvpx / OpenH264 のソフトウェアデコーダーを使用するかどうかを判定
+  bool uses_software_decoder() const;
+
+  // output_width / output_height / output_format による変換が必要か
+  bool converts_output() const;
+  // デコーダーの I420 ピクチャを出力サイズ・フォーマットに変換した VideoFrame を作る
+  // デコードしたサイズの VideoFrame は作らず、ピクチャから直接変換する
+  // matrix と full_range は RGB に変換する際の係数の選択に使う
+  std::unique_ptr<VideoFrame> make_output_frame(
+      const uint8_t* y,
+      int y_stride,
+      const uint8_t* u,
+      int u_stride,
+      const uint8_t* v,
+      int v_stride,
+      int width,
+      int height,
+      int64_t timestamp,
+      VideoMatrixCoefficients matrix = VideoMatrixCoefficients::BT470BG,
+      bool full_range = false);
+  // 出力サイズへの変換後に色変換する場合の作業用バッファ
+  std::vector<uint8_t> output_scale_buffer_;
+
+#if defined(__linux__)
+  // OpenH264 (ソフトウェア H.264 デコーダー) 関連のメンバー
+  // ISVCDecoder は decoder_context_ に保持する
+  // description (avcC) の SPS/PPS を Annex B に変換したもの
+  std::vector<uint8_t> openh264_parameter_sets_;
+  int openh264_length_size_ = 0;  // 長さプレフィックスのバイト数 (0 は Annex B)
+  std::vector<uint8_t> openh264_bitstream_;  // Annex B に変換したチャンク
+  // 出力ピクチャと対応付けるシーケンス番号ごとの timestamp と duration
+  std::map<uint64_t, std::pair<int64_t, uint64_t>> openh264_inputs_;
+
+  // OpenH264 関連のメソッド
+  void init_openh264_decoder();
+  bool decode_openh264(const EncodedVideoChunk& chunk);
+  void output_openh264_picture(unsigned char* const* planes,
+                               const void* buffer_info);
+  void flush_openh264();
+  void cleanup_openh264_decoder();
+#endif
 };
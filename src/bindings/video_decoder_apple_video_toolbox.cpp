@@ -78,8 +78,8 @@ static void vt_decode_callback(void* decompressionOutputRefCon,
   size_t uv_stride = CVPixelBufferGetBytesPerRowOfPlane(pb, 1);
 
   // VideoFrame を作成（GIL不要）
-  auto frame = std::make_unique<VideoFrame>(width, height,
-                                            VideoPixelFormat::NV12, timestamp);
+  auto frame = std::make_unique<VideoFrame>(
+      width, height, VideoPixelFormat::NV12, timestamp, self->frame_pool());
 
   // Y プレーンをコピー
   const uint8_t* dst_y = frame->plane_ptr(0);
@@ -1,17 +1,63 @@
 #include <dav1d/dav1d.h>
 #include <errno.h>
 #include <cstring>
+#include <memory>
+#include <vector>
+#include "thread_count.h"
 #include "video_decoder.h"
 
 void VideoDecoder::init_dav1d_decoder() {
   Dav1dSettings s;
   dav1d_default_settings(&s);
-  // スレッド数を1に設定してdav1d内部のマルチスレッドを無効化
-  // （既にワーカースレッドがあるため）
-  s.n_threads = 1;
-  s.max_frame_delay = 1;
+
+  // optimize_for_latency が指定された場合は 1 スレッド・フレーム遅延 1 で
+  // 入力したチャンクのフレームがすぐに出力されるようにする
+  bool optimize_for_latency = config_.optimize_for_latency.value_or(false);
+  if (config_.decode_threads.value_or(0) > 0) {
+    s.n_threads = static_cast<int>(*config_.decode_threads);
+  } else if (optimize_for_latency) {
+    s.n_threads = 1;
+  } else {
+    // 解像度が不明な場合は 1080p とみなす
+    unsigned int number_of_cores = std::thread::hardware_concurrency();
+    s.n_threads = calculate_number_of_threads(
+        static_cast<int>(config_.coded_width.value_or(1920)),
+        static_cast<int>(config_.coded_height.value_or(1080)),
+        static_cast<int>(number_of_cores));
+  }
+  // フレーム遅延が 1 の場合はタイル・行単位の並列化のみ行うため出力は遅延しない
+  // 1 より大きい場合はフレーム並列化を行い、その分だけ出力が遅延する
+  s.max_frame_delay =
+      optimize_for_latency
+          ? 1
+          : static_cast<unsigned int>(config_.max_frame_delay.value_or(1));
   s.operating_point = 0;  // すべてのレイヤーをデコード
-  s.all_layers = 1;       // すべてのレイヤーを出力
+  // 空間レイヤーを持つテンポラルユニットでは最上位の空間レイヤーのみを出力し、
+  // 1 チャンクにつき 1 フレームを出力する
+  s.all_layers = 0;
+  // デコードするフレームの種類を絞り込むと、それ以外のフレームはデコードも出力もしない
+  switch (config_.decode_frame_type) {
+    case DecodeFrameType::ALL:
+      s.decode_frame_type = DAV1D_DECODEFRAMETYPE_ALL;
+      break;
+    case DecodeFrameType::REFERENCE:
+      s.decode_frame_type = DAV1D_DECODEFRAMETYPE_REFERENCE;
+      break;
+    case DecodeFrameType::INTRA:
+      s.decode_frame_type = DAV1D_DECODEFRAMETYPE_INTRA;
+      break;
+    case DecodeFrameType::KEY:
+      s.decode_frame_type = DAV1D_DECODEFRAMETYPE_KEY;
+      break;
+  }
+  // PREVIEW の場合はデブロッキング・CDEF・ループリストレーションと
+  // フィルムグレインの合成を省略する
+  // 参照フレームもフィルターなしで再構成されるため、誤差は次のキーフレームまで蓄積する
+  if (config_.decode_quality == DecodeQuality::PREVIEW) {
+    s.inloop_filters = DAV1D_INLOOPFILTER_NONE;
+    s.apply_grain = 0;
+  }
+  dav1d_next_output_sequence_ = 0;
 
   Dav1dContext* ctx = nullptr;
   if (dav1d_open(&ctx, &s) < 0) {
@@ -23,7 +69,7 @@ void VideoDecoder::init_dav1d_decoder() {
 void VideoDecoder::cleanup_dav1d_decoder() {
   // ワーカースレッドが完全に停止していることを確認
   // (close() から呼ばれる前に stop_worker() が呼ばれているはず)
-  if (worker_thread_.joinable()) {
+  if (is_worker_running()) {
     // ワーカースレッドがまだ動いている場合は、エラー
     return;
   }
@@ -55,96 +101,165 @@ bool VideoDecoder::decode_dav1d(const EncodedVideoChunk& chunk) {
     return false;
   }
 
-  auto pkt = chunk.data_vector();
+  // チャンクのペイロードをコピーせずに dav1d に渡す
+  // dav1d がデータを手放すまでペイロードの参照を cookie で保持する
   Dav1dData data = {};
-  uint8_t* buf = (uint8_t*)malloc(pkt.size());
-  if (!buf)
-    return false;
-  memcpy(buf, pkt.data(), pkt.size());
+  auto* holder = new std::shared_ptr<const uint8_t>(chunk.buffer().shared());
   if (dav1d_data_wrap(
-          &data, buf, pkt.size(),
-          [](const uint8_t* p, void* cookie) { free((void*)p); },
-          nullptr) < 0) {
-    free(buf);
+          &data, chunk.data(), chunk.byte_length(),
+          [](const uint8_t*, void* cookie) {
+            delete static_cast<std::shared_ptr<const uint8_t>*>(cookie);
+          },
+          holder) < 0) {
+    delete holder;
     return false;
   }
 
+  // フレーム遅延があっても入力チャンクと対応付けられるように、
+  // dav1d がピクチャに引き継ぐ Dav1dDataProps に値を設定する
+  // offset はストリーム位置として dav1d からは参照されないため、
+  // シーケンス番号の受け渡しに使う
+  data.m.timestamp = chunk.timestamp();
+  data.m.duration = static_cast<int64_t>(chunk.duration());
+  data.m.offset = static_cast<int64_t>(current_sequence_);
+
   // バインディング層で既に GIL を解放しているため、ここでは解放しない
   // nb::gil_scoped_release gil_release;
 
-  int r = dav1d_send_data(ctx, &data);
-  if (r < 0 && r != -EAGAIN) {
-    // エラーが発生した場合、残っているデータをクリーンアップ
-    dav1d_data_unref(&data);
-    return false;
-  }
-  Dav1dPicture pic = {};
-  bool got = false;
+  // dav1d_send_data が EAGAIN を返した場合は、ピクチャを取り出してから
+  // 残りのデータを再度送る
+  // 新しいデータを送らずに dav1d_get_picture を繰り返すとフレームスレッドの
+  // ドレインが走りフレーム並列化が効かなくなるため、送信ごとに 1 回だけ取り出す
+  do {
+    int r = dav1d_send_data(ctx, &data);
+    if (r < 0 && r != -EAGAIN) {
+      // エラーが発生した場合、残っているデータをクリーンアップ
+      dav1d_data_unref(&data);
+      return false;
+    }
+    if (!output_dav1d_pictures(false)) {
+      if (data.sz > 0) {
+        dav1d_data_unref(&data);
+      }
+      return false;
+    }
+  } while (data.sz > 0);
+
+  // フレーム遅延によりまだピクチャが出力されていなくてもエラーではない
+  return true;
+}
+
+bool VideoDecoder::output_dav1d_pictures(bool drain) {
+  Dav1dContext* ctx = static_cast<Dav1dContext*>(decoder_context_);
   while (true) {
-    r = dav1d_get_picture(ctx, &pic);
+    Dav1dPicture pic = {};
+    int r = dav1d_get_picture(ctx, &pic);
     if (r == -EAGAIN) {
       // もうフレームがない
-      break;
+      return true;
     }
     if (r < 0) {
       // エラーが発生した場合も picture を解放する必要がある
       if (pic.data[0]) {
         dav1d_picture_unref(&pic);
       }
-      break;
+      return false;
     }
-    got = true;
 
     // 有効な画像データがあるか確認
-    if (pic.p.w > 0 && pic.p.h > 0 && pic.data[0] && pic.data[1] &&
-        pic.data[2] && pic.p.bpc == 8 &&
-        pic.p.layout == DAV1D_PIXEL_LAYOUT_I420) {
-      // サイズが極端に大きくないかチェック
-      if (pic.p.w > 8192 || pic.p.h > 8192) {
-        // 異常なサイズの場合はスキップ
-        continue;
+    // サイズが極端に大きい場合はスキップ
+    // dav1d はチャンクの順にピクチャを出力するため、decode_frame_type で
+    // 出力されなかったそれより前のチャンクは今後も出力されない
+    // リングが一周するまで後続のフレームが待たされないように飛ばす
+    uint64_t sequence = static_cast<uint64_t>(pic.m.offset);
+    if (config_.decode_frame_type != DecodeFrameType::ALL &&
+        sequence > dav1d_next_output_sequence_) {
+      std::vector<std::unique_ptr<VideoFrame>> frames;
+      {
+        std::lock_guard<std::mutex> lock(output_mutex_);
+        for (uint64_t s = std::max(dav1d_next_output_sequence_,
+                                   output_ring_.next());
+             s < sequence; s++) {
+          output_ring_.discard(s, frames);
+        }
       }
+      emit_frames(std::move(frames));
+    }
+    dav1d_next_output_sequence_ = sequence + 1;
 
-      // VideoFrame を作成
-      auto frame = std::make_unique<VideoFrame>(
-          pic.p.w, pic.p.h, VideoPixelFormat::I420, chunk.timestamp());
-
-      // mutable_plane_ptr を使って直接データをコピー（GIL 不要）
-      const uint32_t frame_width = frame->width();
-      const uint32_t frame_height = frame->height();
-      const uint32_t chroma_width = frame_width / 2;
-      const uint32_t chroma_height = frame_height / 2;
-
-      // Y プレーン
-      uint8_t* y_dst = frame->mutable_plane_ptr(0);
-      for (uint32_t row = 0; row < frame_height; ++row) {
-        memcpy(y_dst + row * frame_width,
-               (uint8_t*)pic.data[0] + row * pic.stride[0], frame_width);
+    if (pic.p.w > 0 && pic.p.h > 0 && pic.p.w <= 8192 && pic.p.h <= 8192 &&
+        pic.data[0] && pic.data[1] && pic.data[2] && pic.p.bpc == 8 &&
+        pic.p.layout == DAV1D_PIXEL_LAYOUT_I420) {
+      // 出力サイズやフォーマットが指定されている場合はピクチャから直接変換する
+      if (converts_output()) {
+        VideoMatrixCoefficients matrix = VideoMatrixCoefficients::BT470BG;
+        bool full_range = false;
+        if (pic.seq_hdr) {
+          if (pic.seq_hdr->mtrx == DAV1D_MC_BT709) {
+            matrix = VideoMatrixCoefficients::BT709;
+          } else if (pic.seq_hdr->mtrx == DAV1D_MC_BT2020_NCL) {
+            matrix = VideoMatrixCoefficients::BT2020_NCL;
+          }
+          full_range = pic.seq_hdr->color_range != 0;
+        }
+        auto frame = make_output_frame(
+            static_cast<const uint8_t*>(pic.data[0]),
+            static_cast<int>(pic.stride[0]),
+            static_cast<const uint8_t*>(pic.data[1]),
+            static_cast<int>(pic.stride[1]),
+            static_cast<const uint8_t*>(pic.data[2]),
+            static_cast<int>(pic.stride[1]), pic.p.w, pic.p.h,
+            pic.m.timestamp, matrix, full_range);
+        frame->set_duration(static_cast<uint64_t>(pic.m.duration));
+        handle_output(sequence, std::move(frame));
+        dav1d_picture_unref(&pic);
+        if (!drain) {
+          return true;
+        }
+        continue;
       }
 
-      // U プレーン
-      uint8_t* u_dst = frame->mutable_plane_ptr(1);
-      for (uint32_t row = 0; row < chroma_height; ++row) {
-        memcpy(u_dst + row * chroma_width,
-               (uint8_t*)pic.data[1] + row * pic.stride[1], chroma_width);
-      }
+      // Dav1dPicture の参照を VideoFrame に持たせて行コピーを省略する
+      // VideoFrame が close されるか破棄されると参照が解放される
+      Dav1dPicture* ref = new Dav1dPicture();
+      dav1d_picture_ref(ref, &pic);
+      std::shared_ptr<void> holder(ref, [](void* p) {
+        Dav1dPicture* picture = static_cast<Dav1dPicture*>(p);
+        dav1d_picture_unref(picture);
+        delete picture;
+      });
 
-      // V プレーン（I420 では U と V は同じストライド stride[1] を使用）
-      uint8_t* v_dst = frame->mutable_plane_ptr(2);
-      for (uint32_t row = 0; row < chroma_height; ++row) {
-        memcpy(v_dst + row * chroma_width,
-               (uint8_t*)pic.data[2] + row * pic.stride[1],  // stride[1] を使用
-               chroma_width);
-      }
+      // I420 では U と V は同じストライド stride[1] を使用
+      auto frame = std::make_unique<VideoFrame>(
+          pic.p.w, pic.p.h, VideoPixelFormat::I420, pic.m.timestamp,
+          std::move(holder),
+          std::vector<const uint8_t*>{static_cast<const uint8_t*>(pic.data[0]),
+                                      static_cast<const uint8_t*>(pic.data[1]),
+                                      static_cast<const uint8_t*>(pic.data[2])},
+          std::vector<uint32_t>{static_cast<uint32_t>(pic.stride[0]),
+                                static_cast<uint32_t>(pic.stride[1]),
+                                static_cast<uint32_t>(pic.stride[1])});
 
-      frame->set_duration(chunk.duration());
+      frame->set_duration(static_cast<uint64_t>(pic.m.duration));
 
       // 順序制御された出力処理（GIL を再取得せずに実行）
-      handle_output(current_sequence_, std::move(frame));
+      // ピクチャの元になったチャンクのシーケンス番号を使う
+      handle_output(sequence, std::move(frame));
     }
 
     // 必ず picture を解放
     dav1d_picture_unref(&pic);
+    if (!drain) {
+      return true;
+    }
   }
-  return got;
-}
\ No newline at end of file
+}
+
+void VideoDecoder::flush_dav1d() {
+  // フレーム遅延により dav1d 内部に残っているピクチャを全て出力する
+  // 新しいデータを送らずに dav1d_get_picture を呼ぶとドレインされる
+  if (!decoder_context_) {
+    return;
+  }
+  output_dav1d_pictures(true);
+}
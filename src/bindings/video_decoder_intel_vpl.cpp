@@ -249,7 +249,8 @@ bool VideoDecoder::decode_intel_vpl(const EncodedVideoChunk& chunk) {
       uint32_t pitch = surface_out->Data.Pitch;
 
       auto frame = std::make_unique<VideoFrame>(
-          width, height, VideoPixelFormat::NV12, surface_out->Data.TimeStamp);
+          width, height, VideoPixelFormat::NV12, surface_out->Data.TimeStamp,
+          frame_pool_);
 
       // Y プレーンをコピー
       uint8_t* dst_y = frame->mutable_plane_ptr(0);
@@ -319,7 +320,8 @@ void VideoDecoder::flush_intel_vpl() {
     uint32_t pitch = surface_out->Data.Pitch;
 
     auto frame = std::make_unique<VideoFrame>(
-        width, height, VideoPixelFormat::NV12, surface_out->Data.TimeStamp);
+        width, height, VideoPixelFormat::NV12, surface_out->Data.TimeStamp,
+        frame_pool_);
 
     // Y プレーンをコピー
     uint8_t* dst_y = frame->mutable_plane_ptr(0);
@@ -336,18 +338,11 @@ void VideoDecoder::flush_intel_vpl() {
       std::memcpy(dst_uv + row * width, src_uv + row * pitch, width);
     }
 
-    // flush では直接コールバックを呼ぶ
-    nb::object output_cb;
-    bool has_output;
-    {
-      nb::ft_lock_guard guard(callback_mutex_);
-      output_cb = output_callback_;
-      has_output = has_output_callback_;
-    }
-    if (has_output && !output_cb.is_none()) {
-      nb::gil_scoped_acquire gil;
-      output_cb(nb::cast(frame.release(), nb::rv_policy::take_ownership));
-    }
+    // flush では並べ替えを待たずに出力する
+    // 同期モードや出力キューモードでも同じ経路で渡すため emit_frames() を使う
+    std::vector<std::unique_ptr<VideoFrame>> frames;
+    frames.push_back(std::move(frame));
+    emit_frames(std::move(frames));
   }
 
   pool->release(surface);
@@ -189,8 +189,9 @@ int VideoDecoder::handle_display_picture(void* user_data, void* disp_info_ptr) {
   }
 
   // VideoFrame を作成
-  auto video_frame = std::make_unique<VideoFrame>(
-      width, height, VideoPixelFormat::NV12, disp_info->timestamp);
+  auto video_frame =
+      std::make_unique<VideoFrame>(width, height, VideoPixelFormat::NV12,
+                                   disp_info->timestamp, ctx->decoder->frame_pool());
 
   // mutable_plane_ptr を使って直接データをコピー
   // Y プレーン
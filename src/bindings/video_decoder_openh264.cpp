@@ -0,0 +1,267 @@
+// OpenH264 (ソフトウェア H.264) デコーダーバックエンドの実装
+// このファイルは video_decoder.cpp から #include される
+
+#include "video_decoder.h"
+
+#if defined(__linux__)
+
+#include <libyuv.h>
+
+#include <stdexcept>
+#include <thread>
+
+#include "../dyn/openh264.h"
+#include "thread_count.h"
+#include "video_frame.h"
+
+// 出力ピクチャと対応付けるために保持する入力チャンクの上限
+// SPS/PPS のみのチャンクなど、ピクチャを出力しない入力の情報が溜まり続けないようにする
+static constexpr size_t kOpenH264MaxPendingInputs = 64;
+
+static const uint8_t kOpenH264StartCode[] = {0x00, 0x00, 0x00, 0x01};
+
+// avcC (AVCDecoderConfigurationRecord) から SPS/PPS を取り出して Annex B に変換する
+static void parse_openh264_avcc(const std::vector<uint8_t>& avcc,
+                                std::vector<uint8_t>& parameter_sets,
+                                int& length_size) {
+  if (avcc.size() < 7 || avcc[0] != 1) {
+    throw std::runtime_error("Invalid avcC description");
+  }
+  length_size = (avcc[4] & 0x03) + 1;
+  parameter_sets.clear();
+
+  size_t offset = 5;
+  // SPS の数は下位 5 ビット、PPS の数は 1 バイト
+  for (int i = 0; i < 2; i++) {
+    if (offset >= avcc.size()) {
+      throw std::runtime_error("Invalid avcC description");
+    }
+    int count = i == 0 ? (avcc[offset] & 0x1f) : avcc[offset];
+    offset++;
+    for (int j = 0; j < count; j++) {
+      if (offset + 2 > avcc.size()) {
+        throw std::runtime_error("Invalid avcC description");
+      }
+      size_t size = (static_cast<size_t>(avcc[offset]) << 8) | avcc[offset + 1];
+      offset += 2;
+      if (offset + size > avcc.size()) {
+        throw std::runtime_error("Invalid avcC description");
+      }
+      parameter_sets.insert(parameter_sets.end(), std::begin(kOpenH264StartCode),
+                            std::end(kOpenH264StartCode));
+      parameter_sets.insert(parameter_sets.end(), avcc.begin() + offset,
+                            avcc.begin() + offset + size);
+      offset += size;
+    }
+  }
+}
+
+// 長さプレフィックス形式の NAL ユニットを Annex B に変換して out に追加する
+static bool append_openh264_annexb(const uint8_t* data,
+                                   size_t size,
+                                   int length_size,
+                                   std::vector<uint8_t>& out) {
+  size_t offset = 0;
+  while (offset + length_size <= size) {
+    size_t nal_size = 0;
+    for (int i = 0; i < length_size; i++) {
+      nal_size = (nal_size << 8) | data[offset + i];
+    }
+    offset += length_size;
+    if (nal_size > size - offset) {
+      return false;
+    }
+    out.insert(out.end(), std::begin(kOpenH264StartCode),
+               std::end(kOpenH264StartCode));
+    out.insert(out.end(), data + offset, data + offset + nal_size);
+    offset += nal_size;
+  }
+  return offset == size;
+}
+
+void VideoDecoder::init_openh264_decoder() {
+  if (decoder_context_) {
+    return;
+  }
+
+  // OpenH264 ライブラリがロード可能かチェック
+  if (!dyn::DynModule::IsLoadable(dyn::openh264_so())) {
+    throw std::runtime_error(
+        "H.264 decoder is not available: OpenH264 library could not be "
+        "loaded (install libopenh264.so.8 or set OPENH264_PATH)");
+  }
+
+  // description (avcC) が指定された場合、チャンクは長さプレフィックス形式になる
+  openh264_parameter_sets_.clear();
+  openh264_length_size_ = 0;
+  if (config_.description.has_value() && !config_.description->empty()) {
+    parse_openh264_avcc(*config_.description, openh264_parameter_sets_,
+                        openh264_length_size_);
+  }
+
+  ISVCDecoder* decoder = nullptr;
+  if (dyn::WelsCreateDecoder(&decoder) != 0 || !decoder) {
+    throw std::runtime_error("Failed to create OpenH264 decoder");
+  }
+
+  // スレッド数は Initialize() より前に設定する必要がある
+  // 複数スレッドの場合はスライスとフレームを並列にデコードし、その分だけ出力が遅延する
+  int threads;
+  if (config_.decode_threads.value_or(0) > 0) {
+    threads = static_cast<int>(*config_.decode_threads);
+  } else if (config_.optimize_for_latency.value_or(false)) {
+    threads = 1;
+  } else {
+    // 解像度が不明な場合は 1080p とみなす
+    unsigned int number_of_cores = std::thread::hardware_concurrency();
+    threads = calculate_number_of_threads(
+        static_cast<int>(config_.coded_width.value_or(1920)),
+        static_cast<int>(config_.coded_height.value_or(1080)),
+        static_cast<int>(number_of_cores));
+  }
+  // OpenH264 はスレッド数 0 をシングルスレッドとして扱う
+  int thread_option = threads > 1 ? threads : 0;
+  decoder->SetOption(DECODER_OPTION_NUM_OF_THREADS, &thread_option);
+
+  SDecodingParam param = {};
+  param.sVideoProperty.size = sizeof(param.sVideoProperty);
+  param.sVideoProperty.eVideoBsType = VIDEO_BITSTREAM_AVC;
+  // 参照フレームが欠けたピクチャはエラー隠蔽せずにエラーとして扱う
+  param.eEcActiveIdc = ERROR_CON_DISABLE;
+  if (decoder->Initialize(&param) != 0) {
+    dyn::WelsDestroyDecoder(decoder);
+    throw std::runtime_error("Failed to initialize OpenH264 decoder");
+  }
+
+  decoder_context_ = decoder;
+}
+
+void VideoDecoder::cleanup_openh264_decoder() {
+  if (!decoder_context_) {
+    return;
+  }
+  ISVCDecoder* decoder = static_cast<ISVCDecoder*>(decoder_context_);
+  decoder->Uninitialize();
+  dyn::WelsDestroyDecoder(decoder);
+  decoder_context_ = nullptr;
+  openh264_inputs_.clear();
+}
+
+bool VideoDecoder::decode_openh264(const EncodedVideoChunk& chunk) {
+  ISVCDecoder* decoder = static_cast<ISVCDecoder*>(decoder_context_);
+  if (!decoder) {
+    return false;
+  }
+
+  // Annex B のチャンクはコピーせずにそのまま渡す
+  const uint8_t* data = chunk.data();
+  size_t size = chunk.byte_length();
+  if (openh264_length_size_ > 0) {
+    openh264_bitstream_.clear();
+    // description の SPS/PPS はキーフレームの前に付ける
+    if (chunk.type() == EncodedVideoChunkType::KEY) {
+      openh264_bitstream_.insert(openh264_bitstream_.end(),
+                                 openh264_parameter_sets_.begin(),
+                                 openh264_parameter_sets_.end());
+    }
+    if (!append_openh264_annexb(data, size, openh264_length_size_,
+                                openh264_bitstream_)) {
+      return false;
+    }
+    data = openh264_bitstream_.data();
+    size = openh264_bitstream_.size();
+  }
+
+  // スレッドやフレームの並べ替えで出力が遅延しても入力チャンクと対応付けられるように、
+  // ピクチャに引き継がれる uiInBsTimeStamp にシーケンス番号を設定する
+  openh264_inputs_[current_sequence_] = {chunk.timestamp(), chunk.duration()};
+  if (openh264_inputs_.size() > kOpenH264MaxPendingInputs) {
+    openh264_inputs_.erase(openh264_inputs_.begin());
+  }
+
+  unsigned char* planes[3] = {};
+  SBufferInfo info = {};
+  info.uiInBsTimeStamp = current_sequence_;
+  DECODING_STATE state = decoder->DecodeFrameNoDelay(
+      data, static_cast<int>(size), planes, &info);
+  if (state != dsErrorFree) {
+    return false;
+  }
+  if (info.iBufferStatus == 1) {
+    output_openh264_picture(planes, &info);
+  }
+  return true;
+}
+
+void VideoDecoder::output_openh264_picture(unsigned char* const* planes,
+                                           const void* buffer_info) {
+  const SBufferInfo* info = static_cast<const SBufferInfo*>(buffer_info);
+  uint64_t sequence = info->uiOutYuvTimeStamp;
+  auto it = openh264_inputs_.find(sequence);
+  if (it == openh264_inputs_.end()) {
+    return;  // 対応する入力チャンクがない
+  }
+  int64_t timestamp = it->second.first;
+  uint64_t duration = it->second.second;
+  openh264_inputs_.erase(it);
+
+  const SSysMEMBuffer& buffer = info->UsrData.sSystemBuffer;
+  if (buffer.iWidth <= 0 || buffer.iHeight <= 0 || !planes[0] || !planes[1] ||
+      !planes[2]) {
+    return;
+  }
+
+  // 出力サイズやフォーマットが指定されている場合は内部バッファから直接変換する
+  // OpenH264 は VUI の色情報を返さないため BT.601 のリミテッドレンジとして扱う
+  if (converts_output()) {
+    auto frame = make_output_frame(
+        planes[0], buffer.iStride[0], planes[1], buffer.iStride[1], planes[2],
+        buffer.iStride[1], buffer.iWidth, buffer.iHeight, timestamp);
+    frame->set_duration(duration);
+    handle_output(sequence, std::move(frame));
+    return;
+  }
+
+  // OpenH264 の内部バッファは次のデコードで上書きされるため、プールのバッファへコピーする
+  auto frame = std::make_unique<VideoFrame>(
+      static_cast<uint32_t>(buffer.iWidth),
+      static_cast<uint32_t>(buffer.iHeight), VideoPixelFormat::I420, timestamp,
+      frame_pool_);
+  libyuv::I420Copy(planes[0], buffer.iStride[0], planes[1], buffer.iStride[1],
+                   planes[2], buffer.iStride[1], frame->mutable_plane_ptr(0),
+                   static_cast<int>(frame->plane_stride(0)),
+                   frame->mutable_plane_ptr(1),
+                   static_cast<int>(frame->plane_stride(1)),
+                   frame->mutable_plane_ptr(2),
+                   static_cast<int>(frame->plane_stride(2)), buffer.iWidth,
+                   buffer.iHeight);
+  frame->set_duration(duration);
+
+  handle_output(sequence, std::move(frame));
+}
+
+void VideoDecoder::flush_openh264() {
+  ISVCDecoder* decoder = static_cast<ISVCDecoder*>(decoder_context_);
+  if (!decoder) {
+    return;
+  }
+
+  // ストリームの終端を通知して、スレッドや並べ替えで遅延しているピクチャを取り出す
+  int end_of_stream = 1;
+  decoder->SetOption(DECODER_OPTION_END_OF_STREAM, &end_of_stream);
+  while (true) {
+    unsigned char* planes[3] = {};
+    SBufferInfo info = {};
+    decoder->DecodeFrame2(nullptr, 0, planes, &info);
+    if (info.iBufferStatus != 1) {
+      break;
+    }
+    output_openh264_picture(planes, &info);
+  }
+  // flush() の後もデコードを続けられるように戻す
+  end_of_stream = 0;
+  decoder->SetOption(DECODER_OPTION_END_OF_STREAM, &end_of_stream);
+  openh264_inputs_.clear();
+}
+
+#endif  // defined(__linux__)
@@ -1,7 +1,49 @@
 // VP8/VP9 デコーダー実装 (macOS のみ)
 // video_decoder.cpp から #include されるため、インクルードガードは不要
 
+#include <cstdint>
 #include <cstring>
+#include <memory>
+#include <new>
+#include <vector>
+
+#include "thread_count.h"
+
+// 出力フレームと対応付けるために保持する入力チャンクの上限
+// 表示しないフレームなど、フレームを出力しない入力の情報が溜まり続けないようにする
+static constexpr size_t kVpxMaxPendingInputs = 64;
+
+// VP9 の外部フレームバッファ
+// デコーダーとデコード済み VideoFrame の双方が shared_ptr で参照を持つため、
+// デコーダーがバッファを手放しても VideoFrame が生きている間は解放されない
+// バッファはデコーダーのフレームプール (user_priv) から確保し、参照がなくなるとプールに戻す
+// libvpx の要件によりバッファはゼロ初期化する必要があるが、プールは新しく確保した
+// バッファをゼロで埋めるため、再利用時は vpxdec と同じく以前の内容のまま渡す
+static int vpx_get_frame_buffer(void* user_priv,
+                                size_t min_size,
+                                vpx_codec_frame_buffer_t* fb) {
+  std::shared_ptr<FramePool> pool =
+      *static_cast<std::shared_ptr<FramePool>*>(user_priv);
+  try {
+    uint8_t* data = static_cast<uint8_t*>(pool->acquire(min_size));
+    // shared_ptr の構築に失敗した場合もデリーターでプールに戻る
+    auto* buffer = new std::shared_ptr<uint8_t[]>(
+        data, [pool, min_size](uint8_t* ptr) { pool->release(ptr, min_size); });
+    fb->data = buffer->get();
+    fb->size = min_size;
+    fb->priv = buffer;
+  } catch (...) {
+    return -1;
+  }
+  return 0;
+}
+
+static int vpx_release_frame_buffer(void* user_priv,
+                                    vpx_codec_frame_buffer_t* fb) {
+  delete static_cast<std::shared_ptr<uint8_t[]>*>(fb->priv);
+  fb->priv = nullptr;
+  return 0;
+}
 
 void VideoDecoder::init_vpx_decoder() {
   std::lock_guard<std::mutex> lock(vpx_mutex_);
@@ -22,7 +64,20 @@ void VideoDecoder::init_vpx_decoder() {
 
   vpx_codec_ctx_t* ctx = new vpx_codec_ctx_t();
   vpx_codec_dec_cfg_t cfg = {};
-  cfg.threads = 1;  // シングルスレッド（ワーカースレッドで処理するため）
+  // optimize_for_latency が指定された場合はシングルスレッドで処理する
+  // libvpx はフレーム並列化を行わないため、スレッド数を増やしても出力は遅延しない
+  if (config_.decode_threads.value_or(0) > 0) {
+    cfg.threads = *config_.decode_threads;
+  } else if (config_.optimize_for_latency.value_or(false)) {
+    cfg.threads = 1;
+  } else {
+    // 解像度が不明な場合は 1080p とみなす
+    unsigned int number_of_cores = std::thread::hardware_concurrency();
+    cfg.threads = calculate_number_of_threads(
+        static_cast<int>(config_.coded_width.value_or(1920)),
+        static_cast<int>(config_.coded_height.value_or(1080)),
+        static_cast<int>(number_of_cores));
+  }
 
   vpx_codec_err_t res = vpx_codec_dec_init(ctx, iface, &cfg, 0);
   if (res != VPX_CODEC_OK) {
@@ -31,6 +86,32 @@ void VideoDecoder::init_vpx_decoder() {
                              std::string(vpx_codec_err_to_string(res)));
   }
 
+  // VP9 はタイル単位に加えて行単位でも並列にデコードする
+  if (codec == VideoCodec::VP9 && cfg.threads > 1) {
+    vpx_codec_control(ctx, VP9D_SET_ROW_MT, 1);
+  }
+
+  // PREVIEW の場合、VP9 はループフィルターを省略する
+  // VP8 はポストプロセスを有効にしていないため、これ以上省略できる処理はない
+  if (codec == VideoCodec::VP9 &&
+      config_.decode_quality == DecodeQuality::PREVIEW) {
+    vpx_codec_control(ctx, VP9_SET_SKIP_LOOP_FILTER, 1);
+  }
+
+  // VP9 は外部フレームバッファに対応しているため、
+  // デコード結果を VideoFrame からゼロコピーで参照できるようにする
+  // VP8 は非対応なので従来通り行コピーする
+  if (codec == VideoCodec::VP9) {
+    res = vpx_codec_set_frame_buffer_functions(
+        ctx, vpx_get_frame_buffer, vpx_release_frame_buffer, &frame_pool_);
+    if (res != VPX_CODEC_OK) {
+      vpx_codec_destroy(ctx);
+      delete ctx;
+      throw std::runtime_error("Failed to set VPX frame buffer functions: " +
+                               std::string(vpx_codec_err_to_string(res)));
+    }
+  }
+
   vpx_decoder_ = ctx;
 }
 
@@ -41,6 +122,7 @@ void VideoDecoder::cleanup_vpx_decoder() {
     vpx_codec_destroy(ctx);
     delete ctx;
     vpx_decoder_ = nullptr;
+    vpx_inputs_.clear();
   }
 }
 
@@ -52,20 +134,46 @@ bool VideoDecoder::decode_vpx(const EncodedVideoChunk& chunk) {
 
   vpx_codec_ctx_t* ctx = static_cast<vpx_codec_ctx_t*>(vpx_decoder_);
 
-  auto pkt = chunk.data_vector();
+  // 出力が遅延しても入力チャンクと対応付けられるように、
+  // 出力画像に引き継がれる user_priv にシーケンス番号を設定する
+  vpx_inputs_[current_sequence_] = {chunk.timestamp(), chunk.duration()};
+  if (vpx_inputs_.size() > kVpxMaxPendingInputs) {
+    vpx_inputs_.erase(vpx_inputs_.begin());
+  }
+  void* user_priv =
+      reinterpret_cast<void*>(static_cast<uintptr_t>(current_sequence_));
 
-  vpx_codec_err_t res = vpx_codec_decode(
-      ctx, pkt.data(), static_cast<unsigned int>(pkt.size()), nullptr, 0);
+  // vpx_codec_decode() は呼び出し中のみデータを参照するため、コピーせずに渡す
+  vpx_codec_err_t res =
+      vpx_codec_decode(ctx, chunk.data(),
+                       static_cast<unsigned int>(chunk.byte_length()),
+                       user_priv, 0);
   if (res != VPX_CODEC_OK) {
+    vpx_inputs_.erase(current_sequence_);
     return false;
   }
 
+  // 表示しないフレーム (VP8 の代替参照フレームなど) はフレームを出力しないが、エラーではない
+  output_vpx_frames();
+  return true;
+}
+
+void VideoDecoder::output_vpx_frames() {
+  vpx_codec_ctx_t* ctx = static_cast<vpx_codec_ctx_t*>(vpx_decoder_);
   vpx_codec_iter_t iter = nullptr;
   vpx_image_t* img;
-  bool got = false;
 
   while ((img = vpx_codec_get_frame(ctx, &iter)) != nullptr) {
-    got = true;
+    // 出力画像の元になったチャンクのシーケンス番号・timestamp・duration を使う
+    uint64_t sequence =
+        static_cast<uint64_t>(reinterpret_cast<uintptr_t>(img->user_priv));
+    auto it = vpx_inputs_.find(sequence);
+    if (it == vpx_inputs_.end()) {
+      continue;  // 対応する入力チャンクがない
+    }
+    int64_t timestamp = it->second.first;
+    uint64_t duration = it->second.second;
+    vpx_inputs_.erase(it);
 
     // I420 フォーマットのみサポート
     if (img->fmt != VPX_IMG_FMT_I420) {
@@ -80,9 +188,45 @@ bool VideoDecoder::decode_vpx(const EncodedVideoChunk& chunk) {
         continue;
       }
 
+      // 出力サイズやフォーマットが指定されている場合はデコーダーのバッファから直接変換する
+      if (converts_output()) {
+        VideoMatrixCoefficients matrix = VideoMatrixCoefficients::BT470BG;
+        if (img->cs == VPX_CS_BT_709) {
+          matrix = VideoMatrixCoefficients::BT709;
+        } else if (img->cs == VPX_CS_BT_2020) {
+          matrix = VideoMatrixCoefficients::BT2020_NCL;
+        }
+        auto frame = make_output_frame(
+            img->planes[0], img->stride[0], img->planes[1], img->stride[1],
+            img->planes[2], img->stride[2], static_cast<int>(img->d_w),
+            static_cast<int>(img->d_h), timestamp, matrix,
+            img->range == VPX_CR_FULL_RANGE);
+        frame->set_duration(duration);
+        handle_output(sequence, std::move(frame));
+        continue;
+      }
+
+      // 外部フレームバッファの場合はバッファの参照を VideoFrame に持たせる
+      if (img->fb_priv) {
+        std::shared_ptr<void> holder =
+            *static_cast<std::shared_ptr<uint8_t[]>*>(img->fb_priv);
+        auto frame = std::make_unique<VideoFrame>(
+            img->d_w, img->d_h, VideoPixelFormat::I420, timestamp,
+            std::move(holder),
+            std::vector<const uint8_t*>{img->planes[0], img->planes[1],
+                                        img->planes[2]},
+            std::vector<uint32_t>{static_cast<uint32_t>(img->stride[0]),
+                                  static_cast<uint32_t>(img->stride[1]),
+                                  static_cast<uint32_t>(img->stride[2])});
+        frame->set_duration(duration);
+        handle_output(sequence, std::move(frame));
+        continue;
+      }
+
       // VideoFrame を作成
       auto frame = std::make_unique<VideoFrame>(
-          img->d_w, img->d_h, VideoPixelFormat::I420, chunk.timestamp());
+          img->d_w, img->d_h, VideoPixelFormat::I420, timestamp,
+          frame_pool_);
 
       const uint32_t frame_width = frame->width();
       const uint32_t frame_height = frame->height();
@@ -110,29 +254,27 @@ bool VideoDecoder::decode_vpx(const EncodedVideoChunk& chunk) {
                img->planes[2] + row * img->stride[2], chroma_width);
       }
 
-      frame->set_duration(chunk.duration());
+      frame->set_duration(duration);
 
       // 順序制御された出力処理
-      handle_output(current_sequence_, std::move(frame));
+      handle_output(sequence, std::move(frame));
     }
   }
-
-  return got;
 }
 
 void VideoDecoder::flush_vpx() {
   // VPX デコーダーのフラッシュ処理
-  // 残っているフレームを全て取り出す
+  // データなしで vpx_codec_decode() を呼び出してストリームの終端を通知し、
+  // 残っているフレームを全て出力する
+  std::lock_guard<std::mutex> lock(vpx_mutex_);
   if (!vpx_decoder_) {
     return;
   }
 
-  std::lock_guard<std::mutex> lock(vpx_mutex_);
   vpx_codec_ctx_t* ctx = static_cast<vpx_codec_ctx_t*>(vpx_decoder_);
-
-  vpx_codec_iter_t iter = nullptr;
-  vpx_image_t* img;
-  while ((img = vpx_codec_get_frame(ctx, &iter)) != nullptr) {
-    // 残っているフレームを消費する
+  if (vpx_codec_decode(ctx, nullptr, 0, nullptr, 0) == VPX_CODEC_OK) {
+    output_vpx_frames();
   }
+  // 出力されなかった入力の情報は破棄する
+  vpx_inputs_.clear();
 }
@@ -1,4 +1,6 @@
 #include "video_encoder.h"
+#include <nanobind/stl/shared_ptr.h>
+#include <algorithm>
 #include <cstring>
 #include <stdexcept>
 #include "encoded_video_chunk.h"
@@ -8,25 +10,116 @@
 #include <CoreVideo/CoreVideo.h>
 #include <VideoToolbox/VideoToolbox.h>
 #endif
+#if defined(__linux__)
+#include "../dyn/openh264.h"
+#endif
 
 using namespace nb::literals;
 
-VideoEncoder::VideoEncoder(nb::object output, nb::object error)
+// scalability_mode に対応しているか
+// 時間・空間レイヤーは libaom (AV1) と libvpx (VP9) のみ、VP8 は時間レイヤーのみ対応
+static bool is_scalability_mode_supported(const VideoEncoderConfig& config,
+                                          const CodecParameters& codec_params) {
+  if (!config.scalability_mode.has_value()) {
+    return true;
+  }
+  auto mode = parse_scalability_mode(*config.scalability_mode);
+  if (!mode.has_value()) {
+    return false;
+  }
+  if (!mode->is_layered()) {
+    return true;
+  }
+  if (std::holds_alternative<AV1CodecParameters>(codec_params)) {
+    // NVENC の AV1 は未対応
+    return !(config.hardware_acceleration_engine.has_value() &&
+             config.hardware_acceleration_engine.value() ==
+                 HardwareAccelerationEngine::NVIDIA_VIDEO_CODEC);
+  }
+  if (std::holds_alternative<VP9CodecParameters>(codec_params)) {
+    return true;
+  }
+  if (std::holds_alternative<VP8CodecParameters>(codec_params)) {
+    return mode->spatial_layers == 1;
+  }
+  return false;
+}
+
+// GOP 並列エンコード (segment_frames) に対応しているか
+// セグメントごとに独立したエンコーダーを作るため、libaom (AV1) / libvpx (VP8 / VP9) のみ対応する
+// 先読みで遅延する前提の LatencyMode::QUALITY で、空間・時間レイヤーがない場合に限る
+static bool is_segment_encoding_supported(const VideoEncoderConfig& config,
+                                          const CodecParameters& codec_params) {
+  if (config.latency_mode != LatencyMode::QUALITY) {
+    return false;
+  }
+  if (config.scalability_mode.has_value()) {
+    auto mode = parse_scalability_mode(*config.scalability_mode);
+    if (!mode.has_value() || mode->is_layered()) {
+      return false;
+    }
+  }
+  if (config.hardware_acceleration_engine.has_value() &&
+      config.hardware_acceleration_engine.value() !=
+          HardwareAccelerationEngine::NONE) {
+    return false;
+  }
+  return std::holds_alternative<AV1CodecParameters>(codec_params) ||
+         std::holds_alternative<VP8CodecParameters>(codec_params) ||
+         std::holds_alternative<VP9CodecParameters>(codec_params);
+}
+
+// av1_encoder で選択した AV1 エンコーダーを使える構成か
+// SVT-AV1 は macOS / Linux のみビルドし、入力を I420 に揃えるため 8 ビットの Main プロファイルに限る
+// 空間・時間レイヤーとハードウェアエンコーダーとの組み合わせには対応しない
+static bool is_av1_encoder_supported(const VideoEncoderConfig& config,
+                                     const CodecParameters& codec_params) {
+  if (config.av1_encoder != AV1EncoderImplementation::SVT_AV1 ||
+      !std::holds_alternative<AV1CodecParameters>(codec_params)) {
+    return true;
+  }
+#if defined(__APPLE__) || defined(__linux__)
+  if (config.hardware_acceleration_engine.has_value() &&
+      config.hardware_acceleration_engine.value() !=
+          HardwareAccelerationEngine::NONE) {
+    return false;
+  }
+  if (config.scalability_mode.has_value()) {
+    auto mode = parse_scalability_mode(*config.scalability_mode);
+    if (!mode.has_value() || mode->is_layered()) {
+      return false;
+    }
+  }
+  const auto& av1_params = std::get<AV1CodecParameters>(codec_params);
+  return av1_params.profile == 0 && av1_params.bit_depth == 8;
+#else
+  return false;
+#endif
+}
+
+VideoEncoder::VideoEncoder(nb::object output,
+                           nb::object error,
+                           std::shared_ptr<WorkerPool> worker_pool,
+                           bool output_queue)
     : output_callback_(output),
       error_callback_(error),
-      state_(CodecState::UNCONFIGURED) {
-  aom_encoder_ = nullptr;
-  aom_iface_ = nullptr;
+      state_(CodecState::UNCONFIGURED),
+      worker_pool_(worker_pool ? std::move(worker_pool)
+                               : WorkerPool::default_pool()) {
   vt_session_ = nullptr;
 
   // コールバックフラグを設定
   has_output_callback_ = !output_callback_.is_none();
   has_error_callback_ = !error_callback_.is_none();
+  if (output_queue) {
+    output_queue_ = std::make_unique<OutputQueue<OutputEntry>>();
+  }
   // コンストラクタではコーデックの初期化は行わない
   // configure() で初期化する
 }
 
 VideoEncoder::~VideoEncoder() {
+  cancel_segments();
   stop_worker();  // ワーカースレッドを停止
   close();
 }
@@ -66,9 +159,59 @@ void VideoEncoder::configure(nb::dict config_dict) {
         nb::cast<HardwareAcceleration>(config_dict["hardware_acceleration"]);
   if (config_dict.contains("alpha"))
     config.alpha = nb::cast<AlphaOption>(config_dict["alpha"]);
+  if (config_dict.contains("scalability_mode") &&
+      !config_dict["scalability_mode"].is_none())
+    config.scalability_mode =
+        nb::cast<std::string>(config_dict["scalability_mode"]);
   if (config_dict.contains("hardware_acceleration_engine"))
     config.hardware_acceleration_engine = nb::cast<HardwareAccelerationEngine>(
         config_dict["hardware_acceleration_engine"]);
+  if (config_dict.contains("reorder_capacity") &&
+      !config_dict["reorder_capacity"].is_none()) {
+    config.reorder_capacity =
+        nb::cast<uint32_t>(config_dict["reorder_capacity"]);
+    if (*config.reorder_capacity < 1 ||
+        *config.reorder_capacity > kMaxReorderCapacity) {
+      throw nb::value_error("reorder_capacity must be between 1 and 4096");
+    }
+  }
+  if (config_dict.contains("max_queue_size") &&
+      !config_dict["max_queue_size"].is_none()) {
+    config.max_queue_size = nb::cast<uint32_t>(config_dict["max_queue_size"]);
+    if (*config.max_queue_size < 1) {
+      throw nb::value_error("max_queue_size must be 1 or greater");
+    }
+  }
+  if (config_dict.contains("max_queue_bytes") &&
+      !config_dict["max_queue_bytes"].is_none()) {
+    config.max_queue_bytes =
+        nb::cast<uint64_t>(config_dict["max_queue_bytes"]);
+    if (*config.max_queue_bytes < 1) {
+      throw nb::value_error("max_queue_bytes must be 1 or greater");
+    }
+  }
+  if (config_dict.contains("queue_full_policy") &&
+      !config_dict["queue_full_policy"].is_none()) {
+    config.queue_full_policy =
+        nb::cast<QueueFullPolicy>(config_dict["queue_full_policy"]);
+  }
+  if (config_dict.contains("segment_frames") &&
+      !config_dict["segment_frames"].is_none()) {
+    config.segment_frames = nb::cast<uint32_t>(config_dict["segment_frames"]);
+    if (*config.segment_frames < 1) {
+      throw nb::value_error("segment_frames must be 1 or greater");
+    }
+  }
+  if (config_dict.contains("segment_threads") &&
+      !config_dict["segment_threads"].is_none()) {
+    config.segment_threads =
+        nb::cast<uint32_t>(config_dict["segment_threads"]);
+  }
+  if (config_dict.contains("av1_encoder") &&
+      !config_dict["av1_encoder"].is_none()) {
+    config.av1_encoder =
+        nb::cast<AV1EncoderImplementation>(config_dict["av1_encoder"]);
+  }
 
   // AVC 固有のオプション
   if (config_dict.contains("avc")) {
@@ -86,27 +229,109 @@ void VideoEncoder::configure(nb::dict config_dict) {
     }
   }
 
-  // VideoEncoderConfig を保存
-  config_ = config;
-
   // デフォルト値の設定
-  if (!config_.bitrate.has_value()) {
-    config_.bitrate = 400000;  // デフォルト値
+  if (!config.bitrate.has_value()) {
+    config.bitrate = 400000;  // デフォルト値
   }
-  if (!config_.framerate.has_value()) {
-    config_.framerate = 30.0;  // デフォルト値
+  if (!config.framerate.has_value()) {
+    config.framerate = 30.0;  // デフォルト値
   }
 
   // コーデック文字列をパースして、パラメータを抽出
+  // 再設定の場合に以前のエンコーダーを破棄する前に検証する
+  CodecParameters codec_params;
   try {
-    codec_params_ = parse_codec_string(config_.codec);
+    codec_params = parse_codec_string(config.codec);
   } catch (const std::exception& e) {
     throw std::invalid_argument(std::string("Invalid codec string: ") +
                                 e.what());
   }
+  if (!is_scalability_mode_supported(config, codec_params)) {
+    throw std::runtime_error("Unsupported scalability_mode: " +
+                             *config.scalability_mode);
+  }
+  if (config.segment_frames.has_value() &&
+      !is_segment_encoding_supported(config, codec_params)) {
+    throw std::runtime_error(
+        "NotSupportedError: segment_frames requires AV1, VP8 or VP9 software "
+        "encoding with latency_mode QUALITY and no scalability layers");
+  }
+  if (!is_av1_encoder_supported(config, codec_params)) {
+    throw std::runtime_error(
+        "NotSupportedError: av1_encoder SVT_AV1 requires 8-bit main profile "
+        "software encoding on macOS or Linux with no scalability layers");
+  }
+
+  // 構成済みのエンコーダーを再設定する
+  if (state_ == CodecState::CONFIGURED) {
+    bool hot = false;
+    {
+      // キューに積まれたフレームは以前の設定でエンコードし終えるまで待機する
+      // ワーカースレッドがコールバックを呼び出せるように GIL を解放する
+      nb::gil_scoped_release gil;
+      if (!uses_videotoolbox()) {
+        std::unique_lock<std::mutex> lock(queue_mutex_);
+        queue_cv_.wait(lock, [this]() { return is_queue_idle(); });
+      }
+      // 溜めているフレームも以前の設定のセグメントとしてエンコードし、出力し終えるまで待機する
+      if (uses_segment_encoding()) {
+        finish_segments();
+      }
+
+      hot = reconfigure_in_place(config);
+      if (!hot) {
+        // 先読みでエンコーダー内部に残っているフレームは以前の設定のまま出力してから作り直す
+        if (context_.aom_encoder) {
+          flush_aom_encoder(context_);
+        }
+#if defined(__APPLE__) || defined(__linux__)
+        if (context_.vpx_encoder) {
+          flush_vpx_encoder(context_);
+        }
+        if (context_.svt_av1_encoder) {
+          flush_svt_av1_encoder(context_);
+        }
+#endif
+        if (uses_videotoolbox()) {
+          flush_videotoolbox_encoder();
+        }
+        cleanup_encoders();
+        context_.next_pts = 0;
+      }
+    }
+
+    if (hot) {
+      // レート制御の状態と参照フレームを保ったまま、キーフレームを挿入せずに続ける
+      config_ = config;
+      last_reconfigure_ = "hot";
+      hot_reconfigure_count_++;
+      resize_output_ring();
+      return;
+    }
+    last_reconfigure_ = "cold";
+    cold_reconfigure_count_++;
+  }
+
+  // VideoEncoderConfig を保存
+  config_ = config;
+  codec_params_ = codec_params;
+
+  // scalability_mode をパースする
+  scalability_ = ScalabilityMode();
+  if (config_.scalability_mode.has_value()) {
+    scalability_ = *parse_scalability_mode(*config_.scalability_mode);
+  }
+  context_.scalability_frame_index = 0;
 
   // コーデックの初期化
-  if (uses_nvidia_video_codec()) {
+  segment_pool_.reset();
+  if (uses_segment_encoding()) {
+    // GOP 並列エンコードではエンコーダーをセグメントごとに作成する
+    segment_pool_ =
+        std::make_shared<WorkerPool>(config_.segment_threads.value_or(0));
+    std::lock_guard<std::mutex> lock(segment_mutex_);
+    segments_cancelled_ = false;
+  } else if (uses_nvidia_video_codec()) {
 #if defined(USE_NVIDIA_CUDA_TOOLKIT)
     init_nvenc_encoder();
 #else
@@ -118,9 +343,19 @@ void VideoEncoder::configure(nb::dict config_dict) {
     init_intel_vpl_encoder();
 #else
     throw std::runtime_error("Intel VPL is not enabled in this build");
+#endif
+  } else if (uses_svt_av1()) {
+#if defined(__APPLE__) || defined(__linux__)
+    init_svt_av1_encoder(context_);
 #endif
   } else if (is_av1_codec()) {
-    init_aom_encoder();
+    init_aom_encoder(context_);
+  } else if (uses_openh264()) {
+#if defined(__linux__)
+    init_openh264_encoder();
+#else
+    throw std::runtime_error("OpenH264 is not enabled in this build");
+#endif
   } else if (is_avc_codec() || is_hevc_codec()) {
 #if defined(__APPLE__)
     // VideoToolbox は uses_videotoolbox() で自動判定される
@@ -136,16 +371,19 @@ void VideoEncoder::configure(nb::dict config_dict) {
 #endif
   } else if (is_vp8_codec() || is_vp9_codec()) {
 #if defined(__APPLE__) || defined(__linux__)
-    init_vpx_encoder();
+    init_vpx_encoder(context_);
 #else
     throw std::runtime_error("VP8/VP9 not supported on this platform");
 #endif
   }
 
+  // 出力の並べ替えに使うリングの容量を設定
+  resize_output_ring();
+
   // ワーカースレッドの開始
   // VideoToolbox は独自の非同期モデルを持つため、ワーカースレッドを開始しない
   if (!uses_videotoolbox()) {
-    if (!worker_thread_.joinable()) {
+    if (!is_worker_running()) {
       start_worker();  // ワーカースレッドを開始
     }
   }
@@ -153,6 +391,83 @@ void VideoEncoder::configure(nb::dict config_dict) {
   state_ = CodecState::CONFIGURED;
 }
 
+bool VideoEncoder::reconfigure_in_place(const VideoEncoderConfig& config) {
+  // レート制御の方式や解像度、レイヤー構造が変わる場合はエンコーダーを作り直す
+  if (config.codec != config_.codec || config.width != config_.width ||
+      config.height != config_.height ||
+      config.bitrate_mode != config_.bitrate_mode ||
+      config.latency_mode != config_.latency_mode ||
+      config.scalability_mode != config_.scalability_mode ||
+      config.hardware_acceleration != config_.hardware_acceleration ||
+      config.hardware_acceleration_engine !=
+          config_.hardware_acceleration_engine ||
+      config.alpha != config_.alpha ||
+      config.segment_frames != config_.segment_frames ||
+      config.segment_threads != config_.segment_threads ||
+      config.av1_encoder != config_.av1_encoder) {
+    return false;
+  }
+  // GOP 並列エンコードでは次のセグメントから新しい設定でエンコーダーを作成する
+  if (uses_segment_encoding()) {
+    return true;
+  }
+  // configure() でデフォルト値を設定しているが、ビットレートがない場合は作り直す
+  if (!config.bitrate.has_value()) {
+    return false;
+  }
+  // フレームレートはエンコード時の pts の間隔に反映されるため、
+  // エンコーダーにはビットレートだけを設定する
+  if (context_.aom_encoder) {
+    return reconfigure_aom_encoder(context_, *config.bitrate);
+  }
+#if defined(__APPLE__) || defined(__linux__)
+  if (context_.vpx_encoder) {
+    return reconfigure_vpx_encoder(context_, *config.bitrate);
+  }
+#endif
+  return false;
+}
+
+void VideoEncoder::cleanup_encoders() {
+  // libaom / libvpx / SVT-AV1 エンコーダーをクリーンアップ
+  cleanup_software_encoders(context_);
+
+  // VideoToolbox セッションが存在する場合はクリーンアップ
+  cleanup_videotoolbox_encoder();
+
+#if defined(USE_NVIDIA_CUDA_TOOLKIT)
+  // NVENC リソースをクリーンアップ
+  cleanup_nvenc_encoder();
+#endif
+
+#if defined(__linux__)
+  // Intel VPL リソースをクリーンアップ
+  cleanup_intel_vpl_encoder();
+
+  // OpenH264 エンコーダーをクリーンアップ
+  cleanup_openh264_encoder();
+#endif
+}
+
+void VideoEncoder::cleanup_software_encoders(EncoderContext& ctx) {
+  cleanup_aom_encoder(ctx);
+#if defined(__APPLE__) || defined(__linux__)
+  cleanup_vpx_encoder(ctx);
+  cleanup_svt_av1_encoder(ctx);
+#endif
+}
+
+void VideoEncoder::resize_output_ring() {
+  std::vector<OutputEntry> evicted_entries;
+  {
+    std::lock_guard<std::mutex> lock(output_mutex_);
+    output_ring_.resize(
+        config_.reorder_capacity.value_or(kDefaultReorderCapacity),
+        evicted_entries);
+  }
+  emit_entries(std::move(evicted_entries));
+}
+
 // コーデック判定ヘルパーメソッドの実装
 bool VideoEncoder::is_av1_codec() const {
   return config_.codec.length() >= 5 && config_.codec.substr(0, 5) == "av01.";
@@ -218,78 +533,115 @@ bool VideoEncoder::uses_intel_vpl() const {
 #endif
 }
 
+bool VideoEncoder::uses_svt_av1() const {
+#if defined(__APPLE__) || defined(__linux__)
+  // av1_encoder に SVT_AV1 を指定したソフトウェアの AV1 は SVT-AV1 でエンコードする
+  return is_av1_codec() &&
+         config_.av1_encoder == AV1EncoderImplementation::SVT_AV1 &&
+         (!config_.hardware_acceleration_engine.has_value() ||
+          config_.hardware_acceleration_engine.value() ==
+              HardwareAccelerationEngine::NONE);
+#else
+  return false;
+#endif
+}
+
+bool VideoEncoder::uses_segment_encoding() const {
+  return config_.segment_frames.has_value();
+}
+
+bool VideoEncoder::uses_openh264() const {
+#if defined(__linux__)
+  // ハードウェアアクセラレーションを使用しない H.264 は OpenH264 でエンコードする
+  return is_avc_codec() && (!config_.hardware_acceleration_engine.has_value() ||
+                            config_.hardware_acceleration_engine.value() ==
+                                HardwareAccelerationEngine::NONE);
+#else
+  return false;
+#endif
+}
+
 // 分割されたファイルをインクルード
 #include "video_encoder_aom.cpp"
 #include "video_encoder_apple_video_toolbox.cpp"
 #include "video_encoder_nvidia.cpp"
 #if defined(__APPLE__) || defined(__linux__)
+#include "video_encoder_svt_av1.cpp"
 #include "video_encoder_vpx.cpp"
 #endif
 #if defined(__linux__)
 #include "video_encoder_intel_vpl.cpp"
+#include "video_encoder_openh264.cpp"
 #endif
 
-void VideoEncoder::encode(const VideoFrame& frame, bool keyframe) {
+void VideoEncoder::get_i420_input(EncoderContext& ctx,
+                                  const VideoFrame& frame,
+                                  unsigned char* planes[3],
+                                  int strides[3]) {
+  if (frame.format() == VideoPixelFormat::I420) {
+    for (int i = 0; i < 3; ++i) {
+      planes[i] = const_cast<unsigned char*>(frame.plane_ptr(i));
+      strides[i] = static_cast<int>(frame.plane_stride(i));
+    }
+    return;
+  }
+
+  // 中間フレームを作らずにエンコーダーの入力バッファへ直接変換する
+  const uint32_t width = frame.width();
+  const uint32_t height = frame.height();
+  const uint32_t chroma_width = (width + 1) / 2;
+  const uint32_t chroma_height = (height + 1) / 2;
+  const size_t y_size = static_cast<size_t>(width) * height;
+  const size_t uv_size = static_cast<size_t>(chroma_width) * chroma_height;
+  if (ctx.i420_input.size() < y_size + uv_size * 2) {
+    ctx.i420_input.resize(y_size + uv_size * 2);
+  }
+  planes[0] = ctx.i420_input.data();
+  planes[1] = planes[0] + y_size;
+  planes[2] = planes[1] + uv_size;
+  strides[0] = static_cast<int>(width);
+  strides[1] = static_cast<int>(chroma_width);
+  strides[2] = static_cast<int>(chroma_width);
+  frame.write_i420(planes[0], strides[0], planes[1], strides[1], planes[2],
+                   strides[2]);
+}
+
+void VideoEncoder::encode(VideoFrame& frame, bool keyframe) {
   EncodeOptions options;
   options.keyframe = keyframe;
   encode(frame, options);
 }
 
-void VideoEncoder::encode(const VideoFrame& frame,
-                          const EncodeOptions& options) {
-  if (state_ != CodecState::CONFIGURED) {
-    throw std::runtime_error("VideoEncoder is not configured");
-  }
-
-  // VideoToolbox は独自の非同期モデルを持つため、ワーカースレッドをバイパス
-  if (uses_videotoolbox()) {
-    // VideoToolbox エンコーダーの初期化（必要な場合）
-    if (!vt_session_) {
-      init_videotoolbox_encoder();
-    }
-
-    // AVC/HEVC quantizer オプションを取得
-    std::optional<uint16_t> quantizer;
-    if (options.avc.has_value() && options.avc->quantizer.has_value()) {
-      uint16_t q = options.avc->quantizer.value();
-      if (q > 51) {
-        throw nb::value_error("AVC quantizer must be in range 0-51");
-      }
-      quantizer = q;
-    }
-    if (options.hevc.has_value() && options.hevc->quantizer.has_value()) {
-      uint16_t q = options.hevc->quantizer.value();
-      if (q > 51) {
-        throw nb::value_error("HEVC quantizer must be in range 0-51");
-      }
-      quantizer = q;
-    }
-
-    // シーケンス番号を設定して直接エンコード
-    current_sequence_ = next_sequence_number_++;
-    encode_frame_videotoolbox(frame, options.keyframe, quantizer);
+void VideoEncoder::encode(VideoFrame& frame, const EncodeOptions& options) {
+  encode_many(std::vector<VideoFrame*>{&frame},
+              std::vector<EncodeOptions>{options});
+}
 
-    // デキューコールバックを呼び出す
-    nb::object dequeue_cb;
-    bool has_dequeue;
-    {
-      nb::ft_lock_guard guard(callback_mutex_);
-      dequeue_cb = dequeue_callback_;
-      has_dequeue = has_dequeue_callback_;
+std::optional<uint16_t> VideoEncoder::videotoolbox_quantizer(
+    const EncodeOptions& options) {
+  // AVC/HEVC quantizer オプションを取得
+  std::optional<uint16_t> quantizer;
+  if (options.avc.has_value() && options.avc->quantizer.has_value()) {
+    uint16_t q = options.avc->quantizer.value();
+    if (q > 51) {
+      throw nb::value_error("AVC quantizer must be in range 0-51");
     }
-    if (has_dequeue && !dequeue_cb.is_none()) {
-      nb::gil_scoped_acquire gil;
-      dequeue_cb();
+    quantizer = q;
+  }
+  if (options.hevc.has_value() && options.hevc->quantizer.has_value()) {
+    uint16_t q = options.hevc->quantizer.value();
+    if (q > 51) {
+      throw nb::value_error("HEVC quantizer must be in range 0-51");
     }
-    return;
+    quantizer = q;
   }
+  return quantizer;
+}
 
-  // その他のコーデックはワーカースレッドにタスクを追加
+VideoEncoder::EncodeTask VideoEncoder::make_encode_task(
+    const EncodeOptions& options) {
   EncodeTask task;
-  task.frame =
-      frame.create_encoder_copy();  // エンコーダー用の安全なコピーを作成
   task.keyframe = options.keyframe;
-  task.sequence_number = next_sequence_number_++;
 
   // AV1 オプションを設定
   if (options.av1.has_value() && options.av1->quantizer.has_value()) {
@@ -318,15 +670,146 @@ void VideoEncoder::encode(const VideoFrame& frame,
     task.vp9_quantizer = q;
   }
 
-  // タスクをキューに追加
-  {
-    std::lock_guard<std::mutex> lock(queue_mutex_);
-    encode_queue_.push(task);
-    pending_tasks_++;
+  // AVC オプションを設定
+  if (options.avc.has_value() && options.avc->quantizer.has_value()) {
+    uint16_t q = options.avc->quantizer.value();
+    if (q > 51) {
+      throw nb::value_error("AVC quantizer must be in range 0-51");
+    }
+    task.avc_quantizer = q;
   }
-  queue_cv_.notify_one();
+  return task;
+}
 
-  // デキューコールバックを呼び出す
+void VideoEncoder::encode_many(const std::vector<VideoFrame*>& frames,
+                               const std::vector<EncodeOptions>& options) {
+  if (state_ != CodecState::CONFIGURED) {
+    throw std::runtime_error("VideoEncoder is not configured");
+  }
+  if (options.size() > 1 && options.size() != frames.size()) {
+    throw nb::value_error(
+        "options must be a single dict or a list with the same length as "
+        "frames");
+  }
+  if (frames.empty()) {
+    return;
+  }
+
+  const EncodeOptions default_options;
+  auto options_at = [&](size_t i) -> const EncodeOptions& {
+    if (options.empty()) {
+      return default_options;
+    }
+    return options.size() == 1 ? options[0] : options[i];
+  };
+
+  // 途中のフレームでエラーになってそれまでのフレームだけがキューに入らないよう、
+  // close 済みのフレームと transfer するフレームの重複は先に検証する
+  std::map<const VideoFrame*, size_t> frame_counts;
+  for (const VideoFrame* frame : frames) {
+    if (frame->is_closed()) {
+      throw std::runtime_error("VideoFrame is closed");
+    }
+    frame_counts[frame]++;
+  }
+  for (size_t i = 0; i < frames.size(); i++) {
+    if (options_at(i).transfer && frame_counts[frames[i]] > 1) {
+      throw nb::value_error(
+          "A frame with transfer must not be listed more than once in frames");
+    }
+  }
+
+  // VideoToolbox は独自の非同期モデルを持つため、ワーカースレッドをバイパス
+  if (uses_videotoolbox()) {
+    // 途中でエラーにならないよう、先に全フレームのオプションを検証する
+    std::vector<std::optional<uint16_t>> quantizers;
+    quantizers.reserve(frames.size());
+    for (size_t i = 0; i < frames.size(); i++) {
+      quantizers.push_back(videotoolbox_quantizer(options_at(i)));
+    }
+
+    // VideoToolbox エンコーダーの初期化（必要な場合）
+    if (!vt_session_) {
+      init_videotoolbox_encoder();
+    }
+
+    for (size_t i = 0; i < frames.size(); i++) {
+      // シーケンス番号を設定して直接エンコード
+      context_.current_sequence = next_sequence_number_++;
+      encode_frame_videotoolbox(*frames[i], options_at(i).keyframe,
+                                quantizers[i]);
+      // VideoToolbox はエンコード中にコピーを済ませるため、transfer では close するだけ
+      if (options_at(i).transfer) {
+        frames[i]->close();
+      }
+    }
+
+    // デキューコールバックを呼び出す
+    nb::object dequeue_cb;
+    bool has_dequeue;
+    {
+      nb::ft_lock_guard guard(callback_mutex_);
+      dequeue_cb = dequeue_callback_;
+      has_dequeue = has_dequeue_callback_;
+    }
+    if (has_dequeue && !dequeue_cb.is_none()) {
+      nb::gil_scoped_acquire gil;
+      dequeue_cb();
+    }
+    return;
+  }
+
+  // その他のコーデックはワーカースレッドにタスクを追加
+  std::vector<EncodeTask> tasks;
+  tasks.reserve(frames.size());
+  for (size_t i = 0; i < frames.size(); i++) {
+    tasks.push_back(make_encode_task(options_at(i)));
+  }
+
+  // 全てのオプションの検証が終わってからフレームを受け取る（検証エラーで close しないように）
+  // 破棄によって順序通りに出力できるようになったチャンク
+  std::vector<OutputEntry> outputs;
+  try {
+    for (size_t i = 0; i < frames.size(); i++) {
+      EncodeTask& task = tasks[i];
+      task.bytes = frames[i]->allocation_size();
+      {
+        std::unique_lock<std::mutex> lock(queue_mutex_);
+        // キューの上限に達している場合は queue_full_policy に従う
+        // フレームを受け取る前に行い、QuotaExceededError のときは close しないようにする
+        make_queue_space(lock, task.bytes, outputs);
+        // 順序待ちのシーケンス番号が上限に達している間は待機する (バックプレッシャー)
+        // Python 側の出力処理がエンコードより遅くてもメモリ使用量が増え続けないようにする
+        queue_cv_.wait(lock, [this]() { return has_output_capacity(); });
+      }
+
+      if (options_at(i).transfer) {
+        // バッファの所有権を受け取り、呼び出し元のフレームは close する
+        task.frame = frames[i]->transfer();
+      } else {
+        // エンコーダー用の安全なコピーを作成（バッファはエンコーダーのプールから確保）
+        task.frame = frames[i]->create_encoder_copy(frame_pool_);
+      }
+
+      std::lock_guard<std::mutex> lock(queue_mutex_);
+      task.sequence_number = next_sequence_number_++;
+      pending_bytes_ += task.bytes;
+      encode_queue_.push_back(std::move(task));
+      uint32_t pending = ++pending_tasks_;
+      if (pending > queue_high_water_mark_) {
+        queue_high_water_mark_ = pending;
+      }
+      queue_cv_.notify_all();
+      post_worker_tasks(1);
+    }
+  } catch (...) {
+    // QuotaExceededError の場合も、それまでに追加したフレームはキューに残る
+    emit_entries(std::move(outputs));
+    throw;
+  }
+  emit_entries(std::move(outputs));
+
+  // デキューコールバックを呼び出す（バッチごとに 1 回）
   nb::object dequeue_cb;
   bool has_dequeue;
   {
@@ -340,29 +823,72 @@ void VideoEncoder::encode(const VideoFrame& frame,
   }
 }
 
-void VideoEncoder::handle_encoded_frame(const uint8_t* data,
+void VideoEncoder::register_pending_input(
+    EncoderContext& ctx,
+    int64_t pts,
+    const VideoFrame& frame,
+    std::optional<EncodedVideoChunkMetadata> metadata) {
+  ctx.pending_inputs[pts] =
+      PendingInput{ctx.current_sequence, frame.timestamp(), frame.duration(),
+                   std::move(metadata)};
+}
+
+void VideoEncoder::handle_encoded_frame(EncoderContext& ctx,
+                                        const uint8_t* data,
                                         size_t size,
-                                        int64_t timestamp,
+                                        int64_t pts,
                                         bool keyframe) {
+  // pts が一致しない場合は別のフレームのタイムスタンプ・duration・metadata を
+  // 付けて出力しないよう、パケットを破棄する
+  auto it = ctx.pending_inputs.find(pts);
+  if (it == ctx.pending_inputs.end()) {
+    return;  // 対応する入力フレームがない
+  }
+  PendingInput input = std::move(it->second);
+  ctx.pending_inputs.erase(it);
+
+  // セグメントのエンコーダーでは並べ替えずにセグメントに溜め、元のエンコーダーがまとめて出力する
+  // コールバックは呼び出さない
+  if (ctx.segment_outputs) {
+    auto chunk = std::make_shared<EncodedVideoChunk>(
+        std::vector<uint8_t>(data, data + size),
+        keyframe ? EncodedVideoChunkType::KEY : EncodedVideoChunkType::DELTA,
+        input.timestamp, input.duration);
+    ctx.segment_outputs->emplace_back(
+        input.sequence,
+        OutputEntry{std::move(chunk), std::move(input.metadata)});
+    return;
+  }
+
   nb::object output_cb;
   bool has_output;
+  bool has_output_batch;
   {
     nb::ft_lock_guard guard(callback_mutex_);
     output_cb = output_callback_;
     has_output = has_output_callback_;
+    has_output_batch = has_output_batch_callback_;
   }
-  if (has_output && !output_cb.is_none()) {
+  // 同期モードと出力キューモードではコールバックがなくてもチャンクを作成する
+  if ((has_output && !output_cb.is_none()) || has_output_batch ||
+      output_queue_ || sync_thread_.load() == std::this_thread::get_id()) {
     std::vector<uint8_t> payload;
     // 生のビットストリームを出力
     payload.assign(data, data + size);
 
     auto chunk = std::make_shared<EncodedVideoChunk>(
-        payload,
+        std::move(payload),
         keyframe ? EncodedVideoChunkType::KEY : EncodedVideoChunkType::DELTA,
-        timestamp, 0);
+        input.timestamp, input.duration);
 
     // 順序制御された出力処理
-    handle_output(current_sequence_, chunk);
+    // 先読みで遅延したパケットも元のフレームのシーケンス番号の位置に並べる
+    handle_output(input.sequence, chunk, std::move(input.metadata));
+  }
+
+  // バッチ出力では on_dequeue は encode_many() ごとに 1 回だけ呼び出す
+  if (has_output_batch) {
+    return;
   }
 
   // デキューコールバックを呼び出す
@@ -379,6 +905,18 @@ void VideoEncoder::handle_encoded_frame(const uint8_t* data,
   }
 }
 
+std::optional<EncodedVideoChunkMetadata> VideoEncoder::make_svc_metadata(
+    int temporal_layer_id) const {
+  if (!config_.scalability_mode.has_value()) {
+    return std::nullopt;
+  }
+  EncodedVideoChunkMetadata metadata;
+  SvcOutputMetadata svc;
+  svc.temporal_layer_id = static_cast<uint32_t>(temporal_layer_id);
+  metadata.svc = svc;
+  return metadata;
+}
+
 void VideoEncoder::flush() {
   if (state_ != CodecState::CONFIGURED) {
     return;
@@ -386,19 +924,68 @@ void VideoEncoder::flush() {
 
   // VideoToolbox は直接処理されるため、ワーカーキューの待機をスキップ
   if (!uses_videotoolbox()) {
-    // 全てのペンディングタスクが完了するまで待機
-    {
-      std::unique_lock<std::mutex> lock(queue_mutex_);
-      queue_cv_.wait(lock, [this]() {
-        return encode_queue_.empty() && pending_tasks_ == 0;
-      });
+    // 全てのペンディングタスクと flush タスクが完了するまで待機
+    std::unique_lock<std::mutex> lock(queue_mutex_);
+    queue_cv_.wait(lock, [this]() { return is_queue_idle(); });
+  }
+
+  flush_encoder();
+}
+
+uint64_t VideoEncoder::request_flush() {
+  if (!output_queue_) {
+    throw std::runtime_error("output_queue is not enabled");
+  }
+  std::lock_guard<std::mutex> lock(queue_mutex_);
+  // flush() と同じく、構成済みでない場合は何もせずに完了とする
+  if (state_ != CodecState::CONFIGURED) {
+    return completed_flushes_;
+  }
+  // encode() で追加したフレームを全て処理した後にワーカーで flush する
+  EncodeTask task{};
+  task.flush = true;
+  encode_queue_.push_back(std::move(task));
+  uint64_t id = ++requested_flushes_;
+  queue_cv_.notify_all();
+  post_worker_tasks(1);
+  return id;
+}
+
+void VideoEncoder::run_flush_task() {
+  try {
+    flush_encoder();
+  } catch (const std::exception& e) {
+    report_error(e.what());
+  }
+  // 出力をキューに追加し終えてから完了を通知する
+  deliver_output_batch(true);
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    // reset() で完了扱いにした flush タスクは数えない
+    if (completed_flushes_ < requested_flushes_) {
+      completed_flushes_++;
     }
   }
+  queue_cv_.notify_all();
+  output_queue_->wake();
+}
+
+bool VideoEncoder::is_queue_idle() const {
+  return encode_queue_.empty() && pending_tasks_ == 0 &&
+         completed_flushes_ == requested_flushes_;
+}
+
+void VideoEncoder::flush_encoder() {
+  // GOP 並列エンコードでは溜めているフレームを最後のセグメントとしてエンコードし、全て出力する
+  if (uses_segment_encoding()) {
+    finish_segments();
+    drain_output_ring();
+    return;
+  }
 
-  // ワーカースレッドなしでフラッシュ処理を実行
   // 必要であればここで遅延初期化
-  if (!aom_encoder_ && is_av1_codec()) {
-    init_aom_encoder();
+  if (!context_.aom_encoder && is_av1_codec() && !uses_svt_av1()) {
+    init_aom_encoder(context_);
   }
 
   // VideoToolbox の初期化とフラッシュ
@@ -410,57 +997,233 @@ void VideoEncoder::flush() {
     flush_videotoolbox_encoder();
   }
 
-  // AV1 エンコーダーは libaom の排他制御が必要なため専用処理を挟む
-  if (aom_encoder_) {
-    // エンドオブストリームをシグナル
-    std::lock_guard<std::mutex> lock(aom_mutex_);
+  // 先読みでエンコーダー内部に残っているフレームを出力する
+  if (context_.aom_encoder) {
+    flush_aom_encoder(context_);
+  }
+#if defined(__APPLE__) || defined(__linux__)
+  if (context_.vpx_encoder) {
+    flush_vpx_encoder(context_);
+  }
+  if (context_.svt_av1_encoder) {
+    flush_svt_av1_encoder(context_);
+  }
+#endif
+
+  // 結果を出さなかったシーケンス番号で止まっているチャンクを全て出力
+  drain_output_ring();
+}
+
+std::vector<VideoEncoder::OutputEntry> VideoEncoder::encode_sync(
+    VideoFrame& frame,
+    const EncodeOptions& options) {
+  if (state_ != CodecState::CONFIGURED) {
+    throw std::runtime_error("VideoEncoder is not configured");
+  }
+  // VideoToolbox はエンコード結果を別スレッドのコールバックで返すため対応しない
+  if (uses_videotoolbox()) {
+    throw std::runtime_error(
+        "NotSupportedError: encode_sync is not supported by the VideoToolbox "
+        "encoder");
+  }
+  // GOP 並列エンコードはセグメントが揃うまで出力しないため対応しない
+  if (uses_segment_encoding()) {
+    throw std::runtime_error(
+        "NotSupportedError: encode_sync is not supported with segment_frames");
+  }
+  if (frame.is_closed()) {
+    throw std::runtime_error("VideoFrame is closed");
+  }
+
+  EncodeTask task = make_encode_task(options);
+  // 呼び出し中にエンコーダーへ渡し終えるため、フレームはコピーせずに参照する
+  task.frame = std::shared_ptr<VideoFrame>(&frame, [](VideoFrame*) {});
 
-    // バインディング層で既に GIL を解放しているため、ここでは解放しない
+  std::lock_guard<std::mutex> sync_lock(sync_mutex_);
+  std::vector<OutputEntry> outputs = run_sync([this, &task]() {
     {
-      // nb::gil_scoped_release gil_release;
-
-      // AOM エンコーダーのフラッシュ処理
-      // エンドオブストリームをシグナルするため nullptr を渡す
-      aom_codec_err_t res = aom_codec_encode(aom_encoder_, nullptr,
-                                             frame_count_.fetch_add(1), 1, 0);
-      if (res != AOM_CODEC_OK) {
-        // エラーをログして続行 (フラッシュ時のエラーは致命的ではない)
-      }
+      // encode() でキューに追加したフレームと順序が入れ替わらないよう、処理し終えるまで待機する
+      std::unique_lock<std::mutex> lock(queue_mutex_);
+      queue_cv_.wait(lock, [this]() { return is_queue_idle(); });
+      task.sequence_number = next_sequence_number_++;
+    }
+    process_encode_task(task);
+  });
+  if (options.transfer) {
+    frame.close();
+  }
+  return outputs;
+}
 
-      aom_codec_iter_t iter = nullptr;
-      const aom_codec_cx_pkt_t* pkt;
-      while ((pkt = aom_codec_get_cx_data(aom_encoder_, &iter)) != nullptr) {
-        if (pkt->kind == AOM_CODEC_CX_FRAME_PKT) {
-          bool is_keyframe = (pkt->data.frame.flags & AOM_FRAME_IS_KEY) != 0;
-          // GIL なしで実行
-          handle_encoded_frame(static_cast<const uint8_t*>(pkt->data.frame.buf),
-                               pkt->data.frame.sz,
-                               0,  // タイムスタンプ (未追跡)
-                               is_keyframe);
+std::vector<VideoEncoder::OutputEntry> VideoEncoder::flush_sync() {
+  // セグメントのチャンクは別のスレッドから出力するため、戻り値で返せない
+  if (state_ == CodecState::CONFIGURED && uses_segment_encoding()) {
+    throw std::runtime_error(
+        "NotSupportedError: flush_sync is not supported with segment_frames");
+  }
+  std::lock_guard<std::mutex> sync_lock(sync_mutex_);
+  return run_sync([this]() { flush(); });
+}
+
+std::vector<VideoEncoder::OutputEntry> VideoEncoder::run_sync(
+    const std::function<void()>& fn) {
+  std::vector<OutputEntry> outputs;
+  sync_outputs_ = &outputs;
+  sync_thread_ = std::this_thread::get_id();
+  try {
+    fn();
+  } catch (...) {
+    sync_thread_ = std::thread::id();
+    sync_outputs_ = nullptr;
+    throw;
+  }
+  sync_thread_ = std::thread::id();
+  sync_outputs_ = nullptr;
+  return outputs;
+}
+
+std::optional<VideoEncoder::OutputEntry> VideoEncoder::read_output(
+    std::optional<double> timeout,
+    bool until_idle) {
+  if (!output_queue_) {
+    throw std::runtime_error("output_queue is not enabled");
+  }
+  return output_queue_->pop(timeout, [this, until_idle]() {
+    return state_ == CodecState::CLOSED ||
+           (until_idle && pending_tasks_ == 0 && pending_segments_ == 0);
+  });
+}
+
+std::vector<VideoEncoder::OutputEntry> VideoEncoder::read_all_outputs() {
+  if (!output_queue_) {
+    throw std::runtime_error("output_queue is not enabled");
+  }
+  return output_queue_->pop_all();
+}
+
+int VideoEncoder::output_queue_fd() {
+  if (!output_queue_) {
+    throw std::runtime_error("output_queue is not enabled");
+  }
+  return output_queue_->wakeup_fd();
+}
+
+void VideoEncoder::clear_output_queue_fd() {
+  if (output_queue_) {
+    output_queue_->clear_wakeup_fd();
+  }
+}
+
+bool VideoEncoder::has_output_capacity() {
+  // ワーカースレッド (出力コールバック内) から呼ばれた場合は待機すると進まなくなる
+  if (should_stop_ || is_worker_thread()) {
+    return true;
+  }
+  if (encode_queue_.empty() && pending_tasks_ == 0) {
+    return true;
+  }
+  std::lock_guard<std::mutex> lock(output_mutex_);
+  return next_sequence_number_ - output_ring_.next() < output_ring_.capacity();
+}
+
+bool VideoEncoder::is_queue_full(size_t bytes) {
+  // ワーカースレッド (出力コールバック内) から呼ばれた場合は待機すると進まなくなる
+  if (should_stop_ || is_worker_thread()) {
+    return false;
+  }
+  // 上限より大きなフレームでも進むよう、処理待ちがなければ常に受け付ける
+  if (pending_tasks_ == 0) {
+    return false;
+  }
+  if (config_.max_queue_size.has_value() &&
+      pending_tasks_ >= *config_.max_queue_size) {
+    return true;
+  }
+  if (config_.max_queue_bytes.has_value() &&
+      pending_bytes_ + bytes > *config_.max_queue_bytes) {
+    return true;
+  }
+  return false;
+}
+
+void VideoEncoder::make_queue_space(std::unique_lock<std::mutex>& lock,
+                                    size_t bytes,
+                                    std::vector<OutputEntry>& outputs) {
+  while (is_queue_full(bytes)) {
+    switch (config_.queue_full_policy) {
+      case QueueFullPolicy::RAISE:
+        throw QuotaExceededError("Encode queue is full");
+      case QueueFullPolicy::DROP_OLDEST:
+        if (drop_oldest_task(outputs)) {
+          break;
         }
-      }
+        // 破棄できるフレームがない場合は空きができるまで待機する
+        [[fallthrough]];
+      case QueueFullPolicy::BLOCK:
+        queue_cv_.wait(lock, [this, bytes]() { return !is_queue_full(bytes); });
+        break;
     }
   }
 }
 
+bool VideoEncoder::drop_oldest_task(std::vector<OutputEntry>& outputs) {
+  // エンコード前のフレームは互いに参照しないため、キーフレーム指定のないものを 1 つ破棄する
+  auto it = std::find_if(encode_queue_.begin(), encode_queue_.end(),
+                         [](const EncodeTask& task) {
+                           return !task.flush && !task.keyframe;
+                         });
+  if (it == encode_queue_.end()) {
+    return false;
+  }
+  discard_sequence(it->sequence_number, outputs);
+  pending_bytes_ -= it->bytes;
+  pending_tasks_--;
+  encode_queue_.erase(it);
+  // flush() の待機側に通知
+  queue_cv_.notify_all();
+  return true;
+}
+
+void VideoEncoder::discard_sequence(uint64_t sequence,
+                                    std::vector<OutputEntry>& outputs) {
+  queue_dropped_++;
+  std::lock_guard<std::mutex> lock(output_mutex_);
+  output_ring_.discard(sequence, outputs);
+}
+
+void VideoEncoder::drain_output_ring() {
+  std::vector<OutputEntry> entries_to_output;
+  {
+    std::lock_guard<std::mutex> lock(output_mutex_);
+    output_ring_.drain(entries_to_output);
+    output_ring_.skip_to(next_sequence_number_);
+  }
+  emit_entries(std::move(entries_to_output));
+}
+
 void VideoEncoder::reset() {
+  // セグメントの空きを待っているワーカースレッドが止まるよう、先にセグメントを破棄する
+  cancel_segments();
   // ワーカースレッドを停止
   stop_worker();
 
   // キューをクリア
   {
     std::lock_guard<std::mutex> lock(queue_mutex_);
-    while (!encode_queue_.empty()) {
-      encode_queue_.pop();
-    }
+    encode_queue_.clear();
     pending_tasks_ = 0;
+    pending_bytes_ = 0;
+    queue_high_water_mark_ = 0;
+    queue_dropped_ = 0;
+    // 破棄した flush タスクは完了として扱い、flush_async() の待機を終わらせる
+    completed_flushes_ = requested_flushes_.load();
   }
 
   // 出力バッファをクリア
   {
     std::lock_guard<std::mutex> lock(output_mutex_);
-    output_buffer_.clear();
-    next_output_sequence_ = 0;
+    output_ring_.clear();
+    output_batch_.clear();
   }
 
   // シーケンス番号をリセット
@@ -468,7 +1231,7 @@ void VideoEncoder::reset() {
 
   close();
   state_ = CodecState::UNCONFIGURED;
-  frame_count_ = 0;
+  context_.next_pts = 0;
 
   // ワーカースレッドを再開
   start_worker();
@@ -480,36 +1243,20 @@ void VideoEncoder::close() {
   }
 
   // ワーカースレッドを停止してからリソースを解放
+  // セグメントの空きを待っているワーカースレッドが止まるよう、先にセグメントを破棄する
+  cancel_segments();
   stop_worker();
 
-  cleanup_aom_encoder();
-
-#if defined(__APPLE__)
-  // VideoToolbox セッションが存在する場合はクリーンアップ
-  if (vt_session_) {
-    VTCompressionSessionRef s = (VTCompressionSessionRef)vt_session_;
-    VTCompressionSessionInvalidate(s);
-    CFRelease(s);
-    vt_session_ = nullptr;
-  }
-#endif
-
-#if defined(USE_NVIDIA_CUDA_TOOLKIT)
-  // NVENC リソースをクリーンアップ
-  cleanup_nvenc_encoder();
-#endif
-
-#if defined(__linux__)
-  // Intel VPL リソースをクリーンアップ
-  cleanup_intel_vpl_encoder();
-#endif
-
-#if defined(__APPLE__) || defined(__linux__)
-  // VPX エンコーダーが存在する場合はクリーンアップ
-  cleanup_vpx_encoder();
-#endif
-
+  cleanup_encoders();
+  current_segment_.reset();
+  segment_pool_.reset();
+
+  frame_pool_->trim();
   state_ = CodecState::CLOSED;
+  // 出力キューで待機している read() を起こす (出力済みのチャンクはキューに残す)
+  if (output_queue_) {
+    output_queue_->wake();
+  }
 }
 
 VideoEncoderSupport VideoEncoder::is_config_supported(
@@ -520,6 +1267,20 @@ VideoEncoderSupport VideoEncoder::is_config_supported(
     // コーデック文字列をパースして、パラメータを抽出
     CodecParameters codec_params = parse_codec_string(config.codec);
 
+    // 対応していない scalability_mode は未サポート
+    if (!is_scalability_mode_supported(config, codec_params)) {
+      return VideoEncoderSupport(false, config);
+    }
+    // GOP 並列エンコードに対応していない構成は未サポート
+    if (config.segment_frames.has_value() &&
+        !is_segment_encoding_supported(config, codec_params)) {
+      return VideoEncoderSupport(false, config);
+    }
+    // SVT-AV1 で対応していない構成は未サポート
+    if (!is_av1_encoder_supported(config, codec_params)) {
+      return VideoEncoderSupport(false, config);
+    }
+
     // NVIDIA Video Codec SDK でサポートされているかチェック
 #if defined(USE_NVIDIA_CUDA_TOOLKIT)
     if (config.hardware_acceleration_engine.has_value() &&
@@ -563,6 +1324,15 @@ VideoEncoderSupport VideoEncoder::is_config_supported(
                       HardwareAccelerationEngine::NVIDIA_VIDEO_CODEC;
 #else
       supported = false;  // 他のプラットフォームではまだサポートされていない
+#endif
+#if defined(__linux__)
+      // H.264 はエンジン未指定 (または NONE) の場合に OpenH264 でソフトウェアエンコード
+      if (std::holds_alternative<AVCCodecParameters>(codec_params) &&
+          (!config.hardware_acceleration_engine.has_value() ||
+           config.hardware_acceleration_engine.value() ==
+               HardwareAccelerationEngine::NONE)) {
+        supported = dyn::DynModule::IsLoadable(dyn::openh264_so());
+      }
 #endif
     } else if (std::holds_alternative<VP8CodecParameters>(codec_params) ||
                std::holds_alternative<VP9CodecParameters>(codec_params)) {
@@ -585,6 +1355,19 @@ VideoEncoderSupport VideoEncoder::is_config_supported(
 // ワーカースレッドの開始
 void VideoEncoder::start_worker() {
   should_stop_ = false;
+  if (worker_pool_) {
+    // プールを使う場合はスレッドを立てず、キューに残っているタスクを投入する
+    // 関数から例外が伝播した場合はエラーコールバックで報告する
+    worker_strand_ = worker_pool_->create_strand(
+        [this](const std::string& message) { report_error(message); });
+    size_t queued;
+    {
+      std::lock_guard<std::mutex> lock(queue_mutex_);
+      queued = encode_queue_.size();
+    }
+    post_worker_tasks(queued);
+    return;
+  }
   worker_thread_ = std::thread([this]() { worker_loop(); });
 }
 
@@ -596,17 +1379,40 @@ void VideoEncoder::stop_worker() {
   }
   queue_cv_.notify_all();
 
+  if (worker_strand_) {
+    // 投入済みのタスクを処理し終えるまで待つ
+    worker_strand_->drain();
+    worker_strand_.reset();
+  }
   if (worker_thread_.joinable()) {
     worker_thread_.join();
   }
 }
 
+bool VideoEncoder::is_worker_running() const {
+  return worker_thread_.joinable() || worker_strand_ != nullptr;
+}
+
+bool VideoEncoder::is_worker_thread() const {
+  if (worker_strand_) {
+    return worker_strand_->running_in_this_thread();
+  }
+  return std::this_thread::get_id() == worker_thread_.get_id();
+}
+
+void VideoEncoder::post_worker_tasks(size_t count) {
+  std::shared_ptr<WorkerStrand> strand = worker_strand_;
+  if (!strand) {
+    return;
+  }
+  for (size_t i = 0; i < count; i++) {
+    strand->post([this]() { run_next_task(); });
+  }
+}
+
 // ワーカースレッドのメインループ
 void VideoEncoder::worker_loop() {
   while (true) {
-    EncodeTask task;
-
-    // タスクを取得
     {
       std::unique_lock<std::mutex> lock(queue_mutex_);
       queue_cv_.wait(
@@ -615,60 +1421,254 @@ void VideoEncoder::worker_loop() {
       if (should_stop_ && encode_queue_.empty()) {
         break;
       }
+    }
+    run_next_task();
+  }
+}
 
-      if (!encode_queue_.empty()) {
-        task = encode_queue_.front();
-        encode_queue_.pop();
-      } else {
-        continue;
+// キューの先頭のタスクを処理する
+// 専用スレッドの worker_loop() とプールのストランドの両方から呼ばれる
+void VideoEncoder::run_next_task() {
+  EncodeTask task;
+
+  // タスクを取得
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    if (encode_queue_.empty()) {
+      return;
+    }
+    task = std::move(encode_queue_.front());
+    encode_queue_.pop_front();
+  }
+
+  // flush タスクは処理待ちのタスク数に含めない
+  if (task.flush) {
+    run_flush_task();
+    return;
+  }
+
+  // タスクを処理
+  if (task.frame) {
+    try {
+      process_encode_task(task);
+    } catch (const std::exception& e) {
+      // エラーが発生した場合、エラーコールバックを呼び出す
+      report_error(e.what());
+      // エラーでもワーカースレッドは停止せず、以降は通常と同じく後処理する
+    }
+  }
+
+  // バッチ出力: キューが空になったか上限に達したら溜めたチャンクを出力する
+  // pending_tasks_ を減らす前に出力し、flush() の完了時には出力済みにする
+  bool queue_empty;
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    queue_empty = encode_queue_.empty();
+  }
+  deliver_output_batch(queue_empty);
+
+  // 処理待ちタスク数を減らす
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    pending_tasks_--;
+    pending_bytes_ -= task.bytes;
+  }
+  // flush() と上限で待機している encode() へ進捗通知
+  queue_cv_.notify_all();
+  if (output_queue_) {
+    output_queue_->wake();
+  }
+}
+
+void VideoEncoder::report_error(const std::string& message) {
+  nb::object error_cb;
+  bool has_error;
+  {
+    nb::ft_lock_guard guard(callback_mutex_);
+    error_cb = error_callback_;
+    has_error = has_error_callback_;
+  }
+  if (has_error && !error_cb.is_none()) {
+    nb::gil_scoped_acquire gil;
+    try {
+      error_cb(message);
+    } catch (...) {
+      // エラーコールバック自体のエラーは無視
+    }
+  }
+}
+
+void VideoEncoder::add_segment_task(const EncodeTask& task) {
+  // キーフレームを指定したフレームからは新しいセグメントにする
+  if (task.keyframe && current_segment_) {
+    dispatch_segment();
+  }
+  if (!current_segment_) {
+    current_segment_ = std::make_shared<Segment>();
+    current_segment_->tasks.reserve(*config_.segment_frames);
+  }
+  current_segment_->tasks.push_back(task);
+  // セグメントの先頭はキーフレームにして、前のセグメントを参照せずにデコードできるようにする
+  current_segment_->tasks.front().keyframe = true;
+  if (current_segment_->tasks.size() >= *config_.segment_frames) {
+    dispatch_segment();
+  }
+}
+
+void VideoEncoder::dispatch_segment() {
+  std::shared_ptr<Segment> segment = std::move(current_segment_);
+  current_segment_.reset();
+  if (!segment) {
+    return;
+  }
+  {
+    // 入力フレームを溜め込み続けないよう、エンコード中のセグメントがスレッド数に達している間は待機する
+    std::unique_lock<std::mutex> lock(segment_mutex_);
+    segment_cv_.wait(lock, [this]() {
+      return segments_cancelled_ || segments_.size() < segment_pool_->threads();
+    });
+    if (segments_cancelled_) {
+      return;
+    }
+    segments_.push_back(segment);
+    pending_segments_++;
+  }
+  segment_pool_->create_strand()->post([this, segment]() {
+    try {
+      encode_segment(*segment);
+    } catch (const std::exception& e) {
+      segment->error = e.what();
+    }
+    {
+      std::lock_guard<std::mutex> lock(segment_mutex_);
+      segment->done = true;
+    }
+    deliver_segments();
+  });
+}
+
+void VideoEncoder::encode_segment(Segment& segment) {
+  // 新しいエンコーダーの状態を作成し、以前のセグメントとは独立してエンコードする
+  // 出力したチャンクは segment.outputs に追加する
+  // config_ は configure() がセグメントを出力し終えてから変更するため、ここで参照できる
+  EncoderContext ctx;
+  ctx.segment_outputs = &segment.outputs;
+  ctx.parallelism = segment_pool_->threads();
+
+  try {
+    for (const EncodeTask& task : segment.tasks) {
+      encode_software_task(ctx, task);
+    }
+    // 先読みでエンコーダー内部に残っているフレームを出力する
+    if (ctx.aom_encoder) {
+      flush_aom_encoder(ctx);
+    }
+#if defined(__APPLE__) || defined(__linux__)
+    if (ctx.vpx_encoder) {
+      flush_vpx_encoder(ctx);
+    }
+    if (ctx.svt_av1_encoder) {
+      flush_svt_av1_encoder(ctx);
+    }
+#endif
+  } catch (...) {
+    cleanup_software_encoders(ctx);
+    throw;
+  }
+  cleanup_software_encoders(ctx);
+}
+
+void VideoEncoder::deliver_segments() {
+  // 後から投入したセグメントが先に終わっても、前のセグメントを出力するまで待たせる
+  std::lock_guard<std::mutex> output_lock(segment_output_mutex_);
+  while (true) {
+    std::shared_ptr<Segment> segment;
+    bool cancelled;
+    {
+      std::lock_guard<std::mutex> lock(segment_mutex_);
+      if (segments_.empty() || !segments_.front()->done) {
+        break;
       }
+      segment = segments_.front();
+      cancelled = segments_cancelled_;
     }
 
-    // タスクを処理
-    if (task.frame) {
-      try {
-        process_encode_task(task);
-      } catch (const std::exception& e) {
-        // エラーが発生した場合、エラーコールバックを呼び出す
-        nb::object error_cb;
-        bool has_error;
-        {
-          nb::ft_lock_guard guard(callback_mutex_);
-          error_cb = error_callback_;
-          has_error = has_error_callback_;
-        }
-        if (has_error && !error_cb.is_none()) {
-          nb::gil_scoped_acquire gil;
-          try {
-            error_cb(std::string(e.what()));
-          } catch (...) {
-            // エラーコールバック自体のエラーは無視
-          }
+    if (!cancelled) {
+      if (!segment->error.empty()) {
+        report_error(segment->error);
+      }
+      // シーケンス番号順にリングに追加し、容量を超えて古いシーケンス番号を飛ばさないようにする
+      std::sort(segment->outputs.begin(), segment->outputs.end(),
+                [](const auto& a, const auto& b) { return a.first < b.first; });
+      std::vector<OutputEntry> entries;
+      {
+        std::lock_guard<std::mutex> lock(output_mutex_);
+        for (auto& [sequence, entry] : segment->outputs) {
+          output_ring_.put(sequence, std::move(entry), entries);
         }
-        // pending_tasks_ を減らしてから続行 (ワーカースレッドは停止しない)
-        {
-          std::lock_guard<std::mutex> lock(queue_mutex_);
-          pending_tasks_--;
+        // エラーなどでチャンクが出力されなかったフレームで、後続のセグメントの出力が止まらないようにする
+        for (const EncodeTask& task : segment->tasks) {
+          output_ring_.discard(task.sequence_number, entries);
         }
-        queue_cv_.notify_all();
-        continue;
       }
+      emit_entries(std::move(entries));
     }
 
-    // 処理待ちタスク数を減らす
     {
-      std::lock_guard<std::mutex> lock(queue_mutex_);
-      pending_tasks_--;
+      std::lock_guard<std::mutex> lock(segment_mutex_);
+      segments_.pop_front();
+      pending_segments_--;
+    }
+    segment_cv_.notify_all();
+  }
+
+  // 出力待ちで止まっている encode() と出力キューの read() に通知
+  queue_cv_.notify_all();
+  if (output_queue_) {
+    output_queue_->wake();
+  }
+}
+
+void VideoEncoder::finish_segments() {
+  dispatch_segment();
+  std::unique_lock<std::mutex> lock(segment_mutex_);
+  segment_cv_.wait(lock, [this]() { return segments_.empty(); });
+}
+
+void VideoEncoder::cancel_segments() {
+  {
+    std::lock_guard<std::mutex> lock(segment_mutex_);
+    segments_cancelled_ = true;
+    if (segments_.empty()) {
+      return;
     }
-    // flush() 待機側へ進捗通知
-    queue_cv_.notify_all();
+  }
+  segment_cv_.notify_all();
+
+  // エンコード中のセグメントが終わるまで待機する
+  // 出力中のセグメントがコールバックのために GIL を待っている場合があるため、GIL を解放して待つ
+  auto wait = [this]() {
+    std::unique_lock<std::mutex> lock(segment_mutex_);
+    segment_cv_.wait(lock, [this]() { return segments_.empty(); });
+  };
+  if (PyGILState_Check()) {
+    nb::gil_scoped_release gil;
+    wait();
+  } else {
+    wait();
   }
 }
 
 // エンコードタスクの処理
 void VideoEncoder::process_encode_task(const EncodeTask& task) {
   // 現在のシーケンス番号を保存
-  current_sequence_ = task.sequence_number;
+  context_.current_sequence = task.sequence_number;
+
+  // GOP 並列エンコードではセグメントに溜め、セグメントごとのエンコーダーでエンコードする
+  if (uses_segment_encoding()) {
+    add_segment_task(task);
+    return;
+  }
 
   // 遅延初期化 (初回エンコード時)
 #if defined(USE_NVIDIA_CUDA_TOOLKIT)
@@ -681,22 +1681,15 @@ void VideoEncoder::process_encode_task(const EncodeTask& task) {
   if (uses_intel_vpl() && !vpl_session_) {
     init_intel_vpl_encoder();
   }
-#endif
-
-  if (is_av1_codec() && !aom_encoder_ && !uses_nvidia_video_codec()) {
-    init_aom_encoder();
+  if (uses_openh264() && !openh264_encoder_) {
+    init_openh264_encoder();
   }
+#endif
 
   if (uses_videotoolbox() && !vt_session_) {
     init_videotoolbox_encoder();
   }
 
-#if defined(__APPLE__) || defined(__linux__)
-  if ((is_vp8_codec() || is_vp9_codec()) && !vpx_encoder_) {
-    init_vpx_encoder();
-  }
-#endif
-
   // バインディング層で既に GIL を解放しているため、ここでは解放しない
   // nb::gil_scoped_release gil_release;
 
@@ -712,22 +1705,57 @@ void VideoEncoder::process_encode_task(const EncodeTask& task) {
     encode_frame_intel_vpl(*task.frame, task.keyframe, task.avc_quantizer);
     return;
   }
+  if (uses_openh264()) {
+    encode_frame_openh264(*task.frame, task.keyframe, task.avc_quantizer);
+    return;
+  }
+#endif
+
+  encode_software_task(context_, task);
+}
+
+void VideoEncoder::encode_software_task(EncoderContext& ctx,
+                                        const EncodeTask& task) {
+  ctx.current_sequence = task.sequence_number;
+
+  // 遅延初期化 (初回エンコード時)
+#if defined(__APPLE__) || defined(__linux__)
+  // SVT-AV1 はフラッシュでエンコーダーを破棄するため、次のフレームで作り直す
+  if (uses_svt_av1() && !ctx.svt_av1_encoder) {
+    init_svt_av1_encoder(ctx);
+  }
+#endif
+
+  if (is_av1_codec() && !ctx.aom_encoder && !uses_nvidia_video_codec() &&
+      !uses_svt_av1()) {
+    init_aom_encoder(ctx);
+  }
+
+#if defined(__APPLE__) || defined(__linux__)
+  if ((is_vp8_codec() || is_vp9_codec()) && !ctx.vpx_encoder) {
+    init_vpx_encoder(ctx);
+  }
+
+  if (uses_svt_av1()) {
+    encode_frame_svt_av1(ctx, *task.frame, task.keyframe, task.av1_quantizer);
+    return;
+  }
 #endif
 
   if (is_av1_codec()) {
-    encode_frame_aom(*task.frame, task.keyframe, task.av1_quantizer);
+    encode_frame_aom(ctx, *task.frame, task.keyframe, task.av1_quantizer);
   } else if (is_avc_codec() || is_hevc_codec()) {
     // VideoToolbox は encode() で直接処理されるため、ここには到達しない
     throw std::runtime_error("AVC/HEVC should be handled by VideoToolbox");
   } else if (is_vp8_codec()) {
 #if defined(__APPLE__) || defined(__linux__)
-    encode_frame_vpx(*task.frame, task.keyframe, task.vp8_quantizer);
+    encode_frame_vpx(ctx, *task.frame, task.keyframe, task.vp8_quantizer);
 #else
     throw std::runtime_error("VP8 not supported on this platform");
 #endif
   } else if (is_vp9_codec()) {
 #if defined(__APPLE__) || defined(__linux__)
-    encode_frame_vpx(*task.frame, task.keyframe, task.vp9_quantizer);
+    encode_frame_vpx(ctx, *task.frame, task.keyframe, task.vp9_quantizer);
 #else
     throw std::runtime_error("VP9 not supported on this platform");
 #endif
@@ -744,53 +1772,93 @@ void VideoEncoder::handle_output(
   {
     std::lock_guard<std::mutex> lock(output_mutex_);
 
-    // チャンクと metadata をバッファに追加
-    output_buffer_[sequence] = OutputEntry{chunk, metadata};
+    // チャンクと metadata をリングに追加し、順序通りに出力できるチャンクを収集
+    output_ring_.put(sequence, OutputEntry{chunk, metadata}, entries_to_output);
+  }
+
+  emit_entries(std::move(entries_to_output));
+}
 
-    // 順序通りに出力できるチャンクを収集
-    while (output_buffer_.find(next_output_sequence_) != output_buffer_.end()) {
-      entries_to_output.push_back(output_buffer_[next_output_sequence_]);
-      output_buffer_.erase(next_output_sequence_);
-      next_output_sequence_++;
+// metadata を dict に変換 (存在しない場合は空の dict)
+static nb::dict metadata_to_dict(
+    const std::optional<EncodedVideoChunkMetadata>& metadata) {
+  nb::dict metadata_dict;
+  if (metadata.has_value() && metadata->decoder_config.has_value()) {
+    const auto& config = metadata->decoder_config.value();
+    nb::dict decoder_config_dict;
+    decoder_config_dict["codec"] = config.codec;
+    if (config.coded_width.has_value()) {
+      decoder_config_dict["coded_width"] = config.coded_width.value();
+    }
+    if (config.coded_height.has_value()) {
+      decoder_config_dict["coded_height"] = config.coded_height.value();
+    }
+    if (config.description.has_value()) {
+      const auto& desc = config.description.value();
+      decoder_config_dict["description"] =
+          nb::bytes(reinterpret_cast<const char*>(desc.data()), desc.size());
     }
+    metadata_dict["decoder_config"] = decoder_config_dict;
+  }
+  if (metadata.has_value() && metadata->svc.has_value()) {
+    nb::dict svc_dict;
+    svc_dict["temporal_layer_id"] = metadata->svc->temporal_layer_id;
+    metadata_dict["svc"] = svc_dict;
+  }
+  return metadata_dict;
+}
+
+void VideoEncoder::emit_entries(std::vector<OutputEntry> entries) {
+  if (entries.empty()) {
+    return;
+  }
+
+  // 同期モードで実行中の場合はコールバックを呼ばずに戻り値として返す
+  if (sync_thread_.load() == std::this_thread::get_id()) {
+    for (auto& entry : entries) {
+      sync_outputs_->push_back(std::move(entry));
+    }
+    return;
+  }
+
+  // 出力キューモードでは GIL を取得せずにキューに追加する
+  if (output_queue_) {
+    output_queue_->push(entries);
+    return;
   }
 
-  // コールバックを呼び出す (GIL を取得)
-  // WebCodecs API では callback は (chunk, metadata?) で metadata は optional
-  // Python では常に 2 引数で呼び出し、callback 側で metadata=None のデフォルト引数を使用する
   nb::object output_cb;
   bool has_output;
+  bool has_output_batch;
   {
     nb::ft_lock_guard guard(callback_mutex_);
     output_cb = output_callback_;
     has_output = has_output_callback_;
+    has_output_batch = has_output_batch_callback_;
+  }
+
+  if (has_output_batch) {
+    {
+      std::lock_guard<std::mutex> lock(output_mutex_);
+      for (auto& entry : entries) {
+        output_batch_.push_back(std::move(entry));
+      }
+    }
+    // ワーカースレッドではキューが空になるまで溜める
+    // それ以外 (VideoToolbox のコールバックなど) ではすぐに出力する
+    deliver_output_batch(!is_worker_thread());
+    return;
   }
-  if (has_output && !output_cb.is_none() && !entries_to_output.empty()) {
+
+  // コールバックを呼び出す (GIL を取得)
+  // WebCodecs API では callback は (chunk, metadata?) で metadata は optional
+  // Python では常に 2 引数で呼び出し、callback 側で metadata=None のデフォルト引数を使用する
+  if (has_output && !output_cb.is_none()) {
     nb::gil_scoped_acquire gil;
-    for (auto& entry : entries_to_output) {
+    for (auto& entry : entries) {
       // コピーを作成して渡す (Python 側で所有権を持つ)
       EncodedVideoChunk chunk_copy = *entry.chunk;
-
-      // metadata を dict に変換 (存在しない場合は空の dict)
-      nb::dict metadata_dict;
-      if (entry.metadata.has_value() &&
-          entry.metadata->decoder_config.has_value()) {
-        const auto& config = entry.metadata->decoder_config.value();
-        nb::dict decoder_config_dict;
-        decoder_config_dict["codec"] = config.codec;
-        if (config.coded_width.has_value()) {
-          decoder_config_dict["coded_width"] = config.coded_width.value();
-        }
-        if (config.coded_height.has_value()) {
-          decoder_config_dict["coded_height"] = config.coded_height.value();
-        }
-        if (config.description.has_value()) {
-          const auto& desc = config.description.value();
-          decoder_config_dict["description"] = nb::bytes(
-              reinterpret_cast<const char*>(desc.data()), desc.size());
-        }
-        metadata_dict["decoder_config"] = decoder_config_dict;
-      }
+      nb::dict metadata_dict = metadata_to_dict(entry.metadata);
 
       // callback を呼び出す
       // Python 側では def on_output(chunk, metadata=None): と定義することを推奨
@@ -806,84 +1874,298 @@ void VideoEncoder::handle_output(
   }
 }
 
+void VideoEncoder::deliver_output_batch(bool force) {
+  std::vector<OutputEntry> entries;
+  {
+    std::lock_guard<std::mutex> lock(output_mutex_);
+    if (output_batch_.empty() ||
+        (!force && output_batch_.size() < kMaxOutputBatchSize)) {
+      return;
+    }
+    entries.swap(output_batch_);
+  }
+
+  nb::object output_cb;
+  nb::object output_batch_cb;
+  bool has_output;
+  bool has_output_batch;
+  {
+    nb::ft_lock_guard guard(callback_mutex_);
+    output_cb = output_callback_;
+    output_batch_cb = output_batch_callback_;
+    has_output = has_output_callback_;
+    has_output_batch = has_output_batch_callback_;
+  }
+
+  nb::gil_scoped_acquire gil;
+  if (has_output_batch && !output_batch_cb.is_none()) {
+    // 1 回の GIL 取得と 1 回の呼び出しでまとめて渡す
+    nb::list batch;
+    for (auto& entry : entries) {
+      batch.append(nb::make_tuple(nb::cast(*entry.chunk),
+                                  metadata_to_dict(entry.metadata)));
+    }
+    output_batch_cb(batch);
+  } else if (has_output && !output_cb.is_none()) {
+    // 溜めている間に output_batch コールバックが外された場合は 1 つずつ出力する
+    for (auto& entry : entries) {
+      output_cb(*entry.chunk, metadata_to_dict(entry.metadata));
+    }
+  }
+}
+
+// VideoEncoderEncodeOptions の dict を EncodeOptions に変換する
+// dict アクセスには GIL が必要なので、GIL を保持したまま呼び出すこと
+static VideoEncoder::EncodeOptions parse_encode_options(nb::dict options) {
+  VideoEncoder::EncodeOptions encode_options;
+  if (options.contains("key_frame")) {
+    encode_options.keyframe = nb::cast<bool>(options["key_frame"]);
+  }
+  if (options.contains("transfer")) {
+    encode_options.transfer = nb::cast<bool>(options["transfer"]);
+  }
+
+  // AV1 オプションを解析
+  if (options.contains("av1")) {
+    nb::dict av1_dict = nb::cast<nb::dict>(options["av1"]);
+    VideoEncoder::AV1EncodeOptions av1_options;
+    if (av1_dict.contains("quantizer")) {
+      av1_options.quantizer = nb::cast<uint16_t>(av1_dict["quantizer"]);
+    }
+    encode_options.av1 = av1_options;
+  }
+
+  // AVC オプションを解析
+  if (options.contains("avc")) {
+    nb::dict avc_dict = nb::cast<nb::dict>(options["avc"]);
+    VideoEncoder::AVCEncodeOptions avc_options;
+    if (avc_dict.contains("quantizer")) {
+      avc_options.quantizer = nb::cast<uint16_t>(avc_dict["quantizer"]);
+    }
+    encode_options.avc = avc_options;
+  }
+
+  // HEVC オプションを解析
+  if (options.contains("hevc")) {
+    nb::dict hevc_dict = nb::cast<nb::dict>(options["hevc"]);
+    VideoEncoder::HEVCEncodeOptions hevc_options;
+    if (hevc_dict.contains("quantizer")) {
+      hevc_options.quantizer = nb::cast<uint16_t>(hevc_dict["quantizer"]);
+    }
+    encode_options.hevc = hevc_options;
+  }
+  return encode_options;
+}
+
+// 同期モードで返すチャンクを (chunk, metadata) のリストに変換する
+// (GIL を保持して呼び出す)
+static nb::list entries_to_list(
+    const std::vector<VideoEncoder::OutputEntry>& entries) {
+  nb::list list;
+  for (const auto& entry : entries) {
+    list.append(nb::make_tuple(nb::cast(*entry.chunk),
+                               metadata_to_dict(entry.metadata)));
+  }
+  return list;
+}
+
 void init_video_encoder(nb::module_& m) {
   nb::class_<VideoEncoder>(m, "VideoEncoder")
-      .def(nb::init<nb::object, nb::object>(), "output"_a, "error"_a,
+      .def(nb::init<nb::object, nb::object, std::shared_ptr<WorkerPool>,
+                    bool>(),
+           "output"_a, "error"_a, nb::kw_only(),
+           "worker_pool"_a.none() = nb::none(), "output_queue"_a = false,
            nb::sig("def __init__(self, output: "
-                   "typing.Callable[[EncodedVideoChunk], None], "
-                   "error: typing.Callable[[str], None], /) -> None"))
+                   "typing.Callable[[EncodedVideoChunk], None] | None, "
+                   "error: typing.Callable[[str], None], /, *, "
+                   "worker_pool: WorkerPool | None = None, "
+                   "output_queue: bool = False) -> None"))
       .def("configure", &VideoEncoder::configure, "config"_a,
            nb::sig("def configure(self, config: webcodecs.VideoEncoderConfig, "
                    "/) -> None"))
       // WebCodecs 互換: encode(frame) または encode(frame, {"key_frame": True})
       .def(
           "encode",
-          [](VideoEncoder& self, const VideoFrame& frame) {
+          [](VideoEncoder& self, VideoFrame& frame) {
             self.encode(frame, false);
           },
           "frame"_a, nb::call_guard<nb::gil_scoped_release>(),
           nb::sig("def encode(self, frame: VideoFrame, /) -> None"))
       .def(
           "encode",
-          [](VideoEncoder& self, const VideoFrame& frame, nb::dict options) {
-            VideoEncoder::EncodeOptions encode_options;
-
+          [](VideoEncoder& self, VideoFrame& frame, nb::dict options) {
             // dict アクセスには GIL が必要なので、ここでは解放しない
-            if (options.contains("key_frame")) {
-              encode_options.keyframe = nb::cast<bool>(options["key_frame"]);
-            }
+            VideoEncoder::EncodeOptions encode_options =
+                parse_encode_options(options);
 
-            // AV1 オプションを解析
-            if (options.contains("av1")) {
-              nb::dict av1_dict = nb::cast<nb::dict>(options["av1"]);
-              VideoEncoder::AV1EncodeOptions av1_options;
-              if (av1_dict.contains("quantizer")) {
-                av1_options.quantizer =
-                    nb::cast<uint16_t>(av1_dict["quantizer"]);
-              }
-              encode_options.av1 = av1_options;
+            // GIL を手動で解放してエンコード実行
+            {
+              nb::gil_scoped_release gil;
+              self.encode(frame, encode_options);
             }
-
-            // AVC オプションを解析
-            if (options.contains("avc")) {
-              nb::dict avc_dict = nb::cast<nb::dict>(options["avc"]);
-              VideoEncoder::AVCEncodeOptions avc_options;
-              if (avc_dict.contains("quantizer")) {
-                avc_options.quantizer =
-                    nb::cast<uint16_t>(avc_dict["quantizer"]);
-              }
-              encode_options.avc = avc_options;
+          },
+          "frame"_a, "options"_a,
+          nb::sig("def encode(self, frame: VideoFrame, options: "
+                  "webcodecs.VideoEncoderEncodeOptions, /) -> None"))
+      .def(
+          "encode_many",
+          [](VideoEncoder& self, nb::sequence frames, nb::object options) {
+            // 変換は GIL を保持したまま行う
+            std::vector<VideoFrame*> frame_ptrs;
+            for (nb::handle frame : frames) {
+              frame_ptrs.push_back(&nb::cast<VideoFrame&>(frame));
             }
-
-            // HEVC オプションを解析
-            if (options.contains("hevc")) {
-              nb::dict hevc_dict = nb::cast<nb::dict>(options["hevc"]);
-              VideoEncoder::HEVCEncodeOptions hevc_options;
-              if (hevc_dict.contains("quantizer")) {
-                hevc_options.quantizer =
-                    nb::cast<uint16_t>(hevc_dict["quantizer"]);
+            std::vector<VideoEncoder::EncodeOptions> encode_options;
+            if (nb::isinstance<nb::dict>(options)) {
+              encode_options.push_back(
+                  parse_encode_options(nb::borrow<nb::dict>(options)));
+            } else if (!options.is_none()) {
+              for (nb::handle item : options) {
+                encode_options.push_back(
+                    parse_encode_options(nb::cast<nb::dict>(item)));
               }
-              encode_options.hevc = hevc_options;
             }
 
             // GIL を手動で解放してエンコード実行
             {
               nb::gil_scoped_release gil;
-              self.encode(frame, encode_options);
+              self.encode_many(frame_ptrs, encode_options);
             }
           },
-          "frame"_a, "options"_a,
-          nb::sig("def encode(self, frame: VideoFrame, options: "
-                  "webcodecs.VideoEncoderEncodeOptions, /) -> None"))
+          "frames"_a, "options"_a = nb::none(),
+          nb::sig("def encode_many(self, frames: typing.Sequence[VideoFrame], "
+                  "options: webcodecs.VideoEncoderEncodeOptions | "
+                  "typing.Sequence[webcodecs.VideoEncoderEncodeOptions] | "
+                  "None = None, /) -> None"))
       .def("flush", &VideoEncoder::flush,
            nb::call_guard<nb::gil_scoped_release>(),
            nb::sig("def flush(self, /) -> None"))
+      .def(
+          "encode_sync",
+          [](VideoEncoder& self, VideoFrame& frame, nb::object options) {
+            // dict アクセスには GIL が必要なので、変換してから GIL を解放する
+            VideoEncoder::EncodeOptions encode_options;
+            if (!options.is_none()) {
+              encode_options =
+                  parse_encode_options(nb::cast<nb::dict>(options));
+            }
+            std::vector<VideoEncoder::OutputEntry> entries;
+            {
+              nb::gil_scoped_release gil;
+              entries = self.encode_sync(frame, encode_options);
+            }
+            return entries_to_list(entries);
+          },
+          "frame"_a, "options"_a = nb::none(),
+          nb::sig("def encode_sync(self, frame: VideoFrame, options: "
+                  "webcodecs.VideoEncoderEncodeOptions | None = None, /) -> "
+                  "list[tuple[EncodedVideoChunk, "
+                  "webcodecs.EncodedVideoChunkMetadata]]"))
+      .def(
+          "flush_sync",
+          [](VideoEncoder& self) {
+            std::vector<VideoEncoder::OutputEntry> entries;
+            {
+              nb::gil_scoped_release gil;
+              entries = self.flush_sync();
+            }
+            return entries_to_list(entries);
+          },
+          nb::sig("def flush_sync(self, /) -> list[tuple[EncodedVideoChunk, "
+                  "webcodecs.EncodedVideoChunkMetadata]]"))
+      .def(
+          "read",
+          [](VideoEncoder& self, std::optional<double> timeout) -> nb::object {
+            std::optional<VideoEncoder::OutputEntry> entry;
+            {
+              nb::gil_scoped_release gil;
+              entry = self.read_output(timeout, false);
+            }
+            if (!entry) {
+              return nb::none();
+            }
+            return nb::make_tuple(nb::cast(*entry->chunk),
+                                  metadata_to_dict(entry->metadata));
+          },
+          "timeout"_a = nb::none(),
+          nb::sig("def read(self, timeout: float | None = None) -> "
+                  "tuple[EncodedVideoChunk, "
+                  "webcodecs.EncodedVideoChunkMetadata] | None"))
+      .def(
+          "read_all",
+          [](VideoEncoder& self) {
+            return entries_to_list(self.read_all_outputs());
+          },
+          nb::sig("def read_all(self, /) -> list[tuple[EncodedVideoChunk, "
+                  "webcodecs.EncodedVideoChunkMetadata]]"))
+      .def("__iter__", [](nb::object self) { return self; },
+           nb::sig("def __iter__(self, /) -> typing.Iterator[tuple["
+                   "EncodedVideoChunk, webcodecs.EncodedVideoChunkMetadata]]"))
+      .def(
+          "__next__",
+          [](VideoEncoder& self) {
+            std::optional<VideoEncoder::OutputEntry> entry;
+            {
+              nb::gil_scoped_release gil;
+              entry = self.read_output(std::nullopt, true);
+            }
+            if (!entry) {
+              throw nb::stop_iteration();
+            }
+            return nb::make_tuple(nb::cast(*entry->chunk),
+                                  metadata_to_dict(entry->metadata));
+          },
+          nb::sig("def __next__(self, /) -> tuple[EncodedVideoChunk, "
+                  "webcodecs.EncodedVideoChunkMetadata]"))
+      .def_prop_ro("output_queue_size", &VideoEncoder::output_queue_size,
+                   nb::sig("def output_queue_size(self, /) -> int"))
+      .def_prop_ro("output_queue_fd", &VideoEncoder::output_queue_fd,
+                   nb::sig("def output_queue_fd(self, /) -> int"))
+      .def("clear_output_queue_fd", &VideoEncoder::clear_output_queue_fd,
+           nb::sig("def clear_output_queue_fd(self, /) -> None"))
+      .def("request_flush", &VideoEncoder::request_flush,
+           nb::sig("def request_flush(self, /) -> int"))
+      .def_prop_ro("completed_flushes", &VideoEncoder::completed_flushes,
+                   nb::sig("def completed_flushes(self, /) -> int"))
+      .def(
+          "flush_async",
+          [](nb::object self) {
+            return nb::module_::import_("webcodecs._asyncio")
+                .attr("flush_async")(self);
+          },
+          nb::sig("def flush_async(self, /) -> "
+                  "typing.Coroutine[typing.Any, typing.Any, None]"))
+      .def(
+          "chunks",
+          [](nb::object self) {
+            return nb::module_::import_("webcodecs._asyncio")
+                .attr("outputs")(self);
+          },
+          nb::sig("def chunks(self, /) -> typing.AsyncIterator[tuple["
+                  "EncodedVideoChunk, webcodecs.EncodedVideoChunkMetadata]]"))
       .def("reset", &VideoEncoder::reset, nb::sig("def reset(self, /) -> None"))
       .def("close", &VideoEncoder::close, nb::sig("def close(self, /) -> None"))
       .def_prop_ro("state", &VideoEncoder::state,
                    nb::sig("def state(self, /) -> CodecState"))
       .def_prop_ro("encode_queue_size", &VideoEncoder::encode_queue_size,
                    nb::sig("def encode_queue_size(self, /) -> int"))
+      .def_prop_ro(
+          "encode_queue_high_water_mark",
+          &VideoEncoder::encode_queue_high_water_mark,
+          nb::sig("def encode_queue_high_water_mark(self, /) -> int"))
+      .def_prop_ro("encode_queue_dropped", &VideoEncoder::encode_queue_dropped,
+                   nb::sig("def encode_queue_dropped(self, /) -> int"))
+      .def_prop_ro("last_reconfigure", &VideoEncoder::last_reconfigure,
+                   nb::sig("def last_reconfigure(self, /) -> "
+                           "typing.Literal['hot', 'cold'] | None"))
+      .def_prop_ro("hot_reconfigure_count",
+                   &VideoEncoder::hot_reconfigure_count,
+                   nb::sig("def hot_reconfigure_count(self, /) -> int"))
+      .def_prop_ro("cold_reconfigure_count",
+                   &VideoEncoder::cold_reconfigure_count,
+                   nb::sig("def cold_reconfigure_count(self, /) -> int"))
+      .def("frame_pool_stats", &VideoEncoder::frame_pool_stats,
+           nb::sig("def frame_pool_stats(self, /) -> webcodecs.FramePoolStats"))
       .def_static(
           "is_config_supported",
           [](nb::dict config_dict) {
@@ -933,6 +2215,30 @@ void init_video_encoder(nb::module_& m) {
               config.hardware_acceleration_engine =
                   nb::cast<HardwareAccelerationEngine>(
                       config_dict["hardware_acceleration_engine"]);
+            if (config_dict.contains("reorder_capacity"))
+              config.reorder_capacity =
+                  nb::cast<uint32_t>(config_dict["reorder_capacity"]);
+            if (config_dict.contains("max_queue_size"))
+              config.max_queue_size =
+                  nb::cast<uint32_t>(config_dict["max_queue_size"]);
+            if (config_dict.contains("max_queue_bytes"))
+              config.max_queue_bytes =
+                  nb::cast<uint64_t>(config_dict["max_queue_bytes"]);
+            if (config_dict.contains("queue_full_policy"))
+              config.queue_full_policy =
+                  nb::cast<QueueFullPolicy>(config_dict["queue_full_policy"]);
+            if (config_dict.contains("segment_frames") &&
+                !config_dict["segment_frames"].is_none())
+              config.segment_frames =
+                  nb::cast<uint32_t>(config_dict["segment_frames"]);
+            if (config_dict.contains("segment_threads") &&
+                !config_dict["segment_threads"].is_none())
+              config.segment_threads =
+                  nb::cast<uint32_t>(config_dict["segment_threads"]);
+            if (config_dict.contains("av1_encoder") &&
+                !config_dict["av1_encoder"].is_none())
+              config.av1_encoder = nb::cast<AV1EncoderImplementation>(
+                  config_dict["av1_encoder"]);
 
             return VideoEncoder::is_config_supported(config);
           },
@@ -948,6 +2254,11 @@ void init_video_encoder(nb::module_& m) {
                    "/) -> None"))
       .def("on_dequeue", &VideoEncoder::on_dequeue,
            nb::sig("def on_dequeue(self, callback: typing.Callable[[], None], "
+                   "/) -> None"))
+      .def("on_output_batch", &VideoEncoder::on_output_batch,
+           nb::sig("def on_output_batch(self, callback: typing.Callable[["
+                   "list[tuple[EncodedVideoChunk, "
+                   "webcodecs.EncodedVideoChunkMetadata]]], None] | None, "
                    "/) -> None"));
 }
 
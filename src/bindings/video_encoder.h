@@ -8,10 +8,12 @@
 #include <map>
 #include <memory>
 #include <mutex>
+#include <deque>
 #include <optional>
 #include <queue>
 #include <string>
 #include <thread>
+#include <utility>
 #include <vector>
 
 #include <aom/aom_codec.h>
@@ -23,7 +25,11 @@
 #include <vpx/vpx_encoder.h>
 #endif
 #include "codec_parser.h"
+#include "output_queue.h"
+#include "scalability_mode.h"
+#include "sequence_ring.h"
 #include "webcodecs_types.h"
+#include "worker_pool.h"
 
 #include "video_frame.h"
 
@@ -73,6 +79,8 @@ class VideoEncoder {
   // エンコードオプション
   struct EncodeOptions {
     bool keyframe = false;
+    // true の場合はフレームのバッファをコピーせずに受け取り、フレームを close する
+    bool transfer = false;
     std::optional<AV1EncodeOptions> av1;
     std::optional<AVCEncodeOptions> avc;
     std::optional<HEVCEncodeOptions> hevc;
@@ -90,22 +98,93 @@ class VideoEncoder {
     std::optional<uint16_t> vp8_quantizer;   // VP8 の quantizer オプション
     std::optional<uint16_t> vp9_quantizer;   // VP9 の quantizer オプション
     uint64_t sequence_number;                // タスクの順序を保持
+    size_t bytes = 0;  // max_queue_bytes の計算に使うバイト数
+    // request_flush() で追加した flush タスク (フレームは持たない)
+    bool flush = false;
+  };
+
+  // 出力エントリ (chunk と metadata のペア)
+  struct OutputEntry {
+    std::shared_ptr<EncodedVideoChunk> chunk;
+    std::optional<EncodedVideoChunkMetadata> metadata;
   };
 
   // コールバックを直接受け取るコンストラクタ
-  VideoEncoder(nb::object output, nb::object error);
+  // worker_pool を指定した場合は専用スレッドの代わりにプールのスレッドで処理する
+  // output_queue が true の場合は出力コールバックの代わりに出力キューに溜める
+  VideoEncoder(nb::object output,
+               nb::object error,
+               std::shared_ptr<WorkerPool> worker_pool = nullptr,
+               bool output_queue = false);
   ~VideoEncoder();
 
   // dict を受け取る configure
   void configure(nb::dict config);
-  void encode(const VideoFrame& frame, bool keyframe = false);
-  void encode(const VideoFrame& frame, const EncodeOptions& options);
+  void encode(VideoFrame& frame, bool keyframe = false);
+  void encode(VideoFrame& frame, const EncodeOptions& options);
+  // 複数のフレームをまとめてキューに追加する（独自拡張）
+  // options は空 (既定値)、1 要素 (全フレーム共通)、frames と同じ長さのいずれか
+  // キューのロックと on_dequeue の呼び出しはバッチごとに 1 回
+  void encode_many(const std::vector<VideoFrame*>& frames,
+                   const std::vector<EncodeOptions>& options);
   void flush();
   void reset();
   void close();
 
+  // 同期モード（独自拡張）
+  // ワーカースレッドを経由せず、呼び出し元のスレッドでエンコードする
+  // 出力コールバックは呼び出さず、順序が確定したチャンクを戻り値で返す
+  std::vector<OutputEntry> encode_sync(VideoFrame& frame,
+                                       const EncodeOptions& options);
+  // flush() と同じ処理を行い、残りのチャンクを戻り値で返す
+  std::vector<OutputEntry> flush_sync();
+
+  // 出力キューモード（独自拡張）
+  // 出力キューからチャンクを 1 つ取り出す。取り出せなかった場合は nullopt を返す
+  // timeout (秒) が nullopt の場合は close() されるまで待機する
+  // until_idle が true の場合は処理待ちのタスクがなくなった時点でも待機をやめる
+  std::optional<OutputEntry> read_output(std::optional<double> timeout,
+                                         bool until_idle);
+  // 出力キューのチャンクを待機せずに全て取り出す
+  std::vector<OutputEntry> read_all_outputs();
+  // 出力キューに溜まっているチャンク数
+  uint32_t output_queue_size() const {
+    return output_queue_ ? static_cast<uint32_t>(output_queue_->size()) : 0;
+  }
+  // 出力の追加やタスクの完了、close() の度に読み込み可能になるファイルディスクリプタ
+  // asyncio のイベントループで監視する
+  int output_queue_fd();
+  // output_queue_fd() の通知を読み捨てる
+  void clear_output_queue_fd();
+  // 処理待ちのタスクの後ろに flush タスクを追加し、その番号を返す (flush_async() から使用)
+  // ワーカーがエンコーダー内部に残っているフレームを出力し終えると completed_flushes が
+  // その番号に達し、output_queue_fd() に通知する
+  uint64_t request_flush();
+  uint64_t completed_flushes() const { return completed_flushes_.load(); }
+
   CodecState state() const { return state_; }
   uint32_t encode_queue_size() const { return pending_tasks_.load(); }
+  // encode_queue_size の最大値（独自拡張）
+  uint32_t encode_queue_high_water_mark() const {
+    return queue_high_water_mark_.load();
+  }
+  // DROP_OLDEST でキューから破棄したフレーム数（独自拡張）
+  uint64_t encode_queue_dropped() const { return queue_dropped_.load(); }
+  // 直前の再設定の方法（独自拡張）
+  // "hot" はエンコーダーをそのまま使い、"cold" は作り直した。再設定していない場合は None
+  std::optional<std::string> last_reconfigure() const {
+    if (last_reconfigure_.empty()) {
+      return std::nullopt;
+    }
+    return last_reconfigure_;
+  }
+  uint64_t hot_reconfigure_count() const { return hot_reconfigure_count_; }
+  uint64_t cold_reconfigure_count() const { return cold_reconfigure_count_; }
+
+  // エンコード待ちフレームのコピーが使うバッファプールの統計情報
+  nb::dict frame_pool_stats() const {
+    return frame_pool_stats_to_dict(frame_pool_->stats());
+  }
 
   void on_output(nb::object callback) {
     nb::ft_lock_guard guard(callback_mutex_);
@@ -122,6 +201,13 @@ class VideoEncoder {
     dequeue_callback_ = callback;
     has_dequeue_callback_ = !callback.is_none();
   }
+  // 出力を list[tuple[EncodedVideoChunk, dict]] でまとめて受け取るコールバック（独自拡張）
+  // 設定されている場合は output コールバックの代わりに呼び出す
+  void on_output_batch(nb::object callback) {
+    nb::ft_lock_guard guard(callback_mutex_);
+    output_batch_callback_ = callback;
+    has_output_batch_callback_ = !callback.is_none();
+  }
 
   // Static method to check if configuration is supported
   static VideoEncoderSupport is_config_supported(
@@ -135,53 +221,210 @@ class VideoEncoder {
       std::optional<EncodedVideoChunkMetadata> metadata = std::nullopt);
 
  private:
-  aom_codec_ctx_t* aom_encoder_;
-  aom_codec_enc_cfg_t aom_config_;
-  const aom_codec_iface_t* aom_iface_;
-
   VideoEncoderConfig config_;     // 内部で保持する設定
   CodecParameters codec_params_;  // パースしたコーデックパラメータ
+  ScalabilityMode scalability_;   // パースした scalability_mode
   CodecState state_;
-  std::atomic<int64_t> frame_count_{0};
+
+  // 構成済みの状態で configure() した回数 (再設定の方法ごと)
+  std::string last_reconfigure_;
+  uint64_t hot_reconfigure_count_{0};
+  uint64_t cold_reconfigure_count_{0};
+
+  // GOP 並列エンコード (segment_frames) のためのメンバー
+  // キーフレームから始まるセグメントごとに独立したエンコーダーを作り、
+  // segment_pool_ のスレッドで並列にエンコードする (レート制御もセグメントごとに独立する)
+  struct Segment {
+    std::vector<EncodeTask> tasks;
+    // セグメントのエンコーダーが出力したチャンク (入力フレームのシーケンス番号との組)
+    std::vector<std::pair<uint64_t, OutputEntry>> outputs;
+    std::string error;  // エンコードに失敗した場合のエラーメッセージ
+    bool done = false;  // segment_mutex_ で保護
+  };
+  // フレームを溜めているセグメント (ワーカースレッドと、ワーカーが待機中の flush() から使用)
+  std::shared_ptr<Segment> current_segment_;
+  // エンコード中または出力待ちのセグメント (投入順、segment_mutex_ で保護)
+  std::deque<std::shared_ptr<Segment>> segments_;
+  std::atomic<uint32_t> pending_segments_{0};  // segments_ の数
+  bool segments_cancelled_{false};  // close() で出力せずに破棄する (segment_mutex_ で保護)
+  std::mutex segment_mutex_;
+  std::condition_variable segment_cv_;
+  std::mutex segment_output_mutex_;  // セグメントの出力を投入順に直列化する
+  std::shared_ptr<WorkerPool> segment_pool_;
+
+  // libaom / libvpx に渡したがまだパケットとして出力されていないフレーム
+  // 先読み (lag_in_frames) でパケットの出力が遅延しても、パケットの pts から
+  // 元のフレームのシーケンス番号・タイムスタンプ・metadata を取得する
+  // aom_mutex または vpx_mutex を保持して使用する
+  struct PendingInput {
+    uint64_t sequence;
+    int64_t timestamp;
+    uint64_t duration;
+    std::optional<EncodedVideoChunkMetadata> metadata;
+  };
+
+  // ソフトウェアエンコーダー (libaom / libvpx / SVT-AV1) の状態
+  // ワーカースレッドでは context_ を使い、GOP 並列エンコードではセグメントごとに作成する
+  struct EncoderContext {
+    aom_codec_ctx_t* aom_encoder = nullptr;
+    aom_codec_enc_cfg_t aom_config;
+    const aom_codec_iface_t* aom_iface = nullptr;
+    // libaom の初期化とエンコードを直列化するためのミューテックス
+    std::mutex aom_mutex;
+
+#if defined(__APPLE__) || defined(__linux__)
+    vpx_codec_ctx_t* vpx_encoder = nullptr;
+    vpx_codec_enc_cfg_t vpx_config;
+    const vpx_codec_iface_t* vpx_iface = nullptr;
+    std::mutex vpx_mutex;
+
+    void* svt_av1_encoder = nullptr;  // EbComponentType*
+    // キーフレームのテンポラルユニットにシーケンスヘッダーがない場合に付加する
+    std::vector<uint8_t> svt_av1_sequence_header;
+    uint32_t svt_av1_qp = 0;  // QUANTIZER モードで現在設定している QP
+    // SVT-AV1 の初期化とエンコードを直列化するためのミューテックス
+    std::mutex svt_av1_mutex;
+#endif
+
+    std::map<int64_t, PendingInput> pending_inputs;  // pts → 入力フレーム
+    // 次に libaom / libvpx に渡すフレームの pts (90kHz)
+    std::atomic<int64_t> next_pts{0};
+    // 時間レイヤーのパターン内の位置 (キーフレームで 0 に戻す)
+    uint64_t scalability_frame_index = 0;
+    uint64_t current_sequence = 0;  // 現在処理中のシーケンス番号
+    // I420 以外の入力を libaom / libvpx に渡すための変換先バッファ
+    std::vector<uint8_t> i420_input;
+
+    // セグメントのエンコーダーの場合の出力先 (並べ替えずに追加する、通常は nullptr)
+    std::vector<std::pair<uint64_t, OutputEntry>>* segment_outputs = nullptr;
+    // 同時にエンコードするセグメント数 (エンコーダーのスレッド数をこの数で分ける)
+    uint32_t parallelism = 1;
+  };
+  // ワーカースレッドで使うエンコーダーの状態
+  // ハードウェアエンコーダーと OpenH264 も pending_inputs と current_sequence を使う
+  EncoderContext context_;
 
   nb::object output_callback_;
   nb::object error_callback_;
   nb::object dequeue_callback_;
+  nb::object output_batch_callback_;
   nb::ft_mutex callback_mutex_;  // Free-Threading 用コールバック保護
   bool has_output_callback_{false};
   bool has_error_callback_{false};
   bool has_dequeue_callback_{false};
+  bool has_output_batch_callback_{false};
 
   // 並列処理のためのメンバー
-  std::queue<EncodeTask> encode_queue_;     // エンコード待ちタスクのキュー
+  std::deque<EncodeTask> encode_queue_;     // エンコード待ちタスクのキュー
   std::atomic<uint32_t> pending_tasks_{0};  // 処理待ちタスク数
+  size_t pending_bytes_{0};  // 処理待ちタスクのバイト数 (queue_mutex_ で保護)
+  std::atomic<uint32_t> queue_high_water_mark_{0};  // pending_tasks_ の最大値
+  std::atomic<uint64_t> queue_dropped_{0};          // 破棄したフレーム数
   std::atomic<uint64_t> next_sequence_number_{0};  // タスクのシーケンス番号
+  // request_flush() で追加した flush タスクの数と処理し終えた数 (queue_mutex_ を保持して更新する)
+  // reset() で破棄した flush タスクは処理し終えたものとして扱う
+  std::atomic<uint64_t> requested_flushes_{0};
+  std::atomic<uint64_t> completed_flushes_{0};
   std::mutex queue_mutex_;                         // キューアクセスの同期
   std::condition_variable queue_cv_;               // キューの待機/通知
   // flush() が処理完了を待機できるように queue_cv_ を流用して通知する
   std::thread worker_thread_;             // ワーカースレッド
+  std::shared_ptr<WorkerPool> worker_pool_;        // 共有するワーカープール
+  std::shared_ptr<WorkerStrand> worker_strand_;    // プールで処理する場合のストランド
   std::atomic<bool> should_stop_{false};  // スレッド終了フラグ
-  uint64_t current_sequence_{0};          // 現在処理中のシーケンス番号
 
-  // 出力エントリ (chunk と metadata のペア)
-  struct OutputEntry {
-    std::shared_ptr<EncodedVideoChunk> chunk;
-    std::optional<EncodedVideoChunkMetadata> metadata;
-  };
+  // エンコード待ちフレームのコピーに使うバッファプール
+  std::shared_ptr<FramePool> frame_pool_ = std::make_shared<FramePool>();
 
   // 出力順序制御のためのメンバー
-  std::map<uint64_t, OutputEntry> output_buffer_;  // 順序待ちバッファ
-  uint64_t next_output_sequence_{0};  // 次に出力すべきシーケンス番号
-  std::mutex output_mutex_;           // 出力バッファの同期
-
-  void handle_encoded_frame(const uint8_t* data,
+  // シーケンス番号順に並べ替えるリング (容量は reorder_capacity で指定)
+  SequenceRing<OutputEntry> output_ring_;
+  std::mutex output_mutex_;  // 出力バッファの同期
+
+  // バッチ出力のためのメンバー
+  // ワーカースレッドで出力されたチャンクを溜め、キューが空になるか
+  // 上限に達した時点で output_batch コールバックをまとめて呼び出す
+  static constexpr size_t kMaxOutputBatchSize = 64;
+  std::vector<OutputEntry> output_batch_;  // output_mutex_ で保護
+
+  // 同期モードのためのメンバー
+  // sync_thread_ で実行中に出力されたチャンクはコールバックを呼ばずに sync_outputs_ に追加する
+  std::mutex sync_mutex_;  // 同期モードの呼び出しを直列化する
+  std::atomic<std::thread::id> sync_thread_{};
+  std::vector<OutputEntry>* sync_outputs_{nullptr};
+
+  // 出力キューモードで順序が確定したチャンクを溜めるキュー (無効の場合は nullptr)
+  std::unique_ptr<OutputQueue<OutputEntry>> output_queue_;
+
+  // オプションを検証してエンコードタスクを作成する (frame は設定しない)
+  static EncodeTask make_encode_task(const EncodeOptions& options);
+  // VideoToolbox 用の AVC/HEVC quantizer を検証して取得する
+  static std::optional<uint16_t> videotoolbox_quantizer(
+      const EncodeOptions& options);
+
+  // ビットレートとフレームレートだけが変わる場合に、エンコーダーを作り直さずに反映する
+  // 反映できた場合は true を返し、それ以外は作り直す必要がある
+  bool reconfigure_in_place(const VideoEncoderConfig& config);
+  // 全てのバックエンドのエンコーダーを破棄する
+  void cleanup_encoders();
+  // ctx の libaom / libvpx / SVT-AV1 エンコーダーを破棄する
+  void cleanup_software_encoders(EncoderContext& ctx);
+  // reorder_capacity に合わせて出力を並べ替えるリングの容量を変更する
+  void resize_output_ring();
+
+  // 順序が確定したチャンクを出力する
+  // バッチ出力が有効でワーカースレッドから呼ばれた場合は output_batch_ に溜める
+  void emit_entries(std::vector<OutputEntry> entries);
+  // output_batch_ のチャンクを出力する
+  // force が false の場合は上限に達しているときだけ出力する
+  void deliver_output_batch(bool force);
+  // 呼び出し元のスレッドで fn を実行し、その間に出力されたチャンクを返す
+  std::vector<OutputEntry> run_sync(const std::function<void()>& fn);
+
+  // 現在処理中のフレームを pts と対応付けて ctx.pending_inputs に記録する
+  void register_pending_input(
+      EncoderContext& ctx,
+      int64_t pts,
+      const VideoFrame& frame,
+      std::optional<EncodedVideoChunkMetadata> metadata);
+  // pts に対応する入力フレームのシーケンス番号・タイムスタンプでパケットを出力する
+  // 対応する入力フレームがない場合はパケットを破棄する
+  // セグメントのエンコーダーでは ctx.segment_outputs に追加する
+  void handle_encoded_frame(EncoderContext& ctx,
+                            const uint8_t* data,
                             size_t size,
-                            int64_t timestamp,
+                            int64_t pts,
                             bool keyframe);
-
-  void init_aom_encoder();
-  void cleanup_aom_encoder();
-  void encode_frame_aom(const VideoFrame& frame,
+  // scalability_mode が指定されている場合に temporal_layer_id を含む metadata を返す
+  std::optional<EncodedVideoChunkMetadata> make_svc_metadata(
+      int temporal_layer_id) const;
+
+  // libaom / libvpx に渡す I420 のプレーンとストライドを取得する
+  // I420 以外は ctx.i420_input に変換しながら書き込み、そのプレーンを返す
+  void get_i420_input(EncoderContext& ctx,
+                      const VideoFrame& frame,
+                      unsigned char* planes[3],
+                      int strides[3]);
+
+  void init_aom_encoder(EncoderContext& ctx);
+  // 先読みで libaom 内部に残っているフレームを全て出力する
+  void flush_aom_encoder(EncoderContext& ctx);
+  // scalability_mode の空間・時間レイヤーを libaom に設定する
+  void init_aom_svc(EncoderContext& ctx);
+  // ctx.aom_config の目標ビットレートからレイヤーごとの設定を作成して libaom に渡す
+  aom_codec_err_t set_aom_svc_params(EncoderContext& ctx);
+  // エンコーダーを作り直さずに目標ビットレートを変更する (失敗した場合は false)
+  bool reconfigure_aom_encoder(EncoderContext& ctx, uint64_t bitrate);
+  void cleanup_aom_encoder(EncoderContext& ctx);
+  // 空間レイヤーごとに aom_codec_encode() を呼び出し、1 つのチャンクにまとめて出力する
+  void encode_frame_aom_svc(EncoderContext& ctx,
+                            const VideoFrame& frame,
+                            const aom_image_t& img,
+                            bool keyframe,
+                            aom_codec_pts_t pts,
+                            unsigned long duration);
+  void encode_frame_aom(EncoderContext& ctx,
+                        const VideoFrame& frame,
                         bool keyframe,
                         std::optional<uint16_t> quantizer = std::nullopt);
 
@@ -202,23 +445,72 @@ class VideoEncoder {
 
 #if defined(__APPLE__) || defined(__linux__)
   // libvpx エンコーダー
-  void init_vpx_encoder();
-  void cleanup_vpx_encoder();
-  void encode_frame_vpx(const VideoFrame& frame,
+  void init_vpx_encoder(EncoderContext& ctx);
+  // ctx.vpx_config の目標ビットレートからレイヤーごとの目標ビットレートを設定する
+  void set_vpx_layer_bitrates(EncoderContext& ctx);
+  // エンコーダーを作り直さずに目標ビットレートを変更する (失敗した場合は false)
+  bool reconfigure_vpx_encoder(EncoderContext& ctx, uint64_t bitrate);
+  void cleanup_vpx_encoder(EncoderContext& ctx);
+  // 先読みで libvpx 内部に残っているフレームを全て出力する
+  void flush_vpx_encoder(EncoderContext& ctx);
+  void encode_frame_vpx(EncoderContext& ctx,
+                        const VideoFrame& frame,
                         bool keyframe,
                         std::optional<uint16_t> quantizer = std::nullopt);
-
-  vpx_codec_ctx_t* vpx_encoder_ = nullptr;
-  vpx_codec_enc_cfg_t vpx_config_;
-  const vpx_codec_iface_t* vpx_iface_ = nullptr;
-  std::mutex vpx_mutex_;
 #endif
 
   // 並列処理のためのメソッド
   void worker_loop();  // ワーカースレッドのメインループ
+  void run_next_task();  // キューの先頭のタスクを 1 つ処理する
   void process_encode_task(const EncodeTask& task);  // タスクの処理
+  // libaom / libvpx / SVT-AV1 で ctx のエンコーダーを使ってエンコードする (未作成であれば作成する)
+  void encode_software_task(EncoderContext& ctx, const EncodeTask& task);
   void start_worker();                               // ワーカースレッドの開始
   void stop_worker();                                // ワーカースレッドの停止
+  bool is_worker_running() const;  // ワーカースレッドまたはストランドが動作中か
+  bool is_worker_thread() const;   // 現在のスレッドでタスクを処理中か
+  // プールを使う場合は count 個のタスクの処理をストランドに投入する
+  void post_worker_tasks(size_t count);
+  // 順序待ちのシーケンス番号が output_ring_ の容量未満か (queue_mutex_ を保持して呼び出す)
+  // ワーカースレッドが待機中の場合は、結果が届かないシーケンス番号で止まらないよう true を返す
+  bool has_output_capacity();
+  // output_ring_ に残っているチャンクを全て出力する (flush() の最後に呼び出す)
+  void drain_output_ring();
+  // 処理待ちのタスクも処理中の flush タスクもないか (queue_mutex_ を保持して呼び出す)
+  bool is_queue_idle() const;
+  // エンコーダー内部に残っているフレームと順序待ちのチャンクを全て出力する
+  // flush() と、ワーカーで処理する flush タスクから呼び出す
+  void flush_encoder();
+  // ワーカーで flush タスクを処理し、完了を output_queue_fd() に通知する
+  void run_flush_task();
+  // max_queue_size / max_queue_bytes の上限に達しているか (queue_mutex_ を保持して呼び出す)
+  bool is_queue_full(size_t bytes);
+  // queue_full_policy に従って bytes 分の空きを作る (queue_mutex_ を保持して呼び出す)
+  void make_queue_space(std::unique_lock<std::mutex>& lock,
+                        size_t bytes,
+                        std::vector<OutputEntry>& outputs);
+  // キーフレーム指定のない最も古いタスクを破棄する (破棄できなければ false)
+  bool drop_oldest_task(std::vector<OutputEntry>& outputs);
+  // 破棄したタスクのシーケンス番号を出力順序から外す
+  void discard_sequence(uint64_t sequence, std::vector<OutputEntry>& outputs);
+  // エラーコールバックを呼び出す (GIL を取得する)
+  void report_error(const std::string& message);
+
+  // GOP 並列エンコードのためのメソッド
+  bool uses_segment_encoding() const;
+  // タスクを current_segment_ に追加し、segment_frames に達したら投入する
+  void add_segment_task(const EncodeTask& task);
+  // current_segment_ を segment_pool_ に投入する
+  // エンコード中のセグメントがスレッド数に達している間は待機する
+  void dispatch_segment();
+  // セグメント用の EncoderContext を作成し、先頭のキーフレームから最後のフレームまでエンコードする
+  void encode_segment(Segment& segment);
+  // エンコードし終えたセグメントのチャンクを投入順に handle_output() と同じリングへ出力する
+  void deliver_segments();
+  // 溜めているフレームも投入し、全てのセグメントを出力し終えるまで待機する
+  void finish_segments();
+  // エンコード中のセグメントを出力せずに破棄し、終わるまで待機する
+  void cancel_segments();
 
   // コーデック判定ヘルパーメソッド
   bool is_av1_codec() const;
@@ -232,9 +524,6 @@ class VideoEncoder {
   // プラットフォームのハードウェアアクセラレーション用の不透明ハンドル (Apple では VideoToolbox で使用)
   void* vt_session_ = nullptr;
 
-  // libaom の初期化とエンコードを直列化するためのミューテックス
-  std::mutex aom_mutex_;
-
 #if defined(USE_NVIDIA_CUDA_TOOLKIT)
   // NVIDIA Video Codec SDK (NVENC) 関連のメンバー
   void* nvenc_encoder_ = nullptr;
@@ -289,7 +578,37 @@ class VideoEncoder {
                              bool is_hevc);
 #endif
 
+#if defined(__linux__)
+  // OpenH264 (ソフトウェア H.264 エンコーダー) 関連のメンバー
+  void* openh264_encoder_ = nullptr;  // ISVCEncoder*
+  int openh264_quantizer_ = 0;  // QUANTIZER モードで現在設定している QP
+
+  // OpenH264 関連のメソッド
+  void init_openh264_encoder();
+  void encode_frame_openh264(const VideoFrame& frame,
+                             bool keyframe,
+                             std::optional<uint16_t> quantizer = std::nullopt);
+  void cleanup_openh264_encoder();
+#endif
+
+#if defined(__APPLE__) || defined(__linux__)
+  // SVT-AV1 (ソフトウェア AV1 エンコーダー) 関連のメソッド
+  void init_svt_av1_encoder(EncoderContext& ctx);
+  void encode_frame_svt_av1(EncoderContext& ctx,
+                            const VideoFrame& frame,
+                            bool keyframe,
+                            std::optional<uint16_t> quantizer = std::nullopt);
+  // エンドオブストリームを送って残りのパケットを出力し、エンコーダーを破棄する
+  // SVT-AV1 はエンドオブストリームの後にフレームを受け付けないため、次のフレームで作り直す
+  void flush_svt_av1_encoder(EncoderContext& ctx);
+  // 出力済みのパケットを全て取り出す (done の場合は EOS まで待機する)
+  void drain_svt_av1_packets(EncoderContext& ctx, bool done);
+  void cleanup_svt_av1_encoder(EncoderContext& ctx);
+#endif
+
   bool uses_intel_vpl() const;
+  bool uses_openh264() const;
+  bool uses_svt_av1() const;
 };
 
 void init_video_encoder(nb::module_& m);
@@ -2,146 +2,131 @@
 #include <aom/aomcx.h>
 #include <cstring>
 #include <thread>
+#include "thread_count.h"
 #include "video_encoder.h"
 
-// WebRTC の NumberOfThreads ロジックに準拠
-// タイル数（1, 2, 4, 8）に合わせてスレッド数を決定
-static int calculate_number_of_threads(int width,
-                                       int height,
-                                       int number_of_cores) {
-  // Keep the number of encoder threads equal to the possible number of
-  // column/row tiles, which is (1, 2, 4, 8). See comments below for
-  // AV1E_SET_TILE_COLUMNS/ROWS.
-  if (width * height > 1280 * 720 && number_of_cores > 8) {
-    return 8;
-  } else if (width * height >= 640 * 360 && number_of_cores > 4) {
-    return 4;
-  } else if (width * height >= 320 * 180 && number_of_cores > 2) {
-    return 2;
-  } else {
-    // 1 thread less than VGA.
-    return 1;
-  }
-}
-
-void VideoEncoder::init_aom_encoder() {
-  std::lock_guard<std::mutex> lock(aom_mutex_);
-  if (aom_encoder_) {
+void VideoEncoder::init_aom_encoder(EncoderContext& ctx) {
+  std::lock_guard<std::mutex> lock(ctx.aom_mutex);
+  if (ctx.aom_encoder) {
     return;  // すでに初期化済み
   }
   // AV1 エンコーダーを選択
-  aom_iface_ = aom_codec_av1_cx();
+  ctx.aom_iface = aom_codec_av1_cx();
 
   aom_codec_err_t res =
-      aom_codec_enc_config_default(aom_iface_, &aom_config_, 0);
+      aom_codec_enc_config_default(ctx.aom_iface, &ctx.aom_config, 0);
   if (res != AOM_CODEC_OK) {
     throw std::runtime_error("Failed to get default AOM encoder config");
   }
 
-  aom_config_.g_w = config_.width;
-  aom_config_.g_h = config_.height;
+  ctx.aom_config.g_w = config_.width;
+  ctx.aom_config.g_h = config_.height;
   // タイムベースは 90kHz (RTP 標準) に設定
-  aom_config_.g_timebase.num = 1;
-  aom_config_.g_timebase.den = 90000;
+  ctx.aom_config.g_timebase.num = 1;
+  ctx.aom_config.g_timebase.den = 90000;
   // Annex-B 形式はデフォルト（1）のままにする
-  // aom_config_.save_as_annexb = 0;
-  aom_config_.rc_target_bitrate =
+  // ctx.aom_config.save_as_annexb = 0;
+  ctx.aom_config.rc_target_bitrate =
       config_.bitrate.value_or(1000000) / 1000;  // kbps
 
   // ビットレートモードの設定（WebCodecs API に準拠）
   if (config_.bitrate_mode == VideoEncoderBitrateMode::CONSTANT) {
-    aom_config_.rc_end_usage = AOM_CBR;  // Constant Bitrate
+    ctx.aom_config.rc_end_usage = AOM_CBR;  // Constant Bitrate
   } else if (config_.bitrate_mode == VideoEncoderBitrateMode::VARIABLE) {
-    aom_config_.rc_end_usage = AOM_VBR;  // Variable Bitrate
+    ctx.aom_config.rc_end_usage = AOM_VBR;  // Variable Bitrate
   } else if (config_.bitrate_mode == VideoEncoderBitrateMode::QUANTIZER) {
-    aom_config_.rc_end_usage = AOM_Q;  // Constant Quality
+    ctx.aom_config.rc_end_usage = AOM_Q;  // Constant Quality
   } else {
     // デフォルトは VBR（WebCodecs API のデフォルト）
-    aom_config_.rc_end_usage = AOM_VBR;
+    ctx.aom_config.rc_end_usage = AOM_VBR;
   }
 
   // WebRTC の NumberOfThreads ロジックに準拠してスレッド数を決定
   // 解像度とコア数に応じて動的に設定（1, 2, 4, 8）
-  unsigned int number_of_cores = std::thread::hardware_concurrency();
-  aom_config_.g_threads = calculate_number_of_threads(
+  // GOP 並列エンコードのセグメントでは、同時にエンコードするセグメント数でコアを分ける
+  unsigned int number_of_cores =
+      std::thread::hardware_concurrency() / ctx.parallelism;
+  ctx.aom_config.g_threads = calculate_number_of_threads(
       config_.width, config_.height, static_cast<int>(number_of_cores));
 
   // レート制御の詳細設定（WebRTC の設定に準拠）
-  aom_config_.rc_min_quantizer = 10;  // 最小 QP（WebRTC と同じ）
-  aom_config_.rc_max_quantizer = 56;  // 最大 QP（WebRTC デフォルト）
+  ctx.aom_config.rc_min_quantizer = 10;  // 最小 QP（WebRTC と同じ）
+  ctx.aom_config.rc_max_quantizer = 56;  // 最大 QP（WebRTC デフォルト）
 
   // CBR モードでビットレートを確保するため WebRTC とは異なる設定を使用
   // WebRTC 設定: rc_min_quantizer=10, rc_max_quantizer=56, undershoot_pct=50, overshoot_pct=50
   // webcodecs-py CBR 設定: より厳密なビットレート制御のため以下のように変更
   if (config_.bitrate_mode == VideoEncoderBitrateMode::CONSTANT) {
-    aom_config_.rc_min_quantizer = 2;   // WebRTC: 10 → 2（高品質を強制）
-    aom_config_.rc_max_quantizer = 35;  // WebRTC: 56 → 35（低品質を防止）
-    aom_config_.rc_undershoot_pct =
+    ctx.aom_config.rc_min_quantizer = 2;   // WebRTC: 10 → 2（高品質を強制）
+    ctx.aom_config.rc_max_quantizer = 35;  // WebRTC: 56 → 35（低品質を防止）
+    ctx.aom_config.rc_undershoot_pct =
         0;  // WebRTC: 50 → 0（ビットレート削減を禁止）
-    aom_config_.rc_overshoot_pct = 0;  // WebRTC: 50 → 0（厳密な CBR 制御）
+    ctx.aom_config.rc_overshoot_pct = 0;  // WebRTC: 50 → 0（厳密な CBR 制御）
     // 理由: WebRTC 設定では静的シーンで大幅にビットレートが下がる（指定値の13%程度）
     //       この設定により指定ビットレートの約130%を維持し、高品質を確保
   } else {
-    aom_config_.rc_undershoot_pct =
+    ctx.aom_config.rc_undershoot_pct =
         50;  // アンダーシュートの許容率 50%（WebRTC と同じ）
-    aom_config_.rc_overshoot_pct =
+    ctx.aom_config.rc_overshoot_pct =
         50;  // オーバーシュートの許容率 50%（WebRTC と同じ）
   }
-  aom_config_.rc_buf_sz = 1000;         // バッファサイズ（ミリ秒）
-  aom_config_.rc_buf_initial_sz = 600;  // 初期バッファサイズ（ミリ秒）
-  aom_config_.rc_buf_optimal_sz = 600;  // 最適バッファサイズ（ミリ秒）
-  aom_config_.rc_dropframe_thresh = 0;  // フレームドロップ無効化
-  aom_config_.rc_resize_mode = 0;       // 動的リサイズ無効化
+  ctx.aom_config.rc_buf_sz = 1000;         // バッファサイズ（ミリ秒）
+  ctx.aom_config.rc_buf_initial_sz = 600;  // 初期バッファサイズ（ミリ秒）
+  ctx.aom_config.rc_buf_optimal_sz = 600;  // 最適バッファサイズ（ミリ秒）
+  ctx.aom_config.rc_dropframe_thresh = 0;  // フレームドロップ無効化
+  ctx.aom_config.rc_resize_mode = 0;       // 動的リサイズ無効化
 
   // コーデック文字列からパースしたパラメータを使用
   if (std::holds_alternative<AV1CodecParameters>(codec_params_)) {
     const auto& av1_params = std::get<AV1CodecParameters>(codec_params_);
-    aom_config_.g_profile = av1_params.profile;
+    ctx.aom_config.g_profile = av1_params.profile;
 
     // ビット深度の設定
     switch (av1_params.bit_depth) {
       case 8:
-        aom_config_.g_bit_depth = AOM_BITS_8;
+        ctx.aom_config.g_bit_depth = AOM_BITS_8;
         break;
       case 10:
-        aom_config_.g_bit_depth = AOM_BITS_10;
+        ctx.aom_config.g_bit_depth = AOM_BITS_10;
         break;
       case 12:
-        aom_config_.g_bit_depth = AOM_BITS_12;
+        ctx.aom_config.g_bit_depth = AOM_BITS_12;
         break;
       default:
         throw std::runtime_error("Unsupported bit depth: " +
                                  std::to_string(av1_params.bit_depth));
     }
-    aom_config_.g_input_bit_depth = av1_params.bit_depth;
+    ctx.aom_config.g_input_bit_depth = av1_params.bit_depth;
   } else {
     // デフォルト値（後方互換性のため）
-    aom_config_.g_profile = 0;  // Main profile
-    aom_config_.g_bit_depth = AOM_BITS_8;
-    aom_config_.g_input_bit_depth = 8;
+    ctx.aom_config.g_profile = 0;  // Main profile
+    ctx.aom_config.g_bit_depth = AOM_BITS_8;
+    ctx.aom_config.g_input_bit_depth = 8;
   }
   // WebCodecs API に準拠: キーフレームはアプリケーション側で明示的に制御
   // encode(frame, {key_frame: true}) でのみキーフレームを挿入
   // kf_max_dist を非常に大きな値に設定して、自動キーフレーム挿入を事実上無効化
   // 注意: kf_max_dist = 0 にすると全フレームがキーフレームになるため避ける
-  aom_config_.kf_mode = AOM_KF_AUTO;
-  aom_config_.kf_min_dist = 0;
-  aom_config_.kf_max_dist = 999999;  // 事実上無制限（30fps で約 9 時間）
+  ctx.aom_config.kf_mode = AOM_KF_AUTO;
+  ctx.aom_config.kf_min_dist = 0;
+  ctx.aom_config.kf_max_dist = 999999;  // 事実上無制限（30fps で約 9 時間）
 
   // Realtime vs quality
-  if (config_.latency_mode == LatencyMode::REALTIME) {
-    aom_config_.g_usage = AOM_USAGE_REALTIME;
-    aom_config_.g_lag_in_frames = 0;
+  // 空間・時間レイヤーは REALTIME のみ対応しているため、scalability_mode 指定時は常に REALTIME
+  if (config_.latency_mode == LatencyMode::REALTIME ||
+      scalability_.is_layered()) {
+    ctx.aom_config.g_usage = AOM_USAGE_REALTIME;
+    ctx.aom_config.g_lag_in_frames = 0;
   } else {
-    aom_config_.g_usage = AOM_USAGE_GOOD_QUALITY;
-    aom_config_.g_lag_in_frames = 25;
+    ctx.aom_config.g_usage = AOM_USAGE_GOOD_QUALITY;
+    ctx.aom_config.g_lag_in_frames = 25;
   }
 
-  aom_encoder_ = new aom_codec_ctx_t();
-  res = aom_codec_enc_init(aom_encoder_, aom_iface_, &aom_config_, 0);
+  ctx.aom_encoder = new aom_codec_ctx_t();
+  res = aom_codec_enc_init(ctx.aom_encoder, ctx.aom_iface, &ctx.aom_config, 0);
   if (res != AOM_CODEC_OK) {
-    delete aom_encoder_;
-    aom_encoder_ = nullptr;
+    delete ctx.aom_encoder;
+    ctx.aom_encoder = nullptr;
     throw std::runtime_error("Failed to initialize AOM encoder: " +
                              std::string(aom_codec_err_to_string(res)));
   }
@@ -164,88 +149,216 @@ void VideoEncoder::init_aom_encoder() {
   } else {
     cpu_used = 4;
   }
-  aom_codec_control(aom_encoder_, AOME_SET_CPUUSED, cpu_used);
+  aom_codec_control(ctx.aom_encoder, AOME_SET_CPUUSED, cpu_used);
 
   // WebRTC の追加設定（品質とパフォーマンスの最適化）
-  aom_codec_control(aom_encoder_, AV1E_SET_ENABLE_CDEF, 1);
-  aom_codec_control(aom_encoder_, AV1E_SET_ENABLE_TPL_MODEL, 0);
-  aom_codec_control(aom_encoder_, AV1E_SET_DELTAQ_MODE, 0);
-  aom_codec_control(aom_encoder_, AV1E_SET_ENABLE_ORDER_HINT, 0);
-  aom_codec_control(aom_encoder_, AV1E_SET_AQ_MODE, 3);  // 適応量子化モード
-  aom_codec_control(aom_encoder_, AOME_SET_MAX_INTRA_BITRATE_PCT, 300);
-  aom_codec_control(aom_encoder_, AV1E_SET_COEFF_COST_UPD_FREQ, 3);
-  aom_codec_control(aom_encoder_, AV1E_SET_MODE_COST_UPD_FREQ, 3);
-  aom_codec_control(aom_encoder_, AV1E_SET_MV_COST_UPD_FREQ, 3);
+  aom_codec_control(ctx.aom_encoder, AV1E_SET_ENABLE_CDEF, 1);
+  aom_codec_control(ctx.aom_encoder, AV1E_SET_ENABLE_TPL_MODEL, 0);
+  aom_codec_control(ctx.aom_encoder, AV1E_SET_DELTAQ_MODE, 0);
+  aom_codec_control(ctx.aom_encoder, AV1E_SET_ENABLE_ORDER_HINT, 0);
+  aom_codec_control(ctx.aom_encoder, AV1E_SET_AQ_MODE, 3);  // 適応量子化モード
+  aom_codec_control(ctx.aom_encoder, AOME_SET_MAX_INTRA_BITRATE_PCT, 300);
+  aom_codec_control(ctx.aom_encoder, AV1E_SET_COEFF_COST_UPD_FREQ, 3);
+  aom_codec_control(ctx.aom_encoder, AV1E_SET_MODE_COST_UPD_FREQ, 3);
+  aom_codec_control(ctx.aom_encoder, AV1E_SET_MV_COST_UPD_FREQ, 3);
 
   // タイリングとマルチスレッド
-  aom_codec_control(aom_encoder_, AV1E_SET_AUTO_TILES, 1);
-  aom_codec_control(aom_encoder_, AV1E_SET_ROW_MT, 1);
+  aom_codec_control(ctx.aom_encoder, AV1E_SET_AUTO_TILES, 1);
+  aom_codec_control(ctx.aom_encoder, AV1E_SET_ROW_MT, 1);
 
   // スーパーブロックサイズ（解像度に応じて設定）
   // 640x480 以下: 64, それ以上: 128（WebRTC の設定に準拠）
   int superblock_size = (config_.width * config_.height <= 640 * 480)
                             ? AOM_SUPERBLOCK_SIZE_64X64
                             : AOM_SUPERBLOCK_SIZE_128X128;
-  aom_codec_control(aom_encoder_, AV1E_SET_SUPERBLOCK_SIZE, superblock_size);
+  aom_codec_control(ctx.aom_encoder, AV1E_SET_SUPERBLOCK_SIZE, superblock_size);
 
   // ノイズ感度とモーション推定
-  aom_codec_control(aom_encoder_, AV1E_SET_NOISE_SENSITIVITY, 0);
+  aom_codec_control(ctx.aom_encoder, AV1E_SET_NOISE_SENSITIVITY, 0);
 
   // 機能の無効化（リアルタイムパフォーマンス向上）
-  aom_codec_control(aom_encoder_, AV1E_SET_ENABLE_OBMC, 0);
-  aom_codec_control(aom_encoder_, AV1E_SET_ENABLE_WARPED_MOTION, 0);
-  aom_codec_control(aom_encoder_, AV1E_SET_ENABLE_GLOBAL_MOTION, 0);
-  aom_codec_control(aom_encoder_, AV1E_SET_ENABLE_REF_FRAME_MVS, 0);
+  aom_codec_control(ctx.aom_encoder, AV1E_SET_ENABLE_OBMC, 0);
+  aom_codec_control(ctx.aom_encoder, AV1E_SET_ENABLE_WARPED_MOTION, 0);
+  aom_codec_control(ctx.aom_encoder, AV1E_SET_ENABLE_GLOBAL_MOTION, 0);
+  aom_codec_control(ctx.aom_encoder, AV1E_SET_ENABLE_REF_FRAME_MVS, 0);
 
   // パレットモード（通常のビデオでは無効）
-  aom_codec_control(aom_encoder_, AV1E_SET_ENABLE_PALETTE, 0);
+  aom_codec_control(ctx.aom_encoder, AV1E_SET_ENABLE_PALETTE, 0);
 
   // イントラ予測の最適化
-  aom_codec_control(aom_encoder_, AV1E_SET_ENABLE_CFL_INTRA, 0);
-  aom_codec_control(aom_encoder_, AV1E_SET_ENABLE_SMOOTH_INTRA, 0);
-  aom_codec_control(aom_encoder_, AV1E_SET_ENABLE_ANGLE_DELTA, 0);
-  aom_codec_control(aom_encoder_, AV1E_SET_ENABLE_FILTER_INTRA, 0);
-  aom_codec_control(aom_encoder_, AV1E_SET_INTRA_DEFAULT_TX_ONLY, 1);
+  aom_codec_control(ctx.aom_encoder, AV1E_SET_ENABLE_CFL_INTRA, 0);
+  aom_codec_control(ctx.aom_encoder, AV1E_SET_ENABLE_SMOOTH_INTRA, 0);
+  aom_codec_control(ctx.aom_encoder, AV1E_SET_ENABLE_ANGLE_DELTA, 0);
+  aom_codec_control(ctx.aom_encoder, AV1E_SET_ENABLE_FILTER_INTRA, 0);
+  aom_codec_control(ctx.aom_encoder, AV1E_SET_INTRA_DEFAULT_TX_ONLY, 1);
 
   // 量子化の最適化
-  aom_codec_control(aom_encoder_, AV1E_SET_DISABLE_TRELLIS_QUANT, 1);
+  aom_codec_control(ctx.aom_encoder, AV1E_SET_DISABLE_TRELLIS_QUANT, 1);
 
   // インター予測の最適化
-  aom_codec_control(aom_encoder_, AV1E_SET_ENABLE_DIST_WTD_COMP, 0);
-  aom_codec_control(aom_encoder_, AV1E_SET_ENABLE_DIFF_WTD_COMP, 0);
-  aom_codec_control(aom_encoder_, AV1E_SET_ENABLE_DUAL_FILTER, 0);
-  aom_codec_control(aom_encoder_, AV1E_SET_ENABLE_INTERINTRA_COMP, 0);
-  aom_codec_control(aom_encoder_, AV1E_SET_ENABLE_INTERINTRA_WEDGE, 0);
-  aom_codec_control(aom_encoder_, AV1E_SET_ENABLE_INTRA_EDGE_FILTER, 0);
-  aom_codec_control(aom_encoder_, AV1E_SET_ENABLE_INTRABC, 0);
-  aom_codec_control(aom_encoder_, AV1E_SET_ENABLE_MASKED_COMP, 0);
-  aom_codec_control(aom_encoder_, AV1E_SET_ENABLE_PAETH_INTRA, 0);
+  aom_codec_control(ctx.aom_encoder, AV1E_SET_ENABLE_DIST_WTD_COMP, 0);
+  aom_codec_control(ctx.aom_encoder, AV1E_SET_ENABLE_DIFF_WTD_COMP, 0);
+  aom_codec_control(ctx.aom_encoder, AV1E_SET_ENABLE_DUAL_FILTER, 0);
+  aom_codec_control(ctx.aom_encoder, AV1E_SET_ENABLE_INTERINTRA_COMP, 0);
+  aom_codec_control(ctx.aom_encoder, AV1E_SET_ENABLE_INTERINTRA_WEDGE, 0);
+  aom_codec_control(ctx.aom_encoder, AV1E_SET_ENABLE_INTRA_EDGE_FILTER, 0);
+  aom_codec_control(ctx.aom_encoder, AV1E_SET_ENABLE_INTRABC, 0);
+  aom_codec_control(ctx.aom_encoder, AV1E_SET_ENABLE_MASKED_COMP, 0);
+  aom_codec_control(ctx.aom_encoder, AV1E_SET_ENABLE_PAETH_INTRA, 0);
 
   // その他の機能無効化
-  aom_codec_control(aom_encoder_, AV1E_SET_ENABLE_QM, 0);
-  aom_codec_control(aom_encoder_, AV1E_SET_ENABLE_RECT_PARTITIONS, 0);
-  aom_codec_control(aom_encoder_, AV1E_SET_ENABLE_RESTORATION, 0);
-  aom_codec_control(aom_encoder_, AV1E_SET_ENABLE_SMOOTH_INTERINTRA, 0);
-  aom_codec_control(aom_encoder_, AV1E_SET_ENABLE_TX64, 0);
+  aom_codec_control(ctx.aom_encoder, AV1E_SET_ENABLE_QM, 0);
+  aom_codec_control(ctx.aom_encoder, AV1E_SET_ENABLE_RECT_PARTITIONS, 0);
+  aom_codec_control(ctx.aom_encoder, AV1E_SET_ENABLE_RESTORATION, 0);
+  aom_codec_control(ctx.aom_encoder, AV1E_SET_ENABLE_SMOOTH_INTERINTRA, 0);
+  aom_codec_control(ctx.aom_encoder, AV1E_SET_ENABLE_TX64, 0);
 
   // 参照フレーム数の制限
-  aom_codec_control(aom_encoder_, AV1E_SET_MAX_REFERENCE_FRAMES, 3);
+  aom_codec_control(ctx.aom_encoder, AV1E_SET_MAX_REFERENCE_FRAMES, 3);
+
+  if (scalability_.is_layered()) {
+    init_aom_svc(ctx);
+  }
+}
+
+void VideoEncoder::init_aom_svc(EncoderContext& ctx) {
+  aom_codec_err_t res = set_aom_svc_params(ctx);
+  if (res != AOM_CODEC_OK) {
+    aom_codec_destroy(ctx.aom_encoder);
+    delete ctx.aom_encoder;
+    ctx.aom_encoder = nullptr;
+    throw std::runtime_error("Failed to set AOM SVC params: " +
+                             std::string(aom_codec_err_to_string(res)));
+  }
+}
+
+aom_codec_err_t VideoEncoder::set_aom_svc_params(EncoderContext& ctx) {
+  const int spatial_layers = scalability_.spatial_layers;
+  const int temporal_layers = scalability_.temporal_layers;
+
+  aom_svc_params_t svc_params = {};
+  svc_params.number_spatial_layers = spatial_layers;
+  svc_params.number_temporal_layers = temporal_layers;
+  for (int sl = 0; sl < spatial_layers; ++sl) {
+    // 下位の空間レイヤーほど縦横 1/2 ずつ縮小する (L2 の場合は 1/2, 1/1)
+    svc_params.scaling_factor_num[sl] = 1;
+    svc_params.scaling_factor_den[sl] = 1 << (spatial_layers - 1 - sl);
+    for (int tl = 0; tl < temporal_layers; ++tl) {
+      const int layer = sl * temporal_layers + tl;
+      svc_params.max_quantizers[layer] = ctx.aom_config.rc_max_quantizer;
+      svc_params.min_quantizers[layer] = ctx.aom_config.rc_min_quantizer;
+      // 時間レイヤーは下位レイヤーを含めた累積のビットレート (kbps)
+      svc_params.layer_target_bitrate[layer] = static_cast<int>(
+          ctx.aom_config.rc_target_bitrate *
+          scalability_spatial_rate(spatial_layers, sl) *
+          scalability_temporal_rate(temporal_layers, tl));
+    }
+  }
+  for (int tl = 0; tl < temporal_layers; ++tl) {
+    svc_params.framerate_factor[tl] = 1 << (temporal_layers - 1 - tl);
+  }
+  return aom_codec_control(ctx.aom_encoder, AV1E_SET_SVC_PARAMS, &svc_params);
 }
 
-void VideoEncoder::cleanup_aom_encoder() {
-  if (aom_encoder_) {
-    std::lock_guard<std::mutex> lock(aom_mutex_);
-    aom_codec_destroy(aom_encoder_);
-    delete aom_encoder_;
-    aom_encoder_ = nullptr;
+bool VideoEncoder::reconfigure_aom_encoder(EncoderContext& ctx,
+                                           uint64_t bitrate) {
+  std::lock_guard<std::mutex> lock(ctx.aom_mutex);
+  if (!ctx.aom_encoder) {
+    return false;
+  }
+  // レート制御の状態を保ったまま目標ビットレートだけを変更する
+  aom_codec_enc_cfg_t new_config = ctx.aom_config;
+  new_config.rc_target_bitrate = static_cast<unsigned int>(bitrate / 1000);
+  if (aom_codec_enc_config_set(ctx.aom_encoder, &new_config) != AOM_CODEC_OK) {
+    return false;
   }
+  ctx.aom_config = new_config;
+  // レイヤーごとの目標ビットレートは rc_target_bitrate から計算し直す
+  if (scalability_.is_layered() && set_aom_svc_params(ctx) != AOM_CODEC_OK) {
+    return false;
+  }
+  return true;
 }
 
-void VideoEncoder::encode_frame_aom(const VideoFrame& frame,
+// aom_svc_ref_frame_config_t の reference / ref_idx のインデックス
+static constexpr int kAomLastFrame = 0;
+static constexpr int kAomGoldenFrame = 3;
+
+// 空間・時間レイヤーの参照構造 (libaom の examples/svc_encoder_rtc.c に準拠)
+// スロット 0-1: 各空間レイヤーの TL0
+// スロット 2-3: 各空間レイヤーの TL1 (T3 のみ)
+// スロット 4: 参照されない最上位の時間レイヤーの SL0 (SL1 のレイヤー間予測用)
+static int aom_svc_refresh_slot(int spatial_layer,
+                                int spatial_layers,
+                                int temporal_layers,
+                                int temporal_layer_id) {
+  if (temporal_layer_id == 0) {
+    return spatial_layer;
+  }
+  if (temporal_layers == 3 && temporal_layer_id == 1) {
+    return 2 + spatial_layer;
+  }
+  // 最上位の時間レイヤーは同じ時間レイヤーの上位空間レイヤーからのみ参照される
+  if (spatial_layer + 1 < spatial_layers) {
+    return 4;
+  }
+  return -1;
+}
+
+static aom_svc_ref_frame_config_t make_aom_svc_ref_frame_config(
+    int spatial_layer,
+    int spatial_layers,
+    int temporal_layers,
+    uint64_t index,
+    bool keyframe) {
+  const int temporal_layer_id =
+      scalability_temporal_layer_id(temporal_layers, index);
+  aom_svc_ref_frame_config_t ref = {};
+  for (int i = 0; i < 7; ++i) {
+    ref.ref_idx[i] = spatial_layer;
+  }
+
+  // LAST は同じ空間レイヤーの直近の下位時間レイヤー
+  // T3 の 2 つ目の TL2 (0, 2, 1, 2 の最後) は TL1 を参照する
+  if (temporal_layers == 3 &&
+      index % scalability_temporal_periodicity(temporal_layers) == 3) {
+    ref.ref_idx[kAomLastFrame] = 2 + spatial_layer;
+  }
+  // キーフレームのスーパーフレームでは、キーフレームより前のフレームを参照しない
+  ref.reference[kAomLastFrame] = keyframe ? 0 : 1;
+
+  // GOLDEN は同じスーパーフレームの下位空間レイヤー
+  if (spatial_layer > 0) {
+    ref.ref_idx[kAomGoldenFrame] =
+        aom_svc_refresh_slot(spatial_layer - 1, spatial_layers,
+                             temporal_layers, temporal_layer_id);
+    ref.reference[kAomGoldenFrame] = 1;
+  }
+
+  int refresh = aom_svc_refresh_slot(spatial_layer, spatial_layers,
+                                     temporal_layers, temporal_layer_id);
+  if (refresh >= 0) {
+    ref.refresh[refresh] = 1;
+  }
+  return ref;
+}
+
+void VideoEncoder::cleanup_aom_encoder(EncoderContext& ctx) {
+  if (ctx.aom_encoder) {
+    std::lock_guard<std::mutex> lock(ctx.aom_mutex);
+    aom_codec_destroy(ctx.aom_encoder);
+    delete ctx.aom_encoder;
+    ctx.aom_encoder = nullptr;
+    ctx.pending_inputs.clear();
+  }
+}
+
+void VideoEncoder::encode_frame_aom(EncoderContext& ctx,
+                                    const VideoFrame& frame,
                                     bool keyframe,
                                     std::optional<uint16_t> quantizer) {
-  std::lock_guard<std::mutex> lock(aom_mutex_);
-  if (!aom_encoder_) {
+  std::lock_guard<std::mutex> lock(ctx.aom_mutex);
+  if (!ctx.aom_encoder) {
     throw std::runtime_error("AOM encoder not initialized");
   }
 
@@ -253,35 +366,48 @@ void VideoEncoder::encode_frame_aom(const VideoFrame& frame,
   if (quantizer.has_value() &&
       config_.bitrate_mode == VideoEncoderBitrateMode::QUANTIZER) {
     // AV1E_SET_QUANTIZER_ONE_PASS は 1 パスモードでのフレーム単位 QP 設定
-    aom_codec_control(aom_encoder_, AV1E_SET_QUANTIZER_ONE_PASS,
+    aom_codec_control(ctx.aom_encoder, AV1E_SET_QUANTIZER_ONE_PASS,
                       static_cast<int>(quantizer.value()));
   }
 
   // Wrap I420 memory from VideoFrame directly
+  // I420 以外は変換しながら ctx.i420_input に書き込んだものをラップする
+  unsigned char* planes[3];
+  int strides[3];
+  get_i420_input(ctx, frame, planes, strides);
   aom_image_t img;
-  // VideoFrame のメモリは Y, U, V が連続配置（I420）
-  unsigned char* base = const_cast<unsigned char*>(frame.plane_ptr(0));
   if (!aom_img_wrap(&img, AOM_IMG_FMT_I420, config_.width, config_.height, 1,
-                    base)) {
+                    planes[0])) {
     throw std::runtime_error("Failed to wrap AOM image");
   }
-  // stride を明示（VideoFrame は詰め詰め配置）
-  img.stride[0] = static_cast<int>(config_.width);
-  img.stride[1] = static_cast<int>(config_.width / 2);
-  img.stride[2] = static_cast<int>(config_.width / 2);
-  // U/V の先頭ポインタを正しく設定
-  img.planes[1] = const_cast<unsigned char*>(frame.plane_ptr(1));
-  img.planes[2] = const_cast<unsigned char*>(frame.plane_ptr(2));
+  // デコーダーのピクチャを参照している場合もあるため、stride を明示する
+  for (int i = 0; i < 3; ++i) {
+    img.planes[i] = planes[i];
+    img.stride[i] = strides[i];
+  }
 
   // pts/duration in timebase units
-  const aom_codec_pts_t pts = frame_count_.fetch_add(1);
   // duration は timebase 単位（90kHz）で、1 フレームの時間を表す
   // framerate が fps の場合、1 フレームは 90000/fps ティック
   const double fps = config_.framerate.value_or(30.0);
-  const unsigned long duration = static_cast<unsigned long>(90000.0 / fps);
-  aom_codec_err_t res = aom_codec_encode(aom_encoder_, &img, pts, duration,
+  const unsigned long duration =
+      std::max(1ul, static_cast<unsigned long>(90000.0 / fps));
+  // pts はフレームごとに duration ずつ進め、パケットの pts から入力フレームを特定できるようにする
+  // 再設定でフレームレートが変わっても pts が単調増加するように積算する
+  const aom_codec_pts_t pts =
+      ctx.next_pts.fetch_add(static_cast<int64_t>(duration));
+
+  if (scalability_.is_layered()) {
+    encode_frame_aom_svc(ctx, frame, img, keyframe, pts, duration);
+    aom_img_free(&img);
+    return;
+  }
+
+  register_pending_input(ctx, pts, frame, make_svc_metadata(0));
+  aom_codec_err_t res = aom_codec_encode(ctx.aom_encoder, &img, pts, duration,
                                          keyframe ? AOM_EFLAG_FORCE_KF : 0);
   if (res != AOM_CODEC_OK) {
+    ctx.pending_inputs.erase(pts);
     // aom_img_wrap では img_data_owner=0 のため解放不要
     throw std::runtime_error("AOM encode failed: " +
                              std::string(aom_codec_err_to_string(res)));
@@ -289,14 +415,119 @@ void VideoEncoder::encode_frame_aom(const VideoFrame& frame,
 
   aom_codec_iter_t iter = nullptr;
   const aom_codec_cx_pkt_t* pkt;
-  while ((pkt = aom_codec_get_cx_data(aom_encoder_, &iter)) != nullptr) {
+  while ((pkt = aom_codec_get_cx_data(ctx.aom_encoder, &iter)) != nullptr) {
     if (pkt->kind == AOM_CODEC_CX_FRAME_PKT) {
       bool is_keyframe = (pkt->data.frame.flags & AOM_FRAME_IS_KEY) != 0;
-      handle_encoded_frame(static_cast<const uint8_t*>(pkt->data.frame.buf),
-                           pkt->data.frame.sz, frame.timestamp(), is_keyframe);
+      // 先読みが有効な場合は以前に渡したフレームのパケットが出力される
+      handle_encoded_frame(ctx,
+                           static_cast<const uint8_t*>(pkt->data.frame.buf),
+                           pkt->data.frame.sz, pkt->data.frame.pts,
+                           is_keyframe);
     }
   }
   // aom_img_wrap では img_data_owner=0 のため解放不要だが、
   // API 的に aom_img_free を呼んでも安全（データ本体は解放されない）
   aom_img_free(&img);
-}
\ No newline at end of file
+}
+
+void VideoEncoder::encode_frame_aom_svc(EncoderContext& ctx,
+                                        const VideoFrame& frame,
+                                        const aom_image_t& img,
+                                        bool keyframe,
+                                        aom_codec_pts_t pts,
+                                        unsigned long duration) {
+  const int spatial_layers = scalability_.spatial_layers;
+  const int temporal_layers = scalability_.temporal_layers;
+
+  // キーフレームで時間レイヤーのパターンを先頭に戻し、キーフレームを TL0 にする
+  if (keyframe) {
+    ctx.scalability_frame_index = 0;
+  }
+  const uint64_t index = ctx.scalability_frame_index++;
+  const int temporal_layer_id =
+      scalability_temporal_layer_id(temporal_layers, index);
+  register_pending_input(ctx, pts, frame, make_svc_metadata(temporal_layer_id));
+
+  // 全ての空間レイヤーを 1 つのテンポラルユニットとして 1 チャンクで出力する
+  // (SFU はチャンク内の OBU 拡張ヘッダーの spatial_id で空間レイヤーを選択できる)
+  std::vector<uint8_t> temporal_unit;
+  bool is_keyframe = false;
+  for (int sl = 0; sl < spatial_layers; ++sl) {
+    aom_svc_layer_id_t layer_id = {};
+    layer_id.spatial_layer_id = sl;
+    layer_id.temporal_layer_id = temporal_layer_id;
+    aom_codec_control(ctx.aom_encoder, AV1E_SET_SVC_LAYER_ID, &layer_id);
+
+    aom_svc_ref_frame_config_t ref_config = make_aom_svc_ref_frame_config(
+        sl, spatial_layers, temporal_layers, index, keyframe);
+    aom_codec_control(ctx.aom_encoder, AV1E_SET_SVC_REF_FRAME_CONFIG,
+                      &ref_config);
+
+    // 入力は全ての空間レイヤーで同じ画像を渡し、libaom が縮小する
+    aom_codec_err_t res = aom_codec_encode(
+        ctx.aom_encoder, &img, pts, duration,
+        (keyframe && sl == 0) ? AOM_EFLAG_FORCE_KF : 0);
+    if (res != AOM_CODEC_OK) {
+      ctx.pending_inputs.erase(pts);
+      throw std::runtime_error("AOM encode failed: " +
+                               std::string(aom_codec_err_to_string(res)));
+    }
+
+    aom_codec_iter_t iter = nullptr;
+    const aom_codec_cx_pkt_t* pkt;
+    while ((pkt = aom_codec_get_cx_data(ctx.aom_encoder, &iter)) != nullptr) {
+      if (pkt->kind == AOM_CODEC_CX_FRAME_PKT) {
+        const uint8_t* buf = static_cast<const uint8_t*>(pkt->data.frame.buf);
+        temporal_unit.insert(temporal_unit.end(), buf,
+                             buf + pkt->data.frame.sz);
+        if (sl == 0 && (pkt->data.frame.flags & AOM_FRAME_IS_KEY) != 0) {
+          is_keyframe = true;
+        }
+      }
+    }
+  }
+
+  // レイヤー構造は先読みなしでエンコードするため、このフレームのテンポラルユニットになる
+  if (!temporal_unit.empty()) {
+    handle_encoded_frame(ctx, temporal_unit.data(), temporal_unit.size(), pts,
+                         is_keyframe);
+  } else {
+    // フレームがドロップされた場合は後続のパケットと対応付けないように取り除く
+    ctx.pending_inputs.erase(pts);
+  }
+}
+
+void VideoEncoder::flush_aom_encoder(EncoderContext& ctx) {
+  std::lock_guard<std::mutex> lock(ctx.aom_mutex);
+  if (!ctx.aom_encoder) {
+    return;
+  }
+
+  // エンドオブストリームをシグナルするため nullptr を渡す
+  // 1 回の呼び出しでは先読み中のフレームが全ては出力されないため、
+  // パケットが出力されなくなるまで繰り返す
+  bool got_packet = true;
+  while (got_packet) {
+    got_packet = false;
+    aom_codec_err_t res = aom_codec_encode(ctx.aom_encoder, nullptr, 0, 0, 0);
+    if (res != AOM_CODEC_OK) {
+      // フラッシュ時のエラーは致命的ではないため、出力済みのパケットで終了する
+      break;
+    }
+
+    aom_codec_iter_t iter = nullptr;
+    const aom_codec_cx_pkt_t* pkt;
+    while ((pkt = aom_codec_get_cx_data(ctx.aom_encoder, &iter)) != nullptr) {
+      if (pkt->kind == AOM_CODEC_CX_FRAME_PKT) {
+        got_packet = true;
+        bool is_keyframe = (pkt->data.frame.flags & AOM_FRAME_IS_KEY) != 0;
+        handle_encoded_frame(ctx,
+                             static_cast<const uint8_t*>(pkt->data.frame.buf),
+                             pkt->data.frame.sz, pkt->data.frame.pts,
+                             is_keyframe);
+      }
+    }
+  }
+  // 出力されなかったフレームの情報は次のフレームと対応付けないように破棄する
+  ctx.pending_inputs.clear();
+}
@@ -277,7 +277,7 @@ static void vt_output_callback(void* outputCallbackRefCon,
   }
 
   auto chunk = std::make_shared<EncodedVideoChunk>(
-      out,
+      std::move(out),
       key_frame ? EncodedVideoChunkType::KEY : EncodedVideoChunkType::DELTA,
       timestamp, 0);
   self->handle_output(sequence, chunk, metadata);
@@ -429,49 +429,26 @@ void VideoEncoder::encode_frame_videotoolbox(
       throw std::runtime_error("Failed to get CVPixelBufferPool");
     }
 
-    // Make sure we have NV12 source
-    std::unique_ptr<VideoFrame> nv12;
-    if (frame.format() != VideoPixelFormat::NV12) {
-      nv12 = frame.convert_format(VideoPixelFormat::NV12);
-    }
-    const VideoFrame& src = nv12 ? *nv12 : frame;
-
     CVReturn r =
         CVPixelBufferPoolCreatePixelBuffer(kCFAllocatorDefault, pool, &pb);
     if (r != kCVReturnSuccess || !pb) {
       throw std::runtime_error("Failed to create CVPixelBuffer");
     }
 
-    // Copy planes into CVPixelBuffer
+    // CVPixelBuffer に NV12 で直接書き込む
+    // NV12 以外は中間フレームを作らずに変換しながら書き込む
     CVPixelBufferLockBaseAddress(pb, 0);
     uint8_t* dst_y = (uint8_t*)CVPixelBufferGetBaseAddressOfPlane(pb, 0);
     size_t dst_stride_y = CVPixelBufferGetBytesPerRowOfPlane(pb, 0);
     uint8_t* dst_uv = (uint8_t*)CVPixelBufferGetBaseAddressOfPlane(pb, 1);
     size_t dst_stride_uv = CVPixelBufferGetBytesPerRowOfPlane(pb, 1);
-
-    const uint8_t* src_y = src.plane_ptr(0);
-    const uint8_t* src_uv = src.plane_ptr(1);
-    int width = static_cast<int>(src.width());
-    int height = static_cast<int>(src.height());
-    int chroma_height = (height + 1) / 2;
-    // Y plane
-    if (dst_stride_y == static_cast<size_t>(width)) {
-      memcpy(dst_y, src_y, static_cast<size_t>(width * height));
-    } else {
-      for (int i = 0; i < height; ++i) {
-        memcpy(dst_y + i * dst_stride_y, src_y + i * width, width);
-      }
-    }
-    // UV plane (interleaved)
-    int chroma_row_bytes = ((width + 1) / 2) * 2;
-    if (dst_stride_uv == static_cast<size_t>(chroma_row_bytes)) {
-      memcpy(dst_uv, src_uv,
-             static_cast<size_t>(chroma_row_bytes * chroma_height));
-    } else {
-      for (int i = 0; i < chroma_height; ++i) {
-        memcpy(dst_uv + i * dst_stride_uv, src_uv + i * chroma_row_bytes,
-               chroma_row_bytes);
-      }
+    try {
+      frame.write_nv12(dst_y, static_cast<int>(dst_stride_y), dst_uv,
+                       static_cast<int>(dst_stride_uv));
+    } catch (...) {
+      CVPixelBufferUnlockBaseAddress(pb, 0);
+      CVPixelBufferRelease(pb);
+      throw;
     }
     CVPixelBufferUnlockBaseAddress(pb, 0);
   }
@@ -501,8 +478,8 @@ void VideoEncoder::encode_frame_videotoolbox(
   } else if (is_avc) {
     use_annexb = (config_.avc_format == "annexb");
   }
-  auto* ref = new VTEncodeRef{this, current_sequence_, frame.timestamp(),
-                              use_annexb, is_hevc};
+  auto* ref = new VTEncodeRef{this, context_.current_sequence,
+                              frame.timestamp(), use_annexb, is_hevc};
   CMTime pts = CMTimeMake(frame.timestamp(), 1000000);
 
   // バインディング層で既に GIL を解放しているため、ここでは解放しない
@@ -309,13 +309,6 @@ void VideoEncoder::encode_frame_intel_vpl(const VideoFrame& frame,
 
   mfxSession session = static_cast<mfxSession>(vpl_session_);
 
-  // NV12 フォーマットに変換
-  std::unique_ptr<VideoFrame> nv12;
-  if (frame.format() != VideoPixelFormat::NV12) {
-    nv12 = frame.convert_format(VideoPixelFormat::NV12);
-  }
-  const VideoFrame& src = nv12 ? *nv12 : frame;
-
   // サーフェスプールから未使用のサーフェスを取得
   intel_vpl::SurfacePool* pool =
       static_cast<intel_vpl::SurfacePool*>(vpl_surface_pool_);
@@ -325,25 +318,10 @@ void VideoEncoder::encode_frame_intel_vpl(const VideoFrame& frame,
     throw std::runtime_error("No available surface for encoding");
   }
 
-  // フレームデータをコピー
-  uint32_t width = src.width();
-  uint32_t height = src.height();
-  const uint8_t* src_y = src.plane_ptr(0);
-  const uint8_t* src_uv = src.plane_ptr(1);
-  uint8_t* dst_y = surface->Data.Y;
-  uint8_t* dst_uv = surface->Data.U;
-  uint32_t dst_pitch = surface->Data.Pitch;
-
-  // Y プレーンをコピー
-  for (uint32_t row = 0; row < height; ++row) {
-    std::memcpy(dst_y + row * dst_pitch, src_y + row * width, width);
-  }
-
-  // UV プレーンをコピー
-  uint32_t chroma_height = (height + 1) / 2;
-  for (uint32_t row = 0; row < chroma_height; ++row) {
-    std::memcpy(dst_uv + row * dst_pitch, src_uv + row * width, width);
-  }
+  // サーフェスに NV12 で直接書き込む
+  // NV12 以外は中間フレームを作らずに変換しながら書き込む
+  int dst_pitch = static_cast<int>(surface->Data.Pitch);
+  frame.write_nv12(surface->Data.Y, dst_pitch, surface->Data.U, dst_pitch);
 
   // タイムスタンプを設定
   surface->Data.TimeStamp = frame.timestamp();
@@ -399,7 +377,7 @@ void VideoEncoder::encode_frame_intel_vpl(const VideoFrame& frame,
                 bitstream->DataLength);
 
     auto chunk = std::make_shared<EncodedVideoChunk>(
-        payload,
+        std::move(payload),
         is_keyframe ? EncodedVideoChunkType::KEY : EncodedVideoChunkType::DELTA,
         frame.timestamp(), 0);
 
@@ -418,7 +396,7 @@ void VideoEncoder::encode_frame_intel_vpl(const VideoFrame& frame,
       metadata = std::move(meta);
     }
 
-    handle_output(current_sequence_, chunk, metadata);
+    handle_output(context_.current_sequence, chunk, metadata);
   }
 }
 
@@ -462,12 +440,12 @@ void VideoEncoder::flush_intel_vpl_encoder() {
                   bitstream->DataLength);
 
       auto chunk = std::make_shared<EncodedVideoChunk>(
-          payload,
+          std::move(payload),
           is_keyframe ? EncodedVideoChunkType::KEY
                       : EncodedVideoChunkType::DELTA,
           bitstream->TimeStamp, 0);
 
-      handle_output(current_sequence_, chunk, std::nullopt);
+      handle_output(context_.current_sequence, chunk, std::nullopt);
     }
   }
 }
@@ -382,13 +382,6 @@ void VideoEncoder::encode_frame_nvenc(const VideoFrame& frame,
     throw std::runtime_error("NVENC encoder is not initialized");
   }
 
-  // NV12 フォーマットに変換
-  std::unique_ptr<VideoFrame> nv12;
-  if (frame.format() != VideoPixelFormat::NV12) {
-    nv12 = frame.convert_format(VideoPixelFormat::NV12);
-  }
-  const VideoFrame& src = nv12 ? *nv12 : frame;
-
   // 入力バッファをロック
   NV_ENC_LOCK_INPUT_BUFFER lock_input_buffer = {};
   lock_input_buffer.version = NV_ENC_LOCK_INPUT_BUFFER_VER;
@@ -400,25 +393,17 @@ void VideoEncoder::encode_frame_nvenc(const VideoFrame& frame,
     throw std::runtime_error("Failed to lock NVENC input buffer");
   }
 
-  // フレームデータをコピー
+  // 入力バッファに NV12 で直接書き込む
+  // NV12 以外は中間フレームを作らずに変換しながら書き込む
   uint8_t* dst_y = static_cast<uint8_t*>(lock_input_buffer.bufferDataPtr);
   uint32_t dst_pitch = lock_input_buffer.pitch;
-  uint32_t width = src.width();
-  uint32_t height = src.height();
-
-  const uint8_t* src_y = src.plane_ptr(0);
-  const uint8_t* src_uv = src.plane_ptr(1);
-
-  // Y プレーンをコピー
-  for (uint32_t row = 0; row < height; ++row) {
-    std::memcpy(dst_y + row * dst_pitch, src_y + row * width, width);
-  }
-
-  // UV プレーンをコピー
-  uint8_t* dst_uv = dst_y + dst_pitch * height;
-  uint32_t chroma_height = (height + 1) / 2;
-  for (uint32_t row = 0; row < chroma_height; ++row) {
-    std::memcpy(dst_uv + row * dst_pitch, src_uv + row * width, width);
+  uint8_t* dst_uv = dst_y + dst_pitch * frame.height();
+  try {
+    frame.write_nv12(dst_y, static_cast<int>(dst_pitch), dst_uv,
+                     static_cast<int>(dst_pitch));
+  } catch (...) {
+    nvenc_api_->nvEncUnlockInputBuffer(nvenc_encoder_, nvenc_input_buffer_);
+    throw;
   }
 
   // 入力バッファをアンロック
@@ -480,7 +465,7 @@ void VideoEncoder::encode_frame_nvenc(const VideoFrame& frame,
 
   // EncodedVideoChunk を作成して出力
   auto chunk = std::make_shared<EncodedVideoChunk>(
-      payload,
+      std::move(payload),
       is_keyframe ? EncodedVideoChunkType::KEY : EncodedVideoChunkType::DELTA,
       frame.timestamp(), 0);
 
@@ -499,7 +484,7 @@ void VideoEncoder::encode_frame_nvenc(const VideoFrame& frame,
     metadata = std::move(meta);
   }
 
-  handle_output(current_sequence_, chunk, metadata);
+  handle_output(context_.current_sequence, chunk, metadata);
 }
 
 void VideoEncoder::flush_nvenc_encoder() {
@@ -0,0 +1,309 @@
+// OpenH264 (ソフトウェア H.264) エンコーダーバックエンドの実装
+// このファイルは video_encoder.cpp から #include される
+
+#include "video_encoder.h"
+
+#if defined(__linux__)
+
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+#include "../dyn/openh264.h"
+#include "encoded_video_chunk.h"
+#include "video_frame.h"
+
+// QUANTIZER モードで quantizer が指定されていない場合の QP
+static constexpr int kOpenH264DefaultQp = 26;
+
+// SPS/PPS から avcC (AVCDecoderConfigurationRecord) を生成する
+// (ISO/IEC 14496-15 Section 5.2.4.1.1)
+static std::vector<uint8_t> build_openh264_avcc(const uint8_t* sps,
+                                                size_t sps_size,
+                                                const uint8_t* pps,
+                                                size_t pps_size) {
+  std::vector<uint8_t> avcc;
+  if (sps_size < 4 || pps_size < 1) {
+    return avcc;
+  }
+  avcc.reserve(11 + sps_size + pps_size);
+  // configurationVersion, AVCProfileIndication, profile_compatibility,
+  // AVCLevelIndication
+  avcc.push_back(1);
+  avcc.push_back(sps[1]);
+  avcc.push_back(sps[2]);
+  avcc.push_back(sps[3]);
+  // lengthSizeMinusOne (4 バイト長 - 1 = 3) + reserved (6 bits)
+  avcc.push_back(0xFF);
+  // numOfSequenceParameterSets (1) + reserved (3 bits)
+  avcc.push_back(0xE1);
+  avcc.push_back((sps_size >> 8) & 0xFF);
+  avcc.push_back(sps_size & 0xFF);
+  avcc.insert(avcc.end(), sps, sps + sps_size);
+  // numOfPictureParameterSets
+  avcc.push_back(1);
+  avcc.push_back((pps_size >> 8) & 0xFF);
+  avcc.push_back(pps_size & 0xFF);
+  avcc.insert(avcc.end(), pps, pps + pps_size);
+  return avcc;
+}
+
+void VideoEncoder::init_openh264_encoder() {
+  if (openh264_encoder_) {
+    return;
+  }
+
+  // OpenH264 ライブラリがロード可能かチェック
+  if (!dyn::DynModule::IsLoadable(dyn::openh264_so())) {
+    throw std::runtime_error(
+        "H.264 encoder is not available: OpenH264 library could not be "
+        "loaded (install libopenh264.so.8 or set OPENH264_PATH)");
+  }
+
+  ISVCEncoder* encoder = nullptr;
+  if (dyn::WelsCreateSVCEncoder(&encoder) != 0 || !encoder) {
+    throw std::runtime_error("Failed to create OpenH264 encoder");
+  }
+
+  SEncParamExt param;
+  encoder->GetDefaultParams(&param);
+
+  const bool realtime = config_.latency_mode == LatencyMode::REALTIME;
+  const int width = static_cast<int>(config_.width);
+  const int height = static_cast<int>(config_.height);
+  const float framerate = static_cast<float>(config_.framerate.value_or(30.0));
+  const int bitrate = static_cast<int>(config_.bitrate.value_or(400000));
+
+  // プリセット
+  // REALTIME: WebRTC と同じくカメラ映像のリアルタイム用途で、参照フレーム 1 枚・低演算量
+  // QUALITY: 非リアルタイム用途で、参照フレームとシーンチェンジ検出を使って圧縮率を優先
+  if (realtime) {
+    param.iUsageType = CAMERA_VIDEO_REAL_TIME;
+    param.iComplexityMode = LOW_COMPLEXITY;
+    param.iNumRefFrame = 1;
+    param.bEnableSceneChangeDetect = false;
+  } else {
+    param.iUsageType = CAMERA_VIDEO_NON_REAL_TIME;
+    param.iComplexityMode = HIGH_COMPLEXITY;
+    param.iNumRefFrame = AUTO_REF_PIC_COUNT;
+    param.bEnableSceneChangeDetect = true;
+    param.bEnableAdaptiveQuant = true;
+  }
+  param.iPicWidth = width;
+  param.iPicHeight = height;
+  param.fMaxFrameRate = framerate;
+  param.iTargetBitrate = bitrate;
+  param.iMaxBitrate = UNSPECIFIED_BIT_RATE;
+
+  // レートコントロール
+  // フレームスキップを有効にすると出力のないフレームができるため無効にする
+  param.bEnableFrameSkip = false;
+  if (config_.bitrate_mode == VideoEncoderBitrateMode::QUANTIZER) {
+    param.iRCMode = RC_OFF_MODE;
+  } else {
+    param.iRCMode = RC_BITRATE_MODE;
+  }
+
+  // キーフレームは encode() の key_frame 指定でのみ挿入する
+  param.uiIntraPeriod = 0;
+  // SPS/PPS の ID を固定し、description (avcC) がキーフレームごとに変わらないようにする
+  param.eSpsPpsIdStrategy = CONSTANT_ID;
+  param.bEnableDenoise = false;
+  param.bEnableBackgroundDetection = realtime;
+
+  // プロファイルとレベル
+  EProfileIdc profile = PRO_BASELINE;
+  ELevelIdc level = LEVEL_UNKNOWN;
+  if (std::holds_alternative<AVCCodecParameters>(codec_params_)) {
+    const auto& avc_params = std::get<AVCCodecParameters>(codec_params_);
+    switch (avc_params.profile_idc) {
+      case 0x4D:
+        profile = PRO_MAIN;
+        break;
+      case 0x64:
+        profile = PRO_HIGH;
+        break;
+      default:
+        profile = PRO_BASELINE;
+        break;
+    }
+    level = static_cast<ELevelIdc>(avc_params.level_idc);
+  }
+  // Baseline 以外は CABAC を使う
+  param.iEntropyCodingModeFlag = profile == PRO_BASELINE ? 0 : 1;
+
+  // マルチスレッドはスライス単位で並列化されるため、スライス数をスレッド数に合わせる
+  // スレッド数は libaom と同じく解像度とコア数から決める
+  unsigned int number_of_cores = std::thread::hardware_concurrency();
+  int threads = calculate_number_of_threads(width, height,
+                                            static_cast<int>(number_of_cores));
+  param.iMultipleThreadIdc = static_cast<unsigned short>(threads);
+
+  param.iSpatialLayerNum = 1;
+  param.iTemporalLayerNum = 1;
+  SSpatialLayerConfig& layer = param.sSpatialLayers[0];
+  layer.iVideoWidth = width;
+  layer.iVideoHeight = height;
+  layer.fFrameRate = framerate;
+  layer.iSpatialBitrate = bitrate;
+  layer.iMaxSpatialBitrate = UNSPECIFIED_BIT_RATE;
+  layer.uiProfileIdc = profile;
+  layer.uiLevelIdc = level;
+  layer.iDLayerQp = kOpenH264DefaultQp;
+  if (threads > 1) {
+    layer.sSliceArgument.uiSliceMode = SM_FIXEDSLCNUM_SLICE;
+    layer.sSliceArgument.uiSliceNum = static_cast<unsigned int>(threads);
+  } else {
+    layer.sSliceArgument.uiSliceMode = SM_SINGLE_SLICE;
+  }
+
+  if (encoder->InitializeExt(&param) != cmResultSuccess) {
+    dyn::WelsDestroySVCEncoder(encoder);
+    throw std::runtime_error("Failed to initialize OpenH264 encoder");
+  }
+
+  int video_format = videoFormatI420;
+  encoder->SetOption(ENCODER_OPTION_DATAFORMAT, &video_format);
+
+  openh264_encoder_ = encoder;
+  openh264_quantizer_ = kOpenH264DefaultQp;
+}
+
+void VideoEncoder::encode_frame_openh264(const VideoFrame& frame,
+                                         bool keyframe,
+                                         std::optional<uint16_t> quantizer) {
+  ISVCEncoder* encoder = static_cast<ISVCEncoder*>(openh264_encoder_);
+  if (!encoder) {
+    throw std::runtime_error("OpenH264 encoder is not initialized");
+  }
+
+  // QUANTIZER モードでは RC を無効にしているため、フレームごとの QP をパラメータで更新する
+  if (config_.bitrate_mode == VideoEncoderBitrateMode::QUANTIZER &&
+      quantizer.has_value() && *quantizer != openh264_quantizer_) {
+    SEncParamExt param;
+    encoder->GetOption(ENCODER_OPTION_SVC_ENCODE_PARAM_EXT, &param);
+    param.sSpatialLayers[0].iDLayerQp = *quantizer;
+    if (encoder->SetOption(ENCODER_OPTION_SVC_ENCODE_PARAM_EXT, &param) !=
+        cmResultSuccess) {
+      throw std::runtime_error("Failed to set OpenH264 quantizer");
+    }
+    openh264_quantizer_ = *quantizer;
+  }
+
+  if (keyframe) {
+    encoder->ForceIntraFrame(true);
+  }
+
+  // I420 以外は変換しながら context_.i420_input に書き込む
+  unsigned char* planes[3];
+  int strides[3];
+  get_i420_input(context_, frame, planes, strides);
+
+  SSourcePicture picture = {};
+  picture.iColorFormat = videoFormatI420;
+  picture.iPicWidth = static_cast<int>(frame.width());
+  picture.iPicHeight = static_cast<int>(frame.height());
+  for (int i = 0; i < 3; ++i) {
+    picture.pData[i] = planes[i];
+    picture.iStride[i] = strides[i];
+  }
+  // OpenH264 のタイムスタンプはミリ秒
+  picture.uiTimeStamp = frame.timestamp() / 1000;
+
+  SFrameBSInfo info;
+  std::memset(&info, 0, sizeof(info));
+  if (encoder->EncodeFrame(&picture, &info) != cmResultSuccess) {
+    throw std::runtime_error("OpenH264 encode failed");
+  }
+  if (info.eFrameType == videoFrameTypeSkip ||
+      info.eFrameType == videoFrameTypeInvalid) {
+    return;
+  }
+
+  const bool is_keyframe = info.eFrameType == videoFrameTypeIDR;
+  const bool use_annexb = config_.avc_format == "annexb";
+
+  // OpenH264 の出力は start code 付きの Annex B
+  // avc フォーマットの場合は 4 バイトの長さプレフィックスに変換し、
+  // SPS/PPS はビットストリームから外して description (avcC) として提供する
+  std::vector<uint8_t> out;
+  out.reserve(static_cast<size_t>(info.iFrameSizeInBytes));
+  const uint8_t* sps = nullptr;
+  size_t sps_size = 0;
+  const uint8_t* pps = nullptr;
+  size_t pps_size = 0;
+
+  for (int i = 0; i < info.iLayerNum; ++i) {
+    const SLayerBSInfo& layer_info = info.sLayerInfo[i];
+    const uint8_t* p = layer_info.pBsBuf;
+    for (int j = 0; j < layer_info.iNalCount; ++j) {
+      const size_t nal_length =
+          static_cast<size_t>(layer_info.pNalLengthInByte[j]);
+      const uint8_t* nal = p;
+      p += nal_length;
+      if (use_annexb) {
+        out.insert(out.end(), nal, nal + nal_length);
+        continue;
+      }
+
+      // start code (3 バイトまたは 4 バイト) を取り除く
+      size_t start_code_size = (nal_length >= 3 && nal[2] == 1) ? 3 : 4;
+      if (nal_length <= start_code_size) {
+        continue;
+      }
+      const uint8_t* payload = nal + start_code_size;
+      const size_t payload_size = nal_length - start_code_size;
+      const uint8_t nal_type = payload[0] & 0x1F;
+      if (nal_type == 7) {
+        sps = payload;
+        sps_size = payload_size;
+        continue;
+      }
+      if (nal_type == 8) {
+        pps = payload;
+        pps_size = payload_size;
+        continue;
+      }
+      out.push_back(static_cast<uint8_t>((payload_size >> 24) & 0xFF));
+      out.push_back(static_cast<uint8_t>((payload_size >> 16) & 0xFF));
+      out.push_back(static_cast<uint8_t>((payload_size >> 8) & 0xFF));
+      out.push_back(static_cast<uint8_t>(payload_size & 0xFF));
+      out.insert(out.end(), payload, payload + payload_size);
+    }
+  }
+
+  // キーフレームかつ avc フォーマットの場合、decoderConfig を metadata に含める
+  std::optional<EncodedVideoChunkMetadata> metadata;
+  if (is_keyframe && !use_annexb && sps && pps) {
+    std::vector<uint8_t> description =
+        build_openh264_avcc(sps, sps_size, pps, pps_size);
+    if (!description.empty()) {
+      EncodedVideoChunkMetadata meta;
+      VideoDecoderConfig decoder_config;
+      decoder_config.codec = "avc1";
+      decoder_config.coded_width = config_.width;
+      decoder_config.coded_height = config_.height;
+      decoder_config.description = std::move(description);
+      meta.decoder_config = std::move(decoder_config);
+      metadata = std::move(meta);
+    }
+  }
+
+  // OpenH264 は先読みしないため入力したフレームのパケットがすぐに出力されるが、
+  // 他のエンコーダーと同じく入力フレームの duration をチャンクに引き継ぐ
+  const int64_t pts = context_.next_pts.fetch_add(1);
+  register_pending_input(context_, pts, frame, std::move(metadata));
+  handle_encoded_frame(context_, out.data(), out.size(), pts, is_keyframe);
+}
+
+void VideoEncoder::cleanup_openh264_encoder() {
+  if (!openh264_encoder_) {
+    return;
+  }
+  ISVCEncoder* encoder = static_cast<ISVCEncoder*>(openh264_encoder_);
+  encoder->Uninitialize();
+  dyn::WelsDestroySVCEncoder(encoder);
+  openh264_encoder_ = nullptr;
+}
+
+#endif  // defined(__linux__)
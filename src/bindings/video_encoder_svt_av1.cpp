@@ -0,0 +1,326 @@
+// SVT-AV1 (ソフトウェア AV1) エンコーダーバックエンドの実装
+// このファイルは video_encoder.cpp から #include される
+
+#include "video_encoder.h"
+
+#if defined(__APPLE__) || defined(__linux__)
+
+#include <svt-av1/EbSvtAv1Enc.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+// QUANTIZER モードで quantizer が指定されていない場合の QP
+static constexpr uint32_t kSvtAv1DefaultQp = 35;
+
+// AV1 の OBU タイプ (AV1 仕様 6.2.2)
+static constexpr uint8_t kAv1ObuSequenceHeader = 1;
+static constexpr uint8_t kAv1ObuTemporalDelimiter = 2;
+
+// leb128 を読み取り、読み取ったバイト数を返す (失敗した場合は 0)
+static size_t read_av1_leb128(const uint8_t* data,
+                              size_t size,
+                              uint64_t* value) {
+  *value = 0;
+  for (size_t i = 0; i < size && i < 8; ++i) {
+    *value |= static_cast<uint64_t>(data[i] & 0x7F) << (i * 7);
+    if ((data[i] & 0x80) == 0) {
+      return i + 1;
+    }
+  }
+  return 0;
+}
+
+// テンポラルユニットにシーケンスヘッダー OBU が含まれているか
+// 先頭の Temporal Delimiter の長さを td_size に返す
+// 解析できない場合はシーケンスヘッダーを付加しないように true を返す
+static bool av1_has_sequence_header(const uint8_t* data,
+                                    size_t size,
+                                    size_t* td_size) {
+  *td_size = 0;
+  size_t pos = 0;
+  while (pos < size) {
+    const uint8_t obu_header = data[pos];
+    const uint8_t obu_type = (obu_header >> 3) & 0x0F;
+    const bool has_extension = (obu_header & 0x04) != 0;
+    const bool has_size_field = (obu_header & 0x02) != 0;
+    const size_t header_size = has_extension ? 2 : 1;
+    if (!has_size_field || pos + header_size > size) {
+      return true;
+    }
+    uint64_t payload_size;
+    const size_t leb128_size = read_av1_leb128(
+        data + pos + header_size, size - pos - header_size, &payload_size);
+    if (leb128_size == 0 ||
+        payload_size > size - pos - header_size - leb128_size) {
+      return true;
+    }
+    if (obu_type == kAv1ObuSequenceHeader) {
+      return true;
+    }
+    const size_t obu_size =
+        header_size + leb128_size + static_cast<size_t>(payload_size);
+    if (obu_type == kAv1ObuTemporalDelimiter && pos == 0) {
+      *td_size = obu_size;
+    }
+    pos += obu_size;
+  }
+  return false;
+}
+
+void VideoEncoder::init_svt_av1_encoder(EncoderContext& ctx) {
+  std::lock_guard<std::mutex> lock(ctx.svt_av1_mutex);
+  if (ctx.svt_av1_encoder) {
+    return;  // すでに初期化済み
+  }
+
+  // ハンドルの作成時に svt_config にデフォルト値が設定される
+  EbComponentType* handle = nullptr;
+  EbSvtAv1EncConfiguration svt_config;
+  std::memset(&svt_config, 0, sizeof(svt_config));
+  if (svt_av1_enc_init_handle(&handle, &svt_config) != EB_ErrorNone) {
+    throw std::runtime_error("Failed to create SVT-AV1 encoder handle");
+  }
+
+  svt_config.source_width = config_.width;
+  svt_config.source_height = config_.height;
+  // フレームレートは 1/1000 単位で指定する
+  const double fps = config_.framerate.value_or(30.0);
+  svt_config.frame_rate_numerator =
+      static_cast<uint32_t>(std::max(1l, std::lround(fps * 1000.0)));
+  svt_config.frame_rate_denominator = 1000;
+  // 入力は I420 に揃えているため 8 ビットの Main プロファイルのみ対応する
+  svt_config.encoder_bit_depth = 8;
+  svt_config.encoder_color_format = EB_YUV420;
+  svt_config.profile = MAIN_PROFILE;
+
+  // ビットレートモードの設定（WebCodecs API に準拠）
+  const uint64_t bitrate = config_.bitrate.value_or(1000000);
+  svt_config.target_bit_rate = static_cast<uint32_t>(
+      std::min<uint64_t>(bitrate, std::numeric_limits<uint32_t>::max()));
+  if (config_.bitrate_mode == VideoEncoderBitrateMode::CONSTANT) {
+    svt_config.rate_control_mode = SVT_AV1_RC_MODE_CBR;
+  } else if (config_.bitrate_mode == VideoEncoderBitrateMode::QUANTIZER) {
+    // レート制御と適応量子化を無効にし、フレームごとに QP を指定する
+    svt_config.rate_control_mode = SVT_AV1_RC_MODE_CQP_OR_CRF;
+    svt_config.enable_adaptive_quantization = 0;
+    svt_config.use_qp_file = true;
+    svt_config.qp = kSvtAv1DefaultQp;
+  } else {
+    svt_config.rate_control_mode = SVT_AV1_RC_MODE_VBR;
+  }
+  if (config_.bitrate_mode != VideoEncoderBitrateMode::QUANTIZER) {
+    // QP の範囲は libaom と同じにする（WebRTC と同じ）
+    svt_config.min_qp_allowed = 10;
+    svt_config.max_qp_allowed = 56;
+  }
+
+  // Realtime vs quality
+  // SVT-AV1 の CBR は低遅延の予測構造のみ対応しているため、CONSTANT でも低遅延にする
+  const bool realtime = config_.latency_mode == LatencyMode::REALTIME;
+  if (realtime ||
+      config_.bitrate_mode == VideoEncoderBitrateMode::CONSTANT) {
+    svt_config.pred_structure = SVT_AV1_PRED_LOW_DELAY_B;
+  } else {
+    svt_config.pred_structure = SVT_AV1_PRED_RANDOM_ACCESS;
+  }
+
+  // プリセット (enc_mode): 0 = 最高品質・最遅、13 = 最低品質・最速
+  // REALTIME は libaom の cpu_used と同じく解像度が大きいほど速いプリセットにする
+  // QUALITY は VOD 向けにスループットと品質のバランスがよい 8 を使用する
+  if (realtime) {
+    uint32_t pixel_count = config_.width * config_.height;
+    if (pixel_count <= 640 * 360) {
+      svt_config.enc_mode = 10;
+    } else if (pixel_count <= 1280 * 720) {
+      svt_config.enc_mode = 11;
+    } else {
+      svt_config.enc_mode = 12;
+    }
+  } else {
+    svt_config.enc_mode = 8;
+  }
+
+  // WebCodecs API に準拠: キーフレームはアプリケーション側で明示的に制御
+  // encode(frame, {key_frame: true}) でのみキーフレームを挿入する
+  svt_config.intra_period_length = -1;  // 周期的なキーフレームを挿入しない
+  svt_config.intra_refresh_type = SVT_AV1_KF_REFRESH;
+  svt_config.scene_change_detection = 0;
+  svt_config.force_key_frames = true;
+
+  // GOP 並列エンコードのセグメントでは、セグメント間で並列化するため
+  // エンコーダー内部の並列度を最小にする (未指定の場合はコア数から自動で決まる)
+  if (ctx.parallelism > 1) {
+    svt_config.level_of_parallelism = 1;
+  }
+
+  if (svt_av1_enc_set_parameter(handle, &svt_config) != EB_ErrorNone) {
+    svt_av1_enc_deinit_handle(handle);
+    throw std::runtime_error("Failed to set SVT-AV1 encoder parameters");
+  }
+  if (svt_av1_enc_init(handle) != EB_ErrorNone) {
+    svt_av1_enc_deinit(handle);
+    svt_av1_enc_deinit_handle(handle);
+    throw std::runtime_error("Failed to initialize SVT-AV1 encoder");
+  }
+
+  // 途中のキーフレームからデコードできるように、キーフレームに付加するシーケンスヘッダーを取得する
+  ctx.svt_av1_sequence_header.clear();
+  EbBufferHeaderType* stream_header = nullptr;
+  if (svt_av1_enc_stream_header(handle, &stream_header) == EB_ErrorNone &&
+      stream_header) {
+    ctx.svt_av1_sequence_header.assign(
+        stream_header->p_buffer,
+        stream_header->p_buffer + stream_header->n_filled_len);
+    svt_av1_enc_stream_header_release(stream_header);
+  }
+
+  ctx.svt_av1_encoder = handle;
+  ctx.svt_av1_qp = kSvtAv1DefaultQp;
+}
+
+void VideoEncoder::encode_frame_svt_av1(EncoderContext& ctx,
+                                        const VideoFrame& frame,
+                                        bool keyframe,
+                                        std::optional<uint16_t> quantizer) {
+  std::lock_guard<std::mutex> lock(ctx.svt_av1_mutex);
+  EbComponentType* handle = static_cast<EbComponentType*>(ctx.svt_av1_encoder);
+  if (!handle) {
+    throw std::runtime_error("SVT-AV1 encoder not initialized");
+  }
+
+  // QUANTIZER モードでは use_qp_file によりフレームごとの QP を使用する
+  // SVT-AV1 の QP は 1-63 のため、0 は 1 として扱う
+  if (quantizer.has_value() &&
+      config_.bitrate_mode == VideoEncoderBitrateMode::QUANTIZER) {
+    ctx.svt_av1_qp = std::max<uint32_t>(1, quantizer.value());
+  }
+
+  // I420 以外は変換しながら ctx.i420_input に書き込む
+  // SVT-AV1 は svt_av1_enc_send_picture() の中で入力をコピーする
+  unsigned char* planes[3];
+  int strides[3];
+  get_i420_input(ctx, frame, planes, strides);
+  EbSvtIOFormat input;
+  std::memset(&input, 0, sizeof(input));
+  input.luma = planes[0];
+  input.cb = planes[1];
+  input.cr = planes[2];
+  input.y_stride = static_cast<uint32_t>(strides[0]);
+  input.cb_stride = static_cast<uint32_t>(strides[1]);
+  input.cr_stride = static_cast<uint32_t>(strides[2]);
+
+  // pts は libaom と同じく 90kHz の duration ずつ進め、パケットの pts から入力フレームを特定する
+  const double fps = config_.framerate.value_or(30.0);
+  const int64_t duration =
+      std::max<int64_t>(1, static_cast<int64_t>(90000.0 / fps));
+  const int64_t pts = ctx.next_pts.fetch_add(duration);
+
+  const uint32_t chroma_height = (config_.height + 1) / 2;
+  EbBufferHeaderType buffer;
+  std::memset(&buffer, 0, sizeof(buffer));
+  buffer.size = sizeof(EbBufferHeaderType);
+  buffer.p_buffer = reinterpret_cast<uint8_t*>(&input);
+  buffer.n_filled_len = static_cast<uint32_t>(
+      strides[0] * config_.height + (strides[1] + strides[2]) * chroma_height);
+  buffer.pts = pts;
+  buffer.pic_type = keyframe ? EB_AV1_KEY_PICTURE : EB_AV1_INVALID_PICTURE;
+  buffer.qp = ctx.svt_av1_qp;
+
+  register_pending_input(ctx, pts, frame, make_svc_metadata(0));
+  if (svt_av1_enc_send_picture(handle, &buffer) != EB_ErrorNone) {
+    ctx.pending_inputs.erase(pts);
+    throw std::runtime_error("SVT-AV1 encode failed");
+  }
+
+  // 先読みが有効な場合は以前に渡したフレームのパケットが出力される
+  drain_svt_av1_packets(ctx, false);
+}
+
+void VideoEncoder::drain_svt_av1_packets(EncoderContext& ctx, bool done) {
+  EbComponentType* handle = static_cast<EbComponentType*>(ctx.svt_av1_encoder);
+  while (true) {
+    EbBufferHeaderType* packet = nullptr;
+    EbErrorType res =
+        svt_av1_enc_get_packet(handle, &packet, done ? 1 : 0);
+    if (res == EB_NoErrorEmptyQueue) {
+      break;
+    }
+    if (res != EB_ErrorNone || !packet) {
+      if (done) {
+        // フラッシュ時のエラーは致命的ではないため、出力済みのパケットで終了する
+        break;
+      }
+      throw std::runtime_error("SVT-AV1 failed to get packet");
+    }
+
+    const bool eos = (packet->flags & EB_BUFFERFLAG_EOS) != 0;
+    if (packet->n_filled_len > 0) {
+      const uint8_t* data = packet->p_buffer;
+      const size_t size = packet->n_filled_len;
+      const bool is_keyframe = packet->pic_type == EB_AV1_KEY_PICTURE;
+      size_t td_size = 0;
+      if (is_keyframe && !ctx.svt_av1_sequence_header.empty() &&
+          !av1_has_sequence_header(data, size, &td_size)) {
+        // シーケンスヘッダーは Temporal Delimiter の直後に置く
+        std::vector<uint8_t> temporal_unit;
+        temporal_unit.reserve(size + ctx.svt_av1_sequence_header.size());
+        temporal_unit.insert(temporal_unit.end(), data, data + td_size);
+        temporal_unit.insert(temporal_unit.end(),
+                             ctx.svt_av1_sequence_header.begin(),
+                             ctx.svt_av1_sequence_header.end());
+        temporal_unit.insert(temporal_unit.end(), data + td_size, data + size);
+        handle_encoded_frame(ctx, temporal_unit.data(), temporal_unit.size(),
+                             packet->pts, true);
+      } else {
+        handle_encoded_frame(ctx, data, size, packet->pts, is_keyframe);
+      }
+    }
+    svt_av1_enc_release_out_buffer(&packet);
+    if (eos) {
+      break;
+    }
+  }
+}
+
+void VideoEncoder::flush_svt_av1_encoder(EncoderContext& ctx) {
+  {
+    std::lock_guard<std::mutex> lock(ctx.svt_av1_mutex);
+    EbComponentType* handle =
+        static_cast<EbComponentType*>(ctx.svt_av1_encoder);
+    // 全てのフレームを出力し終えている場合はエンコーダーをそのまま使い続ける
+    if (!handle || ctx.pending_inputs.empty()) {
+      return;
+    }
+
+    // エンドオブストリームを送り、先読み中のフレームを全て出力させる
+    EbBufferHeaderType eos;
+    std::memset(&eos, 0, sizeof(eos));
+    eos.size = sizeof(EbBufferHeaderType);
+    eos.flags = EB_BUFFERFLAG_EOS;
+    eos.pic_type = EB_AV1_INVALID_PICTURE;
+    if (svt_av1_enc_send_picture(handle, &eos) == EB_ErrorNone) {
+      drain_svt_av1_packets(ctx, true);
+    }
+  }
+  // エンドオブストリームの後はフレームを受け付けないため破棄し、次のフレームで作り直す
+  // 出力されなかったフレームの情報もここで破棄する
+  cleanup_svt_av1_encoder(ctx);
+}
+
+void VideoEncoder::cleanup_svt_av1_encoder(EncoderContext& ctx) {
+  std::lock_guard<std::mutex> lock(ctx.svt_av1_mutex);
+  if (!ctx.svt_av1_encoder) {
+    return;
+  }
+  EbComponentType* handle = static_cast<EbComponentType*>(ctx.svt_av1_encoder);
+  svt_av1_enc_deinit(handle);
+  svt_av1_enc_deinit_handle(handle);
+  ctx.svt_av1_encoder = nullptr;
+  ctx.svt_av1_sequence_header.clear();
+  ctx.pending_inputs.clear();
+}
+
+#endif  // defined(__APPLE__) || defined(__linux__)
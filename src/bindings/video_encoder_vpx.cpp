@@ -4,126 +4,172 @@
 #include <cstring>
 #include <thread>
 
-// WebRTC の NumberOfThreads ロジックに準拠
-static int calculate_vpx_number_of_threads(int width,
-                                           int height,
-                                           int number_of_cores) {
-  if (width * height > 1280 * 720 && number_of_cores > 8) {
-    return 8;
-  } else if (width * height >= 640 * 360 && number_of_cores > 4) {
-    return 4;
-  } else if (width * height >= 320 * 180 && number_of_cores > 2) {
-    return 2;
-  } else {
-    return 1;
+#include "thread_count.h"
+
+// VP8 の時間レイヤーごとの参照・更新フラグ
+// TL0 は LAST を参照して LAST を更新し、TL1 (T3) は LAST を参照して GOLDEN を更新する
+// 最上位の時間レイヤーはどのバッファも更新しない
+static vpx_enc_frame_flags_t vp8_temporal_layer_flags(int temporal_layers,
+                                                      uint64_t index) {
+  const vpx_enc_frame_flags_t no_update =
+      VP8_EFLAG_NO_UPD_LAST | VP8_EFLAG_NO_UPD_GF | VP8_EFLAG_NO_UPD_ARF;
+  const vpx_enc_frame_flags_t ref_last_only =
+      VP8_EFLAG_NO_REF_GF | VP8_EFLAG_NO_REF_ARF;
+  const uint64_t periodicity = static_cast<uint64_t>(
+      scalability_temporal_periodicity(temporal_layers));
+  const int position = static_cast<int>(index % periodicity);
+  switch (scalability_temporal_layer_id(temporal_layers, index)) {
+    case 0:
+      return ref_last_only | VP8_EFLAG_NO_UPD_GF | VP8_EFLAG_NO_UPD_ARF;
+    case 1:
+      if (temporal_layers == 3) {
+        return ref_last_only | VP8_EFLAG_NO_UPD_LAST | VP8_EFLAG_NO_UPD_ARF;
+      }
+      return ref_last_only | no_update;
+    default:
+      // T3 の 2 つ目の TL2 は TL1 (GOLDEN) も参照する
+      if (position == 3) {
+        return VP8_EFLAG_NO_REF_ARF | no_update;
+      }
+      return ref_last_only | no_update;
   }
 }
 
-void VideoEncoder::init_vpx_encoder() {
-  std::lock_guard<std::mutex> lock(vpx_mutex_);
-  if (vpx_encoder_) {
+void VideoEncoder::init_vpx_encoder(EncoderContext& ctx) {
+  std::lock_guard<std::mutex> lock(ctx.vpx_mutex);
+  if (ctx.vpx_encoder) {
     return;  // すでに初期化済み
   }
 
   // VP8 または VP9 エンコーダーを選択
   if (is_vp8_codec()) {
-    vpx_iface_ = vpx_codec_vp8_cx();
+    ctx.vpx_iface = vpx_codec_vp8_cx();
   } else if (is_vp9_codec()) {
-    vpx_iface_ = vpx_codec_vp9_cx();
+    ctx.vpx_iface = vpx_codec_vp9_cx();
   } else {
     throw std::runtime_error("Unknown VPX codec");
   }
 
   vpx_codec_err_t res =
-      vpx_codec_enc_config_default(vpx_iface_, &vpx_config_, 0);
+      vpx_codec_enc_config_default(ctx.vpx_iface, &ctx.vpx_config, 0);
   if (res != VPX_CODEC_OK) {
     throw std::runtime_error("Failed to get default VPX encoder config");
   }
 
-  vpx_config_.g_w = config_.width;
-  vpx_config_.g_h = config_.height;
+  ctx.vpx_config.g_w = config_.width;
+  ctx.vpx_config.g_h = config_.height;
   // タイムベースは 90kHz (RTP 標準) に設定
-  vpx_config_.g_timebase.num = 1;
-  vpx_config_.g_timebase.den = 90000;
-  vpx_config_.rc_target_bitrate =
+  ctx.vpx_config.g_timebase.num = 1;
+  ctx.vpx_config.g_timebase.den = 90000;
+  ctx.vpx_config.rc_target_bitrate =
       config_.bitrate.value_or(1000000) / 1000;  // kbps
 
   // ビットレートモードの設定
   if (config_.bitrate_mode == VideoEncoderBitrateMode::CONSTANT) {
-    vpx_config_.rc_end_usage = VPX_CBR;
+    ctx.vpx_config.rc_end_usage = VPX_CBR;
   } else if (config_.bitrate_mode == VideoEncoderBitrateMode::VARIABLE) {
-    vpx_config_.rc_end_usage = VPX_VBR;
+    ctx.vpx_config.rc_end_usage = VPX_VBR;
   } else if (config_.bitrate_mode == VideoEncoderBitrateMode::QUANTIZER) {
-    vpx_config_.rc_end_usage = VPX_Q;
+    ctx.vpx_config.rc_end_usage = VPX_Q;
   } else {
-    vpx_config_.rc_end_usage = VPX_VBR;
+    ctx.vpx_config.rc_end_usage = VPX_VBR;
   }
 
   // スレッド数の設定
-  unsigned int number_of_cores = std::thread::hardware_concurrency();
-  vpx_config_.g_threads = calculate_vpx_number_of_threads(
+  // GOP 並列エンコードのセグメントでは、同時にエンコードするセグメント数でコアを分ける
+  unsigned int number_of_cores =
+      std::thread::hardware_concurrency() / ctx.parallelism;
+  ctx.vpx_config.g_threads = calculate_number_of_threads(
       config_.width, config_.height, static_cast<int>(number_of_cores));
 
   // レート制御の設定
-  vpx_config_.rc_min_quantizer = 2;
-  vpx_config_.rc_max_quantizer = 56;
+  ctx.vpx_config.rc_min_quantizer = 2;
+  ctx.vpx_config.rc_max_quantizer = 56;
 
   if (config_.bitrate_mode == VideoEncoderBitrateMode::CONSTANT) {
-    vpx_config_.rc_undershoot_pct = 0;
-    vpx_config_.rc_overshoot_pct = 0;
+    ctx.vpx_config.rc_undershoot_pct = 0;
+    ctx.vpx_config.rc_overshoot_pct = 0;
   } else {
-    vpx_config_.rc_undershoot_pct = 50;
-    vpx_config_.rc_overshoot_pct = 50;
+    ctx.vpx_config.rc_undershoot_pct = 50;
+    ctx.vpx_config.rc_overshoot_pct = 50;
   }
 
-  vpx_config_.rc_buf_sz = 1000;
-  vpx_config_.rc_buf_initial_sz = 600;
-  vpx_config_.rc_buf_optimal_sz = 600;
-  vpx_config_.rc_dropframe_thresh = 0;
-  vpx_config_.rc_resize_allowed = 0;
+  ctx.vpx_config.rc_buf_sz = 1000;
+  ctx.vpx_config.rc_buf_initial_sz = 600;
+  ctx.vpx_config.rc_buf_optimal_sz = 600;
+  ctx.vpx_config.rc_dropframe_thresh = 0;
+  ctx.vpx_config.rc_resize_allowed = 0;
 
   // VP9 の場合、プロファイルとビット深度を設定
   if (is_vp9_codec() &&
       std::holds_alternative<VP9CodecParameters>(codec_params_)) {
     const auto& vp9_params = std::get<VP9CodecParameters>(codec_params_);
-    vpx_config_.g_profile = vp9_params.profile;
+    ctx.vpx_config.g_profile = vp9_params.profile;
 
     // ビット深度は VP9 Profile 2/3 でのみ 10/12 bit をサポート
     if (vp9_params.bit_depth == 8) {
-      vpx_config_.g_bit_depth = VPX_BITS_8;
-      vpx_config_.g_input_bit_depth = 8;
+      ctx.vpx_config.g_bit_depth = VPX_BITS_8;
+      ctx.vpx_config.g_input_bit_depth = 8;
     } else if (vp9_params.bit_depth == 10) {
-      vpx_config_.g_bit_depth = VPX_BITS_10;
-      vpx_config_.g_input_bit_depth = 10;
+      ctx.vpx_config.g_bit_depth = VPX_BITS_10;
+      ctx.vpx_config.g_input_bit_depth = 10;
     } else if (vp9_params.bit_depth == 12) {
-      vpx_config_.g_bit_depth = VPX_BITS_12;
-      vpx_config_.g_input_bit_depth = 12;
+      ctx.vpx_config.g_bit_depth = VPX_BITS_12;
+      ctx.vpx_config.g_input_bit_depth = 12;
     }
   } else {
-    vpx_config_.g_profile = 0;
-    vpx_config_.g_bit_depth = VPX_BITS_8;
-    vpx_config_.g_input_bit_depth = 8;
+    ctx.vpx_config.g_profile = 0;
+    ctx.vpx_config.g_bit_depth = VPX_BITS_8;
+    ctx.vpx_config.g_input_bit_depth = 8;
   }
 
   // キーフレームの設定
-  vpx_config_.kf_mode = VPX_KF_AUTO;
-  vpx_config_.kf_min_dist = 0;
-  vpx_config_.kf_max_dist = 999999;
+  ctx.vpx_config.kf_mode = VPX_KF_AUTO;
+  ctx.vpx_config.kf_min_dist = 0;
+  ctx.vpx_config.kf_max_dist = 999999;
 
   // リアルタイムモードの設定
   if (config_.latency_mode == LatencyMode::REALTIME) {
-    vpx_config_.g_usage = VPX_DL_REALTIME;
-    vpx_config_.g_lag_in_frames = 0;
+    ctx.vpx_config.g_usage = VPX_DL_REALTIME;
+    ctx.vpx_config.g_lag_in_frames = 0;
   } else {
-    vpx_config_.g_usage = VPX_DL_GOOD_QUALITY;
-    vpx_config_.g_lag_in_frames = 25;
+    ctx.vpx_config.g_usage = VPX_DL_GOOD_QUALITY;
+    ctx.vpx_config.g_lag_in_frames = 25;
+  }
+
+  // scalability_mode の空間・時間レイヤー
+  if (scalability_.is_layered()) {
+    const int spatial_layers = scalability_.spatial_layers;
+    const int temporal_layers = scalability_.temporal_layers;
+    // レイヤー構造は先読みなしのリアルタイムエンコードでのみ使える
+    ctx.vpx_config.g_lag_in_frames = 0;
+    ctx.vpx_config.g_error_resilient = VPX_ERROR_RESILIENT_DEFAULT;
+    ctx.vpx_config.ss_number_layers = spatial_layers;
+    ctx.vpx_config.ts_number_layers = temporal_layers;
+    ctx.vpx_config.ts_periodicity =
+        scalability_temporal_periodicity(temporal_layers);
+    for (unsigned int i = 0; i < ctx.vpx_config.ts_periodicity; ++i) {
+      ctx.vpx_config.ts_layer_id[i] = scalability_temporal_layer_id(
+          temporal_layers, i);
+    }
+    for (int tl = 0; tl < temporal_layers; ++tl) {
+      ctx.vpx_config.ts_rate_decimator[tl] = 1 << (temporal_layers - 1 - tl);
+    }
+    set_vpx_layer_bitrates(ctx);
+    if (is_vp9_codec()) {
+      // VP9 は libvpx が時間レイヤーの参照構造を決める
+      ctx.vpx_config.temporal_layering_mode =
+          temporal_layers == 3   ? VP9E_TEMPORAL_LAYERING_MODE_0212
+          : temporal_layers == 2 ? VP9E_TEMPORAL_LAYERING_MODE_0101
+                                 : VP9E_TEMPORAL_LAYERING_MODE_NOLAYERING;
+    }
   }
 
-  vpx_encoder_ = new vpx_codec_ctx_t();
-  res = vpx_codec_enc_init(vpx_encoder_, vpx_iface_, &vpx_config_, 0);
+  ctx.vpx_encoder = new vpx_codec_ctx_t();
+  res = vpx_codec_enc_init(ctx.vpx_encoder, ctx.vpx_iface, &ctx.vpx_config, 0);
   if (res != VPX_CODEC_OK) {
-    delete vpx_encoder_;
-    vpx_encoder_ = nullptr;
+    delete ctx.vpx_encoder;
+    ctx.vpx_encoder = nullptr;
     throw std::runtime_error("Failed to initialize VPX encoder: " +
                              std::string(vpx_codec_err_to_string(res)));
   }
@@ -137,7 +183,7 @@ void VideoEncoder::init_vpx_encoder() {
     } else {
       cpu_used = 4;
     }
-    vpx_codec_control(vpx_encoder_, VP8E_SET_CPUUSED, cpu_used);
+    vpx_codec_control(ctx.vpx_encoder, VP8E_SET_CPUUSED, cpu_used);
   } else {
     // VP9
     if (config_.latency_mode == LatencyMode::REALTIME) {
@@ -154,37 +200,100 @@ void VideoEncoder::init_vpx_encoder() {
     } else {
       cpu_used = 4;
     }
-    vpx_codec_control(vpx_encoder_, VP8E_SET_CPUUSED, cpu_used);
+    vpx_codec_control(ctx.vpx_encoder, VP8E_SET_CPUUSED, cpu_used);
 
     // VP9 固有の設定
-    vpx_codec_control(vpx_encoder_, VP9E_SET_ROW_MT, 1);
-    vpx_codec_control(vpx_encoder_, VP9E_SET_AQ_MODE, 3);
+    vpx_codec_control(ctx.vpx_encoder, VP9E_SET_ROW_MT, 1);
+    vpx_codec_control(ctx.vpx_encoder, VP9E_SET_AQ_MODE, 3);
+
+    // 空間・時間レイヤー
+    // 空間レイヤーはスーパーフレームとして 1 つのパケットにまとめて出力される
+    if (scalability_.is_layered()) {
+      vpx_codec_control(ctx.vpx_encoder, VP9E_SET_SVC, 1);
+      vpx_svc_extra_cfg_t svc_params = {};
+      const int spatial_layers = scalability_.spatial_layers;
+      const int temporal_layers = scalability_.temporal_layers;
+      for (int sl = 0; sl < spatial_layers; ++sl) {
+        svc_params.scaling_factor_num[sl] = 1;
+        svc_params.scaling_factor_den[sl] = 1 << (spatial_layers - 1 - sl);
+        for (int tl = 0; tl < temporal_layers; ++tl) {
+          const int layer = sl * temporal_layers + tl;
+          svc_params.max_quantizers[layer] = ctx.vpx_config.rc_max_quantizer;
+          svc_params.min_quantizers[layer] = ctx.vpx_config.rc_min_quantizer;
+        }
+      }
+      vpx_codec_control(ctx.vpx_encoder, VP9E_SET_SVC_PARAMETERS, &svc_params);
+    }
   }
 
   // ノイズ感度
-  vpx_codec_control(vpx_encoder_, VP8E_SET_NOISE_SENSITIVITY, 0);
+  vpx_codec_control(ctx.vpx_encoder, VP8E_SET_NOISE_SENSITIVITY, 0);
 
   // スタティック閾値
-  vpx_codec_control(vpx_encoder_, VP8E_SET_STATIC_THRESHOLD, 1);
+  vpx_codec_control(ctx.vpx_encoder, VP8E_SET_STATIC_THRESHOLD, 1);
 
   // 最大イントラビットレート
-  vpx_codec_control(vpx_encoder_, VP8E_SET_MAX_INTRA_BITRATE_PCT, 300);
+  vpx_codec_control(ctx.vpx_encoder, VP8E_SET_MAX_INTRA_BITRATE_PCT, 300);
+}
+
+void VideoEncoder::set_vpx_layer_bitrates(EncoderContext& ctx) {
+  const int spatial_layers = scalability_.spatial_layers;
+  const int temporal_layers = scalability_.temporal_layers;
+  const unsigned int target = ctx.vpx_config.rc_target_bitrate;
+  for (int tl = 0; tl < temporal_layers; ++tl) {
+    ctx.vpx_config.ts_target_bitrate[tl] = static_cast<unsigned int>(
+        target * scalability_temporal_rate(temporal_layers, tl));
+  }
+  for (int sl = 0; sl < spatial_layers; ++sl) {
+    const double spatial_rate = scalability_spatial_rate(spatial_layers, sl);
+    ctx.vpx_config.ss_target_bitrate[sl] =
+        static_cast<unsigned int>(target * spatial_rate);
+    for (int tl = 0; tl < temporal_layers; ++tl) {
+      ctx.vpx_config.layer_target_bitrate[sl * temporal_layers + tl] =
+          static_cast<unsigned int>(
+              target * spatial_rate *
+              scalability_temporal_rate(temporal_layers, tl));
+    }
+  }
 }
 
-void VideoEncoder::cleanup_vpx_encoder() {
-  if (vpx_encoder_) {
-    std::lock_guard<std::mutex> lock(vpx_mutex_);
-    vpx_codec_destroy(vpx_encoder_);
-    delete vpx_encoder_;
-    vpx_encoder_ = nullptr;
+bool VideoEncoder::reconfigure_vpx_encoder(EncoderContext& ctx,
+                                           uint64_t bitrate) {
+  std::lock_guard<std::mutex> lock(ctx.vpx_mutex);
+  if (!ctx.vpx_encoder) {
+    return false;
+  }
+  // レート制御の状態を保ったまま目標ビットレートだけを変更する
+  // 失敗した場合に元の設定へ戻せるように保存しておく
+  const vpx_codec_enc_cfg_t previous_config = ctx.vpx_config;
+  ctx.vpx_config.rc_target_bitrate = static_cast<unsigned int>(bitrate / 1000);
+  if (scalability_.is_layered()) {
+    set_vpx_layer_bitrates(ctx);
   }
+  if (vpx_codec_enc_config_set(ctx.vpx_encoder, &ctx.vpx_config) !=
+      VPX_CODEC_OK) {
+    ctx.vpx_config = previous_config;
+    return false;
+  }
+  return true;
 }
 
-void VideoEncoder::encode_frame_vpx(const VideoFrame& frame,
+void VideoEncoder::cleanup_vpx_encoder(EncoderContext& ctx) {
+  if (ctx.vpx_encoder) {
+    std::lock_guard<std::mutex> lock(ctx.vpx_mutex);
+    vpx_codec_destroy(ctx.vpx_encoder);
+    delete ctx.vpx_encoder;
+    ctx.vpx_encoder = nullptr;
+    ctx.pending_inputs.clear();
+  }
+}
+
+void VideoEncoder::encode_frame_vpx(EncoderContext& ctx,
+                                    const VideoFrame& frame,
                                     bool keyframe,
                                     std::optional<uint16_t> quantizer) {
-  std::lock_guard<std::mutex> lock(vpx_mutex_);
-  if (!vpx_encoder_) {
+  std::lock_guard<std::mutex> lock(ctx.vpx_mutex);
+  if (!ctx.vpx_encoder) {
     throw std::runtime_error("VPX encoder not initialized");
   }
 
@@ -192,44 +301,117 @@ void VideoEncoder::encode_frame_vpx(const VideoFrame& frame,
   if (quantizer.has_value() &&
       config_.bitrate_mode == VideoEncoderBitrateMode::QUANTIZER) {
     // VP8/VP9 の場合は min/max quantizer を同じ値に設定して固定 QP を実現
-    vpx_codec_control(vpx_encoder_, VP8E_SET_CQ_LEVEL,
+    vpx_codec_control(ctx.vpx_encoder, VP8E_SET_CQ_LEVEL,
                       static_cast<unsigned int>(quantizer.value()));
   }
 
   // I420 イメージをラップ
+  // I420 以外は変換しながら ctx.i420_input に書き込んだものをラップする
+  unsigned char* planes[3];
+  int strides[3];
+  get_i420_input(ctx, frame, planes, strides);
   vpx_image_t img;
-  unsigned char* base = const_cast<unsigned char*>(frame.plane_ptr(0));
   if (!vpx_img_wrap(&img, VPX_IMG_FMT_I420, config_.width, config_.height, 1,
-                    base)) {
+                    planes[0])) {
     throw std::runtime_error("Failed to wrap VPX image");
   }
-  img.stride[0] = static_cast<int>(config_.width);
-  img.stride[1] = static_cast<int>(config_.width / 2);
-  img.stride[2] = static_cast<int>(config_.width / 2);
-  img.planes[1] = const_cast<unsigned char*>(frame.plane_ptr(1));
-  img.planes[2] = const_cast<unsigned char*>(frame.plane_ptr(2));
+  for (int i = 0; i < 3; ++i) {
+    img.planes[i] = planes[i];
+    img.stride[i] = strides[i];
+  }
 
   // pts/duration in timebase units
-  const vpx_codec_pts_t pts = frame_count_.fetch_add(1);
+  // pts はフレームごとに duration ずつ進め、パケットの pts から入力フレームを特定できるようにする
   const double fps = config_.framerate.value_or(30.0);
-  const unsigned long duration = static_cast<unsigned long>(90000.0 / fps);
+  const unsigned long duration =
+      std::max(1ul, static_cast<unsigned long>(90000.0 / fps));
+  const vpx_codec_pts_t pts =
+      ctx.next_pts.fetch_add(static_cast<int64_t>(duration));
 
   vpx_enc_frame_flags_t flags = keyframe ? VPX_EFLAG_FORCE_KF : 0;
-  vpx_codec_err_t res = vpx_codec_encode(vpx_encoder_, &img, pts, duration,
+
+  // VP8 の時間レイヤーはフレームごとに参照・更新するバッファとレイヤー ID を指定する
+  int temporal_layer_id = 0;
+  if (is_vp8_codec() && scalability_.temporal_layers > 1) {
+    // キーフレームで時間レイヤーのパターンを先頭に戻し、キーフレームを TL0 にする
+    if (keyframe) {
+      ctx.scalability_frame_index = 0;
+    }
+    const uint64_t index = ctx.scalability_frame_index++;
+    temporal_layer_id =
+        scalability_temporal_layer_id(scalability_.temporal_layers, index);
+    flags |= vp8_temporal_layer_flags(scalability_.temporal_layers, index);
+    vpx_codec_control(ctx.vpx_encoder, VP8E_SET_TEMPORAL_LAYER_ID,
+                      temporal_layer_id);
+  }
+
+  register_pending_input(ctx, pts, frame, make_svc_metadata(temporal_layer_id));
+  vpx_codec_err_t res = vpx_codec_encode(ctx.vpx_encoder, &img, pts, duration,
                                          flags, VPX_DL_REALTIME);
   if (res != VPX_CODEC_OK) {
+    ctx.pending_inputs.erase(pts);
     throw std::runtime_error("VPX encode failed: " +
                              std::string(vpx_codec_err_to_string(res)));
   }
 
+  // VP9 は libvpx が決めた時間レイヤーを取得する
+  if (is_vp9_codec() && scalability_.is_layered()) {
+    vpx_svc_layer_id_t layer_id = {};
+    vpx_codec_control(ctx.vpx_encoder, VP9E_GET_SVC_LAYER_ID, &layer_id);
+    temporal_layer_id = layer_id.temporal_layer_id;
+    // レイヤー構造は先読みなしでエンコードするため、このフレームの metadata を更新する
+    auto it = ctx.pending_inputs.find(pts);
+    if (it != ctx.pending_inputs.end()) {
+      it->second.metadata = make_svc_metadata(temporal_layer_id);
+    }
+  }
+
   vpx_codec_iter_t iter = nullptr;
   const vpx_codec_cx_pkt_t* pkt;
-  while ((pkt = vpx_codec_get_cx_data(vpx_encoder_, &iter)) != nullptr) {
+  while ((pkt = vpx_codec_get_cx_data(ctx.vpx_encoder, &iter)) != nullptr) {
     if (pkt->kind == VPX_CODEC_CX_FRAME_PKT) {
       bool is_keyframe = (pkt->data.frame.flags & VPX_FRAME_IS_KEY) != 0;
-      handle_encoded_frame(static_cast<const uint8_t*>(pkt->data.frame.buf),
-                           pkt->data.frame.sz, frame.timestamp(), is_keyframe);
+      // 先読みが有効な場合は以前に渡したフレームのパケットが出力される
+      handle_encoded_frame(ctx,
+                           static_cast<const uint8_t*>(pkt->data.frame.buf),
+                           pkt->data.frame.sz, pkt->data.frame.pts,
+                           is_keyframe);
     }
   }
   vpx_img_free(&img);
 }
+
+void VideoEncoder::flush_vpx_encoder(EncoderContext& ctx) {
+  std::lock_guard<std::mutex> lock(ctx.vpx_mutex);
+  if (!ctx.vpx_encoder) {
+    return;
+  }
+
+  // エンドオブストリームをシグナルするため nullptr を渡す
+  // パケットが出力されなくなるまで繰り返す
+  bool got_packet = true;
+  while (got_packet) {
+    got_packet = false;
+    vpx_codec_err_t res =
+        vpx_codec_encode(ctx.vpx_encoder, nullptr, 0, 0, 0, VPX_DL_REALTIME);
+    if (res != VPX_CODEC_OK) {
+      // フラッシュ時のエラーは致命的ではないため、出力済みのパケットで終了する
+      break;
+    }
+
+    vpx_codec_iter_t iter = nullptr;
+    const vpx_codec_cx_pkt_t* pkt;
+    while ((pkt = vpx_codec_get_cx_data(ctx.vpx_encoder, &iter)) != nullptr) {
+      if (pkt->kind == VPX_CODEC_CX_FRAME_PKT) {
+        got_packet = true;
+        bool is_keyframe = (pkt->data.frame.flags & VPX_FRAME_IS_KEY) != 0;
+        handle_encoded_frame(ctx,
+                             static_cast<const uint8_t*>(pkt->data.frame.buf),
+                             pkt->data.frame.sz, pkt->data.frame.pts,
+                             is_keyframe);
+      }
+    }
+  }
+  // 出力されなかったフレームの情報は次のフレームと対応付けないように破棄する
+  ctx.pending_inputs.clear();
+}
@@ -7,11 +7,20 @@
 
 using namespace nb::literals;
 
+// デコーダーのピクチャを参照するビューの所有者
+// VideoFrame が close() されてもビューが生きている間はピクチャを解放させない
+static nb::capsule make_external_owner(const std::shared_ptr<void>& holder) {
+  return nb::capsule(new std::shared_ptr<void>(holder), [](void* p) noexcept {
+    delete static_cast<std::shared_ptr<void>*>(p);
+  });
+}
+
 // 内部用コンストラクタ（clone, convert_format, デコーダーで使用）
 VideoFrame::VideoFrame(uint32_t width,
                        uint32_t height,
                        VideoPixelFormat format,
-                       int64_t timestamp)
+                       int64_t timestamp,
+                       std::shared_ptr<FramePool> pool)
     : width_(width),
       height_(height),
       format_(format),
@@ -23,13 +32,62 @@ VideoFrame::VideoFrame(uint32_t width,
       display_width_(width),
       display_height_(height),
       rotation_(0),
-      flip_(false) {
+      flip_(false),
+      data_(FramePoolAllocator<uint8_t>(pool)) {
   // 新しいバッファを作成
   size_t frame_size = get_frame_size();
-  data_.resize(frame_size, 0);
+  if (pool) {
+    // プールのバッファは呼び出し側がすべて上書きするためゼロ初期化しない
+    data_.resize(frame_size);
+  } else {
+    data_.resize(frame_size, 0);
+  }
   calculate_plane_info();
 }
 
+// デコーダーのピクチャバッファを参照する内部用コンストラクタ（ゼロコピー）
+VideoFrame::VideoFrame(uint32_t width,
+                       uint32_t height,
+                       VideoPixelFormat format,
+                       int64_t timestamp,
+                       std::shared_ptr<void> holder,
+                       const std::vector<const uint8_t*>& planes,
+                       const std::vector<uint32_t>& strides)
+    : width_(width),
+      height_(height),
+      format_(format),
+      timestamp_(timestamp),
+      duration_(0),
+      closed_(false),
+      coded_width_(width),
+      coded_height_(height),
+      display_width_(width),
+      display_height_(height),
+      rotation_(0),
+      flip_(false),
+      external_holder_(std::move(holder)),
+      external_planes_(planes) {
+  // plane_offsets_ / plane_sizes_ は詰めて配置した場合の値を保持し、
+  // ストライドだけをデコーダーのネイティブな値で上書きする
+  calculate_plane_info();
+  if (external_planes_.size() != plane_offsets_.size() ||
+      strides.size() != plane_offsets_.size()) {
+    throw std::runtime_error("Plane count mismatch with format");
+  }
+  plane_strides_ = strides;
+
+  // layout_ にはネイティブなストライドと先頭プレーンからのオフセットを設定する
+  std::vector<PlaneLayout> layouts;
+  for (size_t i = 0; i < external_planes_.size(); ++i) {
+    uint32_t offset = 0;
+    if (external_planes_[i] >= external_planes_[0]) {
+      offset = static_cast<uint32_t>(external_planes_[i] - external_planes_[0]);
+    }
+    layouts.push_back(PlaneLayout{offset, plane_strides_[i]});
+  }
+  layout_ = layouts;
+}
+
 // init_dict をパースして共通プロパティを初期化するヘルパー
 void VideoFrame::init_from_dict(nb::dict init_dict) {
   // 必須パラメータのチェック
@@ -228,8 +286,11 @@ VideoFrame::VideoFrame(const VideoFrame& other)
       flip_(other.flip_),
       metadata_(other.metadata_),
       data_(other.data_),
+      external_holder_(other.external_holder_),
+      external_planes_(other.external_planes_),
       plane_offsets_(other.plane_offsets_),
-      plane_sizes_(other.plane_sizes_) {
+      plane_sizes_(other.plane_sizes_),
+      plane_strides_(other.plane_strides_) {
   if (other.closed_) {
     throw std::runtime_error("Cannot copy closed VideoFrame");
   }
@@ -266,15 +327,22 @@ VideoFrame& VideoFrame::operator=(const VideoFrame& other) {
   flip_ = other.flip_;
   metadata_ = other.metadata_;
   data_ = other.data_;
+  external_holder_ = other.external_holder_;
+  external_planes_ = other.external_planes_;
   plane_offsets_ = other.plane_offsets_;
   plane_sizes_ = other.plane_sizes_;
+  plane_strides_ = other.plane_strides_;
 
   return *this;
 }
 
 void VideoFrame::close() {
   if (!closed_) {
-    data_.clear();
+    // clear() では容量が残るため、空のバッファと入れ替えてプールに返す
+    data_ = FrameBuffer(data_.get_allocator());
+    // デコーダーのピクチャへの参照を解放する
+    external_holder_.reset();
+    external_planes_.clear();
     closed_ = true;
   }
 }
@@ -424,40 +492,107 @@ size_t VideoFrame::get_frame_size() const {
 void VideoFrame::calculate_plane_info() {
   plane_offsets_.clear();
   plane_sizes_.clear();
+  plane_strides_.clear();
 
   switch (format_) {
     case VideoPixelFormat::I420:
       plane_offsets_ = {0, width_ * height_, width_ * height_ * 5 / 4};
       plane_sizes_ = {width_ * height_, width_ * height_ / 4,
                       width_ * height_ / 4};
+      plane_strides_ = {width_, width_ / 2, width_ / 2};
       break;
     case VideoPixelFormat::I422:
       plane_offsets_ = {0, width_ * height_, width_ * height_ * 3 / 2};
       plane_sizes_ = {width_ * height_, width_ * height_ / 2,
                       width_ * height_ / 2};
+      plane_strides_ = {width_, width_ / 2, width_ / 2};
       break;
     case VideoPixelFormat::I444:
       plane_offsets_ = {0, width_ * height_, width_ * height_ * 2};
       plane_sizes_ = {width_ * height_, width_ * height_, width_ * height_};
+      plane_strides_ = {width_, width_, width_};
       break;
     case VideoPixelFormat::NV12:
       plane_offsets_ = {0, width_ * height_};
       plane_sizes_ = {width_ * height_, width_ * height_ / 2};
+      plane_strides_ = {width_, width_};
       break;
     case VideoPixelFormat::RGB:
     case VideoPixelFormat::BGR:
       plane_offsets_ = {0};
       plane_sizes_ = {width_ * height_ * 3};
+      plane_strides_ = {width_ * 3};
       break;
     case VideoPixelFormat::RGBA:
     case VideoPixelFormat::BGRA:
       plane_offsets_ = {0};
       plane_sizes_ = {width_ * height_ * 4};
+      plane_strides_ = {width_ * 4};
       break;
   }
 }
 
-nb::ndarray<nb::numpy> VideoFrame::plane(int plane_index) const {
+void VideoFrame::packed_plane_size(int plane_index,
+                                   uint32_t* row_bytes,
+                                   uint32_t* rows) const {
+  *row_bytes = width_;
+  *rows = height_;
+  switch (format_) {
+    case VideoPixelFormat::I420:
+      *row_bytes = plane_index == 0 ? width_ : width_ / 2;
+      *rows = plane_index == 0 ? height_ : height_ / 2;
+      break;
+    case VideoPixelFormat::I422:
+      *row_bytes = plane_index == 0 ? width_ : width_ / 2;
+      break;
+    case VideoPixelFormat::I444:
+      *row_bytes = width_;
+      break;
+    case VideoPixelFormat::NV12:
+      *row_bytes = width_;
+      *rows = plane_index == 0 ? height_ : height_ / 2;
+      break;
+    case VideoPixelFormat::RGB:
+    case VideoPixelFormat::BGR:
+      *row_bytes = width_ * 3;
+      break;
+    case VideoPixelFormat::RGBA:
+    case VideoPixelFormat::BGRA:
+      *row_bytes = width_ * 4;
+      break;
+  }
+}
+
+std::shared_ptr<FramePool> VideoFrame::derived_pool() const {
+  const auto& pool = data_.get_allocator().pool();
+  return pool ? pool : FramePool::global();
+}
+
+void VideoFrame::detach_external_buffer() {
+  if (!external_holder_) {
+    return;
+  }
+
+  // ネイティブなストライドから詰めた配置に行単位でコピーする
+  FrameBuffer data{FramePoolAllocator<uint8_t>(FramePool::global())};
+  data.resize(get_frame_size());
+  for (size_t i = 0; i < plane_offsets_.size(); ++i) {
+    uint32_t row_bytes = 0;
+    uint32_t rows = 0;
+    packed_plane_size(static_cast<int>(i), &row_bytes, &rows);
+    libyuv::CopyPlane(external_planes_[i], plane_strides_[i],
+                      data.data() + plane_offsets_[i], row_bytes, row_bytes,
+                      rows);
+  }
+
+  data_ = std::move(data);
+  external_holder_.reset();
+  external_planes_.clear();
+  layout_.reset();
+  calculate_plane_info();
+}
+
+nb::object VideoFrame::plane(int plane_index) const {
   if (closed_) {
     throw std::runtime_error("VideoFrame is closed");
   }
@@ -490,10 +625,19 @@ nb::ndarray<nb::numpy> VideoFrame::plane(int plane_index) const {
   }
 
   size_t shape[2] = {plane_height, plane_width};
+  if (is_borrowed()) {
+    // デコーダーのピクチャを参照している場合はネイティブなストライドを持つ
+    // 読み取り専用のビューを返す（参照フレームを書き換えさせないため）
+    int64_t strides[2] = {static_cast<int64_t>(plane_strides_[plane_index]),
+                          1};
+    return nb::cast(nb::ndarray<nb::numpy, nb::ro>(
+        external_planes_[plane_index], 2, shape,
+        make_external_owner(external_holder_), strides, nb::dtype<uint8_t>()));
+  }
   // 内部データへのビューを返す
-  return nb::ndarray<nb::numpy>(
+  return nb::cast(nb::ndarray<nb::numpy>(
       const_cast<uint8_t*>(data_.data()) + plane_offsets_[plane_index], 2,
-      shape, nb::handle(), nullptr, nb::dtype<uint8_t>());
+      shape, nb::handle(), nullptr, nb::dtype<uint8_t>()));
 }
 
 nb::ndarray<nb::numpy> VideoFrame::get_writable_plane(int plane_index) {
@@ -501,6 +645,9 @@ nb::ndarray<nb::numpy> VideoFrame::get_writable_plane(int plane_index) {
     throw std::runtime_error("VideoFrame is closed");
   }
 
+  // 書き込む前にデコーダーのピクチャから自前のバッファへ切り替える
+  detach_external_buffer();
+
   if (plane_index < 0 || plane_index >= plane_offsets_.size()) {
     throw std::out_of_range("Invalid plane index");
   }
@@ -528,7 +675,7 @@ nb::ndarray<nb::numpy> VideoFrame::get_writable_plane(int plane_index) {
       shape, nb::handle(), nullptr, nb::dtype<uint8_t>());
 }
 
-nb::ndarray<nb::numpy> VideoFrame::get_plane_data(int plane_index) const {
+nb::object VideoFrame::get_plane_data(int plane_index) const {
   return plane(plane_index);
 }
 
@@ -540,10 +687,28 @@ const uint8_t* VideoFrame::plane_ptr(int plane_index) const {
       plane_index >= static_cast<int>(plane_offsets_.size())) {
     throw std::out_of_range("Invalid plane index");
   }
+  if (external_holder_) {
+    return external_planes_[plane_index];
+  }
   return data_.data() + plane_offsets_[plane_index];
 }
 
+uint32_t VideoFrame::plane_stride(int plane_index) const {
+  if (closed_) {
+    throw std::runtime_error("VideoFrame is closed");
+  }
+  if (plane_index < 0 ||
+      plane_index >= static_cast<int>(plane_strides_.size())) {
+    throw std::out_of_range("Invalid plane index");
+  }
+  return plane_strides_[plane_index];
+}
+
 uint8_t* VideoFrame::mutable_plane_ptr(int plane_index) {
+  if (closed_) {
+    throw std::runtime_error("VideoFrame is closed");
+  }
+  detach_external_buffer();
   return const_cast<uint8_t*>(plane_ptr(plane_index));
 }
 
@@ -551,6 +716,7 @@ uint8_t* VideoFrame::mutable_data() {
   if (closed_) {
     throw std::runtime_error("VideoFrame is closed");
   }
+  detach_external_buffer();
   return data_.data();
 }
 
@@ -560,65 +726,32 @@ std::unique_ptr<VideoFrame> VideoFrame::convert_format(
     throw std::runtime_error("VideoFrame is closed");
   }
 
-  auto result =
-      std::make_unique<VideoFrame>(width_, height_, target_format, timestamp_);
+  auto result = std::make_unique<VideoFrame>(width_, height_, target_format,
+                                             timestamp_, derived_pool());
   result->set_duration(duration_);
 
   // libyuv を使用して変換
+  // 変換元はデコーダーのピクチャを参照している場合があるため、
+  // プレーンのポインタとストライドは plane_ptr / plane_stride から取得する
   if (format_ == VideoPixelFormat::I420 &&
       target_format == VideoPixelFormat::RGBA) {
-    libyuv::I420ToABGR(data_.data() + plane_offsets_[0], width_,
-                       data_.data() + plane_offsets_[1], width_ / 2,
-                       data_.data() + plane_offsets_[2], width_ / 2,
+    libyuv::I420ToABGR(plane_ptr(0), plane_stride(0), plane_ptr(1),
+                       plane_stride(1), plane_ptr(2), plane_stride(2),
                        result->mutable_data(), width_ * 4, width_, height_);
   } else if (format_ == VideoPixelFormat::I420 &&
              target_format == VideoPixelFormat::RGB) {
-    libyuv::I420ToRGB24(data_.data() + plane_offsets_[0], width_,
-                        data_.data() + plane_offsets_[1], width_ / 2,
-                        data_.data() + plane_offsets_[2], width_ / 2,
+    libyuv::I420ToRGB24(plane_ptr(0), plane_stride(0), plane_ptr(1),
+                        plane_stride(1), plane_ptr(2), plane_stride(2),
                         result->mutable_data(), width_ * 3, width_, height_);
-  } else if (format_ == VideoPixelFormat::RGB &&
-             target_format == VideoPixelFormat::I420) {
-    libyuv::RGB24ToI420(
-        data_.data(), width_ * 3,
-        result->mutable_data() + result->plane_offsets_[0], width_,
-        result->mutable_data() + result->plane_offsets_[1], width_ / 2,
-        result->mutable_data() + result->plane_offsets_[2], width_ / 2, width_,
-        height_);
-  } else if (format_ == VideoPixelFormat::RGBA &&
-             target_format == VideoPixelFormat::I420) {
-    libyuv::ABGRToI420(
-        data_.data(), width_ * 4,
-        result->mutable_data() + result->plane_offsets_[0], width_,
-        result->mutable_data() + result->plane_offsets_[1], width_ / 2,
-        result->mutable_data() + result->plane_offsets_[2], width_ / 2, width_,
-        height_);
-  } else if (format_ == VideoPixelFormat::BGRA &&
-             target_format == VideoPixelFormat::I420) {
-    libyuv::ARGBToI420(
-        data_.data(), width_ * 4,
-        result->mutable_data() + result->plane_offsets_[0], width_,
-        result->mutable_data() + result->plane_offsets_[1], width_ / 2,
-        result->mutable_data() + result->plane_offsets_[2], width_ / 2, width_,
-        height_);
-  } else if (format_ == VideoPixelFormat::NV12 &&
-             target_format == VideoPixelFormat::I420) {
-    libyuv::NV12ToI420(
-        data_.data() + plane_offsets_[0], width_,
-        data_.data() + plane_offsets_[1], width_,
-        result->mutable_data() + result->plane_offsets_[0], width_,
-        result->mutable_data() + result->plane_offsets_[1], width_ / 2,
-        result->mutable_data() + result->plane_offsets_[2], width_ / 2, width_,
-        height_);
-  } else if (format_ == VideoPixelFormat::I420 &&
-             target_format == VideoPixelFormat::NV12) {
-    libyuv::I420ToNV12(data_.data() + plane_offsets_[0], width_,
-                       data_.data() + plane_offsets_[1], width_ / 2,
-                       data_.data() + plane_offsets_[2], width_ / 2,
-                       result->mutable_data() + result->plane_offsets_[0],
-                       width_,
-                       result->mutable_data() + result->plane_offsets_[1],
-                       width_, width_, height_);
+  } else if (target_format == VideoPixelFormat::I420) {
+    uint8_t* dst = result->mutable_data();
+    write_i420(dst + result->plane_offsets_[0], width_,
+               dst + result->plane_offsets_[1], width_ / 2,
+               dst + result->plane_offsets_[2], width_ / 2);
+  } else if (target_format == VideoPixelFormat::NV12) {
+    uint8_t* dst = result->mutable_data();
+    write_nv12(dst + result->plane_offsets_[0], width_,
+               dst + result->plane_offsets_[1], width_);
   } else {
     throw std::runtime_error("Unsupported conversion");
   }
@@ -640,8 +773,13 @@ std::unique_ptr<VideoFrame> VideoFrame::clone() const {
         "Cannot clone: VideoFrame was created with native_buffer only");
   }
 
-  auto cloned =
-      std::make_unique<VideoFrame>(width_, height_, format_, timestamp_);
+  // デコーダーのピクチャを参照している場合は参照を共有する（コピーしない）
+  if (is_borrowed()) {
+    return std::make_unique<VideoFrame>(*this);
+  }
+
+  auto cloned = std::make_unique<VideoFrame>(width_, height_, format_,
+                                             timestamp_, derived_pool());
   cloned->set_duration(duration_);
   cloned->coded_width_ = coded_width_;
   cloned->coded_height_ = coded_height_;
@@ -657,14 +795,15 @@ std::unique_ptr<VideoFrame> VideoFrame::clone() const {
   return cloned;
 }
 
-std::unique_ptr<VideoFrame> VideoFrame::create_encoder_copy() const {
+std::unique_ptr<VideoFrame> VideoFrame::create_encoder_copy(
+    std::shared_ptr<FramePool> pool) const {
   if (closed_) {
     throw std::runtime_error("VideoFrame is closed");
   }
 
   // 新しい VideoFrame を作成（常にメモリを所有）
-  auto copy =
-      std::make_unique<VideoFrame>(width_, height_, format_, timestamp_);
+  auto copy = std::make_unique<VideoFrame>(
+      width_, height_, format_, timestamp_, pool ? pool : derived_pool());
 
   // 基本プロパティをコピー
   copy->duration_ = duration_;
@@ -680,11 +819,143 @@ std::unique_ptr<VideoFrame> VideoFrame::create_encoder_copy() const {
   copy->metadata_ = metadata_;
 
   // データを深くコピー（エンコーダー安全性のため必須）
-  std::memcpy(copy->mutable_data(), data_.data(), data_.size());
+  if (is_borrowed()) {
+    // デコーダーのピクチャはストライドが詰まっていないため行単位でコピーする
+    for (size_t i = 0; i < plane_offsets_.size(); ++i) {
+      uint32_t row_bytes = 0;
+      uint32_t rows = 0;
+      packed_plane_size(static_cast<int>(i), &row_bytes, &rows);
+      libyuv::CopyPlane(external_planes_[i], plane_strides_[i],
+                        copy->mutable_data() + copy->plane_offsets_[i],
+                        row_bytes, row_bytes, rows);
+    }
+    // layout_ はネイティブな配置を表すためコピー先には引き継がない
+    copy->layout_.reset();
+  } else {
+    std::memcpy(copy->mutable_data(), data_.data(), data_.size());
+  }
 
   return copy;
 }
 
+std::unique_ptr<VideoFrame> VideoFrame::transfer() {
+  if (closed_) {
+    throw std::runtime_error("VideoFrame is closed");
+  }
+  if (!has_data()) {
+    throw std::runtime_error(
+        "Cannot transfer: VideoFrame was created with native_buffer only");
+  }
+
+  // バッファと metadata を取り出してから残りのプロパティをコピーする
+  // (metadata は GIL なしで参照カウントを操作しないよう move する)
+  FrameBuffer data = std::move(data_);
+  data_ = FrameBuffer(data.get_allocator());
+  std::optional<nb::dict> metadata = std::move(metadata_);
+  metadata_.reset();
+
+  auto transferred = std::make_unique<VideoFrame>(*this);
+  transferred->data_ = std::move(data);
+  transferred->metadata_ = std::move(metadata);
+
+  // デコーダーのピクチャへの参照は transferred と共有しているので、
+  // close() で手放しても解放されない
+  close();
+  return transferred;
+}
+
+void VideoFrame::write_i420(uint8_t* dst_y,
+                            int dst_stride_y,
+                            uint8_t* dst_u,
+                            int dst_stride_u,
+                            uint8_t* dst_v,
+                            int dst_stride_v) const {
+  if (closed_) {
+    throw std::runtime_error("VideoFrame is closed");
+  }
+
+  int width = static_cast<int>(width_);
+  int height = static_cast<int>(height_);
+  int result = 0;
+  switch (format_) {
+    case VideoPixelFormat::I420:
+      result = libyuv::I420Copy(plane_ptr(0), plane_stride(0), plane_ptr(1),
+                                plane_stride(1), plane_ptr(2), plane_stride(2),
+                                dst_y, dst_stride_y, dst_u, dst_stride_u, dst_v,
+                                dst_stride_v, width, height);
+      break;
+    case VideoPixelFormat::NV12:
+      result = libyuv::NV12ToI420(plane_ptr(0), plane_stride(0), plane_ptr(1),
+                                  plane_stride(1), dst_y, dst_stride_y, dst_u,
+                                  dst_stride_u, dst_v, dst_stride_v, width,
+                                  height);
+      break;
+    case VideoPixelFormat::RGBA:
+      result = libyuv::ABGRToI420(plane_ptr(0), plane_stride(0), dst_y,
+                                  dst_stride_y, dst_u, dst_stride_u, dst_v,
+                                  dst_stride_v, width, height);
+      break;
+    case VideoPixelFormat::BGRA:
+      result = libyuv::ARGBToI420(plane_ptr(0), plane_stride(0), dst_y,
+                                  dst_stride_y, dst_u, dst_stride_u, dst_v,
+                                  dst_stride_v, width, height);
+      break;
+    case VideoPixelFormat::RGB:
+      result = libyuv::RGB24ToI420(plane_ptr(0), plane_stride(0), dst_y,
+                                   dst_stride_y, dst_u, dst_stride_u, dst_v,
+                                   dst_stride_v, width, height);
+      break;
+    default:
+      throw std::runtime_error("Unsupported conversion");
+  }
+  if (result != 0) {
+    throw std::runtime_error("Failed to convert VideoFrame to I420");
+  }
+}
+
+void VideoFrame::write_nv12(uint8_t* dst_y,
+                            int dst_stride_y,
+                            uint8_t* dst_uv,
+                            int dst_stride_uv) const {
+  if (closed_) {
+    throw std::runtime_error("VideoFrame is closed");
+  }
+
+  int width = static_cast<int>(width_);
+  int height = static_cast<int>(height_);
+  int result = 0;
+  switch (format_) {
+    case VideoPixelFormat::NV12:
+      // UV プレーンは U と V が交互に並ぶため、幅は輝度と同じバイト数になる
+      libyuv::CopyPlane(plane_ptr(0), plane_stride(0), dst_y, dst_stride_y,
+                        width, height);
+      libyuv::CopyPlane(plane_ptr(1), plane_stride(1), dst_uv, dst_stride_uv,
+                        (width + 1) / 2 * 2, (height + 1) / 2);
+      break;
+    case VideoPixelFormat::I420:
+      result = libyuv::I420ToNV12(plane_ptr(0), plane_stride(0), plane_ptr(1),
+                                  plane_stride(1), plane_ptr(2), plane_stride(2),
+                                  dst_y, dst_stride_y, dst_uv, dst_stride_uv,
+                                  width, height);
+      break;
+    case VideoPixelFormat::RGBA:
+      result = libyuv::ABGRToNV12(plane_ptr(0), plane_stride(0), dst_y,
+                                  dst_stride_y, dst_uv, dst_stride_uv, width,
+                                  height);
+      break;
+    case VideoPixelFormat::BGRA:
+      result = libyuv::ARGBToNV12(plane_ptr(0), plane_stride(0), dst_y,
+                                  dst_stride_y, dst_uv, dst_stride_uv, width,
+                                  height);
+      break;
+    default:
+      throw std::runtime_error("Unsupported conversion");
+  }
+  if (result != 0) {
+    throw std::runtime_error("Failed to convert VideoFrame to NV12");
+  }
+}
+
 // copy_to(): WebCodecs API 準拠の実装
 // destination に書き込み、PlaneLayout のリストを返す
 std::vector<PlaneLayout> VideoFrame::copy_to(
@@ -699,6 +970,11 @@ std::vector<PlaneLayout> VideoFrame::copy_to(
         "Cannot copy data: VideoFrame was created with native_buffer only");
   }
 
+  // デコーダーのピクチャを参照している場合はストライドを考慮してコピーする
+  if (is_borrowed()) {
+    return copy_to(destination, nb::dict());
+  }
+
   // destination のサイズを検証
   if (destination.ndim() != 1) {
     throw std::runtime_error("destination must be a 1D array");
@@ -887,10 +1163,9 @@ std::vector<PlaneLayout> VideoFrame::copy_to(nb::ndarray<nb::numpy> destination,
 
     // Y プレーンをコピー
     {
-      uint32_t src_stride = width_;
+      uint32_t src_stride = plane_stride(0);
       uint32_t dst_stride = output_layout[0].stride;
-      const uint8_t* src =
-          data_.data() + plane_offsets_[0] + rect_y * src_stride + rect_x;
+      const uint8_t* src = plane_ptr(0) + rect_y * src_stride + rect_x;
       uint8_t* dst = dest_ptr + output_layout[0].offset;
       for (uint32_t row = 0; row < y_height; ++row) {
         std::memcpy(dst + row * dst_stride, src + row * src_stride, y_width);
@@ -899,13 +1174,13 @@ std::vector<PlaneLayout> VideoFrame::copy_to(nb::ndarray<nb::numpy> destination,
 
     // UV プレーンをコピー（インターリーブ）
     {
-      uint32_t src_stride = width_;
+      uint32_t src_stride = plane_stride(1);
       uint32_t src_y_offset = rect_y / 2;
       uint32_t src_x_offset =
           rect_x;  // UV はインターリーブなので x オフセットはそのまま
       uint32_t dst_stride = output_layout[1].stride;
-      const uint8_t* src = data_.data() + plane_offsets_[1] +
-                           src_y_offset * src_stride + src_x_offset;
+      const uint8_t* src =
+          plane_ptr(1) + src_y_offset * src_stride + src_x_offset;
       uint8_t* dst = dest_ptr + output_layout[1].offset;
       for (uint32_t row = 0; row < uv_height; ++row) {
         std::memcpy(dst + row * dst_stride, src + row * src_stride, uv_width);
@@ -959,10 +1234,9 @@ std::vector<PlaneLayout> VideoFrame::copy_to(nb::ndarray<nb::numpy> destination,
   // 各プレーンをコピー（rect を適用）
   // Y プレーン
   {
-    uint32_t src_stride = width_;
+    uint32_t src_stride = plane_stride(0);
     uint32_t dst_stride = output_layout[0].stride;
-    const uint8_t* src =
-        data_.data() + plane_offsets_[0] + rect_y * src_stride + rect_x;
+    const uint8_t* src = plane_ptr(0) + rect_y * src_stride + rect_x;
     uint8_t* dst = dest_ptr + output_layout[0].offset;
     for (uint32_t row = 0; row < y_height; ++row) {
       std::memcpy(dst + row * dst_stride, src + row * src_stride, y_width);
@@ -971,15 +1245,14 @@ std::vector<PlaneLayout> VideoFrame::copy_to(nb::ndarray<nb::numpy> destination,
 
   // U プレーン
   {
-    uint32_t src_stride =
-        (format_ == VideoPixelFormat::I444) ? width_ : width_ / 2;
+    uint32_t src_stride = plane_stride(1);
     uint32_t src_y_offset =
         (format_ == VideoPixelFormat::I444) ? rect_y : rect_y / 2;
     uint32_t src_x_offset =
         (format_ == VideoPixelFormat::I444) ? rect_x : rect_x / 2;
     uint32_t dst_stride = output_layout[1].stride;
-    const uint8_t* src = data_.data() + plane_offsets_[1] +
-                         src_y_offset * src_stride + src_x_offset;
+    const uint8_t* src =
+        plane_ptr(1) + src_y_offset * src_stride + src_x_offset;
     uint8_t* dst = dest_ptr + output_layout[1].offset;
     for (uint32_t row = 0; row < uv_height; ++row) {
       std::memcpy(dst + row * dst_stride, src + row * src_stride, uv_width);
@@ -988,15 +1261,14 @@ std::vector<PlaneLayout> VideoFrame::copy_to(nb::ndarray<nb::numpy> destination,
 
   // V プレーン
   {
-    uint32_t src_stride =
-        (format_ == VideoPixelFormat::I444) ? width_ : width_ / 2;
+    uint32_t src_stride = plane_stride(2);
     uint32_t src_y_offset =
         (format_ == VideoPixelFormat::I444) ? rect_y : rect_y / 2;
     uint32_t src_x_offset =
         (format_ == VideoPixelFormat::I444) ? rect_x : rect_x / 2;
     uint32_t dst_stride = output_layout[2].stride;
-    const uint8_t* src = data_.data() + plane_offsets_[2] +
-                         src_y_offset * src_stride + src_x_offset;
+    const uint8_t* src =
+        plane_ptr(2) + src_y_offset * src_stride + src_x_offset;
     uint8_t* dst = dest_ptr + output_layout[2].offset;
     for (uint32_t row = 0; row < uv_height; ++row) {
       std::memcpy(dst + row * dst_stride, src + row * src_stride, uv_width);
@@ -1045,16 +1317,36 @@ nb::tuple VideoFrame::planes() {
   nb::handle owner = nb::handle();  // データは std::vector が所有
 
   size_t y_shape[2] = {y_height, y_width};
+  size_t u_shape[2] = {u_height, u_width};
+  size_t v_shape[2] = {v_height, v_width};
+
+  if (is_borrowed()) {
+    // デコーダーのピクチャを参照している場合はネイティブなストライドを持つ
+    // 読み取り専用のビューを返す（参照フレームを書き換えさせないため）
+    int64_t y_strides[2] = {static_cast<int64_t>(plane_strides_[0]), 1};
+    int64_t u_strides[2] = {static_cast<int64_t>(plane_strides_[1]), 1};
+    int64_t v_strides[2] = {static_cast<int64_t>(plane_strides_[2]), 1};
+    nb::capsule external_owner = make_external_owner(external_holder_);
+    auto y_plane = nb::ndarray<nb::numpy, nb::ro>(
+        external_planes_[0], 2, y_shape, external_owner, y_strides,
+        nb::dtype<uint8_t>());
+    auto u_plane = nb::ndarray<nb::numpy, nb::ro>(
+        external_planes_[1], 2, u_shape, external_owner, u_strides,
+        nb::dtype<uint8_t>());
+    auto v_plane = nb::ndarray<nb::numpy, nb::ro>(
+        external_planes_[2], 2, v_shape, external_owner, v_strides,
+        nb::dtype<uint8_t>());
+    return nb::make_tuple(y_plane, u_plane, v_plane);
+  }
+
   auto y_plane = nb::ndarray<nb::numpy>(
       const_cast<uint8_t*>(data_.data()) + plane_offsets_[0], 2, y_shape, owner,
       nullptr, nb::dtype<uint8_t>());
 
-  size_t u_shape[2] = {u_height, u_width};
   auto u_plane = nb::ndarray<nb::numpy>(
       const_cast<uint8_t*>(data_.data()) + plane_offsets_[1], 2, u_shape, owner,
       nullptr, nb::dtype<uint8_t>());
 
-  size_t v_shape[2] = {v_height, v_width};
   auto v_plane = nb::ndarray<nb::numpy>(
       const_cast<uint8_t*>(data_.data()) + plane_offsets_[2], 2, v_shape, owner,
       nullptr, nb::dtype<uint8_t>());
@@ -1146,6 +1438,9 @@ void init_video_frame(nb::module_& m) {
       .def_prop_ro(
           "color_space", &VideoFrame::color_space,
           nb::sig("def color_space(self, /) -> VideoColorSpace | None"))
+      .def_prop_ro(
+          "layout", &VideoFrame::layout,
+          nb::sig("def layout(self, /) -> list[PlaneLayout] | None"))
       .def_prop_ro("rotation", &VideoFrame::rotation,
                    nb::sig("def rotation(self, /) -> int"))
       .def_prop_ro("flip", &VideoFrame::flip,
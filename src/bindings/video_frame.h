@@ -6,21 +6,11 @@
 #include <memory>
 #include <optional>
 #include <vector>
+#include "frame_pool.h"
 #include "webcodecs_types.h"
 
 namespace nb = nanobind;
 
-enum class VideoPixelFormat {
-  I420,  // YUV 4:2:0
-  I422,  // YUV 4:2:2
-  I444,  // YUV 4:4:4
-  NV12,  // YUV 4:2:0 with interleaved UV
-  RGBA,  // RGBA 8-bit per channel
-  BGRA,  // BGRA 8-bit per channel
-  RGB,   // RGB 8-bit per channel
-  BGR,   // BGR 8-bit per channel
-};
-
 class VideoFrame {
  public:
   // WebCodecs API 準拠コンストラクタ (dict を受け取る)
@@ -31,10 +21,24 @@ class VideoFrame {
 
   // 内部用コンストラクタ（clone, convert_format, デコーダーで使用）
   // Python バインディングには公開しない
+  // pool を指定した場合はプールからバッファを受け取り、ゼロ初期化しない
+  // （呼び出し側がすべてのプレーンを書き込むこと）
+  VideoFrame(uint32_t width,
+             uint32_t height,
+             VideoPixelFormat format,
+             int64_t timestamp = 0,
+             std::shared_ptr<FramePool> pool = nullptr);
+
+  // デコーダーのピクチャバッファを参照する内部用コンストラクタ（ゼロコピー）
+  // holder が生きている間は planes が指すメモリが有効であることを保証する
+  // Python バインディングには公開しない
   VideoFrame(uint32_t width,
              uint32_t height,
              VideoPixelFormat format,
-             int64_t timestamp = 0);
+             int64_t timestamp,
+             std::shared_ptr<void> holder,
+             const std::vector<const uint8_t*>& planes,
+             const std::vector<uint32_t>& strides);
 
   // コピーコンストラクタとコピー代入演算子
   VideoFrame(const VideoFrame& other);
@@ -76,14 +80,20 @@ class VideoFrame {
   void* native_buffer_ptr() const;
 
   // データの存在チェック (native_buffer のみの場合は false)
-  bool has_data() const { return !data_.empty(); }
+  bool has_data() const {
+    return !data_.empty() || external_holder_ != nullptr;
+  }
+
+  // デコーダーのピクチャバッファを参照しているか (ゼロコピー)
+  bool is_borrowed() const { return external_holder_ != nullptr; }
 
   // Data access
-  nb::ndarray<nb::numpy> plane(int plane_index) const;
+  nb::object plane(int plane_index) const;
   nb::ndarray<nb::numpy> get_writable_plane(
       int plane_index);  // 書き込み可能なビュー（内部用）
-  nb::ndarray<nb::numpy> get_plane_data(int plane_index) const;
+  nb::object get_plane_data(int plane_index) const;
   const uint8_t* plane_ptr(int plane_index) const;
+  uint32_t plane_stride(int plane_index) const;
   uint8_t* mutable_plane_ptr(int plane_index);
   uint8_t* mutable_data();
 
@@ -91,6 +101,20 @@ class VideoFrame {
   std::unique_ptr<VideoFrame> convert_format(
       VideoPixelFormat target_format) const;
 
+  // エンコーダーの入力バッファに I420 / NV12 で直接書き込む（内部使用）
+  // 変換が必要な場合も中間フレームを作らずに 1 回の走査で書き込む
+  // 対応する変換元: I420, NV12, RGBA, BGRA (I420 のみ RGB も対応)
+  void write_i420(uint8_t* dst_y,
+                  int dst_stride_y,
+                  uint8_t* dst_u,
+                  int dst_stride_u,
+                  uint8_t* dst_v,
+                  int dst_stride_v) const;
+  void write_nv12(uint8_t* dst_y,
+                  int dst_stride_y,
+                  uint8_t* dst_uv,
+                  int dst_stride_uv) const;
+
   // VideoFrameCopyToOptions のパース結果
   struct CopyToOptions {
     std::optional<DOMRect> rect;                     // コピーする領域
@@ -117,7 +141,13 @@ class VideoFrame {
   std::unique_ptr<VideoFrame> clone() const;
 
   // エンコーダー専用のコピーメソッド（内部使用）
-  std::unique_ptr<VideoFrame> create_encoder_copy() const;
+  // pool を指定しない場合はこのフレームのプール、なければ共有プールを使う
+  std::unique_ptr<VideoFrame> create_encoder_copy(
+      std::shared_ptr<FramePool> pool = nullptr) const;
+
+  // バッファの所有権を新しい VideoFrame に移してこのフレームを close する（内部使用）
+  // データはコピーしない
+  std::unique_ptr<VideoFrame> transfer();
 
  private:
   uint32_t width_;
@@ -143,13 +173,27 @@ class VideoFrame {
   // macOS: CVPixelBufferRef を保持
   nb::object native_buffer_;
 
-  // データストレージ
-  std::vector<uint8_t> data_;
+  // データストレージ (FramePool から確保される)
+  FrameBuffer data_;
+
+  // 外部バッファ (dav1d / libvpx のピクチャ) の参照
+  // 設定されている場合 data_ は空で、external_planes_ がプレーンを指す
+  std::shared_ptr<void> external_holder_;
+  std::vector<const uint8_t*> external_planes_;
 
   std::vector<size_t> plane_offsets_;
   std::vector<size_t> plane_sizes_;
+  std::vector<uint32_t> plane_strides_;
 
   void calculate_plane_info();
+  // clone() や convert_format() で作るフレームが使うプール
+  std::shared_ptr<FramePool> derived_pool() const;
+  // 詰めて配置した場合のプレーンの 1 行のバイト数と行数
+  void packed_plane_size(int plane_index,
+                         uint32_t* row_bytes,
+                         uint32_t* rows) const;
+  // 外部バッファの内容を data_ にコピーして参照を手放す
+  void detach_external_buffer();
   size_t get_frame_size() const;
   VideoPixelFormat string_to_format(const std::string& format_str) const;
 
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstdint>
+#include <stdexcept>
+
+#if defined(__linux__)
+#include <sys/eventfd.h>
+#include <unistd.h>
+#elif !defined(_WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// イベントループに出力の追加を通知するためのファイルディスクリプタ (独自拡張)
+// Linux は eventfd、macOS は非ブロッキングのパイプを使う
+// signal() はワーカースレッドから GIL を取得せずに呼び出せる
+// 何度 signal() しても clear() するまでは読み込み可能な状態が続く
+class WakeupFd {
+ public:
+  WakeupFd() {
+#if defined(__linux__)
+    read_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (read_fd_ < 0) {
+      throw std::runtime_error("Failed to create eventfd");
+    }
+    write_fd_ = read_fd_;
+#elif !defined(_WIN32)
+    int fds[2];
+    if (pipe(fds) != 0) {
+      throw std::runtime_error("Failed to create pipe");
+    }
+    for (int fd : fds) {
+      fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+      fcntl(fd, F_SETFD, FD_CLOEXEC);
+    }
+    read_fd_ = fds[0];
+    write_fd_ = fds[1];
+#else
+    // Windows のイベントループはパイプや eventfd を監視できない
+    throw std::runtime_error(
+        "NotSupportedError: wakeup fd is not supported on Windows");
+#endif
+  }
+
+  ~WakeupFd() {
+#if !defined(_WIN32)
+    if (write_fd_ != read_fd_) {
+      ::close(write_fd_);
+    }
+    ::close(read_fd_);
+#endif
+  }
+
+  WakeupFd(const WakeupFd&) = delete;
+  WakeupFd& operator=(const WakeupFd&) = delete;
+
+  // イベントループが監視するファイルディスクリプタ
+  int fd() const { return read_fd_; }
+
+  // 読み込み可能な状態にする
+  // 既に読み込み可能な場合 (カウンタやパイプが一杯の場合) の EAGAIN は無視する
+  void signal() {
+#if defined(__linux__)
+    uint64_t value = 1;
+    ssize_t result = ::write(write_fd_, &value, sizeof(value));
+    (void)result;
+#elif !defined(_WIN32)
+    char value = 1;
+    ssize_t result = ::write(write_fd_, &value, sizeof(value));
+    (void)result;
+#endif
+  }
+
+  // 溜まった通知を読み捨てて、読み込み可能でない状態に戻す
+  void clear() {
+#if defined(__linux__)
+    uint64_t value;
+    ssize_t result = ::read(read_fd_, &value, sizeof(value));
+    (void)result;
+#elif !defined(_WIN32)
+    char buffer[64];
+    while (::read(read_fd_, buffer, sizeof(buffer)) > 0) {
+    }
+#endif
+  }
+
+ private:
+  int read_fd_ = -1;
+  int write_fd_ = -1;
+};
@@ -5,6 +5,8 @@ namespace nb = nanobind;
 // バインディング関数の前方宣言
 void init_webcodecs_types(nb::module_& m);
 void init_video_frame(nb::module_& m);
+void init_frame_pool(nb::module_& m);
+void init_worker_pool(nb::module_& m);
 void init_audio_data(nb::module_& m);
 void init_encoded_video_chunk(nb::module_& m);
 void init_encoded_audio_chunk(nb::module_& m);
@@ -12,6 +14,7 @@ void init_video_decoder(nb::module_& m);
 void init_audio_decoder(nb::module_& m);
 void init_video_encoder(nb::module_& m);
 void init_audio_encoder(nb::module_& m);
+void init_simulcast_encoder(nb::module_& m);
 void init_video_codec_capabilities(nb::module_& m);
 void init_image_decoder(nb::module_& m);
 void init_avc_parser(nb::module_& m);
@@ -23,6 +26,8 @@ NB_MODULE(webcodecs_ext, m) {
   // 全てのサブモジュールを初期化
   init_webcodecs_types(m);  // WebCodecs 型を先に初期化
   init_video_frame(m);
+  init_frame_pool(m);
+  init_worker_pool(m);
   init_audio_data(m);
   init_encoded_video_chunk(m);
   init_encoded_audio_chunk(m);
@@ -30,6 +35,7 @@ NB_MODULE(webcodecs_ext, m) {
   init_audio_decoder(m);
   init_video_encoder(m);
   init_audio_encoder(m);
+  init_simulcast_encoder(m);
   init_video_codec_capabilities(m);
   init_image_decoder(m);
   init_avc_parser(m);
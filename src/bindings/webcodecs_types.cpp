@@ -79,6 +79,40 @@ void init_webcodecs_types(nb::module_& m) {
       .value("SMPTE170M", VideoMatrixCoefficients::SMPTE170M)
       .value("BT2020_NCL", VideoMatrixCoefficients::BT2020_NCL);
 
+  // QueueFullPolicy 列挙型 (独自拡張)
+  nb::enum_<QueueFullPolicy>(m, "QueueFullPolicy")
+      .value("BLOCK", QueueFullPolicy::BLOCK)
+      .value("RAISE", QueueFullPolicy::RAISE)
+      .value("DROP_OLDEST", QueueFullPolicy::DROP_OLDEST);
+
+  // AV1EncoderImplementation 列挙型 (独自拡張)
+  nb::enum_<AV1EncoderImplementation>(m, "AV1EncoderImplementation")
+      .value("LIBAOM", AV1EncoderImplementation::LIBAOM)
+      .value("SVT_AV1", AV1EncoderImplementation::SVT_AV1);
+
+  // VideoScaleFilter 列挙型 (独自拡張)
+  nb::enum_<VideoScaleFilter>(m, "VideoScaleFilter")
+      .value("NONE", VideoScaleFilter::NONE)
+      .value("LINEAR", VideoScaleFilter::LINEAR)
+      .value("BILINEAR", VideoScaleFilter::BILINEAR)
+      .value("BOX", VideoScaleFilter::BOX);
+
+  // DecodeFrameType 列挙型 (独自拡張)
+  nb::enum_<DecodeFrameType>(m, "DecodeFrameType")
+      .value("ALL", DecodeFrameType::ALL)
+      .value("REFERENCE", DecodeFrameType::REFERENCE)
+      .value("INTRA", DecodeFrameType::INTRA)
+      .value("KEY", DecodeFrameType::KEY);
+
+  // DecodeQuality 列挙型 (独自拡張)
+  nb::enum_<DecodeQuality>(m, "DecodeQuality")
+      .value("FULL", DecodeQuality::FULL)
+      .value("PREVIEW", DecodeQuality::PREVIEW);
+
+  // QuotaExceededError 例外 (独自拡張)
+  nb::exception<QuotaExceededError>(m, "QuotaExceededError",
+                                    PyExc_RuntimeError);
+
   // PlaneLayout クラス
   nb::class_<PlaneLayout>(m, "PlaneLayout")
       .def(nb::init<>())
@@ -171,6 +205,10 @@ void init_webcodecs_types(nb::module_& m) {
                self->content_hint =
                    nb::cast<std::string>(kwargs["content_hint"]);
              }
+             if (kwargs.contains("reorder_capacity")) {
+               self->reorder_capacity =
+                   nb::cast<uint32_t>(kwargs["reorder_capacity"]);
+             }
            })
       .def_rw("codec", &VideoEncoderConfig::codec)
       .def_rw("width", &VideoEncoderConfig::width)
@@ -184,6 +222,7 @@ void init_webcodecs_types(nb::module_& m) {
       .def_rw("bitrate_mode", &VideoEncoderConfig::bitrate_mode)
       .def_rw("latency_mode", &VideoEncoderConfig::latency_mode)
       .def_rw("content_hint", &VideoEncoderConfig::content_hint)
+      .def_rw("reorder_capacity", &VideoEncoderConfig::reorder_capacity)
       .def_rw("hardware_acceleration",
               &VideoEncoderConfig::hardware_acceleration)
       .def_rw("hardware_acceleration_engine",
@@ -252,6 +291,18 @@ void init_webcodecs_types(nb::module_& m) {
                self->optimize_for_latency =
                    nb::cast<bool>(kwargs["optimize_for_latency"]);
              }
+             if (kwargs.contains("decode_threads")) {
+               self->decode_threads =
+                   nb::cast<uint32_t>(kwargs["decode_threads"]);
+             }
+             if (kwargs.contains("max_frame_delay")) {
+               self->max_frame_delay =
+                   nb::cast<uint32_t>(kwargs["max_frame_delay"]);
+             }
+             if (kwargs.contains("reorder_capacity")) {
+               self->reorder_capacity =
+                   nb::cast<uint32_t>(kwargs["reorder_capacity"]);
+             }
              if (kwargs.contains("rotation")) {
                self->rotation = nb::cast<double>(kwargs["rotation"]);
              }
@@ -270,6 +321,9 @@ void init_webcodecs_types(nb::module_& m) {
       .def_rw("hardware_acceleration_engine",
               &VideoDecoderConfig::hardware_acceleration_engine)
       .def_rw("optimize_for_latency", &VideoDecoderConfig::optimize_for_latency)
+      .def_rw("decode_threads", &VideoDecoderConfig::decode_threads)
+      .def_rw("max_frame_delay", &VideoDecoderConfig::max_frame_delay)
+      .def_rw("reorder_capacity", &VideoDecoderConfig::reorder_capacity)
       .def_rw("rotation", &VideoDecoderConfig::rotation)
       .def_rw("flip", &VideoDecoderConfig::flip);
 
@@ -400,6 +454,12 @@ void init_webcodecs_types(nb::module_& m) {
                if (self.config.optimize_for_latency.has_value())
                  d["optimize_for_latency"] =
                      self.config.optimize_for_latency.value();
+               if (self.config.decode_threads.has_value())
+                 d["decode_threads"] = self.config.decode_threads.value();
+               if (self.config.max_frame_delay.has_value())
+                 d["max_frame_delay"] = self.config.max_frame_delay.value();
+               if (self.config.reorder_capacity.has_value())
+                 d["reorder_capacity"] = self.config.reorder_capacity.value();
                d["rotation"] = self.config.rotation;
                d["flip"] = self.config.flip;
                return nb::cast(d);
@@ -459,6 +519,8 @@ void init_webcodecs_types(nb::module_& m) {
                d["latency_mode"] = self.config.latency_mode;
                if (self.config.content_hint.has_value())
                  d["content_hint"] = self.config.content_hint.value();
+               if (self.config.reorder_capacity.has_value())
+                 d["reorder_capacity"] = self.config.reorder_capacity.value();
                d["hardware_acceleration_engine"] =
                    self.config.hardware_acceleration_engine;
                return nb::cast(d);
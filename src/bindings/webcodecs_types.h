@@ -6,6 +6,7 @@
 #include <nanobind/stl/vector.h>
 #include <cstdint>
 #include <optional>
+#include <stdexcept>
 #include <string>
 #include <unordered_map>
 
@@ -105,6 +106,65 @@ enum class VideoMatrixCoefficients {
   BT2020_NCL,  // ITU-R BT.2020 non-constant luminance
 };
 
+// WebCodecs API の VideoPixelFormat 列挙型
+// VideoDecoderConfig の output_format でも使うためここで定義する
+enum class VideoPixelFormat {
+  I420,  // YUV 4:2:0
+  I422,  // YUV 4:2:2
+  I444,  // YUV 4:4:4
+  NV12,  // YUV 4:2:0 with interleaved UV
+  RGBA,  // RGBA 8-bit per channel
+  BGRA,  // BGRA 8-bit per channel
+  RGB,   // RGB 8-bit per channel
+  BGR,   // BGR 8-bit per channel
+};
+
+// 独自拡張: デコード/エンコードキューが上限に達したときの動作
+// Windows の ERROR マクロと衝突しないよう RAISE とする
+enum class QueueFullPolicy {
+  BLOCK,        // 空きができるまで呼び出し元を待機させる (GIL は解放する)
+  RAISE,        // QuotaExceededError を送出する
+  DROP_OLDEST,  // キュー内の最も古いキーフレーム以外のタスクを破棄する
+};
+
+// 独自拡張: AV1 のソフトウェアエンコードに使うエンコーダー
+enum class AV1EncoderImplementation {
+  LIBAOM,   // libaom (デフォルト)
+  SVT_AV1,  // SVT-AV1 (多コアでのスループット重視)
+};
+
+// 独自拡張: デコーダーの出力を縮小・拡大するときのフィルター
+// libyuv の FilterMode に対応する
+enum class VideoScaleFilter {
+  NONE,      // 最近傍 (最速)
+  LINEAR,    // 水平方向のみ線形補間
+  BILINEAR,  // 双線形補間
+  BOX,       // ボックスフィルター (縮小時に最も高品質)
+};
+
+// 独自拡張: デコードするフレームの種類
+// dav1d の Dav1dDecodeFrameType に対応する
+enum class DecodeFrameType {
+  ALL,        // 全てのフレーム
+  REFERENCE,  // 参照されるフレームのみ (AV1 のみ)
+  INTRA,      // イントラフレームのみ (AV1 のみ)
+  KEY,        // キーフレームのみ
+};
+
+// 独自拡張: デコードの画質と速度のプリセット
+// PREVIEW はループフィルターやフィルムグレインを省略して高速にデコードする
+enum class DecodeQuality {
+  FULL,     // 規格通りにデコードする
+  PREVIEW,  // 画質を落として高速にデコードする (プレビューや解析用)
+};
+
+// 独自拡張: キューが上限に達した場合に送出する例外
+// WebCodecs の QuotaExceededError (DOMException) に相当する
+class QuotaExceededError : public std::runtime_error {
+ public:
+  using std::runtime_error::runtime_error;
+};
+
 // WebCodecs API の VideoFrameBufferInit 構造体
 struct VideoFrameBufferInit {
   // 必須フィールド
@@ -154,6 +214,20 @@ struct VideoEncoderConfig {
   // std::nullopt の場合、プラットフォームが自動的に最適なエンジンを選択
   std::optional<HardwareAccelerationEngine> hardware_acceleration_engine;
 
+  // 独自拡張: 出力の並べ替えで保持するシーケンス番号の上限
+  std::optional<uint32_t> reorder_capacity;
+  // 独自拡張: エンコードキューに積めるタスク数とバイト数の上限 (未指定で無制限)
+  std::optional<uint32_t> max_queue_size;
+  std::optional<uint64_t> max_queue_bytes;
+  QueueFullPolicy queue_full_policy = QueueFullPolicy::BLOCK;
+  // 独自拡張: GOP 並列エンコード (LatencyMode::QUALITY の AV1 / VP8 / VP9 のみ)
+  // segment_frames フレームごとにキーフレームで区切り、セグメントを並列にエンコードする
+  std::optional<uint32_t> segment_frames;
+  // セグメントを並列にエンコードするスレッド数 (0 または未指定で論理コア数)
+  std::optional<uint32_t> segment_threads;
+  // 独自拡張: AV1 のソフトウェアエンコードに使うエンコーダー (未指定で libaom)
+  AV1EncoderImplementation av1_encoder = AV1EncoderImplementation::LIBAOM;
+
   // AVC 固有のオプション (WebCodecs AVC Codec Registration 準拠)
   std::string avc_format = "avc";  // "annexb", "avc" (デフォルト: "avc")
 
@@ -178,6 +252,26 @@ struct VideoDecoderConfig {
   std::optional<bool> optimize_for_latency;
   // std::nullopt の場合、プラットフォームが自動的に最適なエンジンを選択
   std::optional<HardwareAccelerationEngine> hardware_acceleration_engine;
+  // 独自拡張: デコーダー内部のスレッド数 (std::nullopt または 0 の場合は自動)
+  std::optional<uint32_t> decode_threads;
+  // 独自拡張: フレーム並列化で許容する遅延フレーム数 (AV1 のみ、未指定で 1)
+  std::optional<uint32_t> max_frame_delay;
+  // 独自拡張: 出力の並べ替えで保持するシーケンス番号の上限
+  std::optional<uint32_t> reorder_capacity;
+  // 独自拡張: デコードキューに積めるタスク数とバイト数の上限 (未指定で無制限)
+  std::optional<uint32_t> max_queue_size;
+  std::optional<uint64_t> max_queue_bytes;
+  QueueFullPolicy queue_full_policy = QueueFullPolicy::BLOCK;
+  // 独自拡張: 出力する VideoFrame のサイズ (未指定でデコードしたサイズのまま)
+  std::optional<uint32_t> output_width;
+  std::optional<uint32_t> output_height;
+  VideoScaleFilter output_scale_filter = VideoScaleFilter::BOX;
+  // 独自拡張: 出力する VideoFrame のフォーマット (未指定で I420)
+  std::optional<VideoPixelFormat> output_format;
+  // 独自拡張: デコードするフレームの種類 (未指定で ALL)
+  DecodeFrameType decode_frame_type = DecodeFrameType::ALL;
+  // 独自拡張: デコードの画質と速度のプリセット (未指定で FULL)
+  DecodeQuality decode_quality = DecodeQuality::FULL;
   double rotation = 0;
   bool flip = false;
 
@@ -277,11 +371,18 @@ struct VideoEncoderSupport {
       : supported(supported), config(config) {}
 };
 
+// WebCodecs API の SvcOutputMetadata 構造体
+struct SvcOutputMetadata {
+  uint32_t temporal_layer_id = 0;
+};
+
 // WebCodecs API の EncodedVideoChunkMetadata 構造体
 struct EncodedVideoChunkMetadata {
   // decoderConfig: キーフレームで提供される VideoDecoderConfig
   // description には avcC/hvcC/av1C などのコーデック固有データが含まれる
   std::optional<VideoDecoderConfig> decoder_config;
+  // svc: scalability_mode が指定されている場合に全てのチャンクで提供される
+  std::optional<SvcOutputMetadata> svc;
 
   EncodedVideoChunkMetadata() = default;
 };
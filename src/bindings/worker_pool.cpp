@@ -0,0 +1,290 @@
+#include "worker_pool.h"
+
+#include <nanobind/stl/optional.h>
+#include <nanobind/stl/shared_ptr.h>
+#include <nanobind/stl/vector.h>
+#include <algorithm>
+#include <cstdio>
+#include <exception>
+#include <optional>
+#include <utility>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#elif defined(_WIN32)
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#endif
+
+namespace nb = nanobind;
+using namespace nb::literals;
+
+namespace {
+
+// 現在のスレッドが属するプールとスレッド番号
+// プールのスレッドからストランドを投入した場合は、そのスレッドのキューに積む
+thread_local const void* current_pool_state = nullptr;
+thread_local size_t current_worker_index = 0;
+
+std::mutex default_pool_mutex;
+std::shared_ptr<WorkerPool> default_worker_pool;
+
+void set_thread_affinity(std::thread& thread, uint32_t cpu) {
+#if defined(__linux__)
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+  // 固定できなくても動作には影響しないため、エラーは無視する
+  pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set);
+#elif defined(_WIN32)
+  SetThreadAffinityMask(static_cast<HANDLE>(thread.native_handle()),
+                        static_cast<DWORD_PTR>(1) << cpu);
+#else
+  // macOS は CPU の固定に対応していない
+  (void)thread;
+  (void)cpu;
+#endif
+}
+
+// CPU 番号の上限 (これ以上の番号は指定できない)
+uint32_t max_cpu_affinity() {
+#if defined(__linux__)
+  return CPU_SETSIZE;
+#elif defined(_WIN32)
+  return sizeof(DWORD_PTR) * 8;
+#else
+  return UINT32_MAX;
+#endif
+}
+
+}  // namespace
+
+WorkerPool::WorkerPool(uint32_t threads, std::vector<uint32_t> cpu_affinity)
+    : state_(std::make_shared<State>()),
+      cpu_affinity_(std::move(cpu_affinity)) {
+  if (threads == 0) {
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  for (uint32_t i = 0; i < threads; i++) {
+    state_->workers.push_back(std::make_unique<Worker>());
+  }
+  // スレッドは State の shared_ptr を持つため、プールより先に State が破棄されることはない
+  for (uint32_t i = 0; i < threads; i++) {
+    Worker& worker = *state_->workers[i];
+    worker.thread = std::thread(
+        [state = state_, i]() { state->worker_loop(static_cast<size_t>(i)); });
+    if (!cpu_affinity_.empty()) {
+      set_thread_affinity(worker.thread,
+                          cpu_affinity_[i % cpu_affinity_.size()]);
+    }
+  }
+}
+
+WorkerPool::~WorkerPool() {
+  {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    state_->stop = true;
+  }
+  state_->cv.notify_all();
+
+  // 実行待ちのストランドを処理し終えてからスレッドは終了する
+  // プールのスレッドで最後の参照が外れた場合は自分自身を join できないため切り離す
+  for (auto& worker : state_->workers) {
+    if (!worker->thread.joinable()) {
+      continue;
+    }
+    if (worker->thread.get_id() == std::this_thread::get_id()) {
+      worker->thread.detach();
+    } else {
+      worker->thread.join();
+    }
+  }
+}
+
+std::shared_ptr<WorkerStrand> WorkerPool::create_strand(
+    std::function<void(const std::string&)> on_error) {
+  return std::shared_ptr<WorkerStrand>(
+      new WorkerStrand(state_, std::move(on_error)));
+}
+
+std::shared_ptr<WorkerPool> WorkerPool::default_pool() {
+  std::lock_guard<std::mutex> lock(default_pool_mutex);
+  return default_worker_pool;
+}
+
+void WorkerPool::set_default_pool(std::shared_ptr<WorkerPool> pool) {
+  std::shared_ptr<WorkerPool> previous;
+  {
+    std::lock_guard<std::mutex> lock(default_pool_mutex);
+    previous = std::exchange(default_worker_pool, std::move(pool));
+  }
+  // 以前のプールはロックの外で解放する (スレッドの join を待つ場合がある)
+}
+
+void WorkerPool::State::schedule(std::shared_ptr<WorkerStrand> strand) {
+  size_t index;
+  if (current_pool_state == this) {
+    // プールのスレッドから投入された場合は同じスレッドで続けて実行する
+    index = current_worker_index;
+  } else {
+    index = static_cast<size_t>(next_worker++ % workers.size());
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    workers[index]->strands.push_back(std::move(strand));
+    queued++;
+  }
+  cv.notify_one();
+}
+
+std::shared_ptr<WorkerStrand> WorkerPool::State::take(size_t index) {
+  Worker& own = *workers[index];
+  if (!own.strands.empty()) {
+    auto strand = std::move(own.strands.front());
+    own.strands.pop_front();
+    return strand;
+  }
+  // 自分のキューが空の場合は他のスレッドのキューの末尾から盗む
+  for (size_t i = 1; i < workers.size(); i++) {
+    Worker& victim = *workers[(index + i) % workers.size()];
+    if (!victim.strands.empty()) {
+      auto strand = std::move(victim.strands.back());
+      victim.strands.pop_back();
+      steals++;
+      return strand;
+    }
+  }
+  return nullptr;
+}
+
+void WorkerPool::State::worker_loop(size_t index) {
+  current_pool_state = this;
+  current_worker_index = index;
+  while (true) {
+    std::shared_ptr<WorkerStrand> strand;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      cv.wait(lock, [this]() { return stop || queued > 0; });
+      if (queued == 0) {
+        break;  // stop かつ実行待ちなし
+      }
+      // queued はキューにあるストランドの数と一致するため、必ず取り出せる
+      strand = take(index);
+      queued--;
+    }
+    strand->run();
+  }
+}
+
+void WorkerStrand::post(std::function<void()> fn) {
+  bool needs_schedule;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    tasks_.push_back(std::move(fn));
+    needs_schedule = !scheduled_;
+    scheduled_ = true;
+  }
+  if (needs_schedule) {
+    pool_->schedule(shared_from_this());
+  }
+}
+
+void WorkerStrand::run() {
+  std::function<void()> fn;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    fn = std::move(tasks_.front());
+    tasks_.pop_front();
+  }
+
+  running_thread_ = std::this_thread::get_id();
+  // 投入する関数の中でエラーを処理する想定だが、伝播した場合もスレッドは止めずに報告する
+  try {
+    fn();
+  } catch (const std::exception& e) {
+    report_error(e.what());
+  } catch (...) {
+    report_error("Unknown error");
+  }
+  running_thread_ = std::thread::id();
+
+  bool has_more;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    has_more = !tasks_.empty();
+    if (!has_more) {
+      scheduled_ = false;
+    }
+  }
+  if (has_more) {
+    pool_->schedule(shared_from_this());
+  } else {
+    cv_.notify_all();
+  }
+}
+
+void WorkerStrand::report_error(const std::string& message) {
+  if (on_error_) {
+    try {
+      on_error_(message);
+      return;
+    } catch (...) {
+      // 報告できなかった場合は標準エラー出力に書き出す
+    }
+  }
+  std::fprintf(stderr, "webcodecs: unhandled error in worker pool task: %s\n",
+               message.c_str());
+}
+
+void WorkerStrand::drain() {
+  // 実行中の関数 (出力コールバック内) から呼ばれた場合は待機すると進まなくなる
+  if (running_in_this_thread()) {
+    return;
+  }
+  std::unique_lock<std::mutex> lock(mutex_);
+  cv_.wait(lock, [this]() { return !scheduled_; });
+}
+
+bool WorkerStrand::running_in_this_thread() const {
+  return running_thread_.load() == std::this_thread::get_id();
+}
+
+void init_worker_pool(nb::module_& m) {
+  nb::class_<WorkerPool>(m, "WorkerPool")
+      .def(
+          "__init__",
+          [](WorkerPool* self, std::optional<uint32_t> threads,
+             std::optional<std::vector<uint32_t>> cpu_affinity) {
+            if (threads.has_value() && (*threads == 0 || *threads > 1024)) {
+              throw nb::value_error("threads must be between 1 and 1024");
+            }
+            std::vector<uint32_t> affinity = cpu_affinity.value_or(
+                std::vector<uint32_t>{});
+            for (uint32_t cpu : affinity) {
+              if (cpu >= max_cpu_affinity()) {
+                throw nb::value_error("cpu_affinity contains an invalid CPU");
+              }
+            }
+            new (self) WorkerPool(threads.value_or(0), std::move(affinity));
+          },
+          "threads"_a = nb::none(), "cpu_affinity"_a = nb::none(),
+          nb::sig("def __init__(self, threads: int | None = None, "
+                  "cpu_affinity: typing.Sequence[int] | None = None) -> None"))
+      .def_prop_ro("threads", &WorkerPool::threads)
+      .def_prop_ro("cpu_affinity", &WorkerPool::cpu_affinity)
+      .def_prop_ro("steals", &WorkerPool::steals);
+
+  m.def("get_default_worker_pool", &WorkerPool::default_pool,
+        nb::sig("def get_default_worker_pool() -> WorkerPool | None"));
+  m.def("set_default_worker_pool", &WorkerPool::set_default_pool,
+        "pool"_a.none(),
+        nb::sig("def set_default_worker_pool(pool: WorkerPool | None, /) "
+                "-> None"));
+
+  // デフォルトのプールは Python のオブジェクトを参照するため、
+  // インタプリタの終了前に解放する
+  nb::module_::import_("atexit").attr("register")(
+      nb::cpp_function([]() { WorkerPool::set_default_pool(nullptr); }));
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <nanobind/nanobind.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class WorkerStrand;
+
+// 複数のコーデックで共有するワーカースレッドのプール (独自拡張)
+// コーデックごとに専用スレッドを立てる代わりに、固定数のスレッドで
+// 各コーデックのタスクキューを WorkerStrand として処理する
+// スレッドごとに実行待ちのストランドのキューを持ち、空いたスレッドは
+// 他のスレッドのキューの末尾からストランドを盗んで実行する
+class WorkerPool {
+ public:
+  // threads が 0 の場合は論理コア数とする
+  // cpu_affinity を指定した場合は i 番目のスレッドを
+  // cpu_affinity[i % cpu_affinity.size()] の CPU に固定する (Linux / Windows のみ)
+  explicit WorkerPool(uint32_t threads = 0,
+                      std::vector<uint32_t> cpu_affinity = {});
+  ~WorkerPool();
+
+  WorkerPool(const WorkerPool&) = delete;
+  WorkerPool& operator=(const WorkerPool&) = delete;
+
+  uint32_t threads() const {
+    return static_cast<uint32_t>(state_->workers.size());
+  }
+  const std::vector<uint32_t>& cpu_affinity() const { return cpu_affinity_; }
+  // ストランドを盗んで実行した回数
+  uint64_t steals() const { return state_->steals.load(); }
+
+  // このプールで実行するストランドを作成する
+  // on_error はストランドで実行した関数から例外が伝播した場合に呼ばれる
+  std::shared_ptr<WorkerStrand> create_strand(
+      std::function<void(const std::string&)> on_error = nullptr);
+
+  // プロセス全体のデフォルトのプール
+  // 設定されている場合、worker_pool を指定せずに作成したコーデックはこのプールを使う
+  // 未設定 (nullptr) の場合はコーデックごとに専用スレッドを立てる
+  static std::shared_ptr<WorkerPool> default_pool();
+  static void set_default_pool(std::shared_ptr<WorkerPool> pool);
+
+ private:
+  friend class WorkerStrand;
+
+  struct Worker {
+    // 実行待ちのストランド (State::mutex で保護)
+    std::deque<std::shared_ptr<WorkerStrand>> strands;
+    std::thread thread;
+  };
+
+  // スレッドとストランドから参照される状態
+  // プールが破棄された後もワーカースレッドが終了するまで生存させるため shared_ptr で持つ
+  struct State {
+    std::vector<std::unique_ptr<Worker>> workers;
+    // スレッドの待機/通知と、各スレッドのキューを保護する
+    // ストランドの追加と queued の増加を同じロックで行うため、
+    // queued > 0 のときは必ずいずれかのキューからストランドを取り出せる
+    std::mutex mutex;
+    std::condition_variable cv;
+    size_t queued = 0;  // 実行待ちのストランド数 (mutex で保護)
+    bool stop = false;  // (mutex で保護)
+    std::atomic<uint64_t> next_worker{0};
+    std::atomic<uint64_t> steals{0};
+
+    // ストランドを実行待ちにする
+    void schedule(std::shared_ptr<WorkerStrand> strand);
+    // index 番目のスレッドのキュー、なければ他のスレッドのキューから取り出す
+    // mutex を保持して呼び出す
+    std::shared_ptr<WorkerStrand> take(size_t index);
+    void worker_loop(size_t index);
+  };
+
+  std::shared_ptr<State> state_;
+  std::vector<uint32_t> cpu_affinity_;
+};
+
+// WorkerPool 上で関数を 1 つずつ投入順に実行する直列キュー
+// 同じストランドの関数が複数のスレッドで同時に実行されることはない
+class WorkerStrand : public std::enable_shared_from_this<WorkerStrand> {
+ public:
+  // 関数を投入する
+  void post(std::function<void()> fn);
+  // 投入済みの関数がすべて実行されるまで待機する
+  // ストランドで実行中の関数から呼ばれた場合は待機せずに戻る
+  void drain();
+  // 現在のスレッドでこのストランドの関数を実行中か
+  bool running_in_this_thread() const;
+
+ private:
+  friend class WorkerPool;
+
+  WorkerStrand(std::shared_ptr<WorkerPool::State> pool,
+               std::function<void(const std::string&)> on_error)
+      : pool_(std::move(pool)), on_error_(std::move(on_error)) {}
+
+  // 関数から伝播した例外を on_error_ に渡す
+  // on_error_ がない場合や on_error_ も失敗した場合は標準エラー出力に書き出す
+  void report_error(const std::string& message);
+
+  // 関数を 1 つ実行し、残っていれば再び実行待ちにする
+  // 1 つずつ実行することで、他のストランドにもスレッドを公平に割り当てる
+  void run();
+
+  std::shared_ptr<WorkerPool::State> pool_;
+  std::function<void(const std::string&)> on_error_;
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<std::function<void()>> tasks_;
+  bool scheduled_ = false;  // プールの実行待ちまたは実行中か (mutex_ で保護)
+  std::atomic<std::thread::id> running_thread_{};
+};
+
+void init_worker_pool(nanobind::module_& m);
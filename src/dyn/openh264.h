@@ -0,0 +1,37 @@
+// OpenH264 API の動的ロード
+
+#ifndef WEBCODECS_PY_DYN_OPENH264_H_
+#define WEBCODECS_PY_DYN_OPENH264_H_
+
+#include <wels/codec_api.h>
+
+#include <cstdlib>
+
+#include "dyn.h"
+
+namespace dyn {
+
+// Linux のみサポート
+// Cisco が配布しているバイナリ (libopenh264-2.6.0-linux64.8.so) の SONAME
+static const char OPENH264_SO[] = "libopenh264.so.8";
+
+// 環境変数 OPENH264_PATH が指定されている場合はそのパスからロードする
+inline const char* openh264_so() {
+  const char* path = std::getenv("OPENH264_PATH");
+  if (path != nullptr && path[0] != '\0') {
+    return path;
+  }
+  return OPENH264_SO;
+}
+
+// デコーダー関数
+DYN_REGISTER(openh264_so(), WelsCreateDecoder);
+DYN_REGISTER(openh264_so(), WelsDestroyDecoder);
+
+// エンコーダー関数
+DYN_REGISTER(openh264_so(), WelsCreateSVCEncoder);
+DYN_REGISTER(openh264_so(), WelsDestroySVCEncoder);
+
+}  // namespace dyn
+
+#endif  // WEBCODECS_PY_DYN_OPENH264_H_
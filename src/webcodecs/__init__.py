@@ -24,6 +24,8 @@ from .webcodecs_ext import (
     AudioEncoder,
     VideoDecoder,
     AudioDecoder,
+    # Simulcast (独自拡張)
+    SimulcastEncoder,
     # Image types
     ImageDecoder,
     ImageTrack,
@@ -40,8 +42,26 @@ from .webcodecs_ext import (
     VideoMatrixCoefficients,
     # Codec capabilities
     HardwareAccelerationEngine,
+    # Queue limits (独自拡張)
+    QueueFullPolicy,
+    QuotaExceededError,
+    # Decoder output scaling (独自拡張)
+    VideoScaleFilter,
+    # Decode frame type (独自拡張)
+    DecodeFrameType,
+    # Decode quality (独自拡張)
+    DecodeQuality,
+    # AV1 encoder implementation (独自拡張)
+    AV1EncoderImplementation,
     # stubgen はプライベート関数をスキップするため type: ignore が必要
     _get_video_codec_capabilities_impl,  # type: ignore[attr-defined]
+    # Frame pool (独自拡張)
+    get_frame_pool_stats,
+    clear_frame_pool,
+    # Worker pool (独自拡張)
+    WorkerPool,
+    get_default_worker_pool,
+    set_default_worker_pool,
     # Header parser (独自拡張)
     AVCNalUnitType,
     HEVCNalUnitType,
@@ -78,10 +98,13 @@ class EncodedAudioChunkInit(TypedDict):
     type: EncodedAudioChunkType
     # マイクロ秒
     timestamp: int
-    data: bytes
+    # bytes はコピーせずに参照する
+    data: bytes | bytearray | memoryview | numpy.typing.NDArray[numpy.uint8]
     # オプションフィールド
     # マイクロ秒
     duration: NotRequired[int]
+    # data を含めるとコピーせずに参照する
+    transfer: NotRequired[list[Any]]
 
 
 class EncodedVideoChunkInit(TypedDict):
@@ -91,10 +114,13 @@ class EncodedVideoChunkInit(TypedDict):
     type: EncodedVideoChunkType
     # マイクロ秒
     timestamp: int
-    data: bytes
+    # bytes はコピーせずに参照する
+    data: bytes | bytearray | memoryview | numpy.typing.NDArray[numpy.uint8]
     # オプションフィールド
     # マイクロ秒
     duration: NotRequired[int]
+    # data を含めるとコピーせずに参照する
+    transfer: NotRequired[list[Any]]
 
 
 class VideoFrameMetadata(TypedDict, total=False):
@@ -183,6 +209,20 @@ class VideoEncoderConfig(TypedDict):
     alpha: NotRequired[AlphaOption | None]
     # 独自拡張
     hardware_acceleration_engine: NotRequired[HardwareAccelerationEngine | None]
+    # 出力の並べ替えで保持するシーケンス番号の上限 (1-4096、未指定で 64)
+    # 上限に達すると encode() / encode_many() は空きができるまで待機する
+    reorder_capacity: NotRequired[int | None]
+    # エンコード待ちキューの上限 (フレーム数 / バイト数、未指定で無制限)
+    max_queue_size: NotRequired[int | None]
+    max_queue_bytes: NotRequired[int | None]
+    # キューが上限に達したときの動作 (未指定で BLOCK)
+    queue_full_policy: NotRequired[QueueFullPolicy | None]
+    # GOP 並列エンコードのセグメントのフレーム数 (QUALITY の AV1 / VP8 / VP9 のみ)
+    segment_frames: NotRequired[int | None]
+    # セグメントを並列にエンコードするスレッド数 (0 または未指定で論理コア数)
+    segment_threads: NotRequired[int | None]
+    # AV1 のソフトウェアエンコードに使うエンコーダー (未指定で LIBAOM)
+    av1_encoder: NotRequired[AV1EncoderImplementation | None]
     # AVC 固有のオプション (WebCodecs AVC Codec Registration 準拠)
     avc: NotRequired[AvcEncoderConfig | None]
     # HEVC 固有のオプション (WebCodecs HEVC Codec Registration 準拠)
@@ -207,6 +247,29 @@ class VideoDecoderConfig(TypedDict):
     flip: NotRequired[bool | None]
     # 独自拡張
     hardware_acceleration_engine: NotRequired[HardwareAccelerationEngine | None]
+    # デコーダー内部のスレッド数 (0 または未指定で解像度とコア数から自動決定)
+    decode_threads: NotRequired[int | None]
+    # フレーム並列化で許容する遅延フレーム数 (AV1 のみ、未指定で 1)
+    max_frame_delay: NotRequired[int | None]
+    # 出力の並べ替えで保持するシーケンス番号の上限 (1-4096、未指定で 64)
+    # 上限に達すると decode() / decode_many() は空きができるまで待機する
+    reorder_capacity: NotRequired[int | None]
+    # デコード待ちキューの上限 (チャンク数 / バイト数、未指定で無制限)
+    max_queue_size: NotRequired[int | None]
+    max_queue_bytes: NotRequired[int | None]
+    # キューが上限に達したときの動作 (未指定で BLOCK)
+    queue_full_policy: NotRequired[QueueFullPolicy | None]
+    # 出力する VideoFrame のサイズ (偶数、両方指定する。未指定でデコードしたサイズ)
+    output_width: NotRequired[int | None]
+    output_height: NotRequired[int | None]
+    # 出力サイズに変換するときのフィルター (未指定で BOX)
+    output_scale_filter: NotRequired[VideoScaleFilter | None]
+    # 出力する VideoFrame のフォーマット (I420 / NV12 / RGBA / BGRA / RGB / BGR、未指定で I420)
+    output_format: NotRequired[VideoPixelFormat | None]
+    # デコードするフレームの種類 (未指定で ALL、REFERENCE / INTRA は AV1 のみ)
+    decode_frame_type: NotRequired[DecodeFrameType | None]
+    # デコードの画質と速度のプリセット (未指定で FULL)
+    decode_quality: NotRequired[DecodeQuality | None]
 
 
 class OpusEncoderConfig(TypedDict):
@@ -345,6 +408,8 @@ class VideoEncoderEncodeOptions(TypedDict, total=False):
 
     # キーフレームを強制
     key_frame: bool | None
+    # フレームのバッファをコピーせずに受け取り、フレームを close する (独自拡張)
+    transfer: bool | None
     # AV1 固有のオプション
     av1: VideoEncoderEncodeOptionsForAv1 | None
     # AVC 固有のオプション
@@ -357,6 +422,58 @@ class VideoEncoderEncodeOptions(TypedDict, total=False):
     vp9: VideoEncoderEncodeOptionsForVp9 | None
 
 
+class SimulcastRendition(TypedDict):
+    """SimulcastEncoderConfig の renditions の要素 (独自拡張)"""
+
+    # 必須フィールド
+    # 出力コールバックに渡すレンディションの ID
+    id: str
+    width: int
+    height: int
+    # オプションフィールド
+    bitrate: NotRequired[int | None]
+    scalability_mode: NotRequired[str | None]
+
+
+class SimulcastEncoderConfig(TypedDict):
+    """SimulcastEncoder.configure() の引数 (独自拡張)
+
+    renditions 以外は全てのレンディションの VideoEncoder.configure() に渡す
+    """
+
+    # 必須フィールド
+    codec: str
+    renditions: list[SimulcastRendition]
+    # オプションフィールド
+    bitrate: NotRequired[int | None]
+    framerate: NotRequired[float | None]
+    hardware_acceleration: NotRequired[HardwareAcceleration | None]
+    bitrate_mode: NotRequired[VideoEncoderBitrateMode | None]
+    latency_mode: NotRequired[LatencyMode | None]
+    alpha: NotRequired[AlphaOption | None]
+    hardware_acceleration_engine: NotRequired[HardwareAccelerationEngine | None]
+    reorder_capacity: NotRequired[int | None]
+    max_queue_size: NotRequired[int | None]
+    max_queue_bytes: NotRequired[int | None]
+    queue_full_policy: NotRequired[QueueFullPolicy | None]
+    av1_encoder: NotRequired[AV1EncoderImplementation | None]
+    # 縮小に使うフィルター (未指定で BOX)
+    scale_filter: NotRequired[VideoScaleFilter | None]
+    # True の場合、いずれかのレンディションをキーフレームにすると全てのレンディションをキーフレームにする
+    align_key_frames: NotRequired[bool | None]
+
+
+class SimulcastEncoderEncodeOptions(TypedDict, total=False):
+    """SimulcastEncoder.encode() のオプション (独自拡張)"""
+
+    # 全てのレンディションでキーフレームを強制
+    key_frame: bool | None
+    # 指定したレンディションでキーフレームを強制
+    key_frame_renditions: list[str] | None
+    # フレームのバッファをコピーせずに受け取り、フレームを close する
+    transfer: bool | None
+
+
 # Support 型定義（is_config_supported の戻り値）
 class VideoEncoderSupport(TypedDict):
     """VideoEncoder.is_config_supported() の戻り値"""
@@ -386,6 +503,21 @@ class AudioDecoderSupport(TypedDict):
     config: AudioDecoderConfig
 
 
+class FramePoolStats(TypedDict):
+    """get_frame_pool_stats() / frame_pool_stats() の戻り値 (独自拡張)"""
+
+    # 空きリストから再利用できた回数
+    hits: int
+    # 新しく確保した回数
+    misses: int
+    # プールが確保しているバイト数 (使用中 + 空き)
+    bytes_resident: int
+    # 空きリストにあるバイト数
+    bytes_free: int
+    # 空きリストにあるバッファ数
+    buffers_free: int
+
+
 # ImageDecoder 関連の型定義
 
 
@@ -427,13 +559,21 @@ class EncodedVideoChunkMetadataDecoderConfig(TypedDict, total=False):
     description: bytes
 
 
+class SvcOutputMetadata(TypedDict):
+    """EncodedVideoChunkMetadata の svc"""
+
+    temporal_layer_id: int
+
+
 class EncodedVideoChunkMetadata(TypedDict, total=False):
     """VideoEncoder の output callback で提供される metadata
 
     キーフレーム時のみ decoder_config が含まれる。
+    scalability_mode を指定した場合は全てのチャンクで svc が含まれる。
     """
 
     decoder_config: EncodedVideoChunkMetadataDecoderConfig
+    svc: SvcOutputMetadata
 
 
 def get_video_codec_capabilities() -> dict[HardwareAccelerationEngine, dict]:
@@ -530,6 +670,7 @@ __all__ = [
     # Metadata types
     "EncodedVideoChunkMetadata",
     "EncodedVideoChunkMetadataDecoderConfig",
+    "SvcOutputMetadata",
     # Enums
     "CodecState",
     "LatencyMode",
@@ -541,8 +682,32 @@ __all__ = [
     "VideoTransferCharacteristics",
     "VideoMatrixCoefficients",
     "HardwareAccelerationEngine",
+    # Queue limits (独自拡張)
+    "QueueFullPolicy",
+    "QuotaExceededError",
+    # Decoder output scaling (独自拡張)
+    "VideoScaleFilter",
+    # Decode frame type (独自拡張)
+    "DecodeFrameType",
+    # Decode quality (独自拡張)
+    "DecodeQuality",
+    # AV1 encoder implementation (独自拡張)
+    "AV1EncoderImplementation",
     # Functions
     "get_video_codec_capabilities",
+    # Frame pool (独自拡張)
+    "FramePoolStats",
+    "get_frame_pool_stats",
+    "clear_frame_pool",
+    # Simulcast (独自拡張)
+    "SimulcastEncoder",
+    "SimulcastEncoderConfig",
+    "SimulcastEncoderEncodeOptions",
+    "SimulcastRendition",
+    # Worker pool (独自拡張)
+    "WorkerPool",
+    "get_default_worker_pool",
+    "set_default_worker_pool",
     # Header parser (独自拡張)
     "AVCNalUnitType",
     "HEVCNalUnitType",
@@ -0,0 +1,104 @@
+"""asyncio のイベントループから出力キューを扱うための補助関数 (独自拡張)
+
+ワーカースレッドは出力キューへの追加、タスクや flush タスクの完了、close() の度に output_queue_fd へ通知する。
+イベントループは loop.add_reader() でそのファイルディスクリプタを監視するため、
+待機用のスレッドを必要としない。
+
+frames() / chunks() と flush_async() を同じコーデックで同時に待機できるように、
+ファイルディスクリプタの監視と通知の読み捨てはコーデックごとに 1 つの _Notifier が行い、
+待機中のコルーチンは _Notifier が起こす。
+
+各コーデックの flush_async() / frames() / chunks() から呼び出される。
+"""
+
+import asyncio
+import weakref
+from collections.abc import AsyncIterator
+from typing import Any
+
+from .webcodecs_ext import CodecState
+
+# イベントループごとに、output_queue_fd → _Notifier
+_notifiers: weakref.WeakKeyDictionary[asyncio.AbstractEventLoop, dict[int, "_Notifier"]] = (
+    weakref.WeakKeyDictionary()
+)
+
+
+class _Notifier:
+    """1 つのコーデックの output_queue_fd を監視し、待機中のコルーチンを全て起こす
+
+    add_reader() / remove_reader() と clear_output_queue_fd() はここでのみ呼び出す。
+    待機するコルーチンがなくなると監視をやめて破棄される。
+    """
+
+    def __init__(self, loop: asyncio.AbstractEventLoop, codec: Any, fd: int) -> None:
+        self._loop = loop
+        self._codec = codec
+        self._fd = fd
+        self._waiters: set[asyncio.Future[None]] = set()
+
+    async def wait(self) -> None:
+        future = self._loop.create_future()
+        if not self._waiters:
+            self._loop.add_reader(self._fd, self._on_readable)
+        self._waiters.add(future)
+        try:
+            await future
+        finally:
+            self._waiters.discard(future)
+            if not self._waiters:
+                self._loop.remove_reader(self._fd)
+                notifiers = _notifiers.get(self._loop)
+                if notifiers is not None and notifiers.get(self._fd) is self:
+                    del notifiers[self._fd]
+
+    def _on_readable(self) -> None:
+        # 通知を読み捨ててから起こすため、起きたコルーチンが確認した後の通知は取りこぼさない
+        self._codec.clear_output_queue_fd()
+        for future in self._waiters:
+            if not future.done():
+                future.set_result(None)
+
+
+async def _wait(codec: Any) -> None:
+    """output_queue_fd への次の通知まで待機する
+
+    呼び出す前に状態を確認すること。確認から待機までの間に通知が来ても、
+    通知は読み捨てられずに残っているため監視を始めた直後に起こされる。
+    待機が終わると _Notifier は破棄されることがあるため、待機の度に取得する。
+    """
+    loop = asyncio.get_running_loop()
+    fd = codec.output_queue_fd
+    notifiers = _notifiers.setdefault(loop, {})
+    notifier = notifiers.get(fd)
+    if notifier is None:
+        notifier = _Notifier(loop, codec, fd)
+        notifiers[fd] = notifier
+    await notifier.wait()
+
+
+async def flush_async(codec: Any) -> None:
+    """flush タスクをワーカーに追加し、処理し終えるまでイベントループを止めずに待機する
+
+    ワーカーはそれまでのタスクを処理した後にコーデック内部に残っている出力を取り出し、
+    completed_flushes を進めて output_queue_fd へ通知する。
+    出力は出力キューに追加されるため、frames() / chunks() や read_all() で取り出す。
+    """
+    flush_id = codec.request_flush()
+    while codec.state != CodecState.CLOSED and codec.completed_flushes < flush_id:
+        await _wait(codec)
+
+
+async def outputs(codec: Any) -> AsyncIterator[Any]:
+    """出力キューの出力を順番に返す
+
+    出力がない間はイベントループを止めずに待機し、close() された後に出力キューが空になると終了する。
+    """
+    while True:
+        items = codec.read_all()
+        for item in items:
+            yield item
+        if not items:
+            if codec.state == CodecState.CLOSED:
+                return
+            await _wait(codec)
@@ -0,0 +1,153 @@
+"""
+映像デコード性能ベンチマーク
+
+decode_quality の FULL と PREVIEW でソフトウェアデコーダーのスループットを比較する
+
+実行方法:
+    uv run pytest tests/benchmarks/bench_video_decoder.py -v
+
+    # コーデックごとに FULL / PREVIEW を並べて比較する
+    uv run pytest tests/benchmarks/bench_video_decoder.py -v --benchmark-group-by=param:codec
+
+    # 結果を JSON に保存
+    uv run pytest tests/benchmarks/bench_video_decoder.py -v --benchmark-json=benchmark.json
+"""
+
+import sys
+
+import numpy as np
+import pytest
+from blend2d import Context, Image
+
+from webcodecs import (
+    DecodeQuality,
+    LatencyMode,
+    VideoDecoder,
+    VideoDecoderConfig,
+    VideoEncoder,
+    VideoEncoderConfig,
+    VideoFrame,
+    VideoFrameBufferInit,
+    VideoPixelFormat,
+)
+
+WIDTH = 1280
+HEIGHT = 720
+NUM_FRAMES = 60
+
+CODECS = [
+    pytest.param("av01.0.08M.08", id="av1"),
+    pytest.param("vp8", id="vp8"),
+    pytest.param("vp09.00.31.08", id="vp9"),
+]
+
+pytestmark = pytest.mark.skipif(
+    sys.platform != "linux", reason="ソフトウェアデコーダーのベンチマークは Linux のみ"
+)
+
+
+def create_gradient_frame_blend2d(width: int, height: int, frame_number: int) -> np.ndarray:
+    """
+    blend2d を使って動きのあるフレームを生成する
+    ループフィルターの効果が出るように、ある程度の圧縮歪みが乗る絵柄にする
+    """
+    image = Image(width, height)
+    ctx = Context(image)
+
+    r = int(128 + 127 * np.sin(frame_number * 0.1))
+    g = int(128 + 127 * np.sin(frame_number * 0.1 + 2))
+    b = int(128 + 127 * np.sin(frame_number * 0.1 + 4))
+    ctx.set_fill_style_rgba(r, g, b, 255)
+    ctx.fill_all()
+
+    for i in range(20):
+        angle = frame_number * 0.05 + i * 0.31
+        cx = width / 2 + (width / 3) * np.cos(angle * (1 + i % 3))
+        cy = height / 2 + (height / 3) * np.sin(angle)
+        radius = 20 + 40 * abs(np.sin(frame_number * 0.1 + i * 0.5))
+        ctx.set_fill_style_rgba(
+            (i * 50 + frame_number * 3) % 256,
+            (i * 80 + frame_number * 5) % 256,
+            (i * 110 + frame_number * 7) % 256,
+            200,
+        )
+        ctx.fill_circle(cx, cy, radius)
+
+    ctx.end()
+    return image.asarray()
+
+
+def encode_chunks(codec: str) -> list:
+    """ベンチマーク用のチャンクを事前にエンコードする"""
+    chunks = []
+    encoder = VideoEncoder(chunks.append, lambda e: pytest.fail(str(e)))
+    config: VideoEncoderConfig = {
+        "codec": codec,
+        "width": WIDTH,
+        "height": HEIGHT,
+        "bitrate": 1_500_000,
+        "framerate": 30,
+        "latency_mode": LatencyMode.REALTIME,
+    }
+    encoder.configure(config)
+    for i in range(NUM_FRAMES):
+        bgra = create_gradient_frame_blend2d(WIDTH, HEIGHT, i)
+        init: VideoFrameBufferInit = {
+            "format": VideoPixelFormat.BGRA,
+            "coded_width": WIDTH,
+            "coded_height": HEIGHT,
+            "timestamp": i * 33333,
+        }
+        bgra_frame = VideoFrame(bgra, init)
+        i420 = np.zeros(bgra_frame.allocation_size({"format": VideoPixelFormat.I420}), np.uint8)
+        bgra_frame.copy_to(i420, {"format": VideoPixelFormat.I420})
+        bgra_frame.close()
+
+        frame = VideoFrame(i420, {**init, "format": VideoPixelFormat.I420})
+        encoder.encode(frame, {"key_frame": i == 0})
+        frame.close()
+    encoder.flush()
+    encoder.close()
+    return chunks
+
+
+@pytest.fixture(scope="module")
+def encoded_chunks():
+    """コーデックごとのチャンクをモジュール内で使い回す"""
+    cache: dict[str, list] = {}
+
+    def get(codec: str) -> list:
+        if codec not in cache:
+            cache[codec] = encode_chunks(codec)
+        return cache[codec]
+
+    return get
+
+
+@pytest.mark.parametrize("decode_quality", [DecodeQuality.FULL, DecodeQuality.PREVIEW])
+@pytest.mark.parametrize("codec", CODECS)
+def test_decode_quality_throughput(benchmark, encoded_chunks, codec, decode_quality):
+    """720p 60 フレームのデコード (FULL / PREVIEW)"""
+    chunks = encoded_chunks(codec)
+    config: VideoDecoderConfig = {
+        "codec": codec,
+        "coded_width": WIDTH,
+        "coded_height": HEIGHT,
+        "decode_quality": decode_quality,
+    }
+    output_count = [0]
+
+    def on_output(frame):
+        output_count[0] += 1
+        frame.close()
+
+    def decode_all():
+        decoder = VideoDecoder(on_output, lambda e: pytest.fail(str(e)))
+        decoder.configure(config)
+        decoder.decode_many(chunks)
+        decoder.flush()
+        decoder.close()
+
+    benchmark(decode_all)
+    benchmark.extra_info["fps"] = NUM_FRAMES / benchmark.stats["mean"]
+    assert output_count[0] % NUM_FRAMES == 0
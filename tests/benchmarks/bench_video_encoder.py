@@ -818,3 +818,45 @@ class TestBatchEncoding:
 
         result = benchmark(run_batch)
         assert result >= 1
+
+
+class TestEncodeTransfer:
+    """transfer エンコードと RGB から I420 への直接変換のベンチマーク (VP8)"""
+
+    @pytest.mark.parametrize("transfer", [False, True], ids=["copy", "transfer"])
+    def test_vp8_encode_bgra_1080p(self, benchmark, transfer):
+        """1080p BGRA フレームを VP8 でエンコード"""
+        if sys.platform not in ("darwin", "linux"):
+            pytest.skip("VP8 is only available on macOS / Linux")
+        width, height = RESOLUTIONS["1080p"]
+
+        def on_output(chunk):
+            pass
+
+        def on_error(error):
+            raise RuntimeError(f"Encoder error: {error}")
+
+        config: VideoEncoderConfig = {
+            "codec": "vp8",
+            "width": width,
+            "height": height,
+            "bitrate": 10_000_000,
+            "framerate": 30,
+        }
+
+        encoder = VideoEncoder(on_output, on_error)
+        encoder.configure(config)
+
+        bgra = create_gradient_frame_blend2d(width, height, 0)
+        timestamp = [0]
+
+        def encode_one_frame():
+            frame = create_video_frame(bgra, width, height, VideoPixelFormat.BGRA, timestamp[0])
+            encoder.encode(frame, {"key_frame": True, "transfer": transfer})
+            encoder.flush()
+            frame.close()
+            timestamp[0] += 33333
+
+        benchmark(encode_one_frame)
+
+        encoder.close()
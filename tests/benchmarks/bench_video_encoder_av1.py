@@ -0,0 +1,174 @@
+"""
+AV1 エンコード性能ベンチマーク (libaom と SVT-AV1 の比較)
+
+壁時計時間あたりの fps に加えて、プロセスが消費した CPU 時間あたりの fps (コアあたりの fps) を
+extra_info に記録する。多コアのマシンでは SVT-AV1 のほうがコアを使い切れるため fps が伸びる
+
+実行方法:
+    uv run pytest tests/benchmarks/bench_video_encoder_av1.py -v
+
+    # コアあたりの fps を含めて結果を JSON に保存
+    uv run pytest tests/benchmarks/bench_video_encoder_av1.py -v --benchmark-json=benchmark.json
+"""
+
+import os
+import time
+
+import numpy as np
+import pytest
+from blend2d import Context, Image
+
+from webcodecs import (
+    AV1EncoderImplementation,
+    LatencyMode,
+    VideoEncoder,
+    VideoEncoderConfig,
+    VideoFrame,
+    VideoFrameBufferInit,
+    VideoPixelFormat,
+)
+
+# 解像度の定義
+RESOLUTIONS = {
+    "720p": (1280, 720),
+    "1080p": (1920, 1080),
+}
+
+# 1 ラウンドでエンコードするフレーム数
+NUM_FRAMES = 60
+
+IMPLEMENTATIONS = [
+    pytest.param(AV1EncoderImplementation.LIBAOM, id="libaom"),
+    pytest.param(AV1EncoderImplementation.SVT_AV1, id="svt_av1"),
+]
+
+
+def create_gradient_frame_blend2d(width: int, height: int, frame_number: int) -> np.ndarray:
+    """
+    blend2d を使ってグラデーションフレームを生成する
+    動きのあるパターンを生成して、エンコーダーの性能を測定する
+    """
+    image = Image(width, height)
+    ctx = Context(image)
+
+    # 背景を塗りつぶし（フレームごとに色を変化）
+    r = int(128 + 127 * np.sin(frame_number * 0.1))
+    g = int(128 + 127 * np.sin(frame_number * 0.1 + 2))
+    b = int(128 + 127 * np.sin(frame_number * 0.1 + 4))
+    ctx.set_fill_style_rgba(r, g, b, 255)
+    ctx.fill_all()
+
+    # 動く円を描画
+    num_circles = 5
+    for i in range(num_circles):
+        angle = frame_number * 0.05 + i * 1.26
+        cx = width / 2 + (width / 4) * np.cos(angle)
+        cy = height / 2 + (height / 4) * np.sin(angle)
+        radius = 30 + 20 * np.sin(frame_number * 0.1 + i * 0.5)
+
+        ctx.set_fill_style_rgba(
+            (i * 50 + frame_number * 3) % 256,
+            (i * 80 + frame_number * 5) % 256,
+            (i * 110 + frame_number * 7) % 256,
+            200,
+        )
+        ctx.fill_circle(cx, cy, radius)
+
+    ctx.end()
+
+    # BGRA 形式で取得
+    return image.asarray()
+
+
+def create_i420_frames(width: int, height: int) -> list[np.ndarray]:
+    """エンコード時間に含めないように、I420 に変換したフレームを事前に作成する"""
+    frames = []
+    for i in range(NUM_FRAMES):
+        init: VideoFrameBufferInit = {
+            "format": VideoPixelFormat.BGRA,
+            "coded_width": width,
+            "coded_height": height,
+            "timestamp": i * 33333,
+        }
+        bgra_frame = VideoFrame(create_gradient_frame_blend2d(width, height, i), init)
+        i420 = np.zeros(
+            bgra_frame.allocation_size({"format": VideoPixelFormat.I420}), dtype=np.uint8
+        )
+        bgra_frame.copy_to(i420, {"format": VideoPixelFormat.I420})
+        bgra_frame.close()
+        frames.append(i420)
+    return frames
+
+
+def encoder_config(
+    width: int, height: int, implementation: AV1EncoderImplementation
+) -> VideoEncoderConfig:
+    return {
+        "codec": "av01.0.08M.08",
+        "width": width,
+        "height": height,
+        "bitrate": 4_000_000,
+        "framerate": 30.0,
+        "latency_mode": LatencyMode.QUALITY,
+        "av1_encoder": implementation,
+    }
+
+
+def run_encode_benchmark(benchmark, resolution: str, implementation: AV1EncoderImplementation):
+    width, height = RESOLUTIONS[resolution]
+    config = encoder_config(width, height, implementation)
+    if not VideoEncoder.is_config_supported(config)["supported"]:
+        pytest.skip(f"{implementation} is not supported on this platform")
+
+    frames = create_i420_frames(width, height)
+    cpu_times = []
+
+    def encode_all():
+        chunks = []
+
+        def on_error(error):
+            raise RuntimeError(f"Encoder error: {error}")
+
+        encoder = VideoEncoder(lambda chunk, metadata=None: chunks.append(chunk), on_error)
+        encoder.configure(config)
+        cpu_start = time.process_time()
+        for i, data in enumerate(frames):
+            init: VideoFrameBufferInit = {
+                "format": VideoPixelFormat.I420,
+                "coded_width": width,
+                "coded_height": height,
+                "timestamp": i * 33333,
+            }
+            frame = VideoFrame(data, init)
+            encoder.encode(frame, {"key_frame": i == 0})
+            frame.close()
+        encoder.flush()
+        cpu_times.append(time.process_time() - cpu_start)
+        encoder.close()
+        return chunks
+
+    chunks = benchmark.pedantic(encode_all, rounds=3, iterations=1, warmup_rounds=1)
+    assert len(chunks) == NUM_FRAMES
+
+    # ウォームアップを除いた計測ラウンドの CPU 時間から、コアあたりの fps を求める
+    measured_cpu_times = cpu_times[-3:]
+    wall_fps = NUM_FRAMES / benchmark.stats.stats.mean
+    fps_per_core = NUM_FRAMES / (sum(measured_cpu_times) / len(measured_cpu_times))
+    benchmark.extra_info["frames"] = NUM_FRAMES
+    benchmark.extra_info["cpu_count"] = os.cpu_count()
+    benchmark.extra_info["fps"] = round(wall_fps, 2)
+    benchmark.extra_info["fps_per_core"] = round(fps_per_core, 2)
+
+
+class TestAV1EncoderImplementation:
+    """libaom と SVT-AV1 の QUALITY モードのエンコード性能の比較"""
+
+    @pytest.mark.parametrize("implementation", IMPLEMENTATIONS)
+    def test_av1_encode_720p(self, benchmark, implementation):
+        """720p AV1 エンコード (60 フレーム)"""
+        run_encode_benchmark(benchmark, "720p", implementation)
+
+    @pytest.mark.parametrize("implementation", IMPLEMENTATIONS)
+    def test_av1_encode_1080p(self, benchmark, implementation):
+        """1080p AV1 エンコード (60 フレーム)"""
+        run_encode_benchmark(benchmark, "1080p", implementation)
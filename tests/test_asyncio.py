@@ -0,0 +1,218 @@
+"""asyncio (出力キューを eventfd / パイプで待機する) のテスト"""
+
+import asyncio
+import select
+import sys
+
+import pytest
+from audio_test_helpers import generate_sine_wave
+from video_test_helpers import create_solid_i420_frame
+
+from webcodecs import (
+    AudioData,
+    AudioDataInit,
+    AudioEncoder,
+    AudioSampleFormat,
+    EncodedVideoChunk,
+    LatencyMode,
+    VideoDecoder,
+    VideoEncoder,
+    VideoEncoderConfig,
+)
+
+pytestmark = pytest.mark.skipif(sys.platform == "win32", reason="Windows は対応しない")
+
+SAMPLE_RATE = 48000
+FRAME_SIZE = 960  # 20ms
+WIDTH = 320
+HEIGHT = 240
+CODEC = "av01.0.04M.08"
+
+
+async def _encode_video(num_frames: int) -> list[EncodedVideoChunk]:
+    encoder = VideoEncoder(None, pytest.fail, output_queue=True)
+    config: VideoEncoderConfig = {
+        "codec": CODEC,
+        "width": WIDTH,
+        "height": HEIGHT,
+        "bitrate": 500_000,
+        "framerate": 30.0,
+    }
+    encoder.configure(config)
+    for i in range(num_frames):
+        frame = create_solid_i420_frame(WIDTH, HEIGHT, i * 33333, y=i * 16 % 256)
+        encoder.encode(frame, {"key_frame": i == 0})
+        frame.close()
+    await encoder.flush_async()
+    encoder.close()
+    return [chunk async for chunk, _metadata in encoder.chunks()]
+
+
+def test_video_frames_async():
+    """decode と並行して frames() で順番に取り出せる"""
+    num_frames = 20
+
+    async def main():
+        chunks = await _encode_video(num_frames)
+        decoder = VideoDecoder(None, pytest.fail, output_queue=True)
+        decoder.configure({"codec": CODEC})
+
+        async def consume():
+            return [frame async for frame in decoder.frames()]
+
+        consumer = asyncio.create_task(consume())
+        for chunk in chunks:
+            decoder.decode(chunk)
+            await asyncio.sleep(0)
+        await decoder.flush_async()
+        assert decoder.decode_queue_size == 0
+        decoder.close()
+        return await asyncio.wait_for(consumer, timeout=10.0)
+
+    frames = asyncio.run(main())
+    assert [frame.timestamp for frame in frames] == [i * 33333 for i in range(num_frames)]
+    for frame in frames:
+        frame.close()
+
+
+def test_video_chunks_async_with_flush_async():
+    """chunks() と flush_async() で同時に待機しても、両方が最後まで進む"""
+    num_frames = 20
+
+    async def main():
+        encoder = VideoEncoder(None, pytest.fail, output_queue=True)
+        config: VideoEncoderConfig = {
+            "codec": CODEC,
+            "width": WIDTH,
+            "height": HEIGHT,
+            "bitrate": 500_000,
+            "framerate": 30.0,
+            "latency_mode": LatencyMode.QUALITY,
+        }
+        encoder.configure(config)
+
+        async def consume():
+            return [chunk async for chunk, _metadata in encoder.chunks()]
+
+        consumer = asyncio.create_task(consume())
+        ticks = 0
+
+        async def tick():
+            nonlocal ticks
+            while True:
+                ticks += 1
+                await asyncio.sleep(0)
+
+        ticker = asyncio.create_task(tick())
+        for i in range(num_frames):
+            frame = create_solid_i420_frame(WIDTH, HEIGHT, i * 33333, y=i * 16 % 256)
+            encoder.encode(frame, {"key_frame": i == 0})
+            frame.close()
+        ticks_before_flush = ticks
+        await asyncio.wait_for(encoder.flush_async(), timeout=10.0)
+        # flush() の間もイベントループは止まらない
+        assert ticks > ticks_before_flush
+        ticker.cancel()
+        encoder.close()
+        return await asyncio.wait_for(consumer, timeout=10.0)
+
+    chunks = asyncio.run(main())
+    assert [chunk.timestamp for chunk in chunks] == [i * 33333 for i in range(num_frames)]
+
+
+def test_audio_chunks_async():
+    """AudioEncoder の出力を chunks() で取り出せる"""
+    num_packets = 10
+    samples = generate_sine_wave(440, SAMPLE_RATE, num_packets * FRAME_SIZE / SAMPLE_RATE)
+
+    async def main():
+        encoder = AudioEncoder(None, pytest.fail, output_queue=True)
+        encoder.configure({"codec": "opus", "sample_rate": SAMPLE_RATE, "number_of_channels": 1})
+        for n in range(num_packets):
+            start = n * FRAME_SIZE
+            init: AudioDataInit = {
+                "format": AudioSampleFormat.F32,
+                "sample_rate": SAMPLE_RATE,
+                "number_of_frames": FRAME_SIZE,
+                "number_of_channels": 1,
+                "timestamp": n * 20000,
+                "data": samples[start : start + FRAME_SIZE].reshape(FRAME_SIZE, 1),
+            }
+            audio = AudioData(init)
+            encoder.encode(audio)
+            audio.close()
+        await encoder.flush_async()
+        chunks = encoder.read_all()
+        encoder.close()
+        # close() 後は空のまま終了する
+        assert [chunk async for chunk in encoder.chunks()] == []
+        return chunks
+
+    chunks = asyncio.run(main())
+    assert [chunk.timestamp for chunk in chunks] == [n * 20000 for n in range(num_packets)]
+
+
+def test_output_queue_fd_readable():
+    """出力がキューに追加されると output_queue_fd が読み込み可能になる"""
+    decoder = VideoDecoder(None, pytest.fail, output_queue=True)
+    decoder.configure({"codec": CODEC})
+    fd = decoder.output_queue_fd
+    decoder.clear_output_queue_fd()
+    assert select.select([fd], [], [], 0)[0] == []
+
+    chunks = asyncio.run(_encode_video(1))
+    decoder.decode(chunks[0])
+    decoder.flush()
+    assert select.select([fd], [], [], 1.0)[0] == [fd]
+    decoder.clear_output_queue_fd()
+    assert select.select([fd], [], [], 0)[0] == []
+    for frame in decoder.read_all():
+        frame.close()
+    decoder.close()
+
+
+def test_request_flush():
+    """flush タスクを処理し終えると completed_flushes が進み、output_queue_fd に通知する"""
+    num_frames = 5
+    encoder = VideoEncoder(None, pytest.fail, output_queue=True)
+    config: VideoEncoderConfig = {
+        "codec": CODEC,
+        "width": WIDTH,
+        "height": HEIGHT,
+        "bitrate": 500_000,
+        "framerate": 30.0,
+        "latency_mode": LatencyMode.QUALITY,
+    }
+    encoder.configure(config)
+    fd = encoder.output_queue_fd
+    for i in range(num_frames):
+        frame = create_solid_i420_frame(WIDTH, HEIGHT, i * 33333, y=i * 16 % 256)
+        encoder.encode(frame, {"key_frame": i == 0})
+        frame.close()
+
+    flush_id = encoder.request_flush()
+    while encoder.completed_flushes < flush_id:
+        assert select.select([fd], [], [], 10.0)[0] == [fd]
+        encoder.clear_output_queue_fd()
+    # 先読みで遅延したフレームも出力されている
+    assert len(encoder.read_all()) == num_frames
+
+    # 構成済みでない場合は待たずに完了している
+    encoder.reset()
+    assert encoder.request_flush() <= encoder.completed_flushes
+    encoder.close()
+
+
+def test_asyncio_output_queue_not_enabled():
+    """output_queue を指定していない場合は例外になる"""
+    decoder = VideoDecoder(lambda f: None, lambda e: None)
+    decoder.configure({"codec": CODEC})
+    with pytest.raises(RuntimeError):
+        _ = decoder.output_queue_fd
+
+    async def consume():
+        return [frame async for frame in decoder.frames()]
+
+    with pytest.raises(RuntimeError):
+        asyncio.run(consume())
+    decoder.close()
@@ -180,3 +180,21 @@ def test_encoded_audio_chunk_timestamp_sequence():
         assert chunk.timestamp == ts
 
     assert len(chunks) == len(timestamps)
+
+
+def test_encoded_audio_chunk_transfer_borrows_buffer():
+    """transfer に含まれるバッファはコピーせずに参照される"""
+    payload = bytearray(b"audio_transfer_data")
+    chunk = EncodedAudioChunk(
+        {
+            "type": EncodedAudioChunkType.KEY,
+            "timestamp": 0,
+            "data": payload,
+            "transfer": [payload],
+        }
+    )
+    assert chunk.byte_length == len(payload)
+
+    destination = np.zeros(chunk.byte_length, dtype=np.uint8)
+    chunk.copy_to(destination)
+    assert bytes(destination) == b"audio_transfer_data"
@@ -1,4 +1,5 @@
 import numpy as np
+import pytest
 
 from webcodecs import EncodedVideoChunk, EncodedVideoChunkType
 
@@ -140,3 +141,73 @@ def test_encoded_video_chunk_type_delta():
     )
 
     assert chunk.type == EncodedVideoChunkType.DELTA
+
+
+def test_encoded_video_chunk_buffer_types():
+    """bytes 以外のバッファプロトコル対応オブジェクトも data に指定できる"""
+    data = b"buffer_protocol_data"
+    for source in (bytearray(data), memoryview(data), np.frombuffer(data, np.uint8)):
+        chunk = EncodedVideoChunk(
+            {
+                "type": EncodedVideoChunkType.KEY,
+                "timestamp": 0,
+                "data": source,
+            }
+        )
+        destination = np.zeros(chunk.byte_length, dtype=np.uint8)
+        chunk.copy_to(destination)
+        assert bytes(destination) == data
+
+
+def test_encoded_video_chunk_copies_without_transfer():
+    """transfer に含まれないバッファはコピーされる"""
+    payload = np.arange(16, dtype=np.uint8)
+    chunk = EncodedVideoChunk(
+        {
+            "type": EncodedVideoChunkType.KEY,
+            "timestamp": 0,
+            "data": payload,
+        }
+    )
+    payload[:] = 0
+
+    destination = np.zeros(chunk.byte_length, dtype=np.uint8)
+    chunk.copy_to(destination)
+    np.testing.assert_array_equal(destination, np.arange(16, dtype=np.uint8))
+
+
+def test_encoded_video_chunk_transfer_borrows_buffer():
+    """transfer に含まれるバッファはコピーせずに参照される"""
+    payload = np.arange(16, dtype=np.uint8)
+    chunk = EncodedVideoChunk(
+        {
+            "type": EncodedVideoChunkType.KEY,
+            "timestamp": 0,
+            "data": payload,
+            "transfer": [payload],
+        }
+    )
+    # 参照していることを確認するために書き換える (通常は書き換えてはいけない)
+    payload[0] = 255
+
+    destination = np.zeros(chunk.byte_length, dtype=np.uint8)
+    chunk.copy_to(destination)
+    assert destination[0] == 255
+
+    # chunk が参照を保持しているので元の変数を削除しても有効なまま
+    del payload
+    chunk.copy_to(destination)
+    assert destination[0] == 255
+
+
+def test_encoded_video_chunk_non_contiguous_data():
+    """C 連続でないバッファは TypeError になる"""
+    payload = np.arange(32, dtype=np.uint8)[::2]
+    with pytest.raises(TypeError):
+        EncodedVideoChunk(
+            {
+                "type": EncodedVideoChunkType.KEY,
+                "timestamp": 0,
+                "data": payload,
+            }
+        )
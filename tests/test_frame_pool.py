@@ -0,0 +1,109 @@
+"""フレームプールのテスト"""
+
+import platform
+
+import numpy as np
+import pytest
+
+from webcodecs import (
+    FramePoolStats,
+    LatencyMode,
+    VideoDecoder,
+    VideoDecoderConfig,
+    VideoEncoder,
+    VideoEncoderConfig,
+    VideoFrame,
+    clear_frame_pool,
+    get_frame_pool_stats,
+)
+from video_test_helpers import create_solid_i420_frame
+
+pytestmark = pytest.mark.skipif(
+    platform.system() not in ("Darwin", "Linux"),
+    reason="VP8 は macOS / Linux のみサポート",
+)
+
+
+def _encode_vp8(width: int, height: int, num_frames: int) -> tuple[list, FramePoolStats]:
+    """VP8 でエンコードしたチャンクとエンコーダーのプール統計を返す"""
+    chunks = []
+    encoder = VideoEncoder(lambda c: chunks.append(c), lambda e: pytest.fail(e))
+    config: VideoEncoderConfig = {
+        "codec": "vp8",
+        "width": width,
+        "height": height,
+        "bitrate": 500_000,
+        "framerate": 30.0,
+        "latency_mode": LatencyMode.REALTIME,
+    }
+    encoder.configure(config)
+    for i in range(num_frames):
+        frame = create_solid_i420_frame(width, height, i * 1000, y=i * 10 % 256)
+        encoder.encode(frame, {"key_frame": i == 0})
+        frame.close()
+    encoder.flush()
+    stats = encoder.frame_pool_stats()
+    encoder.close()
+    return chunks, stats
+
+
+def test_encoder_reuses_frame_copies():
+    """エンコード待ちフレームのコピーはプールで再利用される"""
+    num_frames = 10
+    chunks, stats = _encode_vp8(320, 240, num_frames)
+    assert len(chunks) == num_frames
+    assert stats["hits"] + stats["misses"] == num_frames
+    # flush() 後はすべてのコピーがプールに戻っている
+    assert stats["bytes_resident"] == stats["bytes_free"] > 0
+    assert stats["buffers_free"] == stats["misses"]
+
+
+def test_decoder_reuses_closed_frames():
+    """close() した VideoFrame のバッファが次のデコードで再利用される"""
+    width, height = 320, 240
+    num_frames = 10
+    chunks, _ = _encode_vp8(width, height, num_frames)
+
+    decoded = []
+
+    def on_output(frame: VideoFrame):
+        decoded.append(frame.timestamp)
+        frame.close()
+
+    decoder = VideoDecoder(on_output, lambda e: pytest.fail(e))
+    config: VideoDecoderConfig = {"codec": "vp8"}
+    decoder.configure(config)
+    for chunk in chunks:
+        decoder.decode(chunk)
+    decoder.flush()
+
+    assert decoded == [c.timestamp for c in chunks]
+    stats = decoder.frame_pool_stats()
+    assert stats["hits"] + stats["misses"] == num_frames
+    assert stats["hits"] > 0
+    # 全フレームを close() しているので使用中のバッファはない
+    assert stats["bytes_resident"] == stats["bytes_free"]
+    decoder.close()
+
+
+def test_global_pool_for_clone():
+    """clone() のバッファは共有プールから確保され、clear_frame_pool() で解放される"""
+    clear_frame_pool()
+    before = get_frame_pool_stats()
+
+    frame = create_solid_i420_frame(320, 240)
+    for _ in range(3):
+        cloned = frame.clone()
+        np.testing.assert_array_equal(cloned.planes()[0], frame.planes()[0])
+        cloned.close()
+    frame.close()
+
+    stats = get_frame_pool_stats()
+    assert stats["misses"] - before["misses"] == 1
+    assert stats["hits"] - before["hits"] == 2
+    assert stats["buffers_free"] >= 1
+
+    clear_frame_pool()
+    stats = get_frame_pool_stats()
+    assert stats["bytes_free"] == 0
+    assert stats["buffers_free"] == 0
@@ -0,0 +1,241 @@
+"""OpenH264 (Ubuntu の H.264 ソフトウェアエンコード/デコード) のテスト"""
+
+import sys
+
+import numpy as np
+import pytest
+
+from webcodecs import (
+    EncodedVideoChunkType,
+    HardwareAccelerationEngine,
+    LatencyMode,
+    VideoDecoder,
+    VideoDecoderConfig,
+    VideoEncoder,
+    VideoEncoderBitrateMode,
+    VideoEncoderConfig,
+    VideoFrame,
+    VideoFrameBufferInit,
+    VideoPixelFormat,
+    get_video_codec_capabilities,
+    parse_avc_description,
+)
+from video_test_helpers import create_moving_i420_frame
+
+CODEC = "avc1.42001f"
+WIDTH = 320
+HEIGHT = 240
+
+pytestmark = pytest.mark.skipif(
+    sys.platform != "linux", reason="OpenH264 is only supported on Linux"
+)
+
+
+def is_openh264_available() -> bool:
+    """libopenh264 が dlopen できるかどうかを確認"""
+    caps = get_video_codec_capabilities()
+    codecs = caps[HardwareAccelerationEngine.NONE]["codecs"]
+    return "avc1" in codecs and codecs["avc1"]["decoder"]
+
+
+def _encoder_config(**extra) -> VideoEncoderConfig:
+    config: VideoEncoderConfig = {
+        "codec": CODEC,
+        "width": WIDTH,
+        "height": HEIGHT,
+        "bitrate": 500_000,
+        "framerate": 30.0,
+    }
+    config.update(extra)
+    return config
+
+
+def _encode(config: VideoEncoderConfig, num_frames: int, options=None) -> list:
+    """エンコードして (chunk, metadata) のリストを返す"""
+    outputs = []
+    encoder = VideoEncoder(
+        lambda chunk, metadata=None: outputs.append((chunk, metadata)),
+        lambda e: pytest.fail(e),
+    )
+    encoder.configure(config)
+    for i in range(num_frames):
+        frame = create_moving_i420_frame(WIDTH, HEIGHT, i)
+        encode_options = {"key_frame": i == 0}
+        if options:
+            encode_options.update(options)
+        encoder.encode(frame, encode_options)
+        frame.close()
+    encoder.flush()
+    encoder.close()
+    return outputs
+
+
+def test_is_config_supported_matches_capabilities():
+    """エンジン未指定の H.264 は OpenH264 を読み込めるかどうかで判定される"""
+    config: VideoDecoderConfig = {"codec": CODEC}
+    support = VideoDecoder.is_config_supported(config)
+    assert support["supported"] == is_openh264_available()
+
+    config = {"codec": CODEC, "hardware_acceleration_engine": HardwareAccelerationEngine.NONE}
+    support = VideoDecoder.is_config_supported(config)
+    assert support["supported"] == is_openh264_available()
+
+
+def test_h265_is_not_supported_without_engine():
+    """H.265 は引き続きハードウェアアクセラレーションが必要"""
+    config: VideoDecoderConfig = {"codec": "hvc1.1.6.L93.B0"}
+    assert not VideoDecoder.is_config_supported(config)["supported"]
+
+
+@pytest.mark.skipif(is_openh264_available(), reason="OpenH264 is available")
+def test_configure_without_openh264():
+    """OpenH264 が読み込めない場合、configure() は RuntimeError になる"""
+    decoder = VideoDecoder(lambda f: None, lambda e: None)
+    with pytest.raises(RuntimeError):
+        decoder.configure({"codec": CODEC})
+    decoder.close()
+
+
+@pytest.mark.skipif(not is_openh264_available(), reason="OpenH264 is not available")
+def test_configure_with_openh264():
+    """OpenH264 が読み込める場合は configure() / flush() / reset() できる"""
+    decoder = VideoDecoder(lambda f: None, lambda e: pytest.fail(e))
+    decoder.configure({"codec": CODEC, "decode_threads": 2})
+    decoder.flush()
+    decoder.reset()
+    decoder.close()
+
+
+@pytest.mark.skipif(not is_openh264_available(), reason="OpenH264 is not available")
+def test_invalid_description():
+    """不正な avcC の description は RuntimeError になる"""
+    decoder = VideoDecoder(lambda f: None, lambda e: None)
+    with pytest.raises(RuntimeError):
+        decoder.configure({"codec": CODEC, "description": b"\x00\x01"})
+    decoder.close()
+
+
+def test_encoder_is_config_supported_matches_capabilities():
+    """エンジン未指定の H.264 エンコードは OpenH264 を読み込めるかどうかで判定される"""
+    support = VideoEncoder.is_config_supported(_encoder_config())
+    assert support["supported"] == is_openh264_available()
+
+    caps = get_video_codec_capabilities()
+    codecs = caps[HardwareAccelerationEngine.NONE]["codecs"]
+    if is_openh264_available():
+        assert codecs["avc1"]["encoder"]
+
+
+@pytest.mark.skipif(is_openh264_available(), reason="OpenH264 is available")
+def test_encoder_configure_without_openh264():
+    """OpenH264 が読み込めない場合、エンコーダーの configure() は RuntimeError になる"""
+    encoder = VideoEncoder(lambda c: None, lambda e: None)
+    with pytest.raises(RuntimeError):
+        encoder.configure(_encoder_config())
+    encoder.close()
+
+
+@pytest.mark.skipif(not is_openh264_available(), reason="OpenH264 is not available")
+@pytest.mark.parametrize("latency_mode", [LatencyMode.REALTIME, LatencyMode.QUALITY])
+def test_encode_decode_annexb(latency_mode):
+    """Annex B で出力したチャンクを OpenH264 でデコードできる"""
+    num_frames = 10
+    outputs = _encode(
+        _encoder_config(latency_mode=latency_mode, avc={"format": "annexb"}), num_frames
+    )
+    assert len(outputs) == num_frames
+    assert outputs[0][0].type == EncodedVideoChunkType.KEY
+    assert all(chunk.type == EncodedVideoChunkType.DELTA for chunk, _ in outputs[1:])
+    assert [chunk.timestamp for chunk, _ in outputs] == [i * 33333 for i in range(num_frames)]
+
+    # Annex B の場合は SPS/PPS をビットストリームに含める
+    data = np.zeros(outputs[0][0].byte_length, dtype=np.uint8)
+    outputs[0][0].copy_to(data)
+    assert bytes(data[:4]) == b"\x00\x00\x00\x01" or bytes(data[:3]) == b"\x00\x00\x01"
+
+    decoded = []
+    decoder = VideoDecoder(decoded.append, lambda e: pytest.fail(e))
+    decoder.configure({"codec": CODEC})
+    for chunk, _ in outputs:
+        decoder.decode(chunk)
+    decoder.flush()
+    assert len(decoded) == num_frames
+    assert decoded[0].coded_width == WIDTH
+    assert decoded[0].coded_height == HEIGHT
+    for frame in decoded:
+        frame.close()
+    decoder.close()
+
+
+@pytest.mark.skipif(not is_openh264_available(), reason="OpenH264 is not available")
+def test_encode_decode_avc():
+    """avc フォーマットではキーフレームに description (avcC) が含まれ、それを使ってデコードできる"""
+    num_frames = 5
+    outputs = _encode(_encoder_config(), num_frames)
+    assert len(outputs) == num_frames
+
+    metadata = outputs[0][1]
+    assert metadata is not None
+    decoder_config = metadata["decoder_config"]
+    description = decoder_config["description"]
+    assert description[0] == 1
+    info = parse_avc_description(description)
+    assert info.sps.width == WIDTH
+    assert info.sps.height == HEIGHT
+
+    decoded = []
+    decoder = VideoDecoder(decoded.append, lambda e: pytest.fail(e))
+    decoder.configure({"codec": CODEC, "description": description})
+    for chunk, _ in outputs:
+        decoder.decode(chunk)
+    decoder.flush()
+    assert len(decoded) == num_frames
+    for frame in decoded:
+        frame.close()
+    decoder.close()
+
+
+@pytest.mark.skipif(not is_openh264_available(), reason="OpenH264 is not available")
+def test_encode_keeps_duration():
+    """入力フレームの duration がチャンクに引き継がれる"""
+    outputs = []
+    encoder = VideoEncoder(lambda chunk: outputs.append(chunk), lambda e: pytest.fail(e))
+    encoder.configure(_encoder_config())
+    for i in range(3):
+        init: VideoFrameBufferInit = {
+            "format": VideoPixelFormat.I420,
+            "coded_width": WIDTH,
+            "coded_height": HEIGHT,
+            "timestamp": i * 33333,
+            "duration": 33333,
+        }
+        frame = VideoFrame(np.full(WIDTH * HEIGHT * 3 // 2, 128, dtype=np.uint8), init)
+        encoder.encode(frame, {"key_frame": i == 0})
+        frame.close()
+    encoder.flush()
+    encoder.close()
+
+    assert [chunk.duration for chunk in outputs] == [33333] * 3
+
+
+@pytest.mark.skipif(not is_openh264_available(), reason="OpenH264 is not available")
+def test_encode_quantizer():
+    """QUANTIZER モードでは avc.quantizer が小さいほどサイズが大きくなる"""
+
+    def total_size(quantizer: int) -> int:
+        outputs = _encode(
+            _encoder_config(bitrate_mode=VideoEncoderBitrateMode.QUANTIZER),
+            3,
+            {"avc": {"quantizer": quantizer}},
+        )
+        return sum(chunk.byte_length for chunk, _ in outputs)
+
+    assert total_size(10) > total_size(45)
+
+    encoder = VideoEncoder(lambda c: None, lambda e: None)
+    encoder.configure(_encoder_config(bitrate_mode=VideoEncoderBitrateMode.QUANTIZER))
+    frame = create_moving_i420_frame(WIDTH, HEIGHT, 0)
+    with pytest.raises(ValueError):
+        encoder.encode(frame, {"avc": {"quantizer": 52}})
+    frame.close()
+    encoder.close()
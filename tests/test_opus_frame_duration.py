@@ -0,0 +1,152 @@
+"""Opus の frame_duration と encode() をまたいだサンプルの蓄積のテスト"""
+
+import time
+
+import numpy as np
+import pytest
+from audio_test_helpers import generate_sine_wave
+
+from webcodecs import (
+    AudioData,
+    AudioDataInit,
+    AudioDecoder,
+    AudioEncoder,
+    AudioEncoderConfig,
+    AudioSampleFormat,
+)
+
+SAMPLE_RATE = 48000
+
+
+def _encoder_config(frame_duration: int | None = None) -> AudioEncoderConfig:
+    config: AudioEncoderConfig = {
+        "codec": "opus",
+        "sample_rate": SAMPLE_RATE,
+        "number_of_channels": 1,
+        "bitrate": 64000,
+    }
+    if frame_duration is not None:
+        config["opus"] = {"frame_duration": frame_duration}
+    return config
+
+
+def _make_audio_data(samples: np.ndarray, timestamp: int) -> AudioData:
+    init: AudioDataInit = {
+        "format": AudioSampleFormat.F32,
+        "sample_rate": SAMPLE_RATE,
+        "number_of_frames": len(samples),
+        "number_of_channels": 1,
+        "timestamp": timestamp,
+        "data": samples.reshape(len(samples), 1),
+    }
+    return AudioData(init)
+
+
+def _encode_in_buffers(
+    config: AudioEncoderConfig, samples: np.ndarray, buffer_size: int, flush: bool = True
+) -> list:
+    """samples を buffer_size ずつ encode() して出力されたチャンクを返す"""
+    chunks = []
+    encoder = AudioEncoder(chunks.append, lambda e: pytest.fail(e))
+    encoder.configure(config)
+    for start in range(0, len(samples), buffer_size):
+        buffer = samples[start : start + buffer_size]
+        audio = _make_audio_data(buffer, start * 1_000_000 // SAMPLE_RATE)
+        encoder.encode(audio)
+        audio.close()
+    if flush:
+        encoder.flush()
+    else:
+        # flush() せずにワーカースレッドの処理だけを待つ
+        while encoder.encode_queue_size > 0:
+            time.sleep(0.001)
+    encoder.close()
+    return chunks
+
+
+def test_short_buffers_are_accumulated():
+    """10ms の AudioData を渡しても 20ms のパケットにまとめられる"""
+    samples = generate_sine_wave(440, SAMPLE_RATE, 0.2)  # 200ms
+    chunks = _encode_in_buffers(_encoder_config(), samples, 480)
+
+    assert len(chunks) == 10
+    assert [chunk.timestamp for chunk in chunks] == [i * 20000 for i in range(10)]
+
+
+def test_leftover_is_padded_only_on_flush():
+    """frame_duration に満たない残りのサンプルは flush() で出力される"""
+    samples = generate_sine_wave(440, SAMPLE_RATE, 0.05)  # 50ms
+
+    chunks = _encode_in_buffers(_encoder_config(), samples, 480, flush=False)
+    assert len(chunks) == 2
+
+    chunks = _encode_in_buffers(_encoder_config(), samples, 480)
+    assert len(chunks) == 3
+    assert chunks[2].timestamp == 40000
+
+
+@pytest.mark.parametrize(
+    "frame_duration", [2500, 5000, 10000, 20000, 40000, 60000, 80000, 100000, 120000]
+)
+def test_frame_durations(frame_duration):
+    """Opus が対応する全てのフレーム期間でエンコード・デコードできる"""
+    duration_seconds = 0.24
+    samples = generate_sine_wave(440, SAMPLE_RATE, duration_seconds)
+    chunks = _encode_in_buffers(_encoder_config(frame_duration), samples, 480)
+
+    expected = -(-int(duration_seconds * 1_000_000) // frame_duration)
+    assert len(chunks) == expected
+    assert [chunk.timestamp for chunk in chunks] == [
+        i * frame_duration for i in range(expected)
+    ]
+
+    decoded = []
+    decoder = AudioDecoder(decoded.append, lambda e: pytest.fail(e))
+    decoder.configure({"codec": "opus", "sample_rate": SAMPLE_RATE, "number_of_channels": 1})
+    for chunk in chunks:
+        decoder.decode(chunk)
+    decoder.flush()
+    frame_size = SAMPLE_RATE * frame_duration // 1_000_000
+    assert [audio.number_of_frames for audio in decoded] == [frame_size] * expected
+    for audio in decoded:
+        audio.close()
+    decoder.close()
+
+
+def test_long_frame_duration_reduces_overhead():
+    """60ms のパケットは 20ms のパケットよりパケット数と合計サイズが小さくなる"""
+    samples = generate_sine_wave(440, SAMPLE_RATE, 1.2)
+    chunks_20ms = _encode_in_buffers(_encoder_config(20000), samples, 960)
+    chunks_60ms = _encode_in_buffers(_encoder_config(60000), samples, 960)
+
+    assert len(chunks_20ms) == 60
+    assert len(chunks_60ms) == 20
+    assert sum(c.byte_length for c in chunks_60ms) < sum(c.byte_length for c in chunks_20ms)
+
+
+@pytest.mark.parametrize("frame_duration", [0, 1000, 15000, 30000, 240000])
+def test_invalid_frame_duration(frame_duration):
+    """対応していないフレーム期間は configure() でエラーになる"""
+    config = _encoder_config(frame_duration)
+    assert not AudioEncoder.is_config_supported(config)["supported"]
+
+    encoder = AudioEncoder(lambda c: None, lambda e: None)
+    with pytest.raises(RuntimeError):
+        encoder.configure(config)
+    encoder.close()
+
+
+def test_reset_discards_buffered_samples():
+    """reset() すると蓄積中のサンプルは破棄される"""
+    chunks = []
+    encoder = AudioEncoder(chunks.append, lambda e: pytest.fail(e))
+    encoder.configure(_encoder_config())
+    audio = _make_audio_data(generate_sine_wave(440, SAMPLE_RATE, 0.01), 0)
+    encoder.encode(audio)
+    audio.close()
+    encoder.reset()
+
+    encoder.configure(_encoder_config())
+    encoder.flush()
+    encoder.close()
+    assert chunks == []
@@ -0,0 +1,185 @@
+"""output_queue (出力をコールバックではなく read() で取り出すモード) のテスト"""
+
+import threading
+
+import numpy as np
+import pytest
+from audio_test_helpers import generate_sine_wave
+from video_test_helpers import create_solid_i420_frame
+
+from webcodecs import (
+    AudioData,
+    AudioDataInit,
+    AudioDecoder,
+    AudioEncoder,
+    AudioEncoderConfig,
+    AudioSampleFormat,
+    EncodedVideoChunk,
+    VideoDecoder,
+    VideoEncoder,
+    VideoEncoderConfig,
+)
+
+SAMPLE_RATE = 48000
+FRAME_SIZE = 960  # 20ms
+WIDTH = 320
+HEIGHT = 240
+CODEC = "av01.0.04M.08"
+
+
+def _opus_config() -> AudioEncoderConfig:
+    return {
+        "codec": "opus",
+        "sample_rate": SAMPLE_RATE,
+        "number_of_channels": 1,
+        "bitrate": 32000,
+    }
+
+
+def _make_audio_data(samples: np.ndarray, timestamp: int) -> AudioData:
+    init: AudioDataInit = {
+        "format": AudioSampleFormat.F32,
+        "sample_rate": SAMPLE_RATE,
+        "number_of_frames": len(samples),
+        "number_of_channels": 1,
+        "timestamp": timestamp,
+        "data": samples.reshape(len(samples), 1),
+    }
+    return AudioData(init)
+
+
+def _encode_video(num_frames: int) -> list[EncodedVideoChunk]:
+    encoder = VideoEncoder(None, pytest.fail, output_queue=True)
+    config: VideoEncoderConfig = {
+        "codec": CODEC,
+        "width": WIDTH,
+        "height": HEIGHT,
+        "bitrate": 500_000,
+        "framerate": 30.0,
+    }
+    encoder.configure(config)
+    for i in range(num_frames):
+        frame = create_solid_i420_frame(WIDTH, HEIGHT, i * 33333, y=i * 16 % 256)
+        encoder.encode(frame, {"key_frame": i == 0})
+        frame.close()
+    encoder.flush()
+    outputs = list(encoder)
+    encoder.close()
+    return [chunk for chunk, _metadata in outputs]
+
+
+def test_audio_output_queue():
+    """AudioEncoder / AudioDecoder の出力を read() / read_all() で取り出せる"""
+    num_packets = 10
+    samples = generate_sine_wave(440, SAMPLE_RATE, num_packets * FRAME_SIZE / SAMPLE_RATE)
+
+    encoder = AudioEncoder(None, pytest.fail, output_queue=True)
+    encoder.configure(_opus_config())
+    for n in range(num_packets):
+        start = n * FRAME_SIZE
+        audio = _make_audio_data(samples[start : start + FRAME_SIZE], n * 20000)
+        encoder.encode(audio)
+        audio.close()
+    encoder.flush()
+    assert encoder.output_queue_size == num_packets
+    first = encoder.read(timeout=1.0)
+    chunks = [first, *encoder.read_all()]
+    assert encoder.output_queue_size == 0
+    encoder.close()
+    assert [chunk.timestamp for chunk in chunks] == [n * 20000 for n in range(num_packets)]
+
+    decoder = AudioDecoder(None, pytest.fail, output_queue=True)
+    decoder.configure({"codec": "opus", "sample_rate": SAMPLE_RATE, "number_of_channels": 1})
+    for chunk in chunks:
+        decoder.decode(chunk)
+    decoder.flush()
+    decoded = list(decoder)
+    decoder.close()
+    assert [data.timestamp for data in decoded] == [chunk.timestamp for chunk in chunks]
+    for data in decoded:
+        data.close()
+
+
+def test_video_output_queue_iteration():
+    """VideoEncoder / VideoDecoder の出力をイテレーションで順番に取り出せる"""
+    num_frames = 10
+    chunks = _encode_video(num_frames)
+    assert [chunk.timestamp for chunk in chunks] == [i * 33333 for i in range(num_frames)]
+
+    decoder = VideoDecoder(None, pytest.fail, output_queue=True)
+    decoder.configure({"codec": CODEC})
+    decoder.decode_many(chunks)
+    decoder.flush()
+    frames = list(decoder)
+    assert decoder.read(timeout=0) is None
+    decoder.close()
+
+    assert [frame.timestamp for frame in frames] == [i * 33333 for i in range(num_frames)]
+    for frame in frames:
+        frame.close()
+
+
+def test_video_output_queue_read_from_other_thread():
+    """デコード中に別スレッドから read() で取り出せる"""
+    num_frames = 20
+    chunks = _encode_video(num_frames)
+
+    decoder = VideoDecoder(None, pytest.fail, output_queue=True)
+    decoder.configure({"codec": CODEC})
+    frames = []
+
+    def reader():
+        while len(frames) < num_frames:
+            frame = decoder.read(timeout=5.0)
+            if frame is None:
+                break
+            frames.append(frame)
+
+    thread = threading.Thread(target=reader)
+    thread.start()
+    decoder.decode_many(chunks)
+    decoder.flush()
+    thread.join(timeout=10.0)
+    assert not thread.is_alive()
+    decoder.close()
+
+    assert [frame.timestamp for frame in frames] == [i * 33333 for i in range(num_frames)]
+    for frame in frames:
+        frame.close()
+
+
+def test_output_queue_close_wakes_reader():
+    """close() すると待機中の read() は None を返す"""
+    decoder = VideoDecoder(None, pytest.fail, output_queue=True)
+    decoder.configure({"codec": CODEC})
+    result = []
+    thread = threading.Thread(target=lambda: result.append(decoder.read()))
+    thread.start()
+    decoder.close()
+    thread.join(timeout=5.0)
+    assert not thread.is_alive()
+    assert result == [None]
+
+
+def test_output_queue_callback_not_called():
+    """output_queue の場合は出力コールバックを呼び出さない"""
+    samples = generate_sine_wave(440, SAMPLE_RATE, FRAME_SIZE / SAMPLE_RATE)
+    encoder = AudioEncoder(lambda c: pytest.fail("output が呼ばれた"), pytest.fail, output_queue=True)
+    encoder.configure(_opus_config())
+    audio = _make_audio_data(samples, 0)
+    encoder.encode(audio)
+    audio.close()
+    encoder.flush()
+    assert len(encoder.read_all()) == 1
+    encoder.close()
+
+
+def test_output_queue_not_enabled():
+    """output_queue を指定していない場合は read() が例外になる"""
+    decoder = VideoDecoder(lambda f: None, lambda e: None)
+    with pytest.raises(RuntimeError):
+        decoder.read(timeout=0)
+    with pytest.raises(RuntimeError):
+        decoder.read_all()
+    assert decoder.output_queue_size == 0
+    decoder.close()
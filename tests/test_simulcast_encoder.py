@@ -0,0 +1,215 @@
+"""SimulcastEncoder (1 つの入力から複数の解像度をエンコードする) のテスト"""
+
+import numpy as np
+import pytest
+
+from webcodecs import (
+    CodecState,
+    EncodedVideoChunkType,
+    SimulcastEncoder,
+    SimulcastEncoderConfig,
+    VideoDecoder,
+    VideoFrame,
+    VideoFrameBufferInit,
+    VideoPixelFormat,
+    VideoScaleFilter,
+)
+
+WIDTH = 640
+HEIGHT = 360
+CODEC = "av01.0.04M.08"
+RENDITIONS = [
+    {"id": "high", "width": WIDTH, "height": HEIGHT, "bitrate": 800_000},
+    {"id": "mid", "width": WIDTH // 2, "height": HEIGHT // 2, "bitrate": 300_000},
+    {"id": "low", "width": WIDTH // 4, "height": HEIGHT // 4, "bitrate": 100_000},
+]
+
+
+def _make_i420_frame(frame_num: int) -> VideoFrame:
+    y = np.fromfunction(
+        lambda row, col: (row + col + frame_num * 4) % 256, (HEIGHT, WIDTH), dtype=np.int32
+    ).astype(np.uint8)
+    uv = np.full(WIDTH * HEIGHT // 2, 128, dtype=np.uint8)
+    init: VideoFrameBufferInit = {
+        "format": VideoPixelFormat.I420,
+        "coded_width": WIDTH,
+        "coded_height": HEIGHT,
+        "timestamp": frame_num * 33333,
+    }
+    return VideoFrame(np.concatenate([y.reshape(-1), uv]), init)
+
+
+def _make_bgra_frame(frame_num: int) -> VideoFrame:
+    data = np.full((HEIGHT, WIDTH, 4), (frame_num * 8) % 256, dtype=np.uint8)
+    init: VideoFrameBufferInit = {
+        "format": VideoPixelFormat.BGRA,
+        "coded_width": WIDTH,
+        "coded_height": HEIGHT,
+        "timestamp": frame_num * 33333,
+    }
+    return VideoFrame(data, init)
+
+
+def _config(**kwargs) -> SimulcastEncoderConfig:
+    config: SimulcastEncoderConfig = {
+        "codec": CODEC,
+        "framerate": 30.0,
+        "renditions": RENDITIONS,  # type: ignore[typeddict-item]
+    }
+    config.update(kwargs)  # type: ignore[typeddict-item]
+    return config
+
+
+def _collect():
+    outputs: dict[str, list] = {}
+
+    def on_output(rendition_id, chunk, metadata=None):
+        outputs.setdefault(rendition_id, []).append(chunk)
+
+    return outputs, on_output
+
+
+def test_simulcast_encode_renditions():
+    """全てのレンディションが入力順に出力され、それぞれの解像度でデコードできる"""
+    num_frames = 10
+    outputs, on_output = _collect()
+    encoder = SimulcastEncoder(on_output, pytest.fail)
+    encoder.configure(_config())
+    assert encoder.state == CodecState.CONFIGURED
+    assert encoder.renditions == ["high", "mid", "low"]
+
+    for i in range(num_frames):
+        frame = _make_i420_frame(i)
+        encoder.encode(frame, {"key_frame": i == 0})
+        frame.close()
+    encoder.flush()
+    assert encoder.encode_queue_size == 0
+    encoder.close()
+    assert encoder.state == CodecState.CLOSED
+
+    for rendition in RENDITIONS:
+        chunks = outputs[rendition["id"]]
+        assert [chunk.timestamp for chunk in chunks] == [i * 33333 for i in range(num_frames)]
+        assert chunks[0].type == EncodedVideoChunkType.KEY
+
+        frames = []
+        decoder = VideoDecoder(frames.append, pytest.fail)
+        decoder.configure({"codec": CODEC})
+        decoder.decode_many(chunks)
+        decoder.flush()
+        decoder.close()
+        assert len(frames) == num_frames
+        for frame in frames:
+            assert (frame.coded_width, frame.coded_height) == (
+                rendition["width"],
+                rendition["height"],
+            )
+            frame.close()
+
+
+def test_simulcast_reuses_pooled_buffers():
+    """縮小したフレームのバッファはフレームプールから再利用する"""
+    outputs, on_output = _collect()
+    encoder = SimulcastEncoder(on_output, pytest.fail)
+    encoder.configure(_config(scale_filter=VideoScaleFilter.BILINEAR))
+    for i in range(10):
+        frame = _make_i420_frame(i)
+        encoder.encode(frame, {"key_frame": i == 0})
+        frame.close()
+        encoder.flush()
+    stats = encoder.frame_pool_stats()
+    encoder.close()
+    assert stats["hits"] > 0
+
+
+@pytest.mark.parametrize("align", [True, False])
+def test_simulcast_key_frame_renditions(align):
+    """key_frame_renditions で指定したレンディションをキーフレームにし、align_key_frames で揃える"""
+    num_frames = 8
+    outputs, on_output = _collect()
+    encoder = SimulcastEncoder(on_output, pytest.fail)
+    encoder.configure(_config(align_key_frames=align))
+    for i in range(num_frames):
+        frame = _make_i420_frame(i)
+        if i == 0:
+            encoder.encode(frame, {"key_frame": True})
+        elif i == 5:
+            encoder.encode(frame, {"key_frame_renditions": ["low"]})
+        else:
+            encoder.encode(frame)
+        frame.close()
+    encoder.flush()
+    encoder.close()
+
+    for rendition_id, chunks in outputs.items():
+        key_indices = [i for i, c in enumerate(chunks) if c.type == EncodedVideoChunkType.KEY]
+        if align or rendition_id == "low":
+            assert key_indices == [0, 5]
+        else:
+            assert key_indices == [0]
+
+
+def test_simulcast_transfer_and_bgra_input():
+    """I420 以外の入力も縮小でき、transfer を指定すると入力フレームを close する"""
+    outputs, on_output = _collect()
+    encoder = SimulcastEncoder(on_output, pytest.fail)
+    encoder.configure(_config())
+    for i in range(3):
+        frame = _make_bgra_frame(i)
+        encoder.encode(frame, {"key_frame": i == 0, "transfer": True})
+        assert frame.is_closed
+    encoder.flush()
+    encoder.close()
+
+    assert {rendition_id: len(chunks) for rendition_id, chunks in outputs.items()} == {
+        "high": 3,
+        "mid": 3,
+        "low": 3,
+    }
+
+
+def test_simulcast_reconfigure():
+    """レンディションの構成を変えて再設定できる"""
+    outputs, on_output = _collect()
+    encoder = SimulcastEncoder(on_output, pytest.fail)
+    encoder.configure(_config())
+    frame = _make_i420_frame(0)
+    encoder.encode(frame, {"key_frame": True})
+    frame.close()
+
+    # ビットレートだけを変更する
+    renditions = [{**r, "bitrate": r["bitrate"] // 2} for r in RENDITIONS]
+    encoder.configure(_config(renditions=renditions))
+    frame = _make_i420_frame(1)
+    encoder.encode(frame)
+    frame.close()
+
+    # レンディションを減らす
+    encoder.configure(_config(renditions=RENDITIONS[1:]))
+    assert encoder.renditions == ["mid", "low"]
+    frame = _make_i420_frame(2)
+    encoder.encode(frame, {"key_frame": True})
+    frame.close()
+    encoder.flush()
+    encoder.close()
+
+    assert [c.timestamp for c in outputs["high"]] == [0, 33333]
+    assert [c.timestamp for c in outputs["low"]] == [0, 33333, 66666]
+
+
+def test_simulcast_invalid_config():
+    """レンディションの ID の重複や未知のレンディションの指定は例外になる"""
+    encoder = SimulcastEncoder(lambda *args: None, lambda e: None)
+    with pytest.raises(ValueError):
+        encoder.configure(_config(renditions=[]))
+    with pytest.raises(ValueError):
+        encoder.configure(_config(renditions=[RENDITIONS[0], RENDITIONS[0]]))
+
+    frame = _make_i420_frame(0)
+    with pytest.raises(RuntimeError):
+        encoder.encode(frame)
+    encoder.configure(_config())
+    with pytest.raises(ValueError):
+        encoder.encode(frame, {"key_frame_renditions": ["unknown"]})
+    frame.close()
+    encoder.close()
@@ -0,0 +1,233 @@
+"""decode_sync / encode_sync (呼び出し元のスレッドで処理する同期モード) のテスト"""
+
+import platform
+
+import numpy as np
+import pytest
+from audio_test_helpers import generate_sine_wave
+from video_test_helpers import create_solid_i420_frame
+
+from webcodecs import (
+    AudioData,
+    AudioDataInit,
+    AudioDecoder,
+    AudioEncoder,
+    AudioEncoderConfig,
+    AudioSampleFormat,
+    CodecState,
+    DecodeFrameType,
+    EncodedVideoChunk,
+    EncodedVideoChunkType,
+    VideoDecoder,
+    VideoEncoder,
+    VideoEncoderConfig,
+)
+
+SAMPLE_RATE = 48000
+FRAME_SIZE = 960  # 20ms
+WIDTH = 320
+HEIGHT = 240
+
+VIDEO_CODECS = [
+    pytest.param("av01.0.04M.08", id="av1"),
+    pytest.param(
+        "vp8",
+        id="vp8",
+        marks=pytest.mark.skipif(
+            platform.system() not in ("Darwin", "Linux"),
+            reason="VP8 は macOS / Linux のみサポート",
+        ),
+    ),
+]
+
+
+def _opus_config() -> AudioEncoderConfig:
+    return {
+        "codec": "opus",
+        "sample_rate": SAMPLE_RATE,
+        "number_of_channels": 1,
+        "bitrate": 32000,
+    }
+
+
+def _make_audio_data(samples: np.ndarray, timestamp: int) -> AudioData:
+    init: AudioDataInit = {
+        "format": AudioSampleFormat.F32,
+        "sample_rate": SAMPLE_RATE,
+        "number_of_frames": len(samples),
+        "number_of_channels": 1,
+        "timestamp": timestamp,
+        "data": samples.reshape(len(samples), 1),
+    }
+    return AudioData(init)
+
+
+def _video_encoder_config(codec: str) -> VideoEncoderConfig:
+    return {
+        "codec": codec,
+        "width": WIDTH,
+        "height": HEIGHT,
+        "bitrate": 500_000,
+        "framerate": 30.0,
+    }
+
+
+def _encode_video_sync(codec: str, num_frames: int) -> list[EncodedVideoChunk]:
+    encoder = VideoEncoder(lambda c, m=None: pytest.fail("output が呼ばれた"), pytest.fail)
+    encoder.configure(_video_encoder_config(codec))
+    outputs = []
+    for i in range(num_frames):
+        frame = create_solid_i420_frame(WIDTH, HEIGHT, i * 33333, y=i * 16 % 256)
+        outputs.extend(encoder.encode_sync(frame, {"key_frame": i == 0}))
+        frame.close()
+    outputs.extend(encoder.flush_sync())
+    encoder.close()
+    return [chunk for chunk, _metadata in outputs]
+
+
+def test_audio_encode_decode_sync():
+    """AudioEncoder / AudioDecoder の出力がコールバックではなく戻り値で返る"""
+    num_packets = 10
+    samples = generate_sine_wave(440, SAMPLE_RATE, num_packets * FRAME_SIZE / SAMPLE_RATE)
+
+    encoder = AudioEncoder(lambda c: pytest.fail("output が呼ばれた"), pytest.fail)
+    encoder.configure(_opus_config())
+    chunks = []
+    for n in range(num_packets):
+        start = n * FRAME_SIZE
+        audio = _make_audio_data(samples[start : start + FRAME_SIZE], n * 20000)
+        # 20ms ちょうどの入力なので 1 回の呼び出しで 1 パケット返る
+        outputs = encoder.encode_sync(audio)
+        audio.close()
+        assert len(outputs) == 1
+        chunks.extend(outputs)
+    chunks.extend(encoder.flush_sync())
+    encoder.close()
+    assert [chunk.timestamp for chunk in chunks] == [n * 20000 for n in range(num_packets)]
+
+    decoder = AudioDecoder(lambda d: pytest.fail("output が呼ばれた"), pytest.fail)
+    decoder.configure({"codec": "opus", "sample_rate": SAMPLE_RATE, "number_of_channels": 1})
+    decoded = []
+    for chunk in chunks:
+        decoded.extend(decoder.decode_sync(chunk))
+    decoded.extend(decoder.flush_sync())
+    decoder.close()
+
+    assert [data.timestamp for data in decoded] == [chunk.timestamp for chunk in chunks]
+    for data in decoded:
+        assert data.number_of_frames == FRAME_SIZE
+        data.close()
+
+
+def test_audio_encode_sync_after_encode():
+    """キューに追加済みのタスクを処理し終えてから同期モードで処理する"""
+    samples = generate_sine_wave(440, SAMPLE_RATE, 2 * FRAME_SIZE / SAMPLE_RATE)
+    queued = []
+    encoder = AudioEncoder(queued.append, pytest.fail)
+    encoder.configure(_opus_config())
+
+    audio = _make_audio_data(samples[:FRAME_SIZE], 0)
+    encoder.encode(audio)
+    audio.close()
+    audio = _make_audio_data(samples[FRAME_SIZE:], 20000)
+    outputs = encoder.encode_sync(audio)
+    audio.close()
+    encoder.close()
+
+    assert [chunk.timestamp for chunk in queued] == [0]
+    assert [chunk.timestamp for chunk in outputs] == [20000]
+
+
+@pytest.mark.parametrize("codec", VIDEO_CODECS)
+def test_video_encode_decode_sync(codec):
+    """VideoEncoder / VideoDecoder の出力が入力順に戻り値で返る"""
+    num_frames = 10
+    chunks = _encode_video_sync(codec, num_frames)
+    assert [chunk.timestamp for chunk in chunks] == [i * 33333 for i in range(num_frames)]
+    assert chunks[0].type == EncodedVideoChunkType.KEY
+
+    decoder = VideoDecoder(lambda f: pytest.fail("output が呼ばれた"), pytest.fail)
+    decoder.configure({"codec": codec})
+    frames = []
+    for chunk in chunks:
+        frames.extend(decoder.decode_sync(chunk))
+    frames.extend(decoder.flush_sync())
+    decoder.close()
+
+    assert [frame.timestamp for frame in frames] == [i * 33333 for i in range(num_frames)]
+    for frame in frames:
+        assert frame.coded_width == WIDTH
+        assert frame.coded_height == HEIGHT
+        frame.close()
+
+
+def test_video_encode_sync_metadata():
+    """metadata が chunk と組で返る"""
+    encoder = VideoEncoder(lambda c, m=None: None, pytest.fail)
+    config = _video_encoder_config("av01.0.04M.08")
+    config["scalability_mode"] = "L1T2"
+    encoder.configure(config)
+    outputs = []
+    for i in range(4):
+        frame = create_solid_i420_frame(WIDTH, HEIGHT, i * 33333, y=i * 16 % 256)
+        outputs.extend(encoder.encode_sync(frame, {"key_frame": i == 0}))
+        frame.close()
+    outputs.extend(encoder.flush_sync())
+    encoder.close()
+
+    assert outputs[0][0].type == EncodedVideoChunkType.KEY
+    assert [metadata["svc"]["temporal_layer_id"] for _chunk, metadata in outputs] == [0, 1, 0, 1]
+
+
+def test_video_encode_sync_transfer():
+    """transfer を指定した場合は戻る前にフレームを close する"""
+    encoder = VideoEncoder(lambda c, m=None: None, pytest.fail)
+    encoder.configure(_video_encoder_config("av01.0.04M.08"))
+    frame = create_solid_i420_frame(WIDTH, HEIGHT)
+    encoder.encode_sync(frame, {"key_frame": True, "transfer": True})
+    assert frame.is_closed
+    encoder.close()
+
+
+def test_video_decode_sync_key_only():
+    """decode_frame_type が KEY の場合、差分フレームは空のリストを返す"""
+    chunks = _encode_video_sync("av01.0.04M.08", 5)
+    decoder = VideoDecoder(lambda f: None, pytest.fail)
+    decoder.configure({"codec": "av01.0.04M.08", "decode_frame_type": DecodeFrameType.KEY})
+    frames = []
+    for chunk in chunks:
+        frames.extend(decoder.decode_sync(chunk))
+    frames.extend(decoder.flush_sync())
+    assert decoder.decode_queue_skipped == 4
+    decoder.close()
+
+    assert [frame.timestamp for frame in frames] == [0]
+    for frame in frames:
+        frame.close()
+
+
+def test_sync_not_configured():
+    """configure 前に呼び出すと例外になる"""
+    decoder = VideoDecoder(lambda f: None, lambda e: None)
+    assert decoder.state == CodecState.UNCONFIGURED
+    chunk = EncodedVideoChunk({"type": EncodedVideoChunkType.KEY, "timestamp": 0, "data": b"\x00"})
+    with pytest.raises(RuntimeError):
+        decoder.decode_sync(chunk)
+
+    encoder = AudioEncoder(lambda c: None, lambda e: None)
+    audio = _make_audio_data(np.zeros(FRAME_SIZE, dtype=np.float32), 0)
+    with pytest.raises(RuntimeError):
+        encoder.encode_sync(audio)
+    audio.close()
+
+
+def test_video_decode_sync_invalid_chunk():
+    """デコードに失敗した場合は例外になる"""
+    decoder = VideoDecoder(lambda f: None, lambda e: None)
+    decoder.configure({"codec": "av01.0.04M.08"})
+    chunk = EncodedVideoChunk(
+        {"type": EncodedVideoChunkType.KEY, "timestamp": 0, "data": b"\xff" * 16}
+    )
+    with pytest.raises(RuntimeError):
+        decoder.decode_sync(chunk)
+    decoder.close()
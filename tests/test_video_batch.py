@@ -0,0 +1,211 @@
+"""VideoDecoder.decode_many / VideoEncoder.encode_many と on_output_batch のテスト"""
+
+import pytest
+
+from webcodecs import (
+    EncodedVideoChunkType,
+    LatencyMode,
+    VideoDecoder,
+    VideoDecoderConfig,
+    VideoEncoder,
+    VideoEncoderConfig,
+)
+from video_test_helpers import create_solid_i420_frame
+
+CODEC = "av01.0.04M.08"
+WIDTH = 320
+HEIGHT = 240
+
+
+def _encoder_config() -> VideoEncoderConfig:
+    return {
+        "codec": CODEC,
+        "width": WIDTH,
+        "height": HEIGHT,
+        "bitrate": 500_000,
+        "framerate": 30.0,
+        "latency_mode": LatencyMode.REALTIME,
+    }
+
+
+def _encode_many(num_frames: int) -> list:
+    chunks = []
+    encoder = VideoEncoder(lambda c: chunks.append(c), lambda e: pytest.fail(e))
+    encoder.configure(_encoder_config())
+    frames = [
+        create_solid_i420_frame(WIDTH, HEIGHT, i * 1000, y=i * 10 % 256)
+        for i in range(num_frames)
+    ]
+    encoder.encode_many(frames, [{"key_frame": i == 0} for i in range(num_frames)])
+    encoder.flush()
+    encoder.close()
+    for f in frames:
+        f.close()
+    return chunks
+
+
+def test_encode_many_outputs_in_order():
+    """encode_many() は encode() と同じ順序でチャンクを出力する"""
+    num_frames = 10
+    chunks = _encode_many(num_frames)
+
+    assert len(chunks) == num_frames
+    assert [c.timestamp for c in chunks] == [i * 1000 for i in range(num_frames)]
+    assert chunks[0].type == EncodedVideoChunkType.KEY
+
+
+def test_encode_many_options():
+    """options は None / 共通の dict / フレームごとの list を受け付ける"""
+    encoder = VideoEncoder(lambda c: None, lambda e: pytest.fail(e))
+    encoder.configure(_encoder_config())
+
+    frames = [
+        create_solid_i420_frame(WIDTH, HEIGHT, i * 1000, y=i * 10 % 256)
+        for i in range(3)
+    ]
+    encoder.encode_many(frames)
+    encoder.encode_many(frames, {"key_frame": True})
+    encoder.encode_many(frames, [{}, {"key_frame": True}, {}])
+    encoder.encode_many([])
+
+    # 長さが合わない list は ValueError
+    with pytest.raises(ValueError):
+        encoder.encode_many(frames, [{}, {}])
+
+    # 検証エラーの場合は transfer 指定のフレームも close されない
+    with pytest.raises(ValueError):
+        encoder.encode_many(
+            frames,
+            [{"transfer": True}, {"transfer": True}, {"av1": {"quantizer": 64}}],
+        )
+    assert not any(f.is_closed for f in frames)
+
+    # transfer するフレームを重複して渡すと、何もキューに入れずに ValueError
+    with pytest.raises(ValueError):
+        encoder.encode_many([frames[0], frames[1], frames[0]], {"transfer": True})
+    assert not any(f.is_closed for f in frames)
+
+    # close 済みのフレームが含まれる場合も、何もキューに入れずにエラーになる
+    closed = create_solid_i420_frame(WIDTH, HEIGHT, 3000)
+    closed.close()
+    with pytest.raises(RuntimeError, match="closed"):
+        encoder.encode_many([frames[0], closed], {"transfer": True})
+    assert not frames[0].is_closed
+
+    encoder.encode_many(frames, {"transfer": True})
+    assert all(f.is_closed for f in frames)
+
+    encoder.flush()
+    encoder.close()
+
+
+def test_encode_many_coalesces_dequeue():
+    """on_dequeue は encode_many() ごとに 1 回だけ呼び出される"""
+    dequeue_count = 0
+
+    def on_dequeue():
+        nonlocal dequeue_count
+        dequeue_count += 1
+
+    batches = []
+    encoder = VideoEncoder(lambda c: None, lambda e: pytest.fail(e))
+    encoder.on_output_batch(lambda outputs: batches.append(outputs))
+    encoder.on_dequeue(on_dequeue)
+    encoder.configure(_encoder_config())
+
+    frames = [
+        create_solid_i420_frame(WIDTH, HEIGHT, i * 1000, y=i * 10 % 256)
+        for i in range(8)
+    ]
+    encoder.encode_many(frames, {"transfer": True})
+    encoder.flush()
+
+    assert dequeue_count == 1
+    encoder.close()
+
+
+def test_encoder_output_batch():
+    """on_output_batch はチャンクと metadata のタプルのリストを受け取る"""
+    single = []
+    batches = []
+    encoder = VideoEncoder(lambda c: single.append(c), lambda e: pytest.fail(e))
+    encoder.on_output_batch(lambda outputs: batches.append(outputs))
+    encoder.configure(_encoder_config())
+
+    num_frames = 10
+    for i in range(num_frames):
+        frame = create_solid_i420_frame(WIDTH, HEIGHT, i * 1000, y=i * 10 % 256)
+        encoder.encode(frame, {"key_frame": i == 0, "transfer": True})
+    encoder.flush()
+
+    # output コールバックの代わりに呼び出される
+    assert single == []
+    outputs = [item for batch in batches for item in batch]
+    assert len(outputs) == num_frames
+    assert all(isinstance(b, list) and len(b) > 0 for b in batches)
+    assert [chunk.timestamp for chunk, _ in outputs] == [
+        i * 1000 for i in range(num_frames)
+    ]
+    assert all(isinstance(metadata, dict) for _, metadata in outputs)
+    encoder.close()
+
+
+def test_decode_many_with_output_batch():
+    """decode_many() と on_output_batch で全フレームが順序通りに出力される"""
+    num_frames = 20
+    chunks = _encode_many(num_frames)
+
+    single = []
+    batches = []
+    dequeue_count = 0
+
+    def on_dequeue():
+        nonlocal dequeue_count
+        dequeue_count += 1
+
+    decoder = VideoDecoder(lambda f: single.append(f), lambda e: pytest.fail(e))
+    decoder.on_output_batch(lambda frames: batches.append(frames))
+    decoder.on_dequeue(on_dequeue)
+    config: VideoDecoderConfig = {"codec": CODEC}
+    decoder.configure(config)
+    decoder.decode_many(chunks)
+    decoder.flush()
+
+    assert single == []
+    assert dequeue_count == 1
+    frames = [f for batch in batches for f in batch]
+    assert len(frames) == num_frames
+    # バッチの上限は 64 件
+    assert all(0 < len(batch) <= 64 for batch in batches)
+    assert [f.timestamp for f in frames] == [c.timestamp for c in chunks]
+    for f in frames:
+        f.close()
+    decoder.close()
+
+
+def test_decode_many_without_output_batch():
+    """on_output_batch を設定しない場合は on_output が 1 フレームずつ呼び出される"""
+    num_frames = 5
+    chunks = _encode_many(num_frames)
+
+    decoded = []
+    decoder = VideoDecoder(lambda f: decoded.append(f), lambda e: pytest.fail(e))
+    config: VideoDecoderConfig = {"codec": CODEC}
+    decoder.configure(config)
+    decoder.decode_many(chunks)
+    decoder.decode_many([])
+    decoder.flush()
+
+    assert len(decoded) == num_frames
+    assert [f.timestamp for f in decoded] == [c.timestamp for c in chunks]
+    for f in decoded:
+        f.close()
+    decoder.close()
+
+
+def test_decode_many_not_configured():
+    """未設定の場合は RuntimeError"""
+    decoder = VideoDecoder(lambda f: None, lambda e: None)
+    with pytest.raises(RuntimeError):
+        decoder.decode_many([])
+    decoder.close()
@@ -0,0 +1,160 @@
+"""VideoDecoderConfig の decode_frame_type のテスト"""
+
+import platform
+
+import pytest
+
+from webcodecs import (
+    DecodeFrameType,
+    EncodedVideoChunkType,
+    LatencyMode,
+    VideoDecoder,
+    VideoDecoderConfig,
+    VideoEncoder,
+    VideoEncoderConfig,
+)
+from video_test_helpers import create_moving_i420_frame
+
+WIDTH = 320
+HEIGHT = 240
+NUM_FRAMES = 12
+KEY_INTERVAL = 4
+
+
+def _encode(codec: str) -> list:
+    """KEY_INTERVAL ごとにキーフレームを挟んでエンコードしたチャンクを返す"""
+    chunks = []
+    encoder = VideoEncoder(lambda c: chunks.append(c), lambda e: pytest.fail(e))
+    enc_config: VideoEncoderConfig = {
+        "codec": codec,
+        "width": WIDTH,
+        "height": HEIGHT,
+        "bitrate": 500_000,
+        "framerate": 30.0,
+        "latency_mode": LatencyMode.REALTIME,
+    }
+    encoder.configure(enc_config)
+    for i in range(NUM_FRAMES):
+        frame = create_moving_i420_frame(WIDTH, HEIGHT, i)
+        encoder.encode(frame, {"key_frame": i % KEY_INTERVAL == 0})
+        frame.close()
+    encoder.flush()
+    encoder.close()
+    return chunks
+
+
+def _decode(chunks: list, config: VideoDecoderConfig) -> tuple[list, int]:
+    """デコードした VideoFrame のタイムスタンプと decode_queue_skipped を返す"""
+    timestamps = []
+
+    def on_output(frame):
+        timestamps.append(frame.timestamp)
+        frame.close()
+
+    decoder = VideoDecoder(on_output, lambda e: pytest.fail(e))
+    decoder.configure(config)
+    decoder.decode_many(chunks)
+    decoder.flush()
+    skipped = decoder.decode_queue_skipped
+    decoder.close()
+    return timestamps, skipped
+
+
+CODECS = [
+    pytest.param("av01.0.04M.08", id="av1"),
+    pytest.param(
+        "vp8",
+        id="vp8",
+        marks=pytest.mark.skipif(
+            platform.system() not in ("Darwin", "Linux"),
+            reason="VP8 は macOS / Linux のみサポート",
+        ),
+    ),
+    pytest.param(
+        "vp09.00.10.08",
+        id="vp9",
+        marks=pytest.mark.skipif(
+            platform.system() not in ("Darwin", "Linux"),
+            reason="VP9 は macOS / Linux のみサポート",
+        ),
+    ),
+]
+
+
+@pytest.mark.parametrize("codec", CODECS)
+def test_decode_all(codec):
+    """未指定の場合は全てのフレームが出力される"""
+    chunks = _encode(codec)
+    timestamps, skipped = _decode(chunks, {"codec": codec})
+    assert timestamps == [chunk.timestamp for chunk in chunks]
+    assert skipped == 0
+
+
+@pytest.mark.parametrize("codec", CODECS)
+def test_decode_key_only(codec):
+    """KEY を指定するとキーフレームのみが出力され、差分フレームはキューに積まれない"""
+    chunks = _encode(codec)
+    key_timestamps = [c.timestamp for c in chunks if c.type == EncodedVideoChunkType.KEY]
+    assert len(key_timestamps) == NUM_FRAMES // KEY_INTERVAL
+
+    timestamps, skipped = _decode(
+        chunks, {"codec": codec, "decode_frame_type": DecodeFrameType.KEY}
+    )
+    assert timestamps == key_timestamps
+    assert skipped == len(chunks) - len(key_timestamps)
+
+
+@pytest.mark.parametrize("decode_frame_type", [DecodeFrameType.REFERENCE, DecodeFrameType.INTRA])
+def test_decode_av1_reference_and_intra(decode_frame_type):
+    """AV1 では REFERENCE / INTRA を指定でき、出力されるフレームが間引かれる"""
+    codec = "av01.0.04M.08"
+    chunks = _encode(codec)
+    config: VideoDecoderConfig = {"codec": codec, "decode_frame_type": decode_frame_type}
+    assert VideoDecoder.is_config_supported(config)["supported"]
+
+    timestamps, skipped = _decode(chunks, config)
+    all_timestamps = [chunk.timestamp for chunk in chunks]
+    key_timestamps = [c.timestamp for c in chunks if c.type == EncodedVideoChunkType.KEY]
+    # キーフレームは必ず出力され、出力順は入力順のまま
+    assert set(key_timestamps) <= set(timestamps)
+    assert timestamps == sorted(timestamps)
+    assert set(timestamps) <= set(all_timestamps)
+    assert skipped == 0
+    if decode_frame_type == DecodeFrameType.INTRA:
+        assert timestamps == key_timestamps
+
+
+@pytest.mark.parametrize(
+    "codec",
+    [
+        pytest.param("vp8", id="vp8"),
+        pytest.param("vp09.00.10.08", id="vp9"),
+    ],
+)
+@pytest.mark.parametrize("decode_frame_type", [DecodeFrameType.REFERENCE, DecodeFrameType.INTRA])
+def test_reference_and_intra_not_supported(codec, decode_frame_type):
+    """AV1 以外では REFERENCE / INTRA に対応しない"""
+    config: VideoDecoderConfig = {"codec": codec, "decode_frame_type": decode_frame_type}
+    assert not VideoDecoder.is_config_supported(config)["supported"]
+
+    decoder = VideoDecoder(lambda f: None, lambda e: None)
+    with pytest.raises(RuntimeError):
+        decoder.configure(config)
+    decoder.close()
+
+
+def test_decode_key_only_after_reset():
+    """reset() すると decode_queue_skipped は 0 に戻る"""
+    codec = "av01.0.04M.08"
+    chunks = _encode(codec)
+    config: VideoDecoderConfig = {"codec": codec, "decode_frame_type": DecodeFrameType.KEY}
+
+    decoder = VideoDecoder(lambda f: f.close(), lambda e: pytest.fail(e))
+    decoder.configure(config)
+    decoder.decode_many(chunks)
+    decoder.flush()
+    assert decoder.decode_queue_skipped > 0
+
+    decoder.reset()
+    assert decoder.decode_queue_skipped == 0
+    decoder.close()
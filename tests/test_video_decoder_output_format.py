@@ -0,0 +1,162 @@
+"""VideoDecoderConfig の output_format のテスト"""
+
+import platform
+
+import numpy as np
+import pytest
+
+from webcodecs import (
+    HardwareAccelerationEngine,
+    LatencyMode,
+    VideoDecoder,
+    VideoDecoderConfig,
+    VideoEncoder,
+    VideoEncoderConfig,
+    VideoFrame,
+    VideoPixelFormat,
+)
+from video_test_helpers import create_solid_i420_frame
+
+WIDTH = 320
+HEIGHT = 240
+
+# BT.601 リミテッドレンジの赤 (R, G, B) = (255, 0, 0)
+RED_Y, RED_U, RED_V = 81, 90, 240
+
+
+def _encode(codec: str, num_frames: int) -> list:
+    chunks = []
+    encoder = VideoEncoder(lambda c: chunks.append(c), lambda e: pytest.fail(e))
+    enc_config: VideoEncoderConfig = {
+        "codec": codec,
+        "width": WIDTH,
+        "height": HEIGHT,
+        "bitrate": 1_000_000,
+        "framerate": 30.0,
+        "latency_mode": LatencyMode.REALTIME,
+    }
+    encoder.configure(enc_config)
+    for i in range(num_frames):
+        frame = create_solid_i420_frame(WIDTH, HEIGHT, i * 33333, RED_Y, RED_U, RED_V)
+        encoder.encode(frame, {"key_frame": i == 0})
+        frame.close()
+    encoder.flush()
+    encoder.close()
+    return chunks
+
+
+def _decode(chunks: list, config: VideoDecoderConfig) -> list:
+    frames = []
+    decoder = VideoDecoder(frames.append, lambda e: pytest.fail(e))
+    decoder.configure(config)
+    for chunk in chunks:
+        decoder.decode(chunk)
+    decoder.flush()
+    decoder.close()
+    return frames
+
+
+def _pixels(frame: VideoFrame, channels: int) -> np.ndarray:
+    data = np.empty(frame.allocation_size(), dtype=np.uint8)
+    frame.copy_to(data)
+    return data.reshape(frame.coded_height, frame.coded_width, channels)
+
+
+CODECS = [
+    pytest.param("av01.0.04M.08", id="av1"),
+    pytest.param(
+        "vp09.00.10.08",
+        id="vp9",
+        marks=pytest.mark.skipif(
+            platform.system() not in ("Darwin", "Linux"),
+            reason="VP9 は macOS / Linux のみサポート",
+        ),
+    ),
+]
+
+
+@pytest.mark.parametrize("codec", CODECS)
+@pytest.mark.parametrize(
+    "output_format, channels, expected",
+    [
+        (VideoPixelFormat.RGB, 3, (255, 0, 0)),
+        (VideoPixelFormat.BGR, 3, (0, 0, 255)),
+        (VideoPixelFormat.RGBA, 4, (255, 0, 0, 255)),
+        (VideoPixelFormat.BGRA, 4, (0, 0, 255, 255)),
+    ],
+)
+def test_output_rgb(codec, output_format, channels, expected):
+    """RGB 系のフォーマットを指定するとチャンネル順に従って変換される"""
+    num_frames = 3
+    frames = _decode(_encode(codec, num_frames), {"codec": codec, "output_format": output_format})
+
+    assert len(frames) == num_frames
+    for frame in frames:
+        assert frame.format == output_format
+        assert frame.coded_width == WIDTH
+        assert frame.coded_height == HEIGHT
+        mean = _pixels(frame, channels).reshape(-1, channels).mean(axis=0)
+        np.testing.assert_allclose(mean, expected, atol=12)
+        frame.close()
+
+
+@pytest.mark.parametrize("codec", CODECS)
+def test_output_nv12(codec):
+    """NV12 を指定すると UV がインターリーブされたフレームが出力される"""
+    frames = _decode(
+        _encode(codec, 2), {"codec": codec, "output_format": VideoPixelFormat.NV12}
+    )
+    assert len(frames) == 2
+    for frame in frames:
+        assert frame.format == VideoPixelFormat.NV12
+        y, uv = frame.planes()
+        assert abs(float(np.asarray(y).mean()) - RED_Y) < 4
+        uv = np.asarray(uv).reshape(-1, 2)
+        assert abs(float(uv[:, 0].mean()) - RED_U) < 4
+        assert abs(float(uv[:, 1].mean()) - RED_V) < 4
+        frame.close()
+
+
+@pytest.mark.parametrize("codec", CODECS)
+def test_output_format_with_output_size(codec):
+    """出力サイズと同時に指定すると縮小してからフォーマットを変換する"""
+    frames = _decode(
+        _encode(codec, 2),
+        {
+            "codec": codec,
+            "output_width": 160,
+            "output_height": 120,
+            "output_format": VideoPixelFormat.RGBA,
+        },
+    )
+    assert len(frames) == 2
+    for frame in frames:
+        assert frame.format == VideoPixelFormat.RGBA
+        assert (frame.coded_width, frame.coded_height) == (160, 120)
+        mean = _pixels(frame, 4).reshape(-1, 4).mean(axis=0)
+        np.testing.assert_allclose(mean, (255, 0, 0, 255), atol=12)
+        frame.close()
+
+
+@pytest.mark.parametrize("output_format", [VideoPixelFormat.I422, VideoPixelFormat.I444])
+def test_unsupported_output_format(output_format):
+    """対応していないフォーマットは ValueError になる"""
+    config: VideoDecoderConfig = {"codec": "av01.0.04M.08", "output_format": output_format}
+    assert not VideoDecoder.is_config_supported(config)["supported"]
+
+    decoder = VideoDecoder(lambda f: None, lambda e: None)
+    with pytest.raises(ValueError):
+        decoder.configure(config)
+    decoder.close()
+
+
+def test_output_format_is_config_supported():
+    """ハードウェアデコーダーでは output_format の指定に対応しない"""
+    config: VideoDecoderConfig = {
+        "codec": "av01.0.04M.08",
+        "output_format": VideoPixelFormat.RGB,
+    }
+    assert VideoDecoder.is_config_supported(config)["supported"]
+
+    config["hardware_acceleration_engine"] = HardwareAccelerationEngine.NVIDIA_VIDEO_CODEC
+    assert not VideoDecoder.is_config_supported(config)["supported"]
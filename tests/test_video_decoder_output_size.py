@@ -0,0 +1,163 @@
+"""VideoDecoderConfig の output_width / output_height / output_scale_filter のテスト"""
+
+import platform
+
+import numpy as np
+import pytest
+
+from webcodecs import (
+    HardwareAccelerationEngine,
+    LatencyMode,
+    VideoDecoder,
+    VideoDecoderConfig,
+    VideoEncoder,
+    VideoEncoderConfig,
+    VideoPixelFormat,
+    VideoScaleFilter,
+)
+from video_test_helpers import create_solid_i420_frame
+
+WIDTH = 640
+HEIGHT = 360
+LUMA = 180
+
+
+def _encode(codec: str, num_frames: int) -> list:
+    """num_frames 枚のフレームをエンコードしたチャンクを返す"""
+    chunks = []
+    encoder = VideoEncoder(lambda c: chunks.append(c), lambda e: pytest.fail(e))
+    enc_config: VideoEncoderConfig = {
+        "codec": codec,
+        "width": WIDTH,
+        "height": HEIGHT,
+        "bitrate": 1_000_000,
+        "framerate": 30.0,
+        "latency_mode": LatencyMode.REALTIME,
+    }
+    encoder.configure(enc_config)
+    for i in range(num_frames):
+        frame = create_solid_i420_frame(WIDTH, HEIGHT, i * 33333, y=LUMA)
+        encoder.encode(frame, {"key_frame": i == 0})
+        frame.close()
+    encoder.flush()
+    encoder.close()
+    return chunks
+
+
+def _decode(chunks: list, config: VideoDecoderConfig) -> list:
+    frames = []
+    decoder = VideoDecoder(frames.append, lambda e: pytest.fail(e))
+    decoder.configure(config)
+    for chunk in chunks:
+        decoder.decode(chunk)
+    decoder.flush()
+    decoder.close()
+    return frames
+
+
+CODECS = [
+    pytest.param("av01.0.04M.08", id="av1"),
+    pytest.param(
+        "vp8",
+        id="vp8",
+        marks=pytest.mark.skipif(
+            platform.system() not in ("Darwin", "Linux"),
+            reason="VP8 は macOS / Linux のみサポート",
+        ),
+    ),
+    pytest.param(
+        "vp09.00.10.08",
+        id="vp9",
+        marks=pytest.mark.skipif(
+            platform.system() not in ("Darwin", "Linux"),
+            reason="VP9 は macOS / Linux のみサポート",
+        ),
+    ),
+]
+
+
+@pytest.mark.parametrize("codec", CODECS)
+@pytest.mark.parametrize(
+    "scale_filter",
+    [
+        VideoScaleFilter.NONE,
+        VideoScaleFilter.LINEAR,
+        VideoScaleFilter.BILINEAR,
+        VideoScaleFilter.BOX,
+    ],
+)
+def test_output_size(codec, scale_filter):
+    """出力サイズを指定すると縮小した VideoFrame が出力される"""
+    num_frames = 5
+    chunks = _encode(codec, num_frames)
+    frames = _decode(
+        chunks,
+        {
+            "codec": codec,
+            "output_width": 320,
+            "output_height": 180,
+            "output_scale_filter": scale_filter,
+        },
+    )
+
+    assert len(frames) == num_frames
+    assert [frame.timestamp for frame in frames] == [i * 33333 for i in range(num_frames)]
+    for frame in frames:
+        assert frame.format == VideoPixelFormat.I420
+        assert frame.coded_width == 320
+        assert frame.coded_height == 180
+        y = np.asarray(frame.planes()[0])
+        assert abs(float(y.mean()) - LUMA) < 8
+        frame.close()
+
+
+@pytest.mark.parametrize("codec", CODECS)
+def test_output_size_upscale(codec):
+    """デコードしたサイズより大きい出力サイズも指定できる"""
+    chunks = _encode(codec, 2)
+    frames = _decode(chunks, {"codec": codec, "output_width": 1280, "output_height": 720})
+    assert len(frames) == 2
+    for frame in frames:
+        assert frame.coded_width == 1280
+        assert frame.coded_height == 720
+        frame.close()
+
+
+def test_output_size_without_scaling():
+    """出力サイズが未指定の場合はデコードしたサイズのまま出力される"""
+    codec = "av01.0.04M.08"
+    frames = _decode(_encode(codec, 2), {"codec": codec})
+    assert [(f.coded_width, f.coded_height) for f in frames] == [(WIDTH, HEIGHT)] * 2
+    for frame in frames:
+        frame.close()
+
+
+@pytest.mark.parametrize(
+    "extra",
+    [
+        {"output_width": 320},
+        {"output_height": 180},
+        {"output_width": 321, "output_height": 180},
+        {"output_width": 320, "output_height": 0},
+        {"output_width": 16384, "output_height": 180},
+    ],
+)
+def test_invalid_output_size(extra):
+    """出力サイズは偶数で、幅と高さを両方指定する必要がある"""
+    decoder = VideoDecoder(lambda f: None, lambda e: None)
+    with pytest.raises(ValueError):
+        decoder.configure({"codec": "av01.0.04M.08", **extra})
+    decoder.close()
+
+
+def test_output_size_is_config_supported():
+    """ハードウェアデコーダーでは出力サイズの指定に対応しない"""
+    config: VideoDecoderConfig = {
+        "codec": "av01.0.04M.08",
+        "output_width": 320,
+        "output_height": 180,
+    }
+    assert VideoDecoder.is_config_supported(config)["supported"]
+
+    config["hardware_acceleration_engine"] = HardwareAccelerationEngine.NVIDIA_VIDEO_CODEC
+    assert not VideoDecoder.is_config_supported(config)["supported"]
@@ -0,0 +1,99 @@
+"""VideoDecoderConfig の decode_quality のテスト"""
+
+import platform
+
+import numpy as np
+import pytest
+
+from webcodecs import (
+    DecodeQuality,
+    LatencyMode,
+    VideoDecoder,
+    VideoDecoderConfig,
+    VideoEncoder,
+    VideoEncoderConfig,
+)
+from video_test_helpers import create_solid_i420_frame
+
+WIDTH = 320
+HEIGHT = 240
+LUMA = 160
+
+
+def _encode(codec: str, num_frames: int) -> list:
+    chunks = []
+    encoder = VideoEncoder(lambda c: chunks.append(c), lambda e: pytest.fail(e))
+    enc_config: VideoEncoderConfig = {
+        "codec": codec,
+        "width": WIDTH,
+        "height": HEIGHT,
+        "bitrate": 500_000,
+        "framerate": 30.0,
+        "latency_mode": LatencyMode.REALTIME,
+    }
+    encoder.configure(enc_config)
+    for i in range(num_frames):
+        frame = create_solid_i420_frame(WIDTH, HEIGHT, i * 33333, y=LUMA)
+        encoder.encode(frame, {"key_frame": i == 0})
+        frame.close()
+    encoder.flush()
+    encoder.close()
+    return chunks
+
+
+CODECS = [
+    pytest.param("av01.0.04M.08", id="av1"),
+    pytest.param(
+        "vp8",
+        id="vp8",
+        marks=pytest.mark.skipif(
+            platform.system() not in ("Darwin", "Linux"),
+            reason="VP8 は macOS / Linux のみサポート",
+        ),
+    ),
+    pytest.param(
+        "vp09.00.10.08",
+        id="vp9",
+        marks=pytest.mark.skipif(
+            platform.system() not in ("Darwin", "Linux"),
+            reason="VP9 は macOS / Linux のみサポート",
+        ),
+    ),
+]
+
+
+@pytest.mark.parametrize("codec", CODECS)
+@pytest.mark.parametrize("decode_quality", [DecodeQuality.FULL, DecodeQuality.PREVIEW])
+def test_decode_quality(codec, decode_quality):
+    """PREVIEW でも全てのフレームが入力順に出力される"""
+    num_frames = 10
+    chunks = _encode(codec, num_frames)
+    config: VideoDecoderConfig = {"codec": codec, "decode_quality": decode_quality}
+    assert VideoDecoder.is_config_supported(config)["supported"]
+
+    frames = []
+    decoder = VideoDecoder(frames.append, lambda e: pytest.fail(e))
+    decoder.configure(config)
+    for chunk in chunks:
+        decoder.decode(chunk)
+    decoder.flush()
+    decoder.close()
+
+    assert [frame.timestamp for frame in frames] == [i * 33333 for i in range(num_frames)]
+    for frame in frames:
+        assert frame.coded_width == WIDTH
+        assert frame.coded_height == HEIGHT
+        # 平坦な絵柄なのでループフィルターを省略しても輝度はほぼ変わらない
+        y = np.asarray(frame.planes()[0])
+        assert abs(float(y.mean()) - LUMA) < 8
+        frame.close()
+
+
+def test_decode_quality_none_is_full():
+    """None を指定した場合は FULL と同じく設定できる"""
+    config: VideoDecoderConfig = {"codec": "av01.0.04M.08", "decode_quality": None}
+    assert VideoDecoder.is_config_supported(config)["supported"]
+
+    decoder = VideoDecoder(lambda f: None, lambda e: None)
+    decoder.configure(config)
+    decoder.close()
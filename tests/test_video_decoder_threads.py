@@ -0,0 +1,132 @@
+"""VideoDecoderConfig の decode_threads / max_frame_delay のテスト"""
+
+import platform
+import time
+
+import pytest
+
+from webcodecs import (
+    LatencyMode,
+    VideoDecoder,
+    VideoDecoderConfig,
+    VideoEncoder,
+    VideoEncoderConfig,
+)
+from video_test_helpers import create_solid_i420_frame
+
+
+def _encode(codec: str, width: int, height: int, num_frames: int) -> list:
+    """num_frames 枚のフレームをエンコードしたチャンクを返す"""
+    chunks = []
+    encoder = VideoEncoder(lambda c: chunks.append(c), lambda e: pytest.fail(e))
+    enc_config: VideoEncoderConfig = {
+        "codec": codec,
+        "width": width,
+        "height": height,
+        "bitrate": 500_000,
+        "framerate": 30.0,
+        "latency_mode": LatencyMode.REALTIME,
+    }
+    encoder.configure(enc_config)
+    for i in range(num_frames):
+        frame = create_solid_i420_frame(width, height, i * 1000, y=i * 10 % 256)
+        encoder.encode(frame, {"key_frame": i == 0})
+        frame.close()
+    encoder.flush()
+    encoder.close()
+    return chunks
+
+
+CODECS = [
+    pytest.param("av01.0.04M.08", id="av1"),
+    pytest.param(
+        "vp09.00.10.08",
+        id="vp9",
+        marks=pytest.mark.skipif(
+            platform.system() not in ("Darwin", "Linux"),
+            reason="VP9 は macOS / Linux のみサポート",
+        ),
+    ),
+]
+
+
+@pytest.mark.parametrize("codec", CODECS)
+@pytest.mark.parametrize(
+    "extra",
+    [
+        {},
+        {"decode_threads": 4},
+        {"optimize_for_latency": True},
+        {"decode_threads": 4, "max_frame_delay": 4},
+    ],
+)
+def test_decode_with_threads(codec, extra):
+    """スレッド数やフレーム遅延を指定しても全フレームが順序通り出力される"""
+    width, height = 320, 240
+    num_frames = 10
+    chunks = _encode(codec, width, height, num_frames)
+    assert len(chunks) == num_frames
+
+    decoded = []
+    decoder = VideoDecoder(lambda f: decoded.append(f), lambda e: pytest.fail(e))
+    config: VideoDecoderConfig = {
+        "codec": codec,
+        "coded_width": width,
+        "coded_height": height,
+        **extra,
+    }
+    decoder.configure(config)
+    for chunk in chunks:
+        decoder.decode(chunk)
+    decoder.flush()
+
+    assert len(decoded) == num_frames
+    assert [f.timestamp for f in decoded] == [c.timestamp for c in chunks]
+    for f in decoded:
+        f.close()
+    decoder.close()
+
+
+def test_optimize_for_latency_outputs_without_flush():
+    """optimize_for_latency では flush() を待たずにフレームが出力される"""
+    width, height = 320, 240
+    num_frames = 5
+    chunks = _encode("av01.0.04M.08", width, height, num_frames)
+
+    decoded = []
+    decoder = VideoDecoder(lambda f: decoded.append(f), lambda e: pytest.fail(e))
+    config: VideoDecoderConfig = {
+        "codec": "av01.0.04M.08",
+        "optimize_for_latency": True,
+        "max_frame_delay": 8,
+    }
+    decoder.configure(config)
+    for chunk in chunks:
+        decoder.decode(chunk)
+
+    # ワーカースレッドの処理完了を待つ
+    while decoder.decode_queue_size > 0:
+        time.sleep(0.001)
+    assert len(decoded) == num_frames
+
+    decoder.flush()
+    for f in decoded:
+        f.close()
+    decoder.close()
+
+
+@pytest.mark.parametrize(
+    "extra",
+    [
+        {"decode_threads": 257},
+        {"max_frame_delay": 0},
+        {"max_frame_delay": 257},
+    ],
+)
+def test_invalid_thread_config(extra):
+    """範囲外の値は ValueError になる"""
+    decoder = VideoDecoder(lambda f: None, lambda e: None)
+    config: VideoDecoderConfig = {"codec": "av01.0.04M.08", **extra}
+    with pytest.raises(ValueError):
+        decoder.configure(config)
+    decoder.close()
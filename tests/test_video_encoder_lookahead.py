@@ -0,0 +1,111 @@
+"""先読み (LatencyMode.QUALITY) でエンコードした場合の出力とフレームの対応付けのテスト"""
+
+import platform
+
+import pytest
+
+from webcodecs import (
+    EncodedVideoChunkType,
+    LatencyMode,
+    VideoDecoder,
+    VideoEncoder,
+    VideoEncoderConfig,
+)
+from video_test_helpers import create_moving_i420_frame
+
+WIDTH = 320
+HEIGHT = 240
+NUM_FRAMES = 40
+
+CODECS = [
+    pytest.param("av01.0.04M.08", id="av1"),
+    pytest.param(
+        "vp8",
+        id="vp8",
+        marks=pytest.mark.skipif(
+            platform.system() not in ("Darwin", "Linux"),
+            reason="VP8 は macOS / Linux のみサポート",
+        ),
+    ),
+    pytest.param(
+        "vp09.00.10.08",
+        id="vp9",
+        marks=pytest.mark.skipif(
+            platform.system() not in ("Darwin", "Linux"),
+            reason="VP9 は macOS / Linux のみサポート",
+        ),
+    ),
+]
+
+
+def _timestamp(frame_num: int) -> int:
+    # 間隔が一定でないタイムスタンプでも入力フレームの値がそのまま出力される
+    return frame_num * 33333 + (frame_num % 3) * 100
+
+
+@pytest.mark.parametrize("codec", CODECS)
+def test_quality_mode_outputs_match_inputs(codec):
+    """先読みでパケットの出力が遅延しても、全フレームが入力順のタイムスタンプで出力される"""
+    outputs = []
+    encoder = VideoEncoder(lambda chunk, metadata=None: outputs.append(chunk), pytest.fail)
+    config: VideoEncoderConfig = {
+        "codec": codec,
+        "width": WIDTH,
+        "height": HEIGHT,
+        "bitrate": 500_000,
+        "framerate": 30.0,
+        "latency_mode": LatencyMode.QUALITY,
+    }
+    encoder.configure(config)
+    for i in range(NUM_FRAMES):
+        frame = create_moving_i420_frame(WIDTH, HEIGHT, i, _timestamp(i), 33333)
+        encoder.encode(frame, {"key_frame": i == 0})
+        frame.close()
+    encoder.flush()
+    encoder.close()
+
+    assert [chunk.timestamp for chunk in outputs] == [_timestamp(i) for i in range(NUM_FRAMES)]
+    assert all(chunk.duration == 33333 for chunk in outputs)
+    assert outputs[0].type == EncodedVideoChunkType.KEY
+
+    frames = []
+    decoder = VideoDecoder(frames.append, pytest.fail)
+    decoder.configure({"codec": codec})
+    decoder.decode_many(outputs)
+    decoder.flush()
+    decoder.close()
+
+    assert [frame.timestamp for frame in frames] == [_timestamp(i) for i in range(NUM_FRAMES)]
+    for frame in frames:
+        frame.close()
+
+
+def test_quality_mode_encode_after_flush():
+    """flush() の後もエンコードを続けられ、以前のフレームと混ざらない"""
+    outputs = []
+    encoder = VideoEncoder(lambda chunk, metadata=None: outputs.append(chunk), pytest.fail)
+    encoder.configure(
+        {
+            "codec": "av01.0.04M.08",
+            "width": WIDTH,
+            "height": HEIGHT,
+            "bitrate": 500_000,
+            "framerate": 30.0,
+            "latency_mode": LatencyMode.QUALITY,
+        }
+    )
+    for i in range(10):
+        frame = create_moving_i420_frame(WIDTH, HEIGHT, i, _timestamp(i), 33333)
+        encoder.encode(frame, {"key_frame": i == 0})
+        frame.close()
+    encoder.flush()
+    assert len(outputs) == 10
+
+    for i in range(10, 20):
+        frame = create_moving_i420_frame(WIDTH, HEIGHT, i, _timestamp(i), 33333)
+        encoder.encode(frame, {"key_frame": i == 10})
+        frame.close()
+    encoder.flush()
+    encoder.close()
+
+    assert [chunk.timestamp for chunk in outputs] == [_timestamp(i) for i in range(20)]
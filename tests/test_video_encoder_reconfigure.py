@@ -0,0 +1,248 @@
+"""構成済みの VideoEncoder を configure() で再設定した場合のテスト"""
+
+import platform
+
+import pytest
+
+from webcodecs import (
+    EncodedVideoChunkType,
+    LatencyMode,
+    VideoDecoder,
+    VideoEncoder,
+    VideoEncoderBitrateMode,
+    VideoEncoderConfig,
+)
+from video_test_helpers import create_moving_i420_frame
+
+WIDTH = 320
+HEIGHT = 240
+
+CODECS = [
+    pytest.param("av01.0.04M.08", id="av1"),
+    pytest.param(
+        "vp8",
+        id="vp8",
+        marks=pytest.mark.skipif(
+            platform.system() not in ("Darwin", "Linux"),
+            reason="VP8 は macOS / Linux のみサポート",
+        ),
+    ),
+    pytest.param(
+        "vp09.00.10.08",
+        id="vp9",
+        marks=pytest.mark.skipif(
+            platform.system() not in ("Darwin", "Linux"),
+            reason="VP9 は macOS / Linux のみサポート",
+        ),
+    ),
+]
+
+
+def _config(codec: str, **kwargs) -> VideoEncoderConfig:
+    config: VideoEncoderConfig = {
+        "codec": codec,
+        "width": WIDTH,
+        "height": HEIGHT,
+        "bitrate": 500_000,
+        "framerate": 30.0,
+        "latency_mode": LatencyMode.REALTIME,
+    }
+    config.update(kwargs)
+    return config
+
+
+def _encode(encoder: VideoEncoder, frame_nums: range, width: int = WIDTH, height: int = HEIGHT):
+    for i in frame_nums:
+        frame = create_moving_i420_frame(width, height, i)
+        encoder.encode(frame, {"key_frame": i == frame_nums.start})
+        frame.close()
+
+
+@pytest.mark.parametrize("codec", CODECS)
+def test_hot_reconfigure_bitrate(codec):
+    """ビットレートだけを変更する場合はエンコーダーを作り直さず、キーフレームも挿入されない"""
+    outputs = []
+    encoder = VideoEncoder(lambda chunk, metadata=None: outputs.append(chunk), pytest.fail)
+    encoder.configure(_config(codec))
+    assert encoder.last_reconfigure is None
+
+    _encode(encoder, range(0, 10))
+    encoder.configure(_config(codec, bitrate=200_000))
+    assert encoder.last_reconfigure == "hot"
+    for i in range(10, 20):
+        frame = create_moving_i420_frame(WIDTH, HEIGHT, i)
+        encoder.encode(frame)
+        frame.close()
+    encoder.flush()
+    assert encoder.hot_reconfigure_count == 1
+    assert encoder.cold_reconfigure_count == 0
+    encoder.close()
+
+    assert [chunk.timestamp for chunk in outputs] == [i * 33333 for i in range(20)]
+    assert [chunk.type for chunk in outputs] == [EncodedVideoChunkType.KEY] + [
+        EncodedVideoChunkType.DELTA
+    ] * 19
+
+    # 再設定の前後のチャンクを続けてデコードできる
+    frames = []
+    decoder = VideoDecoder(frames.append, pytest.fail)
+    decoder.configure({"codec": codec})
+    decoder.decode_many(outputs)
+    decoder.flush()
+    decoder.close()
+    assert len(frames) == 20
+    for frame in frames:
+        frame.close()
+
+
+def test_hot_reconfigure_framerate():
+    """フレームレートだけを変更する場合もエンコーダーを作り直さない"""
+    outputs = []
+    encoder = VideoEncoder(lambda chunk, metadata=None: outputs.append(chunk), pytest.fail)
+    encoder.configure(_config("av01.0.04M.08"))
+    _encode(encoder, range(0, 5))
+    # フレームレートを上げて pts の間隔が短くなっても、続けてエンコードできる
+    encoder.configure(_config("av01.0.04M.08", framerate=60.0))
+    for i in range(5, 10):
+        frame = create_moving_i420_frame(WIDTH, HEIGHT, i)
+        encoder.encode(frame)
+        frame.close()
+    encoder.flush()
+    encoder.close()
+
+    assert encoder.last_reconfigure == "hot"
+    assert [chunk.timestamp for chunk in outputs] == [i * 33333 for i in range(10)]
+
+
+@pytest.mark.parametrize("codec", CODECS)
+def test_reconfigure_without_bitrate(codec):
+    """bitrate を省略して再設定した場合はデフォルトのビットレートで続けてエンコードできる"""
+    outputs = []
+    encoder = VideoEncoder(lambda chunk, metadata=None: outputs.append(chunk), pytest.fail)
+    encoder.configure(_config(codec))
+    _encode(encoder, range(0, 5))
+    config = _config(codec)
+    del config["bitrate"]
+    encoder.configure(config)
+    assert encoder.last_reconfigure == "hot"
+    for i in range(5, 10):
+        frame = create_moving_i420_frame(WIDTH, HEIGHT, i)
+        encoder.encode(frame)
+        frame.close()
+    encoder.flush()
+    encoder.close()
+
+    assert [chunk.timestamp for chunk in outputs] == [i * 33333 for i in range(10)]
+
+
+def test_hot_reconfigure_changes_bitrate():
+    """再設定したビットレートがレート制御に反映される"""
+    sizes: dict[str, int] = {"high": 0, "low": 0}
+    phase = ["high"]
+
+    def on_output(chunk, metadata=None):
+        sizes[phase[0]] += chunk.byte_length
+
+    encoder = VideoEncoder(on_output, pytest.fail)
+    config = _config("av01.0.04M.08", bitrate_mode=VideoEncoderBitrateMode.CONSTANT)
+    encoder.configure({**config, "bitrate": 2_000_000})
+    _encode(encoder, range(0, 30))
+    encoder.flush()
+
+    phase[0] = "low"
+    encoder.configure({**config, "bitrate": 100_000})
+    assert encoder.last_reconfigure == "hot"
+    for i in range(30, 60):
+        frame = create_moving_i420_frame(WIDTH, HEIGHT, i)
+        encoder.encode(frame)
+        frame.close()
+    encoder.flush()
+    encoder.close()
+
+    assert sizes["low"] < sizes["high"] / 2
+
+
+@pytest.mark.parametrize("codec", CODECS)
+def test_cold_reconfigure_resolution(codec):
+    """解像度を変更する場合はエンコーダーを作り直す"""
+    outputs = []
+    encoder = VideoEncoder(lambda chunk, metadata=None: outputs.append(chunk), pytest.fail)
+    encoder.configure(_config(codec))
+    _encode(encoder, range(0, 5))
+    encoder.configure(_config(codec, width=WIDTH // 2, height=HEIGHT // 2))
+    assert encoder.last_reconfigure == "cold"
+    _encode(encoder, range(5, 10), WIDTH // 2, HEIGHT // 2)
+    encoder.flush()
+    assert encoder.hot_reconfigure_count == 0
+    assert encoder.cold_reconfigure_count == 1
+    encoder.close()
+
+    assert [chunk.timestamp for chunk in outputs] == [i * 33333 for i in range(10)]
+    assert outputs[5].type == EncodedVideoChunkType.KEY
+
+    frames = []
+    decoder = VideoDecoder(frames.append, pytest.fail)
+    decoder.configure({"codec": codec})
+    decoder.decode_many(outputs[5:])
+    decoder.flush()
+    decoder.close()
+    assert [(frame.coded_width, frame.coded_height) for frame in frames] == [
+        (WIDTH // 2, HEIGHT // 2)
+    ] * 5
+    for frame in frames:
+        frame.close()
+
+
+def test_cold_reconfigure_quality_mode_outputs_pending_frames():
+    """作り直す前に、先読みでエンコーダー内部に残っているフレームを出力する"""
+    outputs = []
+    encoder = VideoEncoder(lambda chunk, metadata=None: outputs.append(chunk), pytest.fail)
+    encoder.configure(_config("av01.0.04M.08", latency_mode=LatencyMode.QUALITY))
+    _encode(encoder, range(0, 10))
+    encoder.configure(_config("av01.0.04M.08", bitrate_mode=VideoEncoderBitrateMode.CONSTANT))
+    assert encoder.last_reconfigure == "cold"
+    assert len(outputs) == 10
+    _encode(encoder, range(10, 15))
+    encoder.flush()
+    encoder.close()
+
+    assert [chunk.timestamp for chunk in outputs] == [i * 33333 for i in range(15)]
+
+
+def test_hot_reconfigure_keeps_scalability():
+    """scalability_mode を指定している場合も、時間レイヤーのパターンを保ったまま再設定する"""
+    metadata_list = []
+    encoder = VideoEncoder(
+        lambda chunk, metadata=None: metadata_list.append(metadata), pytest.fail
+    )
+    encoder.configure(_config("av01.0.04M.08", scalability_mode="L1T2"))
+    _encode(encoder, range(0, 3))
+    encoder.configure(_config("av01.0.04M.08", scalability_mode="L1T2", bitrate=300_000))
+    assert encoder.last_reconfigure == "hot"
+    for i in range(3, 6):
+        frame = create_moving_i420_frame(WIDTH, HEIGHT, i)
+        encoder.encode(frame)
+        frame.close()
+    encoder.flush()
+    encoder.close()
+
+    assert [m["svc"]["temporal_layer_id"] for m in metadata_list] == [0, 1, 0, 1, 0, 1]
+
+
+def test_reconfigure_invalid_config_keeps_encoder():
+    """不正な設定で再設定した場合は例外になり、以前の設定のままエンコードを続けられる"""
+    outputs = []
+    encoder = VideoEncoder(lambda chunk, metadata=None: outputs.append(chunk), pytest.fail)
+    encoder.configure(_config("av01.0.04M.08"))
+    _encode(encoder, range(0, 3))
+    with pytest.raises(ValueError):
+        encoder.configure(_config("av01.invalid"))
+    assert encoder.last_reconfigure is None
+    for i in range(3, 6):
+        frame = create_moving_i420_frame(WIDTH, HEIGHT, i)
+        encoder.encode(frame)
+        frame.close()
+    encoder.flush()
+    encoder.close()
+
+    assert [chunk.timestamp for chunk in outputs] == [i * 33333 for i in range(6)]
@@ -0,0 +1,218 @@
+"""GOP 並列エンコード (segment_frames) のテスト"""
+
+import platform
+
+import pytest
+
+from webcodecs import (
+    EncodedVideoChunkType,
+    HardwareAccelerationEngine,
+    LatencyMode,
+    VideoDecoder,
+    VideoEncoder,
+    VideoEncoderConfig,
+)
+from video_test_helpers import create_moving_i420_frame
+
+WIDTH = 320
+HEIGHT = 240
+
+CODECS = [
+    pytest.param("av01.0.04M.08", id="av1"),
+    pytest.param(
+        "vp8",
+        id="vp8",
+        marks=pytest.mark.skipif(
+            platform.system() not in ("Darwin", "Linux"),
+            reason="VP8 は macOS / Linux のみサポート",
+        ),
+    ),
+    pytest.param(
+        "vp09.00.10.08",
+        id="vp9",
+        marks=pytest.mark.skipif(
+            platform.system() not in ("Darwin", "Linux"),
+            reason="VP9 は macOS / Linux のみサポート",
+        ),
+    ),
+]
+
+
+def _config(codec: str, **kwargs) -> VideoEncoderConfig:
+    config: VideoEncoderConfig = {
+        "codec": codec,
+        "width": WIDTH,
+        "height": HEIGHT,
+        "bitrate": 500_000,
+        "framerate": 30.0,
+        "latency_mode": LatencyMode.QUALITY,
+        "segment_frames": 10,
+        "segment_threads": 4,
+    }
+    config.update(kwargs)  # type: ignore[typeddict-item]
+    return config
+
+
+def _key_indices(chunks) -> list[int]:
+    return [i for i, chunk in enumerate(chunks) if chunk.type == EncodedVideoChunkType.KEY]
+
+
+@pytest.mark.parametrize("codec", CODECS)
+def test_segment_encode(codec):
+    """セグメントごとにキーフレームから並列にエンコードし、入力順に出力する"""
+    num_frames = 35
+    outputs = []
+    encoder = VideoEncoder(lambda chunk, metadata=None: outputs.append(chunk), pytest.fail)
+    encoder.configure(_config(codec))
+    for i in range(num_frames):
+        frame = create_moving_i420_frame(WIDTH, HEIGHT, i)
+        encoder.encode(frame)
+        frame.close()
+    encoder.flush()
+    assert encoder.encode_queue_size == 0
+    encoder.close()
+
+    assert [chunk.timestamp for chunk in outputs] == [i * 33333 for i in range(num_frames)]
+    assert _key_indices(outputs) == [0, 10, 20, 30]
+
+    # セグメントをつなげて 1 つのストリームとしてデコードできる
+    frames = []
+    decoder = VideoDecoder(frames.append, pytest.fail)
+    decoder.configure({"codec": codec})
+    decoder.decode_many(outputs)
+    decoder.flush()
+    decoder.close()
+    assert [frame.timestamp for frame in frames] == [i * 33333 for i in range(num_frames)]
+    for frame in frames:
+        frame.close()
+
+
+def test_segment_key_frame_starts_new_segment():
+    """key_frame を指定したフレームから新しいセグメントを始める"""
+    outputs = []
+    encoder = VideoEncoder(lambda chunk, metadata=None: outputs.append(chunk), pytest.fail)
+    encoder.configure(_config("av01.0.04M.08"))
+    for i in range(30):
+        frame = create_moving_i420_frame(WIDTH, HEIGHT, i)
+        encoder.encode(frame, {"key_frame": i == 5})
+        frame.close()
+    encoder.flush()
+    encoder.close()
+
+    assert len(outputs) == 30
+    assert _key_indices(outputs) == [0, 5, 15, 25]
+
+
+def test_segment_flush_and_continue():
+    """flush() の後もエンコードを続けられ、続きは新しいセグメントになる"""
+    outputs = []
+    encoder = VideoEncoder(lambda chunk, metadata=None: outputs.append(chunk), pytest.fail)
+    encoder.configure(_config("av01.0.04M.08", segment_threads=2))
+    for start, end in [(0, 7), (7, 20)]:
+        for i in range(start, end):
+            frame = create_moving_i420_frame(WIDTH, HEIGHT, i)
+            encoder.encode(frame)
+            frame.close()
+        encoder.flush()
+        assert len(outputs) == end
+    encoder.close()
+
+    assert [chunk.timestamp for chunk in outputs] == [i * 33333 for i in range(20)]
+    assert _key_indices(outputs) == [0, 7, 17]
+
+
+def test_segment_output_queue():
+    """出力キューモードでも入力順に読み出せる"""
+    encoder = VideoEncoder(None, pytest.fail, output_queue=True)
+    encoder.configure(_config("av01.0.04M.08"))
+    for i in range(25):
+        frame = create_moving_i420_frame(WIDTH, HEIGHT, i)
+        encoder.encode(frame)
+        frame.close()
+    encoder.flush()
+    entries = encoder.read_all()
+    encoder.close()
+
+    assert [chunk.timestamp for chunk, _ in entries] == [i * 33333 for i in range(25)]
+
+
+def test_segment_hot_reconfigure_bitrate():
+    """bitrate だけを変更する場合は hot になり、次のセグメントから反映する"""
+    outputs = []
+    encoder = VideoEncoder(lambda chunk, metadata=None: outputs.append(chunk), pytest.fail)
+    encoder.configure(_config("av01.0.04M.08"))
+    for i in range(15):
+        frame = create_moving_i420_frame(WIDTH, HEIGHT, i)
+        encoder.encode(frame)
+        frame.close()
+    encoder.configure(_config("av01.0.04M.08", bitrate=200_000))
+    assert encoder.last_reconfigure == "hot"
+    # 溜めていたフレームは以前の設定で出力し終えている
+    assert len(outputs) == 15
+    for i in range(15, 30):
+        frame = create_moving_i420_frame(WIDTH, HEIGHT, i)
+        encoder.encode(frame)
+        frame.close()
+    encoder.flush()
+    encoder.close()
+
+    assert [chunk.timestamp for chunk in outputs] == [i * 33333 for i in range(30)]
+    assert _key_indices(outputs) == [0, 10, 15, 25]
+
+
+def test_segment_close_without_flush():
+    """エンコード中に close() してもブロックせず、以降は出力しない"""
+    outputs = []
+    encoder = VideoEncoder(lambda chunk, metadata=None: outputs.append(chunk), pytest.fail)
+    encoder.configure(_config("av01.0.04M.08", segment_frames=5))
+    for i in range(40):
+        frame = create_moving_i420_frame(WIDTH, HEIGHT, i)
+        encoder.encode(frame)
+        frame.close()
+    encoder.close()
+    count = len(outputs)
+    assert count <= 40
+    assert [chunk.timestamp for chunk in outputs] == [i * 33333 for i in range(count)]
+
+
+@pytest.mark.parametrize(
+    "kwargs",
+    [
+        pytest.param({"latency_mode": LatencyMode.REALTIME}, id="realtime"),
+        pytest.param({"scalability_mode": "L1T2"}, id="scalability"),
+        pytest.param(
+            {"hardware_acceleration_engine": HardwareAccelerationEngine.NVIDIA_VIDEO_CODEC},
+            id="hardware",
+        ),
+    ],
+)
+def test_segment_not_supported(kwargs):
+    """QUALITY 以外やレイヤー構造、ハードウェアエンコーダーでは NotSupportedError になる"""
+    config = _config("av01.0.04M.08", **kwargs)
+    assert not VideoEncoder.is_config_supported(config)["supported"]
+
+    encoder = VideoEncoder(lambda chunk, metadata=None: None, pytest.fail)
+    with pytest.raises(RuntimeError, match="NotSupportedError"):
+        encoder.configure(config)
+    encoder.close()
+
+
+def test_segment_sync_mode_not_supported():
+    """encode_sync() / flush_sync() には対応しない"""
+    encoder = VideoEncoder(lambda chunk, metadata=None: None, pytest.fail)
+    encoder.configure(_config("av01.0.04M.08"))
+    frame = create_moving_i420_frame(WIDTH, HEIGHT, 0)
+    with pytest.raises(RuntimeError, match="NotSupportedError"):
+        encoder.encode_sync(frame)
+    with pytest.raises(RuntimeError, match="NotSupportedError"):
+        encoder.flush_sync()
+    frame.close()
+    encoder.close()
+
+
+def test_segment_invalid_frames():
+    """segment_frames が 0 の場合は ValueError になる"""
+    encoder = VideoEncoder(lambda chunk, metadata=None: None, pytest.fail)
+    with pytest.raises(ValueError):
+        encoder.configure(_config("av01.0.04M.08", segment_frames=0))
+    encoder.close()
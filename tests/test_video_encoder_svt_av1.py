@@ -0,0 +1,195 @@
+"""SVT-AV1 エンコーダー (av1_encoder) のテスト"""
+
+import platform
+
+import pytest
+
+from webcodecs import (
+    AV1EncoderImplementation,
+    EncodedVideoChunkType,
+    HardwareAccelerationEngine,
+    LatencyMode,
+    VideoDecoder,
+    VideoEncoder,
+    VideoEncoderBitrateMode,
+    VideoEncoderConfig,
+)
+from video_test_helpers import create_moving_i420_frame
+
+pytestmark = pytest.mark.skipif(
+    platform.system() not in ("Darwin", "Linux"),
+    reason="SVT-AV1 は macOS / Linux のみサポート",
+)
+
+WIDTH = 320
+HEIGHT = 240
+
+
+def _config(**kwargs) -> VideoEncoderConfig:
+    config: VideoEncoderConfig = {
+        "codec": "av01.0.04M.08",
+        "width": WIDTH,
+        "height": HEIGHT,
+        "bitrate": 500_000,
+        "framerate": 30.0,
+        "av1_encoder": AV1EncoderImplementation.SVT_AV1,
+    }
+    config.update(kwargs)  # type: ignore[typeddict-item]
+    return config
+
+
+def _encode(config: VideoEncoderConfig, num_frames: int, key_frames=(0,), options=None):
+    outputs = []
+    encoder = VideoEncoder(lambda chunk, metadata=None: outputs.append(chunk), pytest.fail)
+    encoder.configure(config)
+    for i in range(num_frames):
+        frame = create_moving_i420_frame(WIDTH, HEIGHT, i)
+        encode_options = {"key_frame": i in key_frames}
+        if options is not None:
+            encode_options.update(options(i))
+        encoder.encode(frame, encode_options)
+        frame.close()
+    encoder.flush()
+    encoder.close()
+    return outputs
+
+
+def _decode(chunks) -> list[int]:
+    frames = []
+    decoder = VideoDecoder(frames.append, pytest.fail)
+    decoder.configure({"codec": "av01.0.04M.08"})
+    decoder.decode_many(chunks)
+    decoder.flush()
+    decoder.close()
+    timestamps = [frame.timestamp for frame in frames]
+    for frame in frames:
+        frame.close()
+    return timestamps
+
+
+def _key_indices(chunks) -> list[int]:
+    return [i for i, chunk in enumerate(chunks) if chunk.type == EncodedVideoChunkType.KEY]
+
+
+@pytest.mark.parametrize(
+    "latency_mode",
+    [
+        pytest.param(LatencyMode.QUALITY, id="quality"),
+        pytest.param(LatencyMode.REALTIME, id="realtime"),
+    ],
+)
+def test_svt_av1_encode_decode(latency_mode):
+    """SVT-AV1 でエンコードしたチャンクを入力順に出力し、dav1d でデコードできる"""
+    num_frames = 30
+    outputs = _encode(_config(latency_mode=latency_mode), num_frames)
+
+    assert [chunk.timestamp for chunk in outputs] == [i * 33333 for i in range(num_frames)]
+    assert _key_indices(outputs) == [0]
+    assert _decode(outputs) == [i * 33333 for i in range(num_frames)]
+
+
+def test_svt_av1_is_config_supported():
+    """8 ビットの Main プロファイルでは is_config_supported() が True を返す"""
+    assert VideoEncoder.is_config_supported(_config())["supported"]
+
+
+def test_svt_av1_key_frame_decodable_from_middle():
+    """key_frame を指定したフレームのみキーフレームになり、そこから単独でデコードできる"""
+    num_frames = 20
+    outputs = _encode(_config(), num_frames, key_frames=(0, 10))
+
+    assert _key_indices(outputs) == [0, 10]
+    # キーフレームにはシーケンスヘッダーが含まれる
+    assert _decode(outputs[10:]) == [i * 33333 for i in range(10, num_frames)]
+
+
+def test_svt_av1_flush_and_continue():
+    """flush() の後もエンコードを続けられ、続きはキーフレームから始まる"""
+    outputs = []
+    encoder = VideoEncoder(lambda chunk, metadata=None: outputs.append(chunk), pytest.fail)
+    encoder.configure(_config())
+    for start, end in [(0, 8), (8, 20)]:
+        for i in range(start, end):
+            frame = create_moving_i420_frame(WIDTH, HEIGHT, i)
+            encoder.encode(frame, {"key_frame": i == 0})
+            frame.close()
+        encoder.flush()
+        assert len(outputs) == end
+    encoder.close()
+
+    assert [chunk.timestamp for chunk in outputs] == [i * 33333 for i in range(20)]
+    assert _key_indices(outputs) == [0, 8]
+    assert _decode(outputs) == [i * 33333 for i in range(20)]
+
+
+def test_svt_av1_constant_bitrate():
+    """CONSTANT は QUALITY でも低遅延の予測構造でエンコードする"""
+    outputs = _encode(_config(bitrate_mode=VideoEncoderBitrateMode.CONSTANT), 15)
+    assert [chunk.timestamp for chunk in outputs] == [i * 33333 for i in range(15)]
+
+
+def test_svt_av1_quantizer():
+    """QUANTIZER モードでは av1.quantizer をフレームごとの QP として使う"""
+
+    def encode_with_quantizer(quantizer: int) -> int:
+        config = _config(bitrate_mode=VideoEncoderBitrateMode.QUANTIZER)
+        outputs = _encode(config, 10, options=lambda i: {"av1": {"quantizer": quantizer}})
+        assert len(outputs) == 10
+        return sum(chunk.byte_length for chunk in outputs)
+
+    assert encode_with_quantizer(10) > encode_with_quantizer(60)
+
+
+def test_svt_av1_segment_encode():
+    """GOP 並列エンコードのセグメントも SVT-AV1 でエンコードする"""
+    config = _config(latency_mode=LatencyMode.QUALITY, segment_frames=10, segment_threads=2)
+    outputs = _encode(config, 25)
+
+    assert [chunk.timestamp for chunk in outputs] == [i * 33333 for i in range(25)]
+    assert _key_indices(outputs) == [0, 10, 20]
+    assert _decode(outputs) == [i * 33333 for i in range(25)]
+
+
+def test_svt_av1_reconfigure_is_cold():
+    """av1_encoder を変更する再設定と、SVT-AV1 の再設定は cold になる"""
+    outputs = []
+    encoder = VideoEncoder(lambda chunk, metadata=None: outputs.append(chunk), pytest.fail)
+    encoder.configure(_config(av1_encoder=AV1EncoderImplementation.LIBAOM))
+    for i in range(5):
+        frame = create_moving_i420_frame(WIDTH, HEIGHT, i)
+        encoder.encode(frame, {"key_frame": i == 0})
+        frame.close()
+    encoder.configure(_config())
+    assert encoder.last_reconfigure == "cold"
+    encoder.configure(_config(bitrate=200_000))
+    assert encoder.last_reconfigure == "cold"
+    for i in range(5, 10):
+        frame = create_moving_i420_frame(WIDTH, HEIGHT, i)
+        encoder.encode(frame, {"key_frame": i == 5})
+        frame.close()
+    encoder.flush()
+    encoder.close()
+
+    assert [chunk.timestamp for chunk in outputs] == [i * 33333 for i in range(10)]
+
+
+@pytest.mark.parametrize(
+    "kwargs",
+    [
+        pytest.param({"codec": "av01.0.04M.10"}, id="10bit"),
+        pytest.param({"scalability_mode": "L1T2"}, id="scalability"),
+        pytest.param(
+            {"hardware_acceleration_engine": HardwareAccelerationEngine.NVIDIA_VIDEO_CODEC},
+            id="hardware",
+        ),
+    ],
+)
+def test_svt_av1_not_supported(kwargs):
+    """10 ビットやレイヤー構造、ハードウェアエンコーダーとの組み合わせは NotSupportedError になる"""
+    config = _config(**kwargs)
+    assert not VideoEncoder.is_config_supported(config)["supported"]
+
+    encoder = VideoEncoder(lambda chunk, metadata=None: None, pytest.fail)
+    with pytest.raises(RuntimeError, match="NotSupportedError"):
+        encoder.configure(config)
+    encoder.close()
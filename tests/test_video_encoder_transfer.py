@@ -0,0 +1,146 @@
+"""VideoEncoder.encode() の transfer オプションと RGB 入力のテスト"""
+
+import platform
+
+import numpy as np
+import pytest
+
+from webcodecs import (
+    LatencyMode,
+    VideoDecoder,
+    VideoDecoderConfig,
+    VideoEncoder,
+    VideoEncoderConfig,
+    VideoFrame,
+    VideoFrameBufferInit,
+    VideoPixelFormat,
+)
+
+CODECS = [
+    pytest.param("av01.0.04M.08", id="av1"),
+    pytest.param(
+        "vp8",
+        id="vp8",
+        marks=pytest.mark.skipif(
+            platform.system() not in ("Darwin", "Linux"),
+            reason="VP8 は macOS / Linux のみサポート",
+        ),
+    ),
+]
+
+
+def _make_frame(width: int, height: int, pixel_format: VideoPixelFormat, timestamp: int) -> VideoFrame:
+    """単色のフレームを作成する"""
+    if pixel_format == VideoPixelFormat.I420:
+        y = np.full(width * height, 120, dtype=np.uint8)
+        uv = np.full((width // 2) * (height // 2) * 2, 128, dtype=np.uint8)
+        data = np.concatenate([y, uv])
+    else:
+        # BGRA / RGBA でグレー
+        data = np.full((height, width, 4), 120, dtype=np.uint8)
+        data[:, :, 3] = 255
+    init: VideoFrameBufferInit = {
+        "format": pixel_format,
+        "coded_width": width,
+        "coded_height": height,
+        "timestamp": timestamp,
+    }
+    return VideoFrame(data, init)
+
+
+def _encode(codec: str, frames: list[VideoFrame], transfer: bool) -> list:
+    """フレームをエンコードしたチャンクを返す"""
+    chunks = []
+    encoder = VideoEncoder(lambda c: chunks.append(c), lambda e: pytest.fail(e))
+    config: VideoEncoderConfig = {
+        "codec": codec,
+        "width": frames[0].coded_width,
+        "height": frames[0].coded_height,
+        "bitrate": 500_000,
+        "framerate": 30.0,
+        "latency_mode": LatencyMode.REALTIME,
+    }
+    encoder.configure(config)
+    for i, frame in enumerate(frames):
+        encoder.encode(frame, {"key_frame": i == 0, "transfer": transfer})
+    encoder.flush()
+    encoder.close()
+    return chunks
+
+
+@pytest.mark.parametrize("codec", CODECS)
+def test_transfer_closes_frame(codec):
+    """transfer を指定するとフレームは close され、エンコード結果は変わらない"""
+    width, height = 320, 240
+    frames = [_make_frame(width, height, VideoPixelFormat.I420, i * 1000) for i in range(5)]
+    chunks = _encode(codec, frames, transfer=True)
+
+    assert len(chunks) == len(frames)
+    assert [c.timestamp for c in chunks] == [i * 1000 for i in range(5)]
+    for frame in frames:
+        assert frame.is_closed
+        with pytest.raises(RuntimeError):
+            frame.planes()
+
+
+@pytest.mark.parametrize("codec", CODECS)
+def test_without_transfer_keeps_frame(codec):
+    """transfer を指定しない場合はフレームを引き続き使える"""
+    width, height = 320, 240
+    frames = [_make_frame(width, height, VideoPixelFormat.I420, 0)]
+    chunks = _encode(codec, frames, transfer=False)
+
+    assert len(chunks) == 1
+    assert not frames[0].is_closed
+    frames[0].close()
+
+
+def test_transfer_with_invalid_option_keeps_frame():
+    """オプションの検証エラーではフレームを close しない"""
+    width, height = 320, 240
+    encoder = VideoEncoder(lambda c: None, lambda e: None)
+    config: VideoEncoderConfig = {
+        "codec": "av01.0.04M.08",
+        "width": width,
+        "height": height,
+        "bitrate": 500_000,
+        "framerate": 30.0,
+    }
+    encoder.configure(config)
+    frame = _make_frame(width, height, VideoPixelFormat.I420, 0)
+    with pytest.raises(ValueError):
+        encoder.encode(frame, {"transfer": True, "av1": {"quantizer": 64}})
+    assert not frame.is_closed
+    frame.close()
+    encoder.close()
+
+
+@pytest.mark.parametrize("codec", CODECS)
+@pytest.mark.parametrize("pixel_format", [VideoPixelFormat.BGRA, VideoPixelFormat.RGBA])
+@pytest.mark.parametrize("transfer", [False, True])
+def test_encode_rgb_input(codec, pixel_format, transfer):
+    """RGB 系の入力はエンコーダーの入力バッファへ直接 I420 に変換される"""
+    width, height = 320, 240
+    frames = [_make_frame(width, height, pixel_format, i * 1000) for i in range(3)]
+    chunks = _encode(codec, frames, transfer=transfer)
+    assert len(chunks) == len(frames)
+
+    decoded = []
+    decoder = VideoDecoder(lambda f: decoded.append(f), lambda e: pytest.fail(e))
+    dec_config: VideoDecoderConfig = {"codec": codec}
+    decoder.configure(dec_config)
+    for chunk in chunks:
+        decoder.decode(chunk)
+    decoder.flush()
+    decoder.close()
+
+    assert len(decoded) == len(frames)
+    # グレー (120, 120, 120) は BT.601 limited range で Y ≒ 119, U/V ≒ 128
+    y, u, v = decoded[0].planes()
+    assert abs(int(np.mean(y)) - 119) <= 4
+    assert abs(int(np.mean(u)) - 128) <= 4
+    assert abs(int(np.mean(v)) - 128) <= 4
+    for f in decoded:
+        f.close()
+    for f in frames:
+        f.close()
@@ -0,0 +1,191 @@
+"""デコーダーのピクチャバッファを参照する VideoFrame (ゼロコピー) のテスト"""
+
+import platform
+
+import numpy as np
+import pytest
+
+from webcodecs import (
+    LatencyMode,
+    VideoDecoder,
+    VideoDecoderConfig,
+    VideoEncoder,
+    VideoEncoderConfig,
+    VideoFrame,
+    VideoFrameBufferInit,
+    VideoPixelFormat,
+)
+
+
+def _make_gradient_frame(width: int, height: int) -> VideoFrame:
+    """グラデーションの I420 フレームを作成する"""
+    y = np.tile(np.arange(width, dtype=np.uint8), (height, 1))
+    u = np.full((height // 2, width // 2), 100, dtype=np.uint8)
+    v = np.full((height // 2, width // 2), 150, dtype=np.uint8)
+    data = np.concatenate([y.ravel(), u.ravel(), v.ravel()])
+    init: VideoFrameBufferInit = {
+        "format": VideoPixelFormat.I420,
+        "coded_width": width,
+        "coded_height": height,
+        "timestamp": 0,
+    }
+    return VideoFrame(data, init)
+
+
+def _encode_decode(codec: str, width: int, height: int) -> list[VideoFrame]:
+    """1 フレームをエンコードしてデコードし、デコード結果を返す"""
+    chunks = []
+
+    def on_encode_output(chunk):
+        chunks.append(chunk)
+
+    def on_encode_error(error):
+        pytest.fail(f"エンコーダーエラー: {error}")
+
+    encoder = VideoEncoder(on_encode_output, on_encode_error)
+    enc_config: VideoEncoderConfig = {
+        "codec": codec,
+        "width": width,
+        "height": height,
+        "bitrate": 500_000,
+        "framerate": 30.0,
+        "latency_mode": LatencyMode.REALTIME,
+    }
+    encoder.configure(enc_config)
+    frame = _make_gradient_frame(width, height)
+    encoder.encode(frame, {"key_frame": True})
+    encoder.flush()
+    frame.close()
+    encoder.close()
+
+    decoded_frames = []
+
+    def on_decode_output(f: VideoFrame):
+        decoded_frames.append(f)
+
+    def on_decode_error(err: str):
+        pytest.fail(f"デコーダーエラー: {err}")
+
+    decoder = VideoDecoder(on_decode_output, on_decode_error)
+    dec_config: VideoDecoderConfig = {"codec": codec}
+    decoder.configure(dec_config)
+    for c in chunks:
+        decoder.decode(c)
+    decoder.flush()
+    decoder.close()
+
+    assert len(decoded_frames) >= 1
+    return decoded_frames
+
+
+CODECS = [
+    pytest.param("av01.0.04M.08", id="av1"),
+    pytest.param(
+        "vp09.00.10.08",
+        id="vp9",
+        marks=pytest.mark.skipif(
+            platform.system() not in ("Darwin", "Linux"),
+            reason="VP9 は macOS / Linux のみサポート",
+        ),
+    ),
+]
+
+
+@pytest.mark.parametrize("codec", CODECS)
+def test_decoded_frame_planes_are_read_only_strided_views(codec):
+    """デコード結果の planes() はネイティブなストライドを持つ読み取り専用ビュー"""
+    width, height = 160, 120
+    frames = _encode_decode(codec, width, height)
+    out = frames[0]
+
+    y, u, v = out.planes()
+    assert y.shape == (height, width)
+    assert u.shape == (height // 2, width // 2)
+    assert v.shape == (height // 2, width // 2)
+    # ストライドはデコーダーのネイティブな値 (幅以上)
+    assert y.strides[0] >= width
+    assert u.strides[0] >= width // 2
+
+    # 参照フレームを書き換えないよう読み取り専用
+    assert not y.flags.writeable
+    with pytest.raises(ValueError):
+        y[0, 0] = 0
+
+    # layout にネイティブなストライドが反映される
+    layout = out.layout
+    assert layout is not None
+    assert len(layout) == 3
+    assert layout[0].stride == y.strides[0]
+    assert layout[1].stride == u.strides[0]
+
+    for f in frames:
+        f.close()
+
+
+@pytest.mark.parametrize("codec", CODECS)
+def test_decoded_frame_copy_to_is_packed(codec):
+    """copy_to() はストライドを詰めた配置で書き出す"""
+    width, height = 160, 120
+    frames = _encode_decode(codec, width, height)
+    out = frames[0]
+
+    y, u, v = out.planes()
+    destination = np.zeros(out.allocation_size(), dtype=np.uint8)
+    layouts = out.copy_to(destination)
+    assert layouts[0].stride == width
+    assert layouts[1].stride == width // 2
+
+    y_size = width * height
+    uv_size = (width // 2) * (height // 2)
+    np.testing.assert_array_equal(destination[:y_size].reshape(height, width), y)
+    np.testing.assert_array_equal(
+        destination[y_size : y_size + uv_size].reshape(height // 2, width // 2), u
+    )
+    np.testing.assert_array_equal(
+        destination[y_size + uv_size :].reshape(height // 2, width // 2), v
+    )
+
+    for f in frames:
+        f.close()
+
+
+@pytest.mark.parametrize("codec", CODECS)
+def test_decoded_frame_clone_outlives_original(codec):
+    """clone() は参照を共有し、元フレームを close しても有効なまま"""
+    width, height = 160, 120
+    frames = _encode_decode(codec, width, height)
+    out = frames[0]
+
+    expected = np.array(out.planes()[0])
+    cloned = out.clone()
+    for f in frames:
+        f.close()
+
+    np.testing.assert_array_equal(np.array(cloned.planes()[0]), expected)
+
+    # 変換や再エンコード用のコピーも可能
+    destination = np.zeros(cloned.allocation_size({"format": "RGBA"}), np.uint8)
+    cloned.copy_to(destination, {"format": "RGBA"})
+    cloned.close()
+
+    with pytest.raises(RuntimeError):
+        cloned.planes()
+
+
+@pytest.mark.parametrize("codec", CODECS)
+def test_decoded_frame_planes_outlive_close(codec):
+    """planes() / plane() のビューはフレームを close した後もピクチャを参照し続ける"""
+    width, height = 160, 120
+    frames = _encode_decode(codec, width, height)
+    out = frames[0]
+
+    y, u, v = out.planes()
+    y_plane = out.plane(0)
+    expected = np.array(y)
+    for f in frames:
+        f.close()
+
+    np.testing.assert_array_equal(np.array(y), expected)
+    np.testing.assert_array_equal(np.array(y_plane), expected)
+    assert u.shape == (height // 2, width // 2)
+    assert v.shape == (height // 2, width // 2)
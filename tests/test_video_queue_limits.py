@@ -0,0 +1,230 @@
+"""max_queue_size / max_queue_bytes / queue_full_policy (キューの上限) のテスト"""
+
+import time
+
+import pytest
+
+from webcodecs import (
+    LatencyMode,
+    QueueFullPolicy,
+    QuotaExceededError,
+    VideoDecoder,
+    VideoDecoderConfig,
+    VideoEncoder,
+    VideoEncoderConfig,
+)
+from video_test_helpers import create_solid_i420_frame
+
+CODEC = "av01.0.04M.08"
+WIDTH = 320
+HEIGHT = 240
+
+
+def _encoder_config(**extra) -> VideoEncoderConfig:
+    config: VideoEncoderConfig = {
+        "codec": CODEC,
+        "width": WIDTH,
+        "height": HEIGHT,
+        "bitrate": 500_000,
+        "framerate": 30.0,
+        "latency_mode": LatencyMode.REALTIME,
+    }
+    config.update(extra)
+    return config
+
+
+def _encode(num_frames: int, keyframe_interval: int = 0) -> list:
+    chunks = []
+    encoder = VideoEncoder(lambda c: chunks.append(c), lambda e: pytest.fail(e))
+    encoder.configure(_encoder_config())
+    for i in range(num_frames):
+        key_frame = i == 0 or (keyframe_interval > 0 and i % keyframe_interval == 0)
+        encoder.encode(
+            create_solid_i420_frame(WIDTH, HEIGHT, i * 1000, y=i * 10 % 256),
+            {"key_frame": key_frame, "transfer": True},
+        )
+    encoder.flush()
+    encoder.close()
+    return chunks
+
+
+def _slow_decoder(decoded: list) -> VideoDecoder:
+    def on_output(frame):
+        # Python 側の処理がデコードより遅い状況を再現する
+        time.sleep(0.01)
+        decoded.append(frame)
+
+    return VideoDecoder(on_output, lambda e: pytest.fail(e))
+
+
+def test_decoder_block():
+    """BLOCK は上限を超えないよう待機し、全フレームが順序通りに出力される"""
+    chunks = _encode(20)
+
+    decoded = []
+    decoder = _slow_decoder(decoded)
+    config: VideoDecoderConfig = {
+        "codec": CODEC,
+        "max_queue_size": 3,
+        "queue_full_policy": QueueFullPolicy.BLOCK,
+    }
+    decoder.configure(config)
+    for chunk in chunks:
+        decoder.decode(chunk)
+        assert decoder.decode_queue_size <= 3
+    decoder.flush()
+
+    assert [f.timestamp for f in decoded] == [c.timestamp for c in chunks]
+    assert 0 < decoder.decode_queue_high_water_mark <= 3
+    assert decoder.decode_queue_dropped == 0
+    for f in decoded:
+        f.close()
+    decoder.close()
+
+
+def test_decoder_block_bytes():
+    """max_queue_bytes でもキューの大きさを制限できる"""
+    chunks = _encode(10)
+    max_bytes = max(c.byte_length for c in chunks) * 2
+
+    decoded = []
+    decoder = _slow_decoder(decoded)
+    decoder.configure({"codec": CODEC, "max_queue_bytes": max_bytes})
+    decoder.decode_many(chunks)
+    decoder.flush()
+
+    assert [f.timestamp for f in decoded] == [c.timestamp for c in chunks]
+    assert decoder.decode_queue_high_water_mark <= 2
+    for f in decoded:
+        f.close()
+    decoder.close()
+
+
+def test_decoder_raise():
+    """RAISE は上限に達すると QuotaExceededError を送出する"""
+    chunks = _encode(20)
+
+    decoded = []
+    decoder = _slow_decoder(decoded)
+    decoder.configure(
+        {
+            "codec": CODEC,
+            "max_queue_size": 1,
+            "queue_full_policy": QueueFullPolicy.RAISE,
+        }
+    )
+    with pytest.raises(QuotaExceededError):
+        for chunk in chunks:
+            decoder.decode(chunk)
+    assert issubclass(QuotaExceededError, RuntimeError)
+
+    # 送出前にキューに追加したチャンクは出力される
+    decoder.flush()
+    assert len(decoded) > 0
+    for f in decoded:
+        f.close()
+    decoder.close()
+
+
+def test_decoder_drop_oldest():
+    """DROP_OLDEST は差分フレームを破棄し、残りのフレームは順序通りに出力される"""
+    num_frames = 30
+    chunks = _encode(num_frames, keyframe_interval=10)
+
+    decoded = []
+    decoder = _slow_decoder(decoded)
+    decoder.configure(
+        {
+            "codec": CODEC,
+            "max_queue_size": 2,
+            "queue_full_policy": QueueFullPolicy.DROP_OLDEST,
+        }
+    )
+    for chunk in chunks:
+        decoder.decode(chunk)
+        assert decoder.decode_queue_size <= 2
+    decoder.flush()
+
+    timestamps = [f.timestamp for f in decoded]
+    assert decoder.decode_queue_dropped > 0
+    assert len(decoded) + decoder.decode_queue_dropped == num_frames
+    assert timestamps == sorted(timestamps)
+    # キーフレームは破棄されない
+    for i in range(0, num_frames, 10):
+        assert i * 1000 in timestamps
+    for f in decoded:
+        f.close()
+
+    # reset() で統計情報もリセットされる
+    decoder.reset()
+    assert decoder.decode_queue_dropped == 0
+    assert decoder.decode_queue_high_water_mark == 0
+    decoder.close()
+
+
+def test_encoder_limits():
+    """エンコーダーも上限を超えず、DROP_OLDEST ではキーフレーム指定のないフレームを破棄する"""
+    num_frames = 10
+
+    def run(policy):
+        chunks = []
+
+        def on_output(chunk, metadata=None):
+            time.sleep(0.01)
+            chunks.append(chunk)
+
+        encoder = VideoEncoder(on_output, lambda e: pytest.fail(e))
+        encoder.configure(_encoder_config(max_queue_size=2, queue_full_policy=policy))
+        for i in range(num_frames):
+            encoder.encode(
+                create_solid_i420_frame(WIDTH, HEIGHT, i * 1000, y=i * 10 % 256),
+                {"key_frame": i == 0, "transfer": True},
+            )
+            assert encoder.encode_queue_size <= 2
+        encoder.flush()
+        timestamps = [c.timestamp for c in chunks]
+        assert timestamps == sorted(timestamps)
+        assert len(chunks) + encoder.encode_queue_dropped == num_frames
+        assert encoder.encode_queue_high_water_mark <= 2
+        encoder.close()
+        return timestamps
+
+    assert run(QueueFullPolicy.BLOCK) == [i * 1000 for i in range(num_frames)]
+    assert 0 in run(QueueFullPolicy.DROP_OLDEST)
+
+
+def test_encoder_raise_keeps_frame_open():
+    """QuotaExceededError の場合は transfer 指定のフレームも close されない"""
+
+    def on_output(chunk, metadata=None):
+        time.sleep(0.05)
+
+    encoder = VideoEncoder(on_output, lambda e: pytest.fail(e))
+    encoder.configure(
+        _encoder_config(max_queue_size=1, queue_full_policy=QueueFullPolicy.RAISE)
+    )
+    frames = [
+        create_solid_i420_frame(WIDTH, HEIGHT, i * 1000, y=i * 10 % 256)
+        for i in range(10)
+    ]
+    with pytest.raises(QuotaExceededError):
+        encoder.encode_many(frames, {"transfer": True})
+    assert not frames[-1].is_closed
+    encoder.flush()
+    for f in frames:
+        f.close()
+    encoder.close()
+
+
+@pytest.mark.parametrize("key", ["max_queue_size", "max_queue_bytes"])
+def test_invalid_limits(key):
+    """0 は ValueError になる"""
+    decoder = VideoDecoder(lambda f: None, lambda e: None)
+    with pytest.raises(ValueError):
+        decoder.configure({"codec": CODEC, key: 0})
+    decoder.close()
+
+    encoder = VideoEncoder(lambda c: None, lambda e: None)
+    with pytest.raises(ValueError):
+        encoder.configure(_encoder_config(**{key: 0}))
+    encoder.close()
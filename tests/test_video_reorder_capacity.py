@@ -0,0 +1,149 @@
+"""reorder_capacity (出力の並べ替えリングとバックプレッシャー) のテスト"""
+
+import time
+
+import pytest
+
+from webcodecs import (
+    LatencyMode,
+    VideoDecoder,
+    VideoDecoderConfig,
+    VideoEncoder,
+    VideoEncoderConfig,
+)
+from video_test_helpers import create_solid_i420_frame
+
+CODEC = "av01.0.04M.08"
+WIDTH = 320
+HEIGHT = 240
+
+
+def _encoder_config(**extra) -> VideoEncoderConfig:
+    config: VideoEncoderConfig = {
+        "codec": CODEC,
+        "width": WIDTH,
+        "height": HEIGHT,
+        "bitrate": 500_000,
+        "framerate": 30.0,
+        "latency_mode": LatencyMode.REALTIME,
+    }
+    config.update(extra)
+    return config
+
+
+def _encode(num_frames: int) -> list:
+    chunks = []
+    encoder = VideoEncoder(lambda c: chunks.append(c), lambda e: pytest.fail(e))
+    encoder.configure(_encoder_config())
+    for i in range(num_frames):
+        encoder.encode(
+            create_solid_i420_frame(WIDTH, HEIGHT, i * 1000, y=i * 10 % 256),
+            {"key_frame": i == 0, "transfer": True},
+        )
+    encoder.flush()
+    encoder.close()
+    return chunks
+
+
+@pytest.mark.parametrize("capacity", [1, 2, 8])
+def test_decoder_backpressure(capacity):
+    """出力が遅くても出力待ちは reorder_capacity を超えず、順序も保たれる"""
+    num_frames = 20
+    chunks = _encode(num_frames)
+
+    decoded = []
+
+    def on_output(frame):
+        # Python 側の処理がデコードより遅い状況を再現する
+        time.sleep(0.002)
+        decoded.append(frame)
+
+    decoder = VideoDecoder(on_output, lambda e: pytest.fail(e))
+    config: VideoDecoderConfig = {"codec": CODEC, "reorder_capacity": capacity}
+    decoder.configure(config)
+    for chunk in chunks:
+        decoder.decode(chunk)
+        assert decoder.decode_queue_size <= capacity
+    decoder.flush()
+
+    assert [f.timestamp for f in decoded] == [c.timestamp for c in chunks]
+    for f in decoded:
+        f.close()
+    decoder.close()
+
+
+def test_decoder_backpressure_decode_many():
+    """decode_many() もチャンクごとに空きを待ちながらキューに追加する"""
+    num_frames = 20
+    chunks = _encode(num_frames)
+
+    decoded = []
+    decoder = VideoDecoder(lambda f: decoded.append(f), lambda e: pytest.fail(e))
+    config: VideoDecoderConfig = {"codec": CODEC, "reorder_capacity": 4}
+    decoder.configure(config)
+    decoder.decode_many(chunks)
+    assert decoder.decode_queue_size <= 4
+    decoder.flush()
+
+    assert [f.timestamp for f in decoded] == [c.timestamp for c in chunks]
+    for f in decoded:
+        f.close()
+    decoder.close()
+
+
+def test_encoder_backpressure():
+    """エンコーダーも出力待ちが reorder_capacity を超えない"""
+    num_frames = 10
+    chunks = []
+
+    def on_output(chunk, metadata=None):
+        time.sleep(0.002)
+        chunks.append(chunk)
+
+    encoder = VideoEncoder(on_output, lambda e: pytest.fail(e))
+    encoder.configure(_encoder_config(reorder_capacity=2))
+    for i in range(num_frames):
+        encoder.encode(
+            create_solid_i420_frame(WIDTH, HEIGHT, i * 1000, y=i * 10 % 256),
+            {"key_frame": i == 0, "transfer": True},
+        )
+        assert encoder.encode_queue_size <= 2
+    encoder.flush()
+
+    assert [c.timestamp for c in chunks] == [i * 1000 for i in range(num_frames)]
+    encoder.close()
+
+
+def test_reconfigure_capacity():
+    """configure() で容量を変更してもデコードを続けられる"""
+    chunks = _encode(6)
+
+    decoded = []
+    decoder = VideoDecoder(lambda f: decoded.append(f), lambda e: pytest.fail(e))
+    decoder.configure({"codec": CODEC, "reorder_capacity": 16})
+    for chunk in chunks:
+        decoder.decode(chunk)
+    decoder.flush()
+    decoder.configure({"codec": CODEC, "reorder_capacity": 2})
+    for chunk in chunks:
+        decoder.decode(chunk)
+    decoder.flush()
+
+    assert [f.timestamp for f in decoded] == [c.timestamp for c in chunks] * 2
+    for f in decoded:
+        f.close()
+    decoder.close()
+
+
+@pytest.mark.parametrize("capacity", [0, 4097])
+def test_invalid_capacity(capacity):
+    """範囲外の値は ValueError になる"""
+    decoder = VideoDecoder(lambda f: None, lambda e: None)
+    with pytest.raises(ValueError):
+        decoder.configure({"codec": CODEC, "reorder_capacity": capacity})
+    decoder.close()
+
+    encoder = VideoEncoder(lambda c: None, lambda e: None)
+    with pytest.raises(ValueError):
+        encoder.configure(_encoder_config(reorder_capacity=capacity))
+    encoder.close()
@@ -0,0 +1,151 @@
+"""scalability_mode (SVC) のテスト"""
+
+import pytest
+
+from webcodecs import (
+    EncodedVideoChunkType,
+    HardwareAccelerationEngine,
+    LatencyMode,
+    VideoDecoder,
+    VideoEncoder,
+    VideoEncoderConfig,
+)
+from video_test_helpers import create_moving_i420_frame
+
+WIDTH = 320
+HEIGHT = 240
+
+CODECS = ["av01.0.04M.08", "vp09.00.10.08", "vp8"]
+
+
+def _encoder_config(codec: str, mode: str | None) -> VideoEncoderConfig:
+    config: VideoEncoderConfig = {
+        "codec": codec,
+        "width": WIDTH,
+        "height": HEIGHT,
+        "bitrate": 500_000,
+        "framerate": 30.0,
+        "latency_mode": LatencyMode.REALTIME,
+    }
+    if mode is not None:
+        config["scalability_mode"] = mode
+    return config
+
+
+def _encode(codec: str, mode: str | None, num_frames: int, keyframes=(0,)) -> list:
+    outputs = []
+    encoder = VideoEncoder(
+        lambda chunk, metadata=None: outputs.append((chunk, metadata)),
+        lambda e: pytest.fail(e),
+    )
+    encoder.configure(_encoder_config(codec, mode))
+    for i in range(num_frames):
+        frame = create_moving_i420_frame(WIDTH, HEIGHT, i, i * 1000)
+        encoder.encode(frame, {"key_frame": i in keyframes})
+        frame.close()
+    encoder.flush()
+    encoder.close()
+    return outputs
+
+
+def _decode(codec: str, chunks: list) -> int:
+    decoded = []
+    decoder = VideoDecoder(decoded.append, lambda e: pytest.fail(e))
+    decoder.configure({"codec": codec})
+    for chunk in chunks:
+        decoder.decode(chunk)
+    decoder.flush()
+    count = len(decoded)
+    for frame in decoded:
+        frame.close()
+    decoder.close()
+    return count
+
+
+@pytest.mark.parametrize("codec", CODECS)
+@pytest.mark.parametrize(
+    ("mode", "expected"),
+    [
+        ("L1T2", [0, 1, 0, 1, 0, 1, 0, 1]),
+        ("L1T3", [0, 2, 1, 2, 0, 2, 1, 2]),
+    ],
+)
+def test_temporal_layer_id(codec, mode, expected):
+    """時間レイヤーの temporal_layer_id が metadata.svc で提供される"""
+    outputs = _encode(codec, mode, len(expected))
+    assert len(outputs) == len(expected)
+    assert [m["svc"]["temporal_layer_id"] for _, m in outputs] == expected
+
+
+@pytest.mark.parametrize("codec", CODECS)
+def test_drop_upper_temporal_layer(codec):
+    """上位の時間レイヤーを破棄しても下位レイヤーだけでデコードできる"""
+    outputs = _encode(codec, "L1T3", 16)
+    base = [c for c, m in outputs if m["svc"]["temporal_layer_id"] == 0]
+    assert len(base) == 4
+    assert _decode(codec, base) == len(base)
+
+    # TL0 と TL1 だけでもデコードできる
+    lower = [c for c, m in outputs if m["svc"]["temporal_layer_id"] <= 1]
+    assert len(lower) == 8
+    assert _decode(codec, lower) == len(lower)
+
+
+@pytest.mark.parametrize("codec", ["av01.0.04M.08", "vp8"])
+def test_keyframe_resets_pattern(codec):
+    """AV1 / VP8 はキーフレームで時間レイヤーのパターンが先頭に戻る"""
+    outputs = _encode(codec, "L1T3", 6, keyframes=(0, 3))
+    assert outputs[3][0].type == EncodedVideoChunkType.KEY
+    assert [m["svc"]["temporal_layer_id"] for _, m in outputs] == [0, 2, 1, 0, 2, 1]
+
+
+@pytest.mark.parametrize("codec", ["av01.0.04M.08", "vp09.00.10.08"])
+@pytest.mark.parametrize("mode", ["L2T1", "L2T2", "L2T3"])
+def test_spatial_layers(codec, mode):
+    """空間レイヤーは 1 フレームにつき 1 チャンクにまとめて出力され、デコードできる"""
+    num_frames = 8
+    outputs = _encode(codec, mode, num_frames)
+    assert len(outputs) == num_frames
+    assert [c.timestamp for c, _ in outputs] == [i * 1000 for i in range(num_frames)]
+    assert all("svc" in m for _, m in outputs)
+    assert _decode(codec, [c for c, _ in outputs]) == num_frames
+
+
+@pytest.mark.parametrize("codec", CODECS)
+def test_l1t1(codec):
+    """L1T1 は通常のエンコードと同じで、temporal_layer_id は常に 0"""
+    outputs = _encode(codec, "L1T1", 4)
+    assert [m["svc"]["temporal_layer_id"] for _, m in outputs] == [0, 0, 0, 0]
+
+
+def test_no_svc_metadata_without_scalability_mode():
+    """scalability_mode を指定しない場合は svc を含めない"""
+    outputs = _encode("vp8", None, 2)
+    assert all(m is None or "svc" not in m for _, m in outputs)
+
+
+@pytest.mark.parametrize(
+    ("codec", "mode"),
+    [
+        ("vp8", "L2T1"),
+        ("av01.0.04M.08", "L3T3"),
+        ("av01.0.04M.08", "S2T1"),
+        ("vp09.00.10.08", "invalid"),
+    ],
+)
+def test_unsupported_mode(codec, mode):
+    """対応していないモードは is_config_supported() が False で、configure() は RuntimeError"""
+    config = _encoder_config(codec, mode)
+    assert not VideoEncoder.is_config_supported(config)["supported"]
+
+    encoder = VideoEncoder(lambda c: None, lambda e: None)
+    with pytest.raises(RuntimeError):
+        encoder.configure(config)
+    encoder.close()
+
+
+def test_hardware_encoder_is_not_supported():
+    """ハードウェアエンコーダーは scalability_mode に対応していない"""
+    config = _encoder_config("av01.0.04M.08", "L1T2")
+    config["hardware_acceleration_engine"] = HardwareAccelerationEngine.NVIDIA_VIDEO_CODEC
+    assert not VideoEncoder.is_config_supported(config)["supported"]
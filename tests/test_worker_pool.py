@@ -0,0 +1,213 @@
+"""WorkerPool (複数のコーデックで共有するワーカースレッド) のテスト"""
+
+import os
+import sys
+
+import numpy as np
+import pytest
+from audio_test_helpers import generate_sine_wave
+from video_test_helpers import create_solid_i420_frame
+
+from webcodecs import (
+    AudioData,
+    AudioDataInit,
+    AudioDecoder,
+    AudioEncoder,
+    AudioEncoderConfig,
+    AudioSampleFormat,
+    VideoDecoder,
+    VideoEncoder,
+    VideoEncoderConfig,
+    WorkerPool,
+    get_default_worker_pool,
+    set_default_worker_pool,
+)
+
+SAMPLE_RATE = 48000
+FRAME_SIZE = 960  # 20ms
+WIDTH = 320
+HEIGHT = 240
+
+
+@pytest.fixture(autouse=True)
+def restore_default_worker_pool():
+    """テストごとにデフォルトのプールを元に戻す"""
+    yield
+    set_default_worker_pool(None)
+
+
+def _opus_config() -> AudioEncoderConfig:
+    return {
+        "codec": "opus",
+        "sample_rate": SAMPLE_RATE,
+        "number_of_channels": 1,
+        "bitrate": 32000,
+    }
+
+
+def _make_audio_data(samples: np.ndarray, timestamp: int) -> AudioData:
+    init: AudioDataInit = {
+        "format": AudioSampleFormat.F32,
+        "sample_rate": SAMPLE_RATE,
+        "number_of_frames": len(samples),
+        "number_of_channels": 1,
+        "timestamp": timestamp,
+        "data": samples.reshape(len(samples), 1),
+    }
+    return AudioData(init)
+
+
+def _thread_count() -> int:
+    return len(os.listdir("/proc/self/task"))
+
+
+def test_worker_pool_threads():
+    """スレッド数を指定しない場合は論理コア数になる"""
+    assert WorkerPool(threads=3).threads == 3
+    assert WorkerPool().threads == max(1, os.cpu_count() or 1)
+    assert WorkerPool(threads=2, cpu_affinity=[0]).cpu_affinity == [0]
+
+
+@pytest.mark.parametrize("kwargs", [{"threads": 0}, {"threads": 2000}, {"cpu_affinity": [1 << 20]}])
+def test_worker_pool_invalid_arguments(kwargs):
+    """不正なスレッド数や CPU 番号は ValueError になる"""
+    with pytest.raises(ValueError):
+        WorkerPool(**kwargs)
+
+
+def test_many_audio_encoders_share_pool():
+    """多数の AudioEncoder が 1 つのプールを共有しても、インスタンスごとの出力順は保たれる"""
+    pool = WorkerPool(threads=2)
+    num_encoders = 64
+    num_packets = 10
+    samples = generate_sine_wave(440, SAMPLE_RATE, num_packets * FRAME_SIZE / SAMPLE_RATE)
+
+    outputs: list[list] = [[] for _ in range(num_encoders)]
+    encoders = []
+    for i in range(num_encoders):
+        encoder = AudioEncoder(outputs[i].append, lambda e: pytest.fail(e), worker_pool=pool)
+        encoder.configure(_opus_config())
+        encoders.append(encoder)
+
+    # インスタンスをまたいで交互に投入する
+    for n in range(num_packets):
+        for encoder in encoders:
+            start = n * FRAME_SIZE
+            audio = _make_audio_data(samples[start : start + FRAME_SIZE], n * 20000)
+            encoder.encode(audio)
+            audio.close()
+
+    for encoder in encoders:
+        encoder.flush()
+        encoder.close()
+
+    for chunks in outputs:
+        assert [chunk.timestamp for chunk in chunks] == [n * 20000 for n in range(num_packets)]
+
+
+def test_audio_decoder_with_pool():
+    """AudioDecoder もプールで処理できる"""
+    pool = WorkerPool(threads=1)
+    samples = generate_sine_wave(440, SAMPLE_RATE, 0.2)
+    chunks = []
+    encoder = AudioEncoder(chunks.append, lambda e: pytest.fail(e), worker_pool=pool)
+    encoder.configure(_opus_config())
+    audio = _make_audio_data(samples, 0)
+    encoder.encode(audio)
+    audio.close()
+    encoder.flush()
+    encoder.close()
+
+    decoded = []
+    decoder = AudioDecoder(decoded.append, lambda e: pytest.fail(e), worker_pool=pool)
+    decoder.configure({"codec": "opus", "sample_rate": SAMPLE_RATE, "number_of_channels": 1})
+    for chunk in chunks:
+        decoder.decode(chunk)
+    decoder.flush()
+    assert [data.timestamp for data in decoded] == [chunk.timestamp for chunk in chunks]
+    for data in decoded:
+        data.close()
+    decoder.close()
+
+
+def test_video_encode_decode_with_pool():
+    """VideoEncoder / VideoDecoder をプールで処理しても出力順は保たれる"""
+    pool = WorkerPool(threads=2)
+    num_frames = 20
+    codec = "av01.0.04M.08"
+
+    chunks = []
+    encoder = VideoEncoder(chunks.append, lambda e: pytest.fail(e), worker_pool=pool)
+    enc_config: VideoEncoderConfig = {
+        "codec": codec,
+        "width": WIDTH,
+        "height": HEIGHT,
+        "bitrate": 500_000,
+        "framerate": 30.0,
+    }
+    encoder.configure(enc_config)
+    for i in range(num_frames):
+        frame = create_solid_i420_frame(WIDTH, HEIGHT, i * 33333, y=i * 16 % 256)
+        encoder.encode(frame, {"key_frame": i == 0})
+        frame.close()
+    encoder.flush()
+    encoder.close()
+    assert [chunk.timestamp for chunk in chunks] == [i * 33333 for i in range(num_frames)]
+
+    frames = []
+    decoder = VideoDecoder(frames.append, lambda e: pytest.fail(e), worker_pool=pool)
+    decoder.configure({"codec": codec})
+    decoder.decode_many(chunks)
+    decoder.flush()
+    assert [frame.timestamp for frame in frames] == [i * 33333 for i in range(num_frames)]
+    for frame in frames:
+        frame.close()
+
+    # reset() 後も同じプールで処理を続けられる
+    frames.clear()
+    decoder.reset()
+    decoder.configure({"codec": codec})
+    decoder.decode_many(chunks)
+    decoder.flush()
+    assert len(frames) == num_frames
+    for frame in frames:
+        frame.close()
+    decoder.close()
+
+
+def test_default_worker_pool():
+    """デフォルトのプールは、設定後に作成したインスタンスで使われる"""
+    assert get_default_worker_pool() is None
+    pool = WorkerPool(threads=1)
+    set_default_worker_pool(pool)
+    assert get_default_worker_pool() is pool
+
+    chunks = []
+    encoder = AudioEncoder(chunks.append, lambda e: pytest.fail(e))
+    encoder.configure(_opus_config())
+    audio = _make_audio_data(generate_sine_wave(440, SAMPLE_RATE, 0.1), 0)
+    encoder.encode(audio)
+    audio.close()
+    encoder.flush()
+    encoder.close()
+    assert len(chunks) == 5
+
+    set_default_worker_pool(None)
+    assert get_default_worker_pool() is None
+
+
+@pytest.mark.skipif(sys.platform != "linux", reason="/proc/self/task は Linux のみ")
+def test_pool_bounds_thread_count():
+    """プールを使うとインスタンス数に関係なくスレッド数はプールのスレッド数に収まる"""
+    pool = WorkerPool(threads=2)
+    before = _thread_count()
+
+    encoders = []
+    for _ in range(100):
+        encoder = AudioEncoder(lambda c: None, lambda e: pytest.fail(e), worker_pool=pool)
+        encoder.configure(_opus_config())
+        encoders.append(encoder)
+    assert _thread_count() - before < 10
+
+    for encoder in encoders:
+        encoder.close()
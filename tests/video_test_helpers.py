@@ -1,7 +1,7 @@
 """ビデオテスト用ユーティリティ関数"""
 
 import numpy as np
-from typing import Tuple
+from typing import Optional, Tuple
 from webcodecs import VideoFrame, VideoFrameBufferInit, VideoPixelFormat
 
 
@@ -96,6 +96,80 @@ def create_video_frame_from_yuv(
     return VideoFrame(data, init)
 
 
+def create_solid_i420_frame(
+    width: int,
+    height: int,
+    timestamp: int = 0,
+    y: int = 128,
+    u: int = 128,
+    v: int = 128,
+) -> VideoFrame:
+    """全画素が同じ色の I420 の VideoFrame を作成する
+
+    Args:
+        width: フレーム幅
+        height: フレーム高さ
+        timestamp: タイムスタンプ（マイクロ秒）
+        y: Y の値
+        u: U の値
+        v: V の値
+
+    Returns:
+        VideoFrame: 作成された VideoFrame
+    """
+    chroma_size = (width // 2) * (height // 2)
+    data = np.concatenate(
+        [
+            np.full(width * height, y, dtype=np.uint8),
+            np.full(chroma_size, u, dtype=np.uint8),
+            np.full(chroma_size, v, dtype=np.uint8),
+        ]
+    )
+    init: VideoFrameBufferInit = {
+        "format": VideoPixelFormat.I420,
+        "coded_width": width,
+        "coded_height": height,
+        "timestamp": timestamp,
+    }
+    return VideoFrame(data, init)
+
+
+def create_moving_i420_frame(
+    width: int,
+    height: int,
+    frame_num: int,
+    timestamp: Optional[int] = None,
+    duration: Optional[int] = None,
+) -> VideoFrame:
+    """フレームごとに模様が動く I420 の VideoFrame を作成する
+
+    レート制御や先読みが働くように、輝度の斜めの縞をフレーム番号でずらす。
+
+    Args:
+        width: フレーム幅
+        height: フレーム高さ
+        frame_num: フレーム番号（模様の移動量）
+        timestamp: タイムスタンプ（マイクロ秒、省略時は 30fps 相当の frame_num * 33333）
+        duration: 表示時間（マイクロ秒、省略時は指定しない）
+
+    Returns:
+        VideoFrame: 作成された VideoFrame
+    """
+    y_plane = np.fromfunction(
+        lambda row, col: (row * 3 + col + frame_num * 8) % 256, (height, width), dtype=np.int32
+    ).astype(np.uint8)
+    uv = np.full((width // 2) * (height // 2) * 2, 128, dtype=np.uint8)
+    init: VideoFrameBufferInit = {
+        "format": VideoPixelFormat.I420,
+        "coded_width": width,
+        "coded_height": height,
+        "timestamp": frame_num * 33333 if timestamp is None else timestamp,
+    }
+    if duration is not None:
+        init["duration"] = duration
+    return VideoFrame(np.concatenate([y_plane.reshape(-1), uv]), init)
+
+
 # ============================================
 # YUV パターン生成関数
 # ============================================